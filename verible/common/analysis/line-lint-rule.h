@@ -20,6 +20,7 @@
 #define VERIBLE_COMMON_ANALYSIS_LINE_LINT_RULE_H_
 
 #include <string_view>
+#include <vector>
 
 #include "verible/common/analysis/lint-rule.h"
 
@@ -32,6 +33,14 @@ class LineLintRule : public LintRule {
   // Scans a single line during analysis.
   virtual void HandleLine(std::string_view line) = 0;
 
+  // Scans all lines of a file, in order.  LineLinter calls this once per rule
+  // instead of making a virtual HandleLine() call for every line.
+  // Rules that can examine many lines at a time (e.g. with a single search
+  // over the underlying buffer) should override this.
+  virtual void HandleLines(const std::vector<std::string_view> &lines) {
+    for (const auto &line : lines) HandleLine(line);
+  }
+
   // Analyze the final state of the rule, after the last line has been read.
   virtual void Finalize() {}
 };
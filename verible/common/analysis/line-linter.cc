@@ -26,12 +26,8 @@ namespace verible {
 
 void LineLinter::Lint(const std::vector<std::string_view> &lines) {
   VLOG(1) << "LineLinter analyzing lines with " << rules_.size() << " rules.";
-  for (const auto &line : lines) {
-    for (const auto &rule : rules_) {
-      ABSL_DIE_IF_NULL(rule)->HandleLine(line);
-    }
-  }
   for (const auto &rule : rules_) {
+    ABSL_DIE_IF_NULL(rule)->HandleLines(lines);
     rule->Finalize();
   }
 }
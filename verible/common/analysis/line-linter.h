@@ -19,6 +19,8 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_LINE_LINTER_H_
 #define VERIBLE_COMMON_ANALYSIS_LINE_LINTER_H_
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <string_view>
 #include <utility>
@@ -39,6 +41,13 @@ class LineLinter {
     rules_.emplace_back(std::move(rule));
   }
 
+  // Prepares all rules for analyzing another input: rules are Reset() in
+  // place, or else replaced with recreate(index).
+  void ResetRules(
+      const std::function<std::unique_ptr<LineLintRule>(size_t)> &recreate) {
+    ResetOrRecreateRules(&rules_, recreate);
+  }
+
   // Aggregates results of each held LintRule
   std::vector<LintRuleStatus> ReportStatus() const;
 
@@ -138,5 +138,85 @@ TEST(LineLinterTest, FinalizeRejects) {
   EXPECT_THAT(statuses[0].violations, SizeIs(1));
 }
 
+// Mock rule that scans all lines at once.
+class BulkLineCountRule : public LineLintRule {
+ public:
+  void HandleLine(std::string_view line) final { ++single_calls_; }
+
+  void HandleLines(const std::vector<std::string_view> &lines) final {
+    ++bulk_calls_;
+    lines_ += lines.size();
+  }
+
+  LintRuleStatus Report() const final { return LintRuleStatus(); }
+
+  size_t single_calls_ = 0;
+  size_t bulk_calls_ = 0;
+  size_t lines_ = 0;
+};
+
+// This test verifies that LineLinter hands all lines to a rule at once.
+TEST(LineLinterTest, BulkHandleLines) {
+  std::vector<std::string_view> lines{"a", "b", "c"};
+  auto *rule = new BulkLineCountRule;
+  LineLinter linter;
+  linter.AddRule(std::unique_ptr<LineLintRule>(rule));
+  linter.Lint(lines);
+  EXPECT_EQ(rule->bulk_calls_, 1);
+  EXPECT_EQ(rule->single_calls_, 0);
+  EXPECT_EQ(rule->lines_, 3);
+}
+
+// Mock rule that counts lines, and can be reused.
+class ReusableLineCountRule : public LineLintRule {
+ public:
+  void HandleLine(std::string_view line) final { ++lines_; }
+
+  LintRuleStatus Report() const final { return LintRuleStatus(); }
+
+  bool Reset() final {
+    lines_ = 0;
+    ++resets_;
+    return true;
+  }
+
+  size_t lines_ = 0;
+  size_t resets_ = 0;
+};
+
+// This test verifies that ResetRules reuses rules that support Reset(), and
+// re-creates the others.
+TEST(LineLinterTest, ResetRules) {
+  auto *reusable = new ReusableLineCountRule;
+  LineLinter linter;
+  linter.AddRule(std::unique_ptr<LineLintRule>(reusable));
+  linter.AddRule(MakeBlankLineRule());
+  {
+    std::vector<std::string_view> lines{"a", ""};
+    linter.Lint(lines);
+    std::vector<LintRuleStatus> statuses = linter.ReportStatus();
+    ASSERT_THAT(statuses, SizeIs(2));
+    EXPECT_THAT(statuses[1].violations, SizeIs(1));
+  }
+
+  std::vector<size_t> recreated;
+  linter.ResetRules([&recreated](size_t index) {
+    recreated.push_back(index);
+    return MakeBlankLineRule();
+  });
+  EXPECT_THAT(recreated, testing::ElementsAre(1));
+  EXPECT_EQ(reusable->resets_, 1);
+  EXPECT_EQ(reusable->lines_, 0);
+
+  {
+    std::vector<std::string_view> lines{"a", "b", "c"};
+    linter.Lint(lines);
+    std::vector<LintRuleStatus> statuses = linter.ReportStatus();
+    ASSERT_THAT(statuses, SizeIs(2));
+    EXPECT_THAT(statuses[1].violations, IsEmpty());
+    EXPECT_EQ(reusable->lines_, 3);
+  }
+}
+
 }  // namespace
 }  // namespace verible
@@ -18,7 +18,11 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_LINT_RULE_H_
 #define VERIBLE_COMMON_ANALYSIS_LINT_RULE_H_
 
+#include <cstddef>
+#include <functional>
+#include <memory>
 #include <string_view>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "verible/common/analysis/lint-rule-status.h"
@@ -46,8 +50,28 @@ class LintRule {
   // Report() returns a LintRuleStatus, which summarizes the results so
   // far of running the LintRule.
   virtual LintRuleStatus Report() const = 0;
+
+  // Discards all state accumulated while analyzing a file (such as
+  // violations), but keeps the configuration, so that one instance can be
+  // reused to analyze another file.  This saves re-running Configure() and
+  // any setup work done on construction (e.g. compiling regular expressions).
+  // Returns false if the rule does not support reuse, in which case a new
+  // instance must be created instead.
+  virtual bool Reset() { return false; }
 };
 
+// Calls Reset() on every rule in 'rules', and replaces each rule that does not
+// support it with recreate(index), where index is the rule's position.
+template <class RuleType>
+void ResetOrRecreateRules(
+    std::vector<std::unique_ptr<RuleType>> *rules,
+    const std::function<std::unique_ptr<RuleType>(size_t)> &recreate) {
+  for (size_t i = 0; i < rules->size(); ++i) {
+    auto &rule = (*rules)[i];
+    if (!rule->Reset()) rule = recreate(i);
+  }
+}
+
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_ANALYSIS_LINT_RULE_H_
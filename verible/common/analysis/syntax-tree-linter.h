@@ -19,6 +19,8 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_SYNTAX_TREE_LINTER_H_
 #define VERIBLE_COMMON_ANALYSIS_SYNTAX_TREE_LINTER_H_
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -58,6 +60,14 @@ class SyntaxTreeLinter : public TreeContextVisitor {
     rules_.emplace_back(std::move(rule));
   }
 
+  // Prepares all rules for analyzing another input: rules are Reset() in
+  // place, or else replaced with recreate(index).
+  void ResetRules(
+      const std::function<std::unique_ptr<SyntaxTreeLintRule>(size_t)>
+          &recreate) {
+    ResetOrRecreateRules(&rules_, recreate);
+  }
+
   // Aggregates results of each held LintRule
   std::vector<LintRuleStatus> ReportStatus() const;
 
@@ -21,6 +21,7 @@
 
 #include "verible/common/analysis/lint-rule.h"
 #include "verible/common/text/token-info.h"
+#include "verible/common/text/token-stream-view.h"
 
 namespace verible {
 
@@ -30,6 +31,14 @@ class TokenStreamLintRule : public LintRule {
 
   // Scans a single token during analysis.
   virtual void HandleToken(const TokenInfo &token) = 0;
+
+  // Scans the whole token stream, in order.  TokenStreamLinter calls this
+  // once per rule instead of making a virtual HandleToken() call for every
+  // token.  Rules that only care about a few token kinds can override this
+  // with a tighter scan.
+  virtual void HandleTokens(const TokenSequence &tokens) {
+    for (const auto &token : tokens) HandleToken(token);
+  }
 };
 
 }  // namespace verible
@@ -26,10 +26,8 @@ namespace verible {
 void TokenStreamLinter::Lint(const TokenSequence &tokens) {
   VLOG(1) << "TokenStreamLinter analyzing tokens with " << rules_.size()
           << " rules.";
-  for (const auto &token : tokens) {
-    for (const auto &rule : rules_) {
-      ABSL_DIE_IF_NULL(rule)->HandleToken(token);
-    }
+  for (const auto &rule : rules_) {
+    ABSL_DIE_IF_NULL(rule)->HandleTokens(tokens);
   }
 }
 
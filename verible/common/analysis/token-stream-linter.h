@@ -19,6 +19,8 @@
 #ifndef VERIBLE_COMMON_ANALYSIS_TOKEN_STREAM_LINTER_H_
 #define VERIBLE_COMMON_ANALYSIS_TOKEN_STREAM_LINTER_H_
 
+#include <cstddef>
+#include <functional>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -39,6 +41,14 @@ class TokenStreamLinter {
     rules_.emplace_back(std::move(rule));
   }
 
+  // Prepares all rules for analyzing another input: rules are Reset() in
+  // place, or else replaced with recreate(index).
+  void ResetRules(
+      const std::function<std::unique_ptr<TokenStreamLintRule>(size_t)>
+          &recreate) {
+    ResetOrRecreateRules(&rules_, recreate);
+  }
+
   // Aggregates results of each held LintRule
   std::vector<LintRuleStatus> ReportStatus() const;
 
@@ -14,10 +14,13 @@
 
 #include "verible/common/lsp/json-rpc-dispatcher.h"
 
+#include <cstddef>
 #include <exception>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
 
 #include "nlohmann/json.hpp"
 #include "verible/common/util/logging.h"
@@ -29,8 +32,7 @@ void JsonRpcDispatcher::DispatchMessage(std::string_view data) {
   try {
     request = nlohmann::json::parse(data);
   } catch (const std::exception &e) {
-    ++statistic_counters_[e.what()];
-    ++exception_count_;
+    Count(e.what(), /*exception=*/true);
     SendReply(CreateError(request, kParseError, e.what()));
     return;
   }
@@ -38,11 +40,17 @@ void JsonRpcDispatcher::DispatchMessage(std::string_view data) {
   if (request.find("method") == request.end()) {
     SendReply(
         CreateError(request, kMethodNotFound, "Method required in request"));
-    ++statistic_counters_["Request without method"];
+    Count("Request without method");
     return;
   }
   const std::string &method = request["method"];
 
+  if (method == "$/cancelRequest") {
+    // Too late: we only see this after having answered the request.
+    Count(method + "  ev");
+    return;
+  }
+
   // Direct dispatch, later maybe send to an executor that returns futures ?
   const bool is_notification = (request.find("id") == request.end());
   VLOG(1) << "Got " << (is_notification ? "notification" : "method call")
@@ -53,8 +61,8 @@ void JsonRpcDispatcher::DispatchMessage(std::string_view data) {
   } else {
     handled = CallRequestHandler(request, method);
   }
-  ++statistic_counters_[method + (handled ? "" : " (unhandled)") +
-                        (is_notification ? "  ev" : " RPC")];
+  Count(method + (handled ? "" : " (unhandled)") +
+        (is_notification ? "  ev" : " RPC"));
 }
 
 // Methods/Notifications without parameters can also send nothing for "params".
@@ -77,8 +85,7 @@ bool JsonRpcDispatcher::CallNotification(const nlohmann::json &req,
     fun_to_call(ExtractParams(req));
     return true;
   } catch (const std::exception &e) {
-    ++exception_count_;
-    ++statistic_counters_[method + " : " + e.what()];
+    Count(method + " : " + e.what(), /*exception=*/true);
     LOG(ERROR) << "Notification error for '" << method << "' :" << e.what();
   }
   return false;
@@ -87,23 +94,93 @@ bool JsonRpcDispatcher::CallNotification(const nlohmann::json &req,
 bool JsonRpcDispatcher::CallRequestHandler(const nlohmann::json &req,
                                            const std::string &method) {
   const auto &found = handlers_.find(method);
+  const std::string id = req["id"].dump();
+  bool cancelled;
+  {
+    // In one step, so that a cancellation finds the request either queued
+    // or running.
+    const std::lock_guard<std::mutex> l(cancel_mutex_);
+    if (auto queued = queued_ids_.find(id); queued != queued_ids_.end()) {
+      queued_ids_.erase(queued);
+    }
+    cancelled = cancelled_ids_.erase(id) > 0;
+    if (!cancelled && found != handlers_.end()) {
+      running_requests_[std::this_thread::get_id()] = {.id = id};
+    }
+  }
   if (found == handlers_.end()) {
     SendReply(CreateError(req, kMethodNotFound,
                           "method '" + method + "' not found."));
     LOG(ERROR) << "Unhandled method '" << method << "'";
     return false;
   }
+  if (cancelled) {
+    Count(method + " (cancelled)");
+    SendReply(CreateError(req, kRequestCancelled, "Request cancelled"));
+    return true;
+  }
   const auto &fun_to_call = found->second;
+  const nlohmann::json &params = ExtractParams(req);
+  if (before_request_) before_request_(method, params);
+  bool handled = false;
+  nlohmann::json response;
   try {
-    SendReply(MakeResponse(req, fun_to_call(ExtractParams(req))));
-    return true;
+    response = MakeResponse(req, fun_to_call(params));
+    handled = true;
   } catch (const std::exception &e) {
-    ++exception_count_;
-    ++statistic_counters_[method + " : " + e.what()];
-    SendReply(CreateError(req, kInternalError, e.what()));
+    Count(method + " : " + e.what(), /*exception=*/true);
+    response = CreateError(req, kInternalError, e.what());
     LOG(ERROR) << "Method error for '" << method << "' :" << e.what();
   }
-  return false;
+  bool cancelled_while_running;
+  {
+    const std::lock_guard<std::mutex> l(cancel_mutex_);
+    cancelled_while_running =
+        running_requests_.extract(std::this_thread::get_id())
+            .mapped()
+            .cancelled;
+  }
+  if (handled && cancelled_while_running) {
+    Count(method + " (cancelled)");
+    response = CreateError(req, kRequestCancelled, "Request cancelled");
+  }
+  SendReply(response);
+  return handled;
+}
+
+void JsonRpcDispatcher::RequestQueued(const nlohmann::json &id) {
+  const std::lock_guard<std::mutex> l(cancel_mutex_);
+  queued_ids_.insert(id.dump());
+}
+
+void JsonRpcDispatcher::CancelRequest(const nlohmann::json &id) {
+  const std::string serialized = id.dump();
+  const std::lock_guard<std::mutex> l(cancel_mutex_);
+  for (auto &[thread, running] : running_requests_) {
+    if (running.id == serialized) {
+      running.cancelled = true;
+      return;
+    }
+  }
+  if (queued_ids_.count(serialized) > 0) {
+    cancelled_ids_.insert(serialized);
+  }
+}
+
+bool JsonRpcDispatcher::IsCurrentRequestCancelled() const {
+  const std::lock_guard<std::mutex> l(cancel_mutex_);
+  const auto found = running_requests_.find(std::this_thread::get_id());
+  return found != running_requests_.end() && found->second.cancelled;
+}
+
+size_t JsonRpcDispatcher::queued_request_count() const {
+  const std::lock_guard<std::mutex> l(cancel_mutex_);
+  return queued_ids_.size();
+}
+
+size_t JsonRpcDispatcher::cancelled_request_count() const {
+  const std::lock_guard<std::mutex> l(cancel_mutex_);
+  return cancelled_ids_.size();
 }
 
 void JsonRpcDispatcher::SendNotification(const std::string &method,
@@ -144,7 +221,14 @@ void JsonRpcDispatcher::SendNotification(const std::string &method,
 void JsonRpcDispatcher::SendReply(const nlohmann::json &response) {
   std::stringstream out_bytes;
   out_bytes << response << "\n";
+  const std::lock_guard<std::mutex> l(write_mutex_);
   write_fun_(out_bytes.str());
 }
+
+void JsonRpcDispatcher::Count(const std::string &name, bool exception) {
+  const std::lock_guard<std::mutex> l(stats_mutex_);
+  ++statistic_counters_[name];
+  if (exception) ++exception_count_;
+}
 }  // namespace lsp
 }  // namespace verible
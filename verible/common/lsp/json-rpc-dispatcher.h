@@ -15,10 +15,14 @@
 #ifndef VERIBLE_COMMON_LSP_JSON_RPC_DISPATCHER_H
 #define VERIBLE_COMMON_LSP_JSON_RPC_DISPATCHER_H
 
+#include <cstddef>
 #include <functional>
 #include <map>
+#include <mutex>
+#include <set>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <unordered_map>
 #include <utility>
 
@@ -36,6 +40,10 @@ namespace lsp {
 // All receiving (call to DispatchMessage()) and writing of response (WriteFun)
 // is abstracted out to make the dispatcher agnostic of the transport layer.
 //
+// Once the handlers are registered, messages can be dispatched from several
+// threads at once. The handlers of these then run concurrently, and the
+// WriteFun is called by one thread at a time.
+//
 // The RPCHandlers take and return json objects, but since nlohmann::json
 // provides ways to auto-convert objects to json, it is possible to
 // register properly typed handlers. To create the boilerplate for custom
@@ -57,6 +65,9 @@ class JsonRpcDispatcher {
   static constexpr int kParseError = -32700;
   static constexpr int kMethodNotFound = -32601;
   static constexpr int kInternalError = -32603;
+  // Defined by the Language Server Protocol, in the range the JSON RPC
+  // specification reserves for implementations.
+  static constexpr int kRequestCancelled = -32800;
 
   // A notification receives a request, but does not return anything
   using RPCNotification = std::function<void(const nlohmann::json &r)>;
@@ -92,11 +103,50 @@ class JsonRpcDispatcher {
     return notifications_.insert({method_name, fun}).second;
   }
 
+  // Set a function that is called with the method name and the parameters
+  // before each request handler, but not for notifications; e.g. to send
+  // notifications that should reach the client before the response.
+  using BeforeRequestFun = std::function<void(const std::string &method,
+                                              const nlohmann::json &params)>;
+  void SetBeforeRequestHandler(BeforeRequestFun fun) {
+    before_request_ = std::move(fun);
+  }
+
   // Dispatch incoming message, a string view with json data.
   // Call this with the content of exactly one message.
   // If this is an RPC call, response will call WriteFun.
   void DispatchMessage(std::string_view data);
 
+  // Announces that the request with the given "id" was read, and will be
+  // passed to DispatchMessage() later. Only such requests, and those whose
+  // handler is running, can be cancelled.
+  void RequestQueued(const nlohmann::json &id);
+
+  // Marks the request with the given "id" as cancelled, if it is queued or
+  // running. A cancelled request is answered with a kRequestCancelled error
+  // instead of its result; if its handler has not been called yet, it will
+  // not be. Requests that were answered already are not remembered, as
+  // clients often cancel those.
+  //
+  // Unlike all other methods, RequestQueued() and this can be called from
+  // any thread, e.g. one that reads ahead of the messages passed to
+  // DispatchMessage(). A "$/cancelRequest" notification passed to
+  // DispatchMessage() on the other hand arrives after the request it
+  // cancels was answered, and is ignored.
+  void CancelRequest(const nlohmann::json &id);
+
+  // Number of requests announced with RequestQueued() that are not
+  // dispatched yet.
+  size_t queued_request_count() const;
+
+  // Number of queued requests that are cancelled.
+  size_t cancelled_request_count() const;
+
+  // Returns true if the request whose handler is running in the calling
+  // thread has been cancelled. Handlers that take long may check this, and
+  // return early.
+  bool IsCurrentRequestCancelled() const;
+
   // Send a notification to the client side. Parameters will be wrapped
   // in a JSON-RPC message and pushed out to the WriteFun
   void SendNotification(const std::string &method,
@@ -104,19 +154,29 @@ class JsonRpcDispatcher {
 
   // Get some human-readable statistical counters of methods called
   // and exception messages encountered.
-  const StatsMap &GetStatCounters() const { return statistic_counters_; }
+  StatsMap GetStatCounters() const {
+    const std::lock_guard<std::mutex> l(stats_mutex_);
+    return statistic_counters_;
+  }
 
   // Number of exceptions that have been dealt with and turned into error
   // messages or ignored depending on the context.
   // The counters returned by GetStatsCounters() will report counts by
   // exception message.
-  int exception_count() const { return exception_count_; }
+  int exception_count() const {
+    const std::lock_guard<std::mutex> l(stats_mutex_);
+    return exception_count_;
+  }
 
  private:
   bool CallNotification(const nlohmann::json &req, const std::string &method);
   bool CallRequestHandler(const nlohmann::json &req, const std::string &method);
   void SendReply(const nlohmann::json &response);
 
+  // Increments the statistic counter "name"; also the exception count if
+  // it is about an exception.
+  void Count(const std::string &name, bool exception = false);
+
   static nlohmann::json CreateError(const nlohmann::json &request, int code,
                                     std::string_view message);
   static nlohmann::json MakeResponse(const nlohmann::json &request,
@@ -126,8 +186,26 @@ class JsonRpcDispatcher {
 
   std::unordered_map<std::string, RPCCallHandler> handlers_;
   std::unordered_map<std::string, RPCNotification> notifications_;
+  BeforeRequestFun before_request_;
+
+  std::mutex write_mutex_;
+
+  mutable std::mutex stats_mutex_;
   int exception_count_ = 0;
   StatsMap statistic_counters_;
+
+  mutable std::mutex cancel_mutex_;
+  // Serialized ids of requests that were read but not dispatched yet; a
+  // client may re-use an id once it got the response.
+  std::multiset<std::string> queued_ids_;
+  // The subset of queued_ids_ that were cancelled.
+  std::set<std::string> cancelled_ids_;
+  // The requests whose handlers are running, by the thread running them.
+  struct RunningRequest {
+    std::string id;  // Serialized.
+    bool cancelled = false;
+  };
+  std::map<std::thread::id, RunningRequest> running_requests_;
 };
 }  // namespace lsp
 }  // namespace verible
@@ -14,10 +14,14 @@
 
 #include "verible/common/lsp/json-rpc-dispatcher.h"
 
+#include <atomic>
 #include <iostream>
+#include <map>
 #include <stdexcept>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "nlohmann/json.hpp"
@@ -243,6 +247,157 @@ TEST(JsonRpcDispatcherTest, CallRpcHandler_MissingMethodImplemented) {
   EXPECT_EQ(dispatcher.exception_count(), 0);
 }
 
+TEST(JsonRpcDispatcherTest, CallRpcHandler_CancelledBeforeStart) {
+  std::vector<json> replies;
+  int rpc_fun_called = 0;
+
+  JsonRpcDispatcher dispatcher(
+      [&](std::string_view s) { replies.push_back(json::parse(s)); });
+  dispatcher.AddRequestHandler("foo", [&](const json &j) -> json {
+    ++rpc_fun_called;
+    return "response";
+  });
+
+  dispatcher.RequestQueued(1);
+  dispatcher.CancelRequest(1);
+  EXPECT_EQ(dispatcher.cancelled_request_count(), 1);
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":1,"method":"foo"})");
+  EXPECT_EQ(rpc_fun_called, 0);
+  EXPECT_EQ(dispatcher.queued_request_count(), 0);
+  EXPECT_EQ(dispatcher.cancelled_request_count(), 0);
+  ASSERT_EQ(replies.size(), 1);
+  EXPECT_EQ(replies[0]["id"], 1);
+  EXPECT_EQ(replies[0]["error"]["code"], JsonRpcDispatcher::kRequestCancelled);
+
+  // Other requests, or a re-used id, are not affected.
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":"1","method":"foo"})");
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":1,"method":"foo"})");
+  EXPECT_EQ(rpc_fun_called, 2);
+  ASSERT_EQ(replies.size(), 3);
+  EXPECT_EQ(replies[1]["result"], "response");
+  EXPECT_EQ(replies[2]["result"], "response");
+}
+
+TEST(JsonRpcDispatcherTest, CallRpcHandler_CancelledWhileRunning) {
+  std::vector<json> replies;
+
+  JsonRpcDispatcher dispatcher(
+      [&](std::string_view s) { replies.push_back(json::parse(s)); });
+  dispatcher.AddRequestHandler("foo", [&](const json &j) -> json {
+    EXPECT_FALSE(dispatcher.IsCurrentRequestCancelled());
+    dispatcher.CancelRequest(j["cancel"]);  // As if from another thread.
+    return dispatcher.IsCurrentRequestCancelled() ? "partial" : "response";
+  });
+
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","id":1,"method":"foo","params":{"cancel":1}})");
+  ASSERT_EQ(replies.size(), 1);
+  EXPECT_EQ(replies[0]["error"]["code"], JsonRpcDispatcher::kRequestCancelled);
+  EXPECT_TRUE(replies[0].find("result") == replies[0].end());
+
+  // Cancelling another request does not affect the running one.
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","id":2,"method":"foo","params":{"cancel":3}})");
+  ASSERT_EQ(replies.size(), 2);
+  EXPECT_EQ(replies[1]["result"], "response");
+}
+
+TEST(JsonRpcDispatcherTest, CancelAnsweredRequestIsNotRetained) {
+  std::vector<json> replies;
+  JsonRpcDispatcher dispatcher(
+      [&](std::string_view s) { replies.push_back(json::parse(s)); });
+  dispatcher.AddRequestHandler("foo", [](const json &) { return "response"; });
+
+  dispatcher.RequestQueued(1);
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":1,"method":"foo"})");
+  EXPECT_EQ(dispatcher.queued_request_count(), 0);
+
+  // Clients cancel requests after they got the response, or that never
+  // existed; neither is remembered.
+  dispatcher.CancelRequest(1);
+  dispatcher.CancelRequest(42);
+  EXPECT_EQ(dispatcher.cancelled_request_count(), 0);
+
+  // So the id can be re-used.
+  dispatcher.RequestQueued(1);
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":1,"method":"foo"})");
+  ASSERT_EQ(replies.size(), 2);
+  EXPECT_EQ(replies[1]["result"], "response");
+
+  // Requests for unknown methods leave nothing behind either.
+  dispatcher.RequestQueued(2);
+  dispatcher.CancelRequest(2);
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","id":2,"method":"bar"})");
+  EXPECT_EQ(dispatcher.queued_request_count(), 0);
+  EXPECT_EQ(dispatcher.cancelled_request_count(), 0);
+}
+
+TEST(JsonRpcDispatcherTest, CancelOneOfConcurrentRequests) {
+  std::map<int, json> replies;  // By id.
+  JsonRpcDispatcher dispatcher([&](std::string_view s) {
+    const json reply = json::parse(s);
+    replies[reply["id"]] = reply;
+  });
+  std::atomic<int> running = 0;
+  std::atomic<bool> cancel_sent = false;
+  dispatcher.AddRequestHandler("foo", [&](const json &) -> json {
+    ++running;
+    while (!cancel_sent) std::this_thread::yield();
+    return dispatcher.IsCurrentRequestCancelled();
+  });
+
+  std::vector<std::thread> threads;
+  for (int id : {1, 2}) {
+    threads.emplace_back([&dispatcher, id]() {
+      dispatcher.DispatchMessage(
+          json{{"jsonrpc", "2.0"}, {"id", id}, {"method", "foo"}}.dump());
+    });
+  }
+  while (running < 2) std::this_thread::yield();
+  dispatcher.CancelRequest(1);
+  cancel_sent = true;
+  for (std::thread &thread : threads) thread.join();
+
+  ASSERT_EQ(replies.size(), 2);
+  EXPECT_EQ(replies[1]["error"]["code"], JsonRpcDispatcher::kRequestCancelled);
+  EXPECT_EQ(replies[2]["result"], false);
+}
+
+TEST(JsonRpcDispatcherTest, CancelNotificationAfterResponseIsIgnored) {
+  int write_fun_called = 0;
+  JsonRpcDispatcher dispatcher([&](std::string_view s) { ++write_fun_called; });
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","method":"$/cancelRequest","params":{"id":1}})");
+  EXPECT_EQ(write_fun_called, 0);
+  EXPECT_EQ(dispatcher.exception_count(), 0);
+}
+
+TEST(JsonRpcDispatcherTest, BeforeRequestHandlerIsOnlyCalledForRequests) {
+  std::vector<std::string> written;
+  JsonRpcDispatcher dispatcher(
+      [&](std::string_view s) { written.emplace_back(s); });
+  dispatcher.AddRequestHandler("foo", [](const json &) { return "response"; });
+  dispatcher.AddNotificationHandler("bar", [](const json &) {});
+  std::vector<std::string> before;
+  dispatcher.SetBeforeRequestHandler(
+      [&](const std::string &method, const json &params) {
+        before.push_back(method);
+        dispatcher.SendNotification("update", params);
+      });
+
+  dispatcher.DispatchMessage(R"({"jsonrpc":"2.0","method":"bar"})");
+  EXPECT_TRUE(before.empty());
+  EXPECT_TRUE(written.empty());
+
+  dispatcher.DispatchMessage(
+      R"({"jsonrpc":"2.0","id":1,"method":"foo","params":"first"})");
+  ASSERT_EQ(before.size(), 1);
+  EXPECT_EQ(before[0], "foo");
+  ASSERT_EQ(written.size(), 2);
+  EXPECT_EQ(json::parse(written[0])["params"], "first");
+  EXPECT_EQ(json::parse(written[1])["result"], "response");
+}
+
 TEST(JsonRpcDispatcherTest, SendNotificationToClient) {
   int write_fun_called = 0;
   JsonRpcDispatcher dispatcher([&](std::string_view s) {
@@ -70,6 +70,40 @@ enum InlayHintKind {
   kType = 1,
   kParameter = 2,
 };
+
+// These are the CompletionItemKinds defined by the LSP specification.
+// https://microsoft.github.io/language-server-protocol/specifications/lsp/3.17/specification/#completionItemKind
+// Many of the names are the same as in SymbolKind, so they are scoped in a
+// struct, but still usable as plain integer constants.
+struct CompletionItemKind {
+  enum : int {
+    kText = 1,
+    kMethod = 2,
+    kFunction = 3,  // SV function or task
+    kConstructor = 4,
+    kField = 5,
+    kVariable = 6,  // SV data, net, variable or instance
+    kClass = 7,
+    kInterface = 8,
+    kModule = 9,  // SV module or package
+    kProperty = 10,
+    kUnit = 11,
+    kValue = 12,
+    kEnum = 13,
+    kKeyword = 14,
+    kSnippet = 15,
+    kColor = 16,
+    kFile = 17,
+    kReference = 18,
+    kFolder = 19,
+    kEnumMember = 20,
+    kConstant = 21,  // SV parameter or macro
+    kStruct = 22,
+    kEvent = 23,
+    kOperator = 24,
+    kTypeParameter = 25,  // SV typedef
+  };
+};
 }  // namespace lsp
 }  // namespace verible
 #endif  // COMMON_LSP_LSP_PROTOCOL_ENUMS_H
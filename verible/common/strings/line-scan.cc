@@ -0,0 +1,75 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/common/strings/line-scan.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+namespace verible {
+
+bool AreOrderedSlices(const std::vector<std::string_view> &lines) {
+  const char *prev_end = nullptr;
+  for (const std::string_view line : lines) {
+    if (line.data() == nullptr || line.data() < prev_end) return false;
+    prev_end = line.data() + line.length();
+  }
+  return true;
+}
+
+std::vector<LineCharMatch> FindFirstInEachLine(
+    const std::vector<std::string_view> &lines, char c) {
+  std::vector<LineCharMatch> matches;
+  if (lines.empty()) return matches;
+
+  if (!AreOrderedSlices(lines)) {
+    for (size_t i = 0; i < lines.size(); ++i) {
+      const size_t pos = lines[i].find(c);
+      if (pos != std::string_view::npos) matches.push_back({i, pos});
+    }
+    return matches;
+  }
+
+  // Search the whole span at once, including any gaps between lines
+  // (usually just newlines), and discard hits that fall into gaps.
+  const char *pos = lines.front().data();
+  const char *const end = lines.back().data() + lines.back().length();
+  auto line_iter = lines.begin();
+  while (pos < end) {
+    const auto *hit =
+        static_cast<const char *>(std::memchr(pos, c, end - pos));
+    if (hit == nullptr) break;
+    // Find the last line that starts at or before the hit.
+    line_iter = std::prev(std::upper_bound(
+        line_iter, lines.end(), hit,
+        [](const char *p, std::string_view line) { return p < line.data(); }));
+    const char *const line_end = line_iter->data() + line_iter->length();
+    if (hit < line_end) {
+      matches.push_back({static_cast<size_t>(line_iter - lines.begin()),
+                         static_cast<size_t>(hit - line_iter->data())});
+      // Skip the rest of this line: only the first occurrence is wanted.
+      pos = line_end;
+    } else {
+      // Hit is in the gap after this line.
+      pos = hit + 1;
+    }
+  }
+  return matches;
+}
+
+}  // namespace verible
@@ -0,0 +1,51 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_STRINGS_LINE_SCAN_H_
+#define VERIBLE_COMMON_STRINGS_LINE_SCAN_H_
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+namespace verible {
+
+// Location of a character found by FindFirstInEachLine().
+struct LineCharMatch {
+  size_t line;    // index into the scanned lines
+  size_t column;  // byte offset within that line
+
+  bool operator==(const LineCharMatch &other) const {
+    return line == other.line && column == other.column;
+  }
+};
+
+// Returns true if every line is a non-null slice that starts at or after the
+// end of the previous one, as is the case for lines split out of one buffer
+// (e.g. TextStructureView::Lines()).
+bool AreOrderedSlices(const std::vector<std::string_view> &lines);
+
+// Returns the line index and column of the first occurrence of 'c' in each
+// line that contains it, in line order.
+//
+// When 'lines' are ordered slices of a common buffer (see AreOrderedSlices()),
+// the whole span is searched as one block with memchr(), which libc
+// implementations vectorize, so that lines without 'c' incur no per-line
+// work.  Otherwise, each line is searched separately.
+std::vector<LineCharMatch> FindFirstInEachLine(
+    const std::vector<std::string_view> &lines, char c);
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_STRINGS_LINE_SCAN_H_
@@ -0,0 +1,106 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/common/strings/line-scan.h"
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+
+static std::ostream &operator<<(std::ostream &stream,
+                                const LineCharMatch &match) {
+  return stream << '(' << match.line << ", " << match.column << ')';
+}
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+std::vector<std::string_view> SplitLines(std::string_view text) {
+  return absl::StrSplit(text, '\n');
+}
+
+TEST(AreOrderedSlicesTest, Various) {
+  const std::string_view text("abc\ndef\n");
+  EXPECT_TRUE(AreOrderedSlices({}));
+  EXPECT_TRUE(AreOrderedSlices(SplitLines(text)));
+  EXPECT_TRUE(AreOrderedSlices({text.substr(0, 2), text.substr(2, 2)}));
+  EXPECT_FALSE(AreOrderedSlices({text.substr(4), text.substr(0, 3)}));
+  EXPECT_FALSE(AreOrderedSlices({text.substr(0, 3), text.substr(1, 3)}));
+  EXPECT_FALSE(AreOrderedSlices({std::string_view()}));
+}
+
+TEST(FindFirstInEachLineTest, Empty) {
+  EXPECT_THAT(FindFirstInEachLine({}, '\t'), IsEmpty());
+  EXPECT_THAT(FindFirstInEachLine(SplitLines(""), '\t'), IsEmpty());
+  EXPECT_THAT(FindFirstInEachLine(SplitLines("\n\n"), '\t'), IsEmpty());
+}
+
+TEST(FindFirstInEachLineTest, OnlyFirstPerLine) {
+  EXPECT_THAT(FindFirstInEachLine(SplitLines("\t\t\na\tb\t\n\nxyz\n\t"), '\t'),
+              ElementsAre(LineCharMatch{0, 0}, LineCharMatch{1, 1},
+                          LineCharMatch{4, 0}));
+}
+
+TEST(FindFirstInEachLineTest, IgnoresGapsBetweenLines) {
+  // Lines exclude the separators, which must not be reported.
+  EXPECT_THAT(FindFirstInEachLine(SplitLines("a\nb\n\nc\n"), '\n'), IsEmpty());
+  const std::string_view text("ab;cd;ef");
+  EXPECT_THAT(
+      FindFirstInEachLine({text.substr(0, 2), text.substr(6, 2)}, 'd'),
+      IsEmpty());
+}
+
+TEST(FindFirstInEachLineTest, UnorderedLines) {
+  const std::string first("xxa"), second("ayy");
+  // Separate buffers, in descending address order.
+  const std::vector<std::string_view> lines =
+      first.data() < second.data()
+          ? std::vector<std::string_view>{second, "", first}
+          : std::vector<std::string_view>{first, "", second};
+  EXPECT_THAT(FindFirstInEachLine(lines, 'a'),
+              ElementsAre(LineCharMatch{0, lines[0].find('a')},
+                          LineCharMatch{2, lines[2].find('a')}));
+}
+
+// Differential test against a line-by-line search.
+TEST(FindFirstInEachLineTest, MatchesLineByLineSearch) {
+  std::string text;
+  for (int i = 0; i < 1000; ++i) {
+    text += std::string(i % 7, ' ');
+    if (i % 5 == 0) text += '\t';
+    text += std::string(i % 3, 'x');
+    if (i % 11 == 0) text += "\t\t";
+    text += '\n';
+  }
+  const std::vector<std::string_view> lines = SplitLines(text);
+  std::vector<LineCharMatch> expected;
+  for (size_t i = 0; i < lines.size(); ++i) {
+    const size_t pos = lines[i].find('\t');
+    if (pos != std::string_view::npos) expected.push_back({i, pos});
+  }
+  EXPECT_EQ(FindFirstInEachLine(lines, '\t'), expected);
+}
+
+}  // namespace
+}  // namespace verible
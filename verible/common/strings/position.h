@@ -34,13 +34,17 @@ int AdvancingTextNewColumnPosition(int old_column_position,
 // Intentionally defining a class instead of merely typedef-ing to
 // IntervalSet<int> to avoid potential confusion with other IntervalSet<int>.
 // Type safety will enforce intent of meaning.
-class ByteOffsetSet : public verible::IntervalSet<int> {
-  using impl_type = verible::IntervalSet<int>;
+// Uses flat storage, because these are queried per token while formatting.
+class ByteOffsetSet : public verible::FlatIntervalSet<int> {
+  using impl_type = verible::FlatIntervalSet<int>;
 
  public:
   ByteOffsetSet() = default;
 
-  explicit ByteOffsetSet(const impl_type &iset) : impl_type(iset) {}
+  // Initializes from an IntervalSet<int> with any storage type.
+  template <typename S>
+  explicit ByteOffsetSet(const verible::IntervalSet<int, S> &iset)
+      : impl_type(iset) {}
 
   // This constructor can initialize from a sequence of pairs, e.g.
   //   ByteOffsetSet s{{0,1}, {4,7}, {8,10}};
@@ -52,13 +56,17 @@ class ByteOffsetSet : public verible::IntervalSet<int> {
 // Intentionally defining this as its own class instead of a typedef to
 // avoid potential confusion with other IntervalSet<int>.
 // Mismatches will be caught as type errors.
-class LineNumberSet : public verible::IntervalSet<int> {
-  using impl_type = verible::IntervalSet<int>;
+// Uses flat storage, because these are queried per line (e.g. lint waivers).
+class LineNumberSet : public verible::FlatIntervalSet<int> {
+  using impl_type = verible::FlatIntervalSet<int>;
 
  public:
   LineNumberSet() = default;
 
-  explicit LineNumberSet(const impl_type &iset) : impl_type(iset) {}
+  // Initializes from an IntervalSet<int> with any storage type.
+  template <typename S>
+  explicit LineNumberSet(const verible::IntervalSet<int, S> &iset)
+      : impl_type(iset) {}
 
   // This constructor can initialize from a sequence of pairs, e.g.
   //   LineNumberSet s{{0,1}, {4,7}, {8,10}};
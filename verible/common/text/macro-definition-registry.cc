@@ -0,0 +1,123 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/common/text/macro-definition-registry.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "absl/container/node_hash_set.h"
+#include "verible/common/text/macro-definition.h"
+
+namespace verible {
+
+void MacroDefinitionRegistry::const_iterator::SkipHidden() {
+  while (layer_ != nullptr) {
+    if (current_ == layer_->definitions.end()) {
+      layer_ = layer_->below.get();
+      if (layer_ != nullptr) current_ = layer_->definitions.begin();
+      continue;
+    }
+    bool hidden = false;
+    const std::string_view name = current_->first;
+    for (const Layer *above = top_; above != layer_;
+         above = above->below.get()) {
+      if (above->definitions.contains(name) ||
+          above->undefined.contains(name)) {
+        hidden = true;
+        break;
+      }
+    }
+    if (!hidden) return;
+    ++current_;
+  }
+}
+
+MacroDefinitionRegistry::MacroDefinitionRegistry()
+    : names_(std::make_shared<absl::node_hash_set<std::string>>()),
+      top_(std::make_shared<Layer>()) {}
+
+MacroDefinitionRegistry::const_iterator MacroDefinitionRegistry::begin()
+    const {
+  const_iterator result(top_.get(), top_.get(), top_->definitions.begin());
+  result.SkipHidden();
+  return result;
+}
+
+MacroDefinitionRegistry::const_iterator MacroDefinitionRegistry::find(
+    std::string_view name) const {
+  for (const Layer *layer = top_.get(); layer != nullptr;
+       layer = layer->below.get()) {
+    const auto found = layer->definitions.find(name);
+    if (found != layer->definitions.end()) {
+      return const_iterator(top_.get(), layer, found);
+    }
+    if (layer->undefined.contains(name)) break;
+  }
+  return end();
+}
+
+const MacroDefinition *MacroDefinitionRegistry::Lookup(
+    std::string_view name) const {
+  for (const Layer *layer = top_.get(); layer != nullptr;
+       layer = layer->below.get()) {
+    const auto found = layer->definitions.find(name);
+    if (found != layer->definitions.end()) return &found->second;
+    if (layer->undefined.contains(name)) return nullptr;
+  }
+  return nullptr;
+}
+
+bool MacroDefinitionRegistry::Define(const MacroDefinition &definition) {
+  const bool inserted = Lookup(definition.Name()) == nullptr;
+  Layer *top = MutableTop();
+  const std::string_view name = Intern(definition.Name());
+  top->undefined.erase(name);
+  top->definitions.insert_or_assign(name, definition);
+  if (inserted) ++size_;
+  return inserted;
+}
+
+bool MacroDefinitionRegistry::Undefine(std::string_view name) {
+  if (Lookup(name) == nullptr) return false;
+  Layer *top = MutableTop();
+  top->definitions.erase(name);
+  if (top->below != nullptr) top->undefined.insert(Intern(name));
+  --size_;
+  return true;
+}
+
+void MacroDefinitionRegistry::clear() {
+  names_ = std::make_shared<absl::node_hash_set<std::string>>();
+  top_ = std::make_shared<Layer>();
+  size_ = 0;
+}
+
+MacroDefinitionRegistry::Layer *MacroDefinitionRegistry::MutableTop() {
+  // Copies of this registry, or layers stacked on top of ours by them, still
+  // see the current top layer.
+  if (top_.use_count() > 1) {
+    auto layer = std::make_shared<Layer>();
+    layer->below = std::move(top_);
+    top_ = std::move(layer);
+  }
+  return top_.get();
+}
+
+std::string_view MacroDefinitionRegistry::Intern(std::string_view name) {
+  return *names_->emplace(name).first;
+}
+
+}  // namespace verible
@@ -0,0 +1,147 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_TEXT_MACRO_DEFINITION_REGISTRY_H_
+#define VERIBLE_COMMON_TEXT_MACRO_DEFINITION_REGISTRY_H_
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "absl/container/flat_hash_set.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/container/node_hash_set.h"
+#include "verible/common/text/macro-definition.h"
+
+namespace verible {
+
+// MacroDefinitionRegistry maps macro names to their definitions.
+//
+// Lookups are hashed.  The names are interned, so the keys do not refer to
+// the memory of the tokens that defined the macros.
+//
+// Copying a registry is cheap, regardless of the number of macros: the copy
+// shares all definitions with the original, and whichever of them changes
+// afterwards stores its changes in a layer of its own (copy-on-write).
+// Copies also share the interned names, so a registry and its copies must not
+// be used concurrently.
+//
+// The interface follows std::map where it makes sense, but iteration order is
+// unspecified.
+class MacroDefinitionRegistry {
+  struct Layer;
+  using DefinitionMap = absl::node_hash_map<std::string_view, MacroDefinition>;
+
+ public:
+  using key_type = std::string_view;
+  using mapped_type = MacroDefinition;
+  using value_type = DefinitionMap::value_type;
+
+  // Iterates over the visible definitions.
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = MacroDefinitionRegistry::value_type;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type *;
+    using reference = const value_type &;
+
+    const_iterator() = default;
+
+    reference operator*() const { return *current_; }
+    pointer operator->() const { return &*current_; }
+
+    const_iterator &operator++() {
+      ++current_;
+      SkipHidden();
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return layer_ == other.layer_ &&
+             (layer_ == nullptr || current_ == other.current_);
+    }
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class MacroDefinitionRegistry;
+
+    const_iterator(const Layer *top, const Layer *layer,
+                   DefinitionMap::const_iterator current)
+        : top_(top), layer_(layer), current_(current) {}
+
+    // Advances to the next definition that no layer above overrides.
+    void SkipHidden();
+
+    const Layer *top_ = nullptr;
+    const Layer *layer_ = nullptr;  // nullptr at the end
+    DefinitionMap::const_iterator current_;
+  };
+  using iterator = const_iterator;
+
+  MacroDefinitionRegistry();
+
+  const_iterator begin() const;
+  const_iterator end() const { return const_iterator(); }
+  const_iterator find(std::string_view name) const;
+
+  // Returns the definition of 'name', or nullptr if it is not defined.
+  const MacroDefinition *Lookup(std::string_view name) const;
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Defines, or re-defines, the macro definition.Name().
+  // Returns true if it was not defined before.
+  bool Define(const MacroDefinition &definition);
+
+  // Removes the definition of 'name'.  Returns true if it was defined.
+  bool Undefine(std::string_view name);
+
+  // Removes all definitions.
+  void clear();
+
+ private:
+  // Definitions that override those of the layers below.
+  struct Layer {
+    std::shared_ptr<const Layer> below;
+    DefinitionMap definitions;
+    // Names that are defined below, but not in this layer.
+    absl::flat_hash_set<std::string_view> undefined;
+  };
+
+  // Returns the top layer, after giving this registry its own one if the
+  // current one is shared.
+  Layer *MutableTop();
+
+  std::string_view Intern(std::string_view name);
+
+  std::shared_ptr<absl::node_hash_set<std::string>> names_;
+  std::shared_ptr<Layer> top_;
+  size_t size_ = 0;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_TEXT_MACRO_DEFINITION_REGISTRY_H_
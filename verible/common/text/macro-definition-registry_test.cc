@@ -0,0 +1,166 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/common/text/macro-definition-registry.h"
+
+#include <map>
+#include <string>
+#include <string_view>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/common/text/macro-definition.h"
+#include "verible/common/text/token-info.h"
+
+namespace verible {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+// Returns a definition of 'name' with the body 'body'.  The texts must
+// outlive the definition.
+MacroDefinition MakeDefinition(std::string_view name, std::string_view body) {
+  MacroDefinition definition(TokenInfo(1, "`define"), TokenInfo(2, name));
+  definition.SetDefinitionText(TokenInfo(3, body));
+  return definition;
+}
+
+// Returns name -> body of all definitions visible by iteration.
+std::map<std::string, std::string> Contents(
+    const MacroDefinitionRegistry &registry) {
+  std::map<std::string, std::string> result;
+  for (const auto &[name, definition] : registry) {
+    EXPECT_EQ(name, definition.Name());
+    const bool inserted =
+        result
+            .emplace(std::string(name),
+                     std::string(definition.DefinitionText().text()))
+            .second;
+    EXPECT_TRUE(inserted) << "visited twice: " << name;
+  }
+  EXPECT_EQ(result.size(), registry.size());
+  return result;
+}
+
+TEST(MacroDefinitionRegistryTest, Empty) {
+  const MacroDefinitionRegistry registry;
+  EXPECT_TRUE(registry.empty());
+  EXPECT_EQ(registry.size(), 0);
+  EXPECT_EQ(registry.begin(), registry.end());
+  EXPECT_EQ(registry.Lookup("FOO"), nullptr);
+  EXPECT_EQ(registry.find("FOO"), registry.end());
+}
+
+TEST(MacroDefinitionRegistryTest, DefineUndefine) {
+  MacroDefinitionRegistry registry;
+  EXPECT_TRUE(registry.Define(MakeDefinition("FOO", "1")));
+  EXPECT_TRUE(registry.Define(MakeDefinition("BAR", "2")));
+  EXPECT_FALSE(registry.Define(MakeDefinition("FOO", "3")));  // re-defined
+  EXPECT_EQ(registry.size(), 2);
+  ASSERT_NE(registry.Lookup("FOO"), nullptr);
+  EXPECT_EQ(registry.Lookup("FOO")->DefinitionText().text(), "3");
+  const auto found = registry.find("BAR");
+  ASSERT_NE(found, registry.end());
+  EXPECT_EQ(found->first, "BAR");
+  EXPECT_EQ(found->second.DefinitionText().text(), "2");
+
+  EXPECT_TRUE(registry.Undefine("FOO"));
+  EXPECT_FALSE(registry.Undefine("FOO"));
+  EXPECT_FALSE(registry.Undefine("NEVER_DEFINED"));
+  EXPECT_EQ(registry.Lookup("FOO"), nullptr);
+  EXPECT_THAT(registry, UnorderedElementsAre(Pair("BAR", ::testing::_)));
+
+  registry.clear();
+  EXPECT_TRUE(registry.empty());
+  EXPECT_EQ(registry.Lookup("BAR"), nullptr);
+}
+
+TEST(MacroDefinitionRegistryTest, NamesAreInterned) {
+  MacroDefinitionRegistry registry;
+  {
+    const std::string name = "TRANSIENT";
+    registry.Define(MakeDefinition(name, ""));
+  }
+  // The key does not refer to the (now gone) name of the definition.
+  ASSERT_EQ(registry.size(), 1);
+  EXPECT_EQ(registry.begin()->first, "TRANSIENT");
+  EXPECT_NE(registry.find("TRANSIENT"), registry.end());
+}
+
+TEST(MacroDefinitionRegistryTest, CopiesAreIndependent) {
+  MacroDefinitionRegistry original;
+  original.Define(MakeDefinition("A", "a"));
+  original.Define(MakeDefinition("B", "b"));
+  original.Define(MakeDefinition("C", "c"));
+
+  MacroDefinitionRegistry copy = original;
+  EXPECT_EQ(Contents(copy), Contents(original));
+
+  // Changes to the copy do not show in the original...
+  copy.Define(MakeDefinition("A", "a2"));
+  copy.Define(MakeDefinition("D", "d"));
+  copy.Undefine("B");
+  EXPECT_EQ(Contents(copy), (std::map<std::string, std::string>{
+                                {"A", "a2"}, {"C", "c"}, {"D", "d"}}));
+  EXPECT_EQ(Contents(original), (std::map<std::string, std::string>{
+                                    {"A", "a"}, {"B", "b"}, {"C", "c"}}));
+
+  // ...nor the other way around.
+  original.Undefine("C");
+  original.Define(MakeDefinition("E", "e"));
+  EXPECT_EQ(Contents(copy), (std::map<std::string, std::string>{
+                                {"A", "a2"}, {"C", "c"}, {"D", "d"}}));
+  EXPECT_EQ(Contents(original), (std::map<std::string, std::string>{
+                                    {"A", "a"}, {"B", "b"}, {"E", "e"}}));
+}
+
+TEST(MacroDefinitionRegistryTest, NestedCopies) {
+  MacroDefinitionRegistry outer;
+  outer.Define(MakeDefinition("A", "a"));
+  {
+    MacroDefinitionRegistry middle = outer;
+    middle.Define(MakeDefinition("B", "b"));
+    {
+      MacroDefinitionRegistry inner = middle;
+      inner.Undefine("A");
+      inner.Define(MakeDefinition("B", "b2"));
+      inner.Undefine("B");
+      inner.Define(MakeDefinition("A", "a3"));
+      EXPECT_EQ(Contents(inner),
+                (std::map<std::string, std::string>{{"A", "a3"}}));
+      EXPECT_EQ(inner.find("B"), inner.end());
+    }
+    EXPECT_EQ(Contents(middle), (std::map<std::string, std::string>{
+                                    {"A", "a"}, {"B", "b"}}));
+  }
+  // With all copies gone, the original is changed in place again.
+  outer.Define(MakeDefinition("C", "c"));
+  EXPECT_EQ(Contents(outer),
+            (std::map<std::string, std::string>{{"A", "a"}, {"C", "c"}}));
+}
+
+TEST(MacroDefinitionRegistryTest, ClearedCopy) {
+  MacroDefinitionRegistry original;
+  original.Define(MakeDefinition("A", "a"));
+  MacroDefinitionRegistry copy = original;
+  copy.clear();
+  EXPECT_THAT(Contents(copy), IsEmpty());
+  EXPECT_EQ(Contents(original),
+            (std::map<std::string, std::string>{{"A", "a"}}));
+}
+
+}  // namespace
+}  // namespace verible
@@ -14,8 +14,7 @@
 
 #include "verible/common/text/macro-definition.h"
 
-#include <map>
-#include <string>
+#include <algorithm>
 #include <vector>
 
 #include "absl/status/status.h"
@@ -29,13 +28,13 @@ using container::FindOrNull;
 
 bool MacroDefinition::AppendParameter(const MacroParameterInfo &param_info) {
   is_callable_ = true;
-  // Record position of this parameter.
-  const bool inserted = parameter_positions_
-                            .insert({std::string(param_info.name.text()),
-                                     parameter_info_array_.size()})
-                            .second;
+  const bool duplicate = std::any_of(
+      parameter_info_array_.begin(), parameter_info_array_.end(),
+      [&param_info](const MacroParameterInfo &existing) {
+        return existing.name.text() == param_info.name.text();
+      });
   parameter_info_array_.push_back(param_info);
-  return inserted;
+  return !duplicate;
 }
 
 absl::Status MacroDefinition::PopulateSubstitutionMap(
@@ -18,9 +18,7 @@
 #ifndef VERIBLE_COMMON_TEXT_MACRO_DEFINITION_H_
 #define VERIBLE_COMMON_TEXT_MACRO_DEFINITION_H_
 
-#include <cstddef>
 #include <map>
-#include <string>
 #include <string_view>
 #include <vector>
 
@@ -123,9 +121,9 @@ class MacroDefinition {
   // Distinguish between a definition without () vs. with empty ().
   bool is_callable_ = false;
 
-  // These form an ordered dictionary on macro parameters.
+  // Macro parameters, in order.  There are few, so a linear search for a
+  // name is faster than a map lookup.
   std::vector<MacroParameterInfo> parameter_info_array_;
-  std::map<std::string, size_t> parameter_positions_;
 
   // un-tokenized text
   DefaultTokenInfo definition_text_;
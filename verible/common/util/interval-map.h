@@ -20,6 +20,7 @@
 
 #include "verible/common/util/auto-iterator.h"
 #include "verible/common/util/logging.h"
+#include "verible/common/util/sorted-vector-map.h"
 
 namespace verible {
 
@@ -122,12 +123,17 @@ static std::pair<typename M::iterator, bool> FindNonoverlappingEmplacePosition(
 // Insert using emplace() or must_emplace();
 // Insertion consumes the given value by rvalue-reference.
 //
-template <typename K, typename V>
+// Storage is the ordered map type that holds the key-intervals and values,
+//   keyed by std::pair<K, K>, compared with internal::CompareFirst<K>.
+//   The default std::map provides stable iterators; SortedVectorMap provides
+//   contiguous storage and cheaper lookups, but invalidates iterators on
+//   insertion.  See FlatDisjointIntervalMap below.
+//
+template <typename K, typename V,
+          typename Storage =
+              std::map<std::pair<K, K>, V, internal::CompareFirst<K>>>
 class DisjointIntervalMap {
-  // Interpreted as the interval [i,j)
-  using interval_key_type = std::pair<K, K>;
-  using comparator = internal::CompareFirst<K>;
-  using map_type = std::map<interval_key_type, V, comparator>;
+  using map_type = Storage;
 
  public:
   using key_type = typename map_type::key_type;
@@ -205,6 +211,15 @@ class DisjointIntervalMap {
   map_type map_;
 };
 
+// DisjointIntervalMap with contiguous (sorted vector) storage.
+// Lookups are branch-free binary searches over a flat array.
+// Unlike the default, emplacement invalidates previously returned iterators.
+template <typename K, typename V>
+using FlatDisjointIntervalMap =
+    DisjointIntervalMap<K, V,
+                        SortedVectorMap<std::pair<K, K>, V,
+                                        internal::CompareFirst<K>>>;
+
 }  // namespace verible
 
 #endif  // VERIBLE_COMMON_UTIL_INTERVAL_MAP_H_
@@ -323,5 +323,45 @@ TEST(DisjointIntervalMapTest, VectorDemo) {
   VerifyVectorBlock(vmap, block3);
 }
 
+using FlatIntIntervalMap = FlatDisjointIntervalMap<int, std::unique_ptr<int>>;
+
+TEST(FlatDisjointIntervalMapTest, DefaultCtor) {
+  const FlatIntIntervalMap imap;
+  EXPECT_TRUE(imap.empty());
+  EXPECT_EQ(imap.find(3), imap.end());
+}
+
+TEST(FlatDisjointIntervalMapTest, EmplaceAndFind) {
+  FlatIntIntervalMap imap;
+  // values chosen to be == interval size
+  imap.must_emplace({50, 60}, std::make_unique<int>(10));
+  imap.must_emplace({30, 35}, std::make_unique<int>(5));
+  imap.must_emplace({39, 46}, std::make_unique<int>(7));
+  imap.must_emplace({35, 39}, std::make_unique<int>(4));  // abutting both
+  for (const auto &pair : imap) {
+    EXPECT_EQ(pair.first.second - pair.first.first, *pair.second);
+  }
+  EXPECT_EQ(imap.find(29), imap.end());
+  for (int i = 30; i < 46; ++i) {
+    const auto found = imap.find(i);
+    ASSERT_NE(found, imap.end());
+    EXPECT_LE(found->first.first, i);
+    EXPECT_LT(i, found->first.second);
+  }
+  EXPECT_EQ(imap.find(46), imap.end());
+  EXPECT_EQ(*imap.find({51, 60})->second, 10);
+  EXPECT_EQ(imap.find({45, 51}), imap.end());
+}
+
+TEST(FlatDisjointIntervalMapTest, MustEmplaceOverlap) {
+  FlatIntIntervalMap imap;
+  imap.must_emplace({30, 40}, std::make_unique<int>(5));
+  imap.must_emplace({50, 60}, std::make_unique<int>(5));
+  EXPECT_FALSE(imap.emplace({35, 45}, std::make_unique<int>(1)).second);
+  EXPECT_FALSE(imap.emplace({45, 55}, std::make_unique<int>(1)).second);
+  EXPECT_FALSE(imap.emplace({20, 70}, std::make_unique<int>(1)).second);
+  EXPECT_TRUE(imap.emplace({40, 50}, std::make_unique<int>(1)).second);
+}
+
 }  // namespace
 }  // namespace verible
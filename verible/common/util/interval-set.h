@@ -15,6 +15,7 @@
 #ifndef VERIBLE_COMMON_UTIL_INTERVAL_SET_H_
 #define VERIBLE_COMMON_UTIL_INTERVAL_SET_H_
 
+#include <algorithm>
 #include <cstddef>
 #include <functional>
 #include <initializer_list>
@@ -35,6 +36,7 @@
 #include "verible/common/util/interval.h"
 #include "verible/common/util/iterator-range.h"
 #include "verible/common/util/logging.h"
+#include "verible/common/util/sorted-vector-map.h"
 
 namespace verible {
 
@@ -143,10 +145,16 @@ class IntervalSetImpl {
 // non-overlapping [min, max) intervals.
 // Mutating operations will automatically merge abutting intervals.
 // Type T must be std::less-comparable for binary-search-ability.
-template <typename T>
+//
+// Storage is the ordered map type (T -> T) that holds the intervals:
+//   * std::map<T, T> (default): O(lg N) mutations anywhere, stable iterators.
+//   * SortedVectorMap<T, T>: contiguous storage with branch-free lookups,
+//     preferred for sets that are built once and queried in hot loops.
+//     See FlatIntervalSet below.
+template <typename T, typename Storage = std::map<T, T>>
 class IntervalSet : private internal::IntervalSetImpl {
  private:
-  using impl_type = std::map<T, T>;
+  using impl_type = Storage;
 
  protected:
   using iterator = typename impl_type::iterator;
@@ -160,20 +168,57 @@ class IntervalSet : private internal::IntervalSetImpl {
 
  public:
   IntervalSet() = default;
-  IntervalSet(std::initializer_list<Interval<T>> ranges) {
-    // Add-ing will properly fuse overlapping intervals and maintain intervals_'
-    // invariants.
-    for (const auto &range : ranges) {
-      Add(range);
-    }
-  }
+  IntervalSet(std::initializer_list<Interval<T>> ranges)
+      : IntervalSet(FromIntervals(ranges.begin(), ranges.end())) {}
 
-  IntervalSet(const IntervalSet<T> &) = default;
-  IntervalSet(IntervalSet<T> &&) noexcept = default;
+  IntervalSet(const IntervalSet &) = default;
+  IntervalSet(IntervalSet &&) noexcept = default;
   ~IntervalSet() { CheckIntegrity(); }
 
-  IntervalSet<T> &operator=(const IntervalSet<T> &) = default;
-  IntervalSet<T> &operator=(IntervalSet<T> &&) noexcept = default;
+  IntervalSet &operator=(const IntervalSet &) = default;
+  IntervalSet &operator=(IntervalSet &&) noexcept = default;
+
+  // Converts from a set with a different storage type.
+  template <typename OtherStorage>
+  explicit IntervalSet(const IntervalSet<T, OtherStorage> &other) {
+    for (const auto &interval : other) {
+      intervals_.emplace_hint(intervals_.end(), interval.first,
+                              interval.second);
+    }
+  }
+
+  // Batch construction from a sequence of intervals in any order, which may
+  // overlap or abut.  This sorts once and merges in a single linear pass,
+  // O(N lg N) overall, which is cheaper than N successive Add()s
+  // (especially for flat storage, where each Add() may be O(N)).
+  // Iter can point to any Interval<> or type convertible to Interval<>.
+  template <class Iter>
+  static IntervalSet FromIntervals(Iter begin, Iter end) {
+    std::vector<Interval<T>> sorted;
+    for (; begin != end; ++begin) {
+      const Interval<T> interval(*begin);
+      CHECK(interval.valid());
+      if (!interval.empty()) sorted.push_back(interval);
+    }
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Interval<T> &left, const Interval<T> &right) {
+                return left.min < right.min;
+              });
+    IntervalSet result;
+    for (const auto &interval : sorted) {
+      if (!result.intervals_.empty()) {
+        auto &last_max = std::prev(result.intervals_.end())->second;
+        if (interval.min <= last_max) {  // overlaps or abuts: fuse
+          if (last_max < interval.max) last_max = interval.max;
+          continue;
+        }
+      }
+      result.intervals_.emplace_hint(result.intervals_.end(), interval.min,
+                                     interval.max);
+    }
+    result.CheckIntegrity();
+    return result;
+  }
 
  public:
   const_iterator begin() const { return intervals_.begin(); }
@@ -192,15 +237,13 @@ class IntervalSet : private internal::IntervalSetImpl {
   // Remove all intervals from the set.
   void clear() { intervals_.clear(); }
 
-  void swap(IntervalSet<T> &other) noexcept {
-    intervals_.swap(other.intervals_);
-  }
+  void swap(IntervalSet &other) noexcept { intervals_.swap(other.intervals_); }
 
-  bool operator==(const IntervalSet<T> &other) const {
+  bool operator==(const IntervalSet &other) const {
     return intervals_ == other.intervals_;
   }
 
-  bool operator!=(const IntervalSet<T> &other) const {
+  bool operator!=(const IntervalSet &other) const {
     return !(*this == other);
   }
 
@@ -248,48 +291,33 @@ class IntervalSet : private internal::IntervalSetImpl {
     const auto &min = interval.min;
     const auto &max = interval.max;
 
-    T new_max = max;
-    iterator erase_end;
-    const auto max_lb = LowerBound(max);
-    if (max_lb == intervals_.end()) {
-      // erase all the way to the end
-      erase_end = max_lb;
-    } else if (AsInterval(*max_lb).contains(max)) {
-      // erase this interval, but use its max (.second)
-      erase_end = std::next(max_lb);
-      new_max = max_lb->second;
-    } else {
-      // erase up to the interval before this one
-      erase_end = max_lb;
+    // Find the range of existing intervals [fuse_begin, fuse_end) that overlap
+    // or abut the new interval; these are all fused into one.
+    // Only iterators obtained after the last mutation are used, so this is
+    // also valid for storage types whose mutations invalidate iterators.
+    iterator fuse_begin = intervals_.lower_bound(min);
+    if (fuse_begin != intervals_.begin()) {
+      const auto prev = std::prev(fuse_begin);
+      if (prev->second >= min) fuse_begin = prev;
     }
+    const iterator fuse_end = intervals_.upper_bound(max);
 
-    iterator erase_begin;
-    const auto p = intervals_.insert({min, new_max});  // (bool, iterator)
-    if (p.second) {
-      // new interval was successfully inserted at p.first
-      // If this abuts or overlaps with the previous interval, update that
-      // one with new_max, and discard this one.
-      if (p.first == intervals_.begin()) {
-        erase_begin = std::next(p.first);
-      } else {
-        const auto prev = std::prev(p.first);
-        if (prev->second >= min) {
-          prev->second = new_max;
-          erase_begin = p.first;
-        } else {
-          erase_begin = std::next(p.first);
-        }
+    T new_max = max;
+    if (fuse_begin != fuse_end) {
+      const T &last_max = std::prev(fuse_end)->second;
+      if (new_max < last_max) new_max = last_max;
+      if (fuse_begin->first <= min) {
+        // Re-use the first interval, extending its max (.second).
+        fuse_begin->second = new_max;
+        // Finally erase range of obsolete intervals to maintain invariants.
+        intervals_.erase(std::next(fuse_begin), fuse_end);
+        CheckIntegrity();
+        return;
       }
-    } else {
-      // new interval was not inserted because there already exist key=min.
-      // Re-use that interval, but update its max.
-      p.first->second = new_max;
-      // Erase intervals starting after that one.
-      erase_begin = std::next(p.first);
     }
-
-    // Finally erase range of obsolete intervals to maintain invariants.
-    intervals_.erase(erase_begin, erase_end);
+    // The new interval starts at 'min': replace all fused intervals.
+    const auto hint = intervals_.erase(fuse_begin, fuse_end);
+    intervals_.emplace_hint(hint, min, new_max);
 
     CheckIntegrity();
   }
@@ -369,7 +397,9 @@ class IntervalSet : private internal::IntervalSetImpl {
   void Difference(const T &value) { Difference({value, value + 1}); }
 
   // Subtracts all intervals in the other set from this one.
-  void Difference(const IntervalSet<T> &iset) {
+  // The other set may use a different storage type.
+  template <typename OtherStorage>
+  void Difference(const IntervalSet<T, OtherStorage> &iset) {
     // TODO(fangism): optimize by implementing with two advancing iterators,
     // like linear-time sorted-sequence set operations.
     for (const auto &interval : iset) {
@@ -378,7 +408,9 @@ class IntervalSet : private internal::IntervalSetImpl {
   }
 
   // Adds all intervals in the other set from this one.
-  void Union(const IntervalSet<T> &iset) {
+  // The other set may use a different storage type.
+  template <typename OtherStorage>
+  void Union(const IntervalSet<T, OtherStorage> &iset) {
     // Could be optimized with a hand-written linear-merge.
     for (const auto &interval : iset) {
       Add(AsInterval(interval));
@@ -388,7 +420,7 @@ class IntervalSet : private internal::IntervalSetImpl {
   // Inverts the set of integers with respect to the given interval bound.
   void Complement(const Interval<T> &interval) {
     // This could be more efficient with a direct insertion of elements.
-    IntervalSet<T> temp{{interval}};
+    IntervalSet temp{{interval}};
     temp.Difference(*this);
     swap(temp);
   }
@@ -515,6 +547,10 @@ class IntervalSet : private internal::IntervalSetImpl {
   iterator UpperBound(const T &value) { return intervals_.upper_bound(value); }
 
  private:
+  // Allow conversions and transforms across element and storage types.
+  template <typename, typename>
+  friend class IntervalSet;
+
   // Internal storage of intervals.
   // Invariants: all intervals are
   //   * non-overlapping
@@ -523,13 +559,20 @@ class IntervalSet : private internal::IntervalSetImpl {
   impl_type intervals_;
 };  // class IntervalSet
 
+// IntervalSet with contiguous (sorted vector) storage.
+// Membership queries are branch-free binary searches over a flat array, which
+// makes this preferable for sets that are queried per token or per line.
+// Mutations in the middle of the set are O(N), and invalidate iterators.
 template <typename T>
-void swap(IntervalSet<T> &t1, IntervalSet<T> &t2) noexcept {
+using FlatIntervalSet = IntervalSet<T, SortedVectorMap<T, T>>;
+
+template <typename T, typename S>
+void swap(IntervalSet<T, S> &t1, IntervalSet<T, S> &t2) noexcept {
   t1.swap(t2);
 }
 
-template <typename T>
-std::ostream &operator<<(std::ostream &stream, const IntervalSet<T> &iset) {
+template <typename T, typename S>
+std::ostream &operator<<(std::ostream &stream, const IntervalSet<T, S> &iset) {
   // Format each IntervalSet internal interval as an Interval<T>.
   return FormatIntervals(stream, iset.begin(), iset.end());
 }
@@ -539,8 +582,8 @@ std::ostream &operator<<(std::ostream &stream, const IntervalSet<T> &iset) {
 // Overlapping/adjoining ranges are automatically merged by IntervalSet.
 // Iter is any iterator that points to a string (or string-like).
 // Returns false on any parse eror, true on complete success.
-template <typename T, typename Iter>
-bool ParseInclusiveRanges(IntervalSet<T> *iset, Iter begin, Iter end,
+template <typename T, typename S, typename Iter>
+bool ParseInclusiveRanges(IntervalSet<T, S> *iset, Iter begin, Iter end,
                           std::ostream *errstream, const char sep = '-') {
   std::vector<std::string_view> bounds;  // re-use allocated memory
   for (const auto &range : verible::make_range(begin, end)) {
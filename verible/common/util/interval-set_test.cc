@@ -14,6 +14,7 @@
 
 #include "verible/common/util/interval-set.h"
 
+#include <algorithm>
 #include <initializer_list>
 #include <iterator>
 #include <map>
@@ -957,6 +958,116 @@ TEST(UniformRandomGeneratorTest, MultiRanges) {
   }
 }
 
+// FlatIntervalSet tests
+
+using flat_interval_set_type = FlatIntervalSet<int>;
+using flat_pair_t = flat_interval_set_type::value_type;
+
+TEST(FlatIntervalSetTest, DefaultConstruction) {
+  const flat_interval_set_type iset;
+  EXPECT_TRUE(iset.empty());
+  EXPECT_EQ(iset.size(), 0);
+  EXPECT_FALSE(iset.Contains(0));
+  EXPECT_FALSE(iset.Contains({0, 1}));
+}
+
+TEST(FlatIntervalSetTest, ConstructionWithInitializerFusesIntervals) {
+  const flat_interval_set_type iset{{8, 9}, {2, 4}, {4, 6}, {3, 5}, {10, 12}};
+  EXPECT_THAT(iset, ElementsAre(flat_pair_t{2, 6}, flat_pair_t{8, 9},
+                                flat_pair_t{10, 12}));
+  EXPECT_FALSE(iset.Contains(1));
+  EXPECT_TRUE(iset.Contains(2));
+  EXPECT_TRUE(iset.Contains(5));
+  EXPECT_FALSE(iset.Contains(6));
+  EXPECT_TRUE(iset.Contains({3, 6}));
+  EXPECT_FALSE(iset.Contains({5, 9}));
+}
+
+TEST(FlatIntervalSetTest, FromIntervals) {
+  const std::vector<interval_type> intervals{
+      {30, 40}, {5, 5}, {10, 20}, {15, 25}, {1, 2}, {40, 41}};
+  const auto iset =
+      flat_interval_set_type::FromIntervals(intervals.begin(), intervals.end());
+  EXPECT_THAT(iset, ElementsAre(flat_pair_t{1, 2}, flat_pair_t{10, 25},
+                                flat_pair_t{30, 41}));
+  // Same result with tree-based storage.
+  const auto tree_iset =
+      interval_set_type::FromIntervals(intervals.begin(), intervals.end());
+  EXPECT_EQ(tree_iset, (interval_set_type{{1, 2}, {10, 25}, {30, 41}}));
+}
+
+TEST(FlatIntervalSetTest, ConvertFromOtherStorage) {
+  const interval_set_type tree_iset{{1, 3}, {5, 8}};
+  const flat_interval_set_type iset(tree_iset);
+  EXPECT_THAT(iset, ElementsAre(flat_pair_t{1, 3}, flat_pair_t{5, 8}));
+  const interval_set_type round_trip(iset);
+  EXPECT_EQ(round_trip, tree_iset);
+}
+
+TEST(FlatIntervalSetTest, LowerUpperBound) {
+  const flat_interval_set_type iset{{10, 20}, {30, 40}};
+  EXPECT_EQ(iset.LowerBound(5), iset.begin());
+  EXPECT_EQ(iset.LowerBound(19), iset.begin());
+  EXPECT_EQ(iset.LowerBound(20), std::next(iset.begin()));
+  EXPECT_EQ(iset.LowerBound(40), iset.end());
+  EXPECT_EQ(iset.UpperBound(10), std::next(iset.begin()));
+  EXPECT_EQ(iset.UpperBound(30), iset.end());
+}
+
+// Applies the same sequence of operations to both storage types, and expects
+// identical results.
+TEST(FlatIntervalSetTest, MatchesTreeStorage) {
+  interval_set_type tree_iset;
+  flat_interval_set_type flat_iset;
+  // Deterministic pseudo-random sequence of operations.
+  int seed = 17;
+  const auto next = [&seed](int mod) {
+    seed = (seed * 1103515245 + 12345) & 0x7fffffff;
+    return seed % mod;
+  };
+  for (int i = 0; i < 2000; ++i) {
+    const int min = next(500);
+    const interval_type interval{min, min + next(20)};
+    if (next(3) == 0) {
+      tree_iset.Difference(interval);
+      flat_iset.Difference(interval);
+    } else {
+      tree_iset.Add(interval);
+      flat_iset.Add(interval);
+    }
+    ASSERT_EQ(tree_iset.size(), flat_iset.size()) << "after " << interval;
+    ASSERT_TRUE(std::equal(tree_iset.begin(), tree_iset.end(),
+                           flat_iset.begin(),
+                           [](const pair_t &left, const flat_pair_t &right) {
+                             return left.first == right.first &&
+                                    left.second == right.second;
+                           }))
+        << "after " << interval << ": " << tree_iset << " vs. " << flat_iset;
+  }
+  for (int value = -1; value < 521; ++value) {
+    EXPECT_EQ(tree_iset.Contains(value), flat_iset.Contains(value));
+  }
+}
+
+TEST(FlatIntervalSetTest, SetOperationsWithMixedStorage) {
+  flat_interval_set_type iset{{0, 100}};
+  iset.Difference(interval_set_type{{30, 40}, {60, 70}});
+  EXPECT_EQ(iset, (flat_interval_set_type{{0, 30}, {40, 60}, {70, 100}}));
+  iset.Union(interval_set_type{{30, 40}});
+  EXPECT_EQ(iset, (flat_interval_set_type{{0, 60}, {70, 100}}));
+  iset.Complement({0, 100});
+  EXPECT_EQ(iset, (flat_interval_set_type{{60, 70}}));
+}
+
+TEST(FlatIntervalSetTest, ParseInclusiveRanges) {
+  flat_interval_set_type iset;
+  std::ostringstream errstream;
+  const std::vector<std::string_view> ranges{"5-6", "1", "7"};
+  EXPECT_TRUE(ParseInclusiveRanges(&iset, ranges.begin(), ranges.end(),
+                                   &errstream));
+  EXPECT_EQ(iset, (flat_interval_set_type{{1, 2}, {5, 8}}));
+}
+
 // DisjointIntervalSet tests
 
 using IntIntervalSet = DisjointIntervalSet<int>;
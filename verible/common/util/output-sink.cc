@@ -0,0 +1,193 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/common/util/output-sink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "verible/common/util/logging.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace verible {
+
+// Maximum number of pieces written with one writev() call; this is the
+// IOV_MAX of common platforms.
+static constexpr size_t kMaxPieces = 1024;
+
+OutputSink::OutputSink(int fd, size_t buffer_size) : fd_(fd) {
+  CHECK_GE(fd, 0);
+  buffer_.reserve(buffer_size);
+  pieces_.reserve(kMaxPieces);
+}
+
+OutputSink::OutputSink(std::ostream *stream, size_t buffer_size)
+    : stream_(stream) {
+  CHECK(stream != nullptr);
+  buffer_.reserve(buffer_size);
+}
+
+OutputSink::OutputSink(std::string *output) : string_(output) {
+  CHECK(output != nullptr);
+}
+
+OutputSink::~OutputSink() { Flush().IgnoreError(); }
+
+OutputSink &OutputSink::Append(std::string_view text) {
+  if (string_) {
+    string_->append(text);
+    return *this;
+  }
+  if (text.size() >= buffer_.capacity()) {
+    // Too large to be worth copying; it is valid until we return.
+    AddPiece(text);
+    WritePieces();
+    return *this;
+  }
+  if (text.size() > buffer_.capacity() - buffer_.size()) WritePieces();
+  const size_t start = buffer_.size();
+  buffer_.append(text);
+  AddPiece(std::string_view(buffer_).substr(start));
+  return *this;
+}
+
+OutputSink &OutputSink::Append(size_t count, char c) {
+  if (string_) {
+    string_->append(count, c);
+    return *this;
+  }
+  while (count > 0) {
+    if (buffer_.size() == buffer_.capacity()) WritePieces();
+    const size_t start = buffer_.size();
+    const size_t length = std::min(count, buffer_.capacity() - start);
+    buffer_.append(length, c);
+    AddPiece(std::string_view(buffer_).substr(start));
+    count -= length;
+  }
+  return *this;
+}
+
+OutputSink &OutputSink::AppendReference(std::string_view text) {
+  // Streams are written to piece by piece, so small pieces are better copied.
+  if (fd_ < 0) return Append(text);
+  AddPiece(text);
+  return *this;
+}
+
+absl::Status OutputSink::Flush() {
+  WritePieces();
+  if (stream_ && status_.ok()) {
+    stream_->flush();
+    if (stream_->fail()) {
+      status_ = absl::UnavailableError("Failed to write to output stream.");
+    }
+  }
+  return status_;
+}
+
+void OutputSink::AddPiece(std::string_view text) {
+  if (text.empty()) return;
+  if (!pieces_.empty()) {
+    std::string_view &last = pieces_.back();
+    if (last.data() + last.size() == text.data()) {
+      last = std::string_view(last.data(), last.size() + text.size());
+      return;
+    }
+  }
+  pieces_.push_back(text);
+  if (pieces_.size() >= kMaxPieces) WritePieces();
+}
+
+static absl::Status WriteError(std::string_view function) {
+  const int error = errno;
+  return {absl::ErrnoToStatusCode(error),
+          absl::StrCat(function, " failed: ", strerror(error))};
+}
+
+#ifdef _WIN32
+static absl::Status WriteToFd(int fd,
+                              const std::vector<std::string_view> &pieces) {
+  for (std::string_view piece : pieces) {
+    while (!piece.empty()) {
+      const int written = _write(fd, piece.data(), piece.size());
+      if (written < 0) return WriteError("write()");
+      piece.remove_prefix(written);
+    }
+  }
+  return absl::OkStatus();
+}
+#else
+static absl::Status WriteToFd(int fd,
+                              const std::vector<std::string_view> &pieces) {
+  std::vector<struct iovec> iov;
+  iov.reserve(pieces.size());
+  for (const std::string_view piece : pieces) {
+    iov.push_back({const_cast<char *>(piece.data()), piece.size()});
+  }
+  struct iovec *next = iov.data();
+  size_t remaining = iov.size();
+  while (remaining > 0) {
+    const ssize_t written = writev(fd, next, static_cast<int>(remaining));
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return WriteError("writev()");
+    }
+    // Skip what was written; a short write can end in the middle of a piece.
+    size_t skip = written;
+    while (remaining > 0 && skip >= next->iov_len) {
+      skip -= next->iov_len;
+      ++next;
+      --remaining;
+    }
+    if (remaining > 0) {
+      next->iov_base = static_cast<char *>(next->iov_base) + skip;
+      next->iov_len -= skip;
+    }
+  }
+  return absl::OkStatus();
+}
+#endif
+
+void OutputSink::WritePieces() {
+  if (status_.ok() && !pieces_.empty()) {
+    if (stream_) {
+      for (const std::string_view piece : pieces_) {
+        stream_->write(piece.data(), piece.size());
+      }
+      if (stream_->fail()) {
+        status_ = absl::UnavailableError("Failed to write to output stream.");
+      }
+    } else {
+      status_ = WriteToFd(fd_, pieces_);
+    }
+  }
+  pieces_.clear();
+  buffer_.clear();
+}
+
+}  // namespace verible
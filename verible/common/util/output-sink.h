@@ -0,0 +1,108 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_UTIL_OUTPUT_SINK_H_
+#define VERIBLE_COMMON_UTIL_OUTPUT_SINK_H_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+
+namespace verible {
+
+// OutputSink collects many small pieces of text, such as token texts, and
+// writes them out in few large writes, avoiding the per-call overhead of
+// std::ostream.
+//
+// Text passed to Append() is copied into a fixed-size buffer, which is written
+// out when it is full.  Text passed to AppendReference() is not copied when
+// writing to a file descriptor: the sink only records where the text is, and
+// writes all recorded pieces with one writev() call.  Adjacent pieces, like
+// consecutive tokens of the same file, are merged into one.
+//
+// Anything appended is written out at the latest by Flush() or by the
+// destructor.
+class OutputSink {
+ public:
+  static constexpr size_t kDefaultBufferSize = 64 * 1024;
+
+  // File descriptor of the standard output.
+  static constexpr int kStdout = 1;
+
+  // Writes to the file descriptor 'fd', which is not closed by the sink.
+  // Nothing else should write to 'fd' until the sink is flushed.
+  explicit OutputSink(int fd, size_t buffer_size = kDefaultBufferSize);
+
+  // Writes to 'stream' with large stream->write() calls.
+  explicit OutputSink(std::ostream *stream,
+                      size_t buffer_size = kDefaultBufferSize);
+
+  // Appends to 'output' directly, without buffering.
+  explicit OutputSink(std::string *output);
+
+  OutputSink(const OutputSink &) = delete;
+  OutputSink &operator=(const OutputSink &) = delete;
+
+  // Flushes, ignoring errors.  Call Flush() to check for errors.
+  ~OutputSink();
+
+  // Appends a copy of 'text'.
+  OutputSink &Append(std::string_view text);
+
+  // Appends 'count' copies of 'c'.
+  OutputSink &Append(size_t count, char c);
+
+  OutputSink &Append(char c) { return Append(1, c); }
+
+  // Appends 'text' without copying it if possible.  The memory of 'text' must
+  // stay valid and unchanged until the next Flush().
+  OutputSink &AppendReference(std::string_view text);
+
+  // Writes out everything that was appended.  Returns the first write error;
+  // after an error, further output is dropped.
+  absl::Status Flush();
+
+  // Returns the first write error, if any.
+  const absl::Status &status() const { return status_; }
+
+ private:
+  // Records the piece 'text' to be written, merging it with the last piece if
+  // they are adjacent.
+  void AddPiece(std::string_view text);
+
+  // Writes all recorded pieces, and empties the buffer.
+  void WritePieces();
+
+  const int fd_ = -1;
+  std::ostream *const stream_ = nullptr;
+  std::string *const string_ = nullptr;
+
+  // Buffer for copied text.  Its capacity is reserved up front and it never
+  // grows, so pieces that point into it stay valid until they are written.
+  std::string buffer_;
+
+  // Pieces of text to write, in order.  Only used when writing to a file
+  // descriptor; otherwise the only piece is the buffer.
+  std::vector<std::string_view> pieces_;
+
+  absl::Status status_;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_UTIL_OUTPUT_SINK_H_
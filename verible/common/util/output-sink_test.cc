@@ -0,0 +1,122 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/common/util/output-sink.h"
+
+#include <sstream>
+#include <string>
+#include <string_view>
+
+#include "absl/status/statusor.h"
+#include "gtest/gtest.h"
+#include "verible/common/util/file-util.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace verible {
+namespace {
+
+// Appends a mix of copied, referenced and repeated text to 'sink', and
+// returns the expected output.
+std::string AppendMixedText(OutputSink *sink, std::string_view source) {
+  std::string expected;
+  for (int i = 0; i < 100; ++i) {
+    // Consecutive references into 'source' are merged into one piece.
+    sink->AppendReference(source.substr(0, 5));
+    sink->AppendReference(source.substr(5));
+    sink->Append(std::string(i % 7, 'x'));
+    sink->Append(i % 11, '-').Append('\n');
+    expected.append(source);
+    expected.append(i % 7, 'x');
+    expected.append(i % 11, '-');
+    expected.push_back('\n');
+  }
+  // Larger than the buffer.
+  const std::string large(1000, 'L');
+  sink->Append(large);
+  expected.append(large);
+  return expected;
+}
+
+TEST(OutputSinkTest, String) {
+  std::string output = "prefix ";
+  OutputSink sink(&output);
+  const std::string expected = AppendMixedText(&sink, "hello world");
+  EXPECT_TRUE(sink.Flush().ok());
+  EXPECT_EQ(output, "prefix " + expected);
+}
+
+TEST(OutputSinkTest, Stream) {
+  for (size_t buffer_size : {1, 16, 100, 4096}) {
+    std::ostringstream stream;
+    std::string expected;
+    {
+      OutputSink sink(&stream, buffer_size);
+      expected = AppendMixedText(&sink, "hello world");
+      // The destructor flushes.
+    }
+    EXPECT_EQ(stream.str(), expected) << buffer_size;
+  }
+}
+
+TEST(OutputSinkTest, StreamError) {
+  std::ostringstream stream;
+  stream.setstate(std::ios::badbit);
+  OutputSink sink(&stream);
+  sink.Append("text");
+  EXPECT_FALSE(sink.Flush().ok());
+  EXPECT_FALSE(sink.status().ok());
+}
+
+#ifndef _WIN32
+TEST(OutputSinkTest, FileDescriptor) {
+  const std::string filename = file::JoinPath(
+      ::testing::TempDir(), "output_sink_file_descriptor_test.txt");
+  for (size_t buffer_size : {1, 16, 4096}) {
+    const int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    std::string expected;
+    {
+      OutputSink sink(fd, buffer_size);
+      // Many pieces that can't be merged, more than one writev() can take.
+      const std::string source = "abc";
+      for (int i = 0; i < 3000; ++i) {
+        sink.AppendReference(source).Append('|');
+        expected.append("abc|");
+      }
+      expected.append(AppendMixedText(&sink, "hello world"));
+      EXPECT_TRUE(sink.Flush().ok());
+    }
+    close(fd);
+    const absl::StatusOr<std::string> content =
+        file::GetContentAsString(filename);
+    ASSERT_TRUE(content.ok()) << content.status();
+    EXPECT_EQ(*content, expected) << buffer_size;
+  }
+}
+
+TEST(OutputSinkTest, FileDescriptorError) {
+  OutputSink sink(12345);  // not an open file descriptor
+  sink.Append("text");
+  EXPECT_FALSE(sink.Flush().ok());
+  sink.Append("more");  // dropped
+  EXPECT_FALSE(sink.Flush().ok());
+}
+#endif
+
+}  // namespace
+}  // namespace verible
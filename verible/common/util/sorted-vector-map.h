@@ -0,0 +1,253 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_UTIL_SORTED_VECTOR_MAP_H_
+#define VERIBLE_COMMON_UTIL_SORTED_VECTOR_MAP_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace verible {
+
+namespace internal {
+// Branch-free binary search over a sorted array of key-value pairs.
+// Returns the index of the first element for which 'before(element.first)'
+// is false, i.e. the partition point.  The loop body compiles to a
+// conditional-move, and its trip count only depends on 'size', so the search
+// does not suffer from branch mispredictions.
+template <typename Pair, typename Pred>
+size_t BranchlessPartitionPoint(const Pair *data, size_t size, Pred before) {
+  if (size == 0) return 0;
+  const Pair *base = data;
+  while (size > 1) {
+    const size_t half = size / 2;
+    base = before(base[half].first) ? base + half : base;
+    size -= half;
+  }
+  return (base - data) + static_cast<size_t>(before(base->first));
+}
+}  // namespace internal
+
+// SortedVectorMap is an ordered associative container that stores its
+// elements in a single contiguous, sorted std::vector.  It implements the
+// subset of the std::map interface that IntervalSet and DisjointIntervalMap
+// need, so it can be used as their storage policy.
+//
+// Compared to std::map:
+//   * Lookups are branch-free binary searches over contiguous memory,
+//     which cost only a few cache misses.
+//   * Insertion and erasure in the middle are O(N) (appending at the end is
+//     amortized O(1)), so this is best suited for sets that are built once
+//     (or in order) and then queried many times.
+//   * Any mutation invalidates all iterators, like std::vector.
+//   * value_type is std::pair<K, V>, (not std::pair<const K, V>).
+//     Modifying keys through mutable iterators is permitted, but it is the
+//     caller's responsibility to maintain sorted order.
+//
+// Compare may be transparent (define is_transparent) to enable heterogeneous
+// lookups, like std::map.
+template <typename K, typename V, typename Compare = std::less<K>>
+class SortedVectorMap {
+  using impl_type = std::vector<std::pair<K, V>>;
+
+ public:
+  using key_type = K;
+  using mapped_type = V;
+  using value_type = typename impl_type::value_type;
+  using key_compare = Compare;
+  using size_type = typename impl_type::size_type;
+  using iterator = typename impl_type::iterator;
+  using const_iterator = typename impl_type::const_iterator;
+  using reverse_iterator = typename impl_type::reverse_iterator;
+  using const_reverse_iterator = typename impl_type::const_reverse_iterator;
+
+  SortedVectorMap() = default;
+
+  // Batch construction: sorts the given elements once, in O(N lg N), instead
+  // of N successive O(N) insertions.  For duplicate keys, only the first
+  // occurrence (in original order) is kept, consistent with std::map::insert.
+  explicit SortedVectorMap(impl_type elements)
+      : elements_(std::move(elements)) {
+    std::stable_sort(elements_.begin(), elements_.end(),
+                     [this](const value_type &left, const value_type &right) {
+                       return compare_(left.first, right.first);
+                     });
+    elements_.erase(
+        std::unique(elements_.begin(), elements_.end(),
+                    [this](const value_type &left, const value_type &right) {
+                      return !compare_(left.first, right.first);
+                    }),
+        elements_.end());
+  }
+
+  SortedVectorMap(const SortedVectorMap &) = default;
+  SortedVectorMap(SortedVectorMap &&) noexcept = default;
+  SortedVectorMap &operator=(const SortedVectorMap &) = default;
+  SortedVectorMap &operator=(SortedVectorMap &&) noexcept = default;
+
+  iterator begin() { return elements_.begin(); }
+  iterator end() { return elements_.end(); }
+  const_iterator begin() const { return elements_.begin(); }
+  const_iterator end() const { return elements_.end(); }
+  reverse_iterator rbegin() { return elements_.rbegin(); }
+  reverse_iterator rend() { return elements_.rend(); }
+  const_reverse_iterator rbegin() const { return elements_.rbegin(); }
+  const_reverse_iterator rend() const { return elements_.rend(); }
+
+  size_type size() const { return elements_.size(); }
+  bool empty() const { return elements_.empty(); }
+  void clear() { elements_.clear(); }
+  void reserve(size_type n) { elements_.reserve(n); }
+  void swap(SortedVectorMap &other) noexcept {
+    elements_.swap(other.elements_);
+  }
+
+  bool operator==(const SortedVectorMap &other) const {
+    return elements_ == other.elements_;
+  }
+  bool operator!=(const SortedVectorMap &other) const {
+    return !(*this == other);
+  }
+
+  // Returns the first element whose key is not less than 'key'.
+  iterator lower_bound(const key_type &key) {
+    return begin() + LowerBoundIndex(key);
+  }
+  const_iterator lower_bound(const key_type &key) const {
+    return begin() + LowerBoundIndex(key);
+  }
+  // Heterogeneous lookup, requires a transparent Compare.
+  template <typename KeyLike, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator lower_bound(const KeyLike &key) {
+    return begin() + LowerBoundIndex(key);
+  }
+  template <typename KeyLike, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator lower_bound(const KeyLike &key) const {
+    return begin() + LowerBoundIndex(key);
+  }
+
+  // Returns the first element whose key is greater than 'key'.
+  iterator upper_bound(const key_type &key) {
+    return begin() + UpperBoundIndex(key);
+  }
+  const_iterator upper_bound(const key_type &key) const {
+    return begin() + UpperBoundIndex(key);
+  }
+  // Heterogeneous lookup, requires a transparent Compare.
+  template <typename KeyLike, typename C = Compare,
+            typename = typename C::is_transparent>
+  iterator upper_bound(const KeyLike &key) {
+    return begin() + UpperBoundIndex(key);
+  }
+  template <typename KeyLike, typename C = Compare,
+            typename = typename C::is_transparent>
+  const_iterator upper_bound(const KeyLike &key) const {
+    return begin() + UpperBoundIndex(key);
+  }
+
+  // Returns the element with an equivalent key, or end().
+  iterator find(const key_type &key) {
+    const iterator iter = lower_bound(key);
+    return (iter == end() || compare_(key, iter->first)) ? end() : iter;
+  }
+  const_iterator find(const key_type &key) const {
+    const const_iterator iter = lower_bound(key);
+    return (iter == end() || compare_(key, iter->first)) ? end() : iter;
+  }
+
+  // Inserts 'value' if no element with an equivalent key exists.
+  // Returns the position of the (new or existing) element with that key and
+  // whether insertion took place.
+  std::pair<iterator, bool> insert(const value_type &value) {
+    return emplace_hint_impl(LowerBoundIndex(value.first), value);
+  }
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return emplace_hint_impl(LowerBoundIndex(value.first), std::move(value));
+  }
+
+  // Inserts an element constructed from 'args' if no element with an
+  // equivalent key exists.  'hint' is the position before which the element
+  // should be inserted; an accurate hint avoids the search entirely (which
+  // makes in-order appending O(1)).  An inaccurate hint is ignored.
+  template <typename... Args>
+  iterator emplace_hint(const_iterator hint, Args &&...args) {
+    value_type value(std::forward<Args>(args)...);
+    const size_t hint_index = std::distance(elements_.cbegin(), hint);
+    const bool hint_ok =
+        (hint == elements_.cbegin() ||
+         compare_(std::prev(hint)->first, value.first)) &&
+        (hint == elements_.cend() || compare_(value.first, hint->first));
+    const size_t index = hint_ok ? hint_index : LowerBoundIndex(value.first);
+    return emplace_hint_impl(index, std::move(value)).first;
+  }
+
+  // Returns the value mapped to 'key', inserting a default-constructed one
+  // if it does not already exist.
+  mapped_type &operator[](const key_type &key) {
+    return emplace_hint_impl(LowerBoundIndex(key), value_type(key, V()))
+        .first->second;
+  }
+
+  iterator erase(const_iterator pos) { return elements_.erase(pos); }
+  iterator erase(const_iterator first, const_iterator last) {
+    return elements_.erase(first, last);
+  }
+
+ private:
+  template <typename KeyLike>
+  size_t LowerBoundIndex(const KeyLike &key) const {
+    return internal::BranchlessPartitionPoint(
+        elements_.data(), elements_.size(),
+        [this, &key](const key_type &k) { return compare_(k, key); });
+  }
+
+  template <typename KeyLike>
+  size_t UpperBoundIndex(const KeyLike &key) const {
+    return internal::BranchlessPartitionPoint(
+        elements_.data(), elements_.size(),
+        [this, &key](const key_type &k) { return !compare_(key, k); });
+  }
+
+  // 'index' must be the lower-bound position of value's key.
+  template <typename Value>
+  std::pair<iterator, bool> emplace_hint_impl(size_t index, Value &&value) {
+    const iterator pos = begin() + index;
+    if (pos != end() && !compare_(value.first, pos->first)) {
+      return {pos, false};  // equivalent key already exists
+    }
+    return {elements_.insert(pos, std::forward<Value>(value)), true};
+  }
+
+  // Elements, sorted by key, with unique keys.
+  impl_type elements_;
+
+  // Key comparator.
+  Compare compare_;
+};
+
+template <typename K, typename V, typename C>
+void swap(SortedVectorMap<K, V, C> &left,
+          SortedVectorMap<K, V, C> &right) noexcept {
+  left.swap(right);
+}
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_UTIL_SORTED_VECTOR_MAP_H_
@@ -0,0 +1,175 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/common/util/sorted-vector-map.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+using IntMap = SortedVectorMap<int, std::string>;
+
+TEST(BranchlessPartitionPointTest, MatchesStdLowerBound) {
+  for (int size = 0; size < 20; ++size) {
+    std::vector<std::pair<int, int>> data;
+    for (int i = 0; i < size; ++i) data.emplace_back(i * 2, 0);
+    for (int key = -1; key < size * 2 + 2; ++key) {
+      const auto expected = std::lower_bound(
+          data.begin(), data.end(), key,
+          [](const std::pair<int, int> &p, int k) { return p.first < k; });
+      EXPECT_EQ(internal::BranchlessPartitionPoint(
+                    data.data(), data.size(), [key](int k) { return k < key; }),
+                std::distance(data.begin(), expected))
+          << "size=" << size << " key=" << key;
+    }
+  }
+}
+
+TEST(SortedVectorMapTest, DefaultConstruction) {
+  const IntMap m;
+  EXPECT_TRUE(m.empty());
+  EXPECT_EQ(m.size(), 0);
+  EXPECT_EQ(m.begin(), m.end());
+  EXPECT_EQ(m.find(1), m.end());
+  EXPECT_EQ(m.lower_bound(1), m.end());
+  EXPECT_EQ(m.upper_bound(1), m.end());
+}
+
+TEST(SortedVectorMapTest, BatchConstructionSortsAndDedupes) {
+  const IntMap m({{5, "e"}, {1, "a"}, {3, "c"}, {1, "z"}});
+  EXPECT_THAT(m, ElementsAre(Pair(1, "a"), Pair(3, "c"), Pair(5, "e")));
+}
+
+TEST(SortedVectorMapTest, InsertKeepsOrder) {
+  IntMap m;
+  EXPECT_TRUE(m.insert({4, "d"}).second);
+  EXPECT_TRUE(m.insert({2, "b"}).second);
+  EXPECT_TRUE(m.insert({6, "f"}).second);
+  const auto p = m.insert({4, "x"});
+  EXPECT_FALSE(p.second);
+  EXPECT_EQ(p.first->second, "d");
+  EXPECT_THAT(m, ElementsAre(Pair(2, "b"), Pair(4, "d"), Pair(6, "f")));
+}
+
+TEST(SortedVectorMapTest, EmplaceHint) {
+  IntMap m;
+  // Accurate hints (appending).
+  m.emplace_hint(m.end(), 1, "a");
+  m.emplace_hint(m.end(), 3, "c");
+  // Inaccurate hint is ignored.
+  m.emplace_hint(m.end(), 2, "b");
+  m.emplace_hint(m.begin(), 4, "d");
+  // Existing key is not replaced.
+  const auto iter = m.emplace_hint(m.begin(), 3, "x");
+  EXPECT_EQ(iter->second, "c");
+  EXPECT_THAT(m, ElementsAre(Pair(1, "a"), Pair(2, "b"), Pair(3, "c"),
+                             Pair(4, "d")));
+}
+
+TEST(SortedVectorMapTest, Bounds) {
+  const IntMap m({{10, "a"}, {20, "b"}, {30, "c"}});
+  EXPECT_EQ(m.lower_bound(5), m.begin());
+  EXPECT_EQ(m.lower_bound(10), m.begin());
+  EXPECT_EQ(m.upper_bound(10), m.begin() + 1);
+  EXPECT_EQ(m.lower_bound(25), m.begin() + 2);
+  EXPECT_EQ(m.upper_bound(25), m.begin() + 2);
+  EXPECT_EQ(m.lower_bound(30), m.begin() + 2);
+  EXPECT_EQ(m.upper_bound(30), m.end());
+  EXPECT_EQ(m.find(20), m.begin() + 1);
+  EXPECT_EQ(m.find(21), m.end());
+}
+
+TEST(SortedVectorMapTest, SubscriptAndErase) {
+  IntMap m;
+  m[3] = "c";
+  m[1] = "a";
+  m[3] += "c";
+  EXPECT_THAT(m, ElementsAre(Pair(1, "a"), Pair(3, "cc")));
+  m.erase(m.begin());
+  EXPECT_THAT(m, ElementsAre(Pair(3, "cc")));
+  m.erase(m.begin(), m.end());
+  EXPECT_TRUE(m.empty());
+}
+
+TEST(SortedVectorMapTest, EqualityAndSwap) {
+  IntMap a({{1, "a"}});
+  IntMap b({{2, "b"}});
+  EXPECT_NE(a, b);
+  swap(a, b);
+  EXPECT_THAT(a, ElementsAre(Pair(2, "b")));
+  EXPECT_THAT(b, ElementsAre(Pair(1, "a")));
+  b = a;
+  EXPECT_EQ(a, b);
+}
+
+// Comparator that enables lookup by the first element of a pair-key.
+struct ComparePairFirst {
+  bool operator()(const std::pair<int, int> &l, int r) const {
+    return l.first < r;
+  }
+  bool operator()(int l, const std::pair<int, int> &r) const {
+    return l < r.first;
+  }
+  bool operator()(const std::pair<int, int> &l,
+                  const std::pair<int, int> &r) const {
+    return l.first < r.first;
+  }
+  using is_transparent = void;
+};
+
+TEST(SortedVectorMapTest, HeterogeneousLookup) {
+  const SortedVectorMap<std::pair<int, int>, char, ComparePairFirst> m(
+      {{{10, 15}, 'a'}, {{20, 25}, 'b'}});
+  EXPECT_EQ(m.lower_bound(12), m.begin() + 1);
+  EXPECT_EQ(m.upper_bound(10), m.begin() + 1);
+  EXPECT_EQ(m.upper_bound(20), m.end());
+}
+
+TEST(SortedVectorMapTest, MatchesStdMap) {
+  std::map<int, int> expected;
+  SortedVectorMap<int, int> m;
+  // Deterministic pseudo-random sequence of keys.
+  int key = 7;
+  for (int i = 0; i < 500; ++i) {
+    key = (key * 37 + 11) % 1009;
+    EXPECT_EQ(m.insert({key, i}).second, expected.insert({key, i}).second);
+  }
+  ASSERT_EQ(m.size(), expected.size());
+  EXPECT_TRUE(std::equal(m.begin(), m.end(), expected.begin(),
+                         [](const std::pair<int, int> &left,
+                            const std::pair<const int, int> &right) {
+                           return left.first == right.first &&
+                                  left.second == right.second;
+                         }));
+  for (int k = -1; k < 1010; ++k) {
+    EXPECT_EQ(std::distance(m.begin(), m.lower_bound(k)),
+              std::distance(expected.begin(), expected.lower_bound(k)));
+    EXPECT_EQ(std::distance(m.begin(), m.upper_bound(k)),
+              std::distance(expected.begin(), expected.upper_bound(k)));
+  }
+}
+
+}  // namespace
+}  // namespace verible
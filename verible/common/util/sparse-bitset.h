@@ -0,0 +1,148 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_COMMON_UTIL_SPARSE_BITSET_H_
+#define VERIBLE_COMMON_UTIL_SPARSE_BITSET_H_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+#include <vector>
+
+#include "verible/common/util/logging.h"
+
+namespace verible {
+
+// SparseBitSet is an unbounded set of bit positions, stored as the sorted
+// vector of the positions of the set bits.  Its size is proportional to the
+// number of set bits, not to the highest position, which suits large
+// universes (e.g. thousands of macro names) of which only a few bits are set.
+//
+// The interface follows std::bitset where it makes sense: test(), set(),
+// reset(), flip(), count(), any(), none().  Iteration yields the positions of
+// the set bits in increasing order.
+// Setting or resetting a bit is O(N) in the number of set bits N, which is
+// fast for small N, and O(1) when bits are set in increasing order.
+class SparseBitSet {
+  using impl_type = std::vector<uint32_t>;
+
+ public:
+  using value_type = impl_type::value_type;
+  using const_iterator = impl_type::const_iterator;
+  using iterator = const_iterator;
+
+  SparseBitSet() = default;
+
+  SparseBitSet(std::initializer_list<size_t> positions) {
+    for (const size_t pos : positions) set(pos);
+  }
+
+  SparseBitSet(const SparseBitSet &) = default;
+  SparseBitSet(SparseBitSet &&) noexcept = default;
+  SparseBitSet &operator=(const SparseBitSet &) = default;
+  SparseBitSet &operator=(SparseBitSet &&) noexcept = default;
+
+  // Returns true if the bit at 'pos' is set.
+  bool test(size_t pos) const {
+    const auto iter = LowerBound(pos);
+    return iter != bits_.end() && *iter == pos;
+  }
+
+  // Sets the bit at 'pos' to 'value'.
+  SparseBitSet &set(size_t pos, bool value = true) {
+    CHECK_LE(pos, UINT32_MAX);
+    // Fast path: appending in increasing order.
+    if (value && (bits_.empty() || bits_.back() < pos)) {
+      bits_.push_back(pos);
+      return *this;
+    }
+    const auto iter = LowerBound(pos);
+    const bool is_set = iter != bits_.end() && *iter == pos;
+    if (value && !is_set) {
+      bits_.insert(iter, pos);
+    } else if (!value && is_set) {
+      bits_.erase(iter);
+    }
+    return *this;
+  }
+
+  SparseBitSet &reset(size_t pos) { return set(pos, false); }
+
+  SparseBitSet &flip(size_t pos) { return set(pos, !test(pos)); }
+
+  // Clears all bits.
+  void reset() { bits_.clear(); }
+
+  // Returns the number of set bits.
+  size_t count() const { return bits_.size(); }
+
+  bool any() const { return !bits_.empty(); }
+  bool none() const { return bits_.empty(); }
+
+  // Iterates over the positions of the set bits, in increasing order.
+  const_iterator begin() const { return bits_.begin(); }
+  const_iterator end() const { return bits_.end(); }
+
+  // Returns true if every bit that is set in this set is also set in 'other'.
+  bool IsSubsetOf(const SparseBitSet &other) const {
+    return std::includes(other.bits_.begin(), other.bits_.end(), bits_.begin(),
+                         bits_.end());
+  }
+
+  // Returns true if this set and 'other' have at least one bit in common.
+  bool Intersects(const SparseBitSet &other) const {
+    auto left = bits_.begin();
+    auto right = other.bits_.begin();
+    while (left != bits_.end() && right != other.bits_.end()) {
+      if (*left == *right) return true;
+      if (*left < *right) {
+        ++left;
+      } else {
+        ++right;
+      }
+    }
+    return false;
+  }
+
+  bool operator==(const SparseBitSet &other) const {
+    return bits_ == other.bits_;
+  }
+  bool operator!=(const SparseBitSet &other) const {
+    return !(*this == other);
+  }
+  // Lexicographic order of the set positions, for use in ordered containers.
+  bool operator<(const SparseBitSet &other) const {
+    return bits_ < other.bits_;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H state, const SparseBitSet &bits) {
+    return H::combine(std::move(state), bits.bits_);
+  }
+
+ private:
+  const_iterator LowerBound(size_t pos) const {
+    return std::lower_bound(bits_.begin(), bits_.end(), pos,
+                            [](uint32_t bit, size_t p) { return bit < p; });
+  }
+
+  // Positions of the set bits, sorted and unique.
+  impl_type bits_;
+};
+
+}  // namespace verible
+
+#endif  // VERIBLE_COMMON_UTIL_SPARSE_BITSET_H_
@@ -0,0 +1,119 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/common/util/sparse-bitset.h"
+
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <set>
+
+#include "absl/container/flat_hash_set.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace verible {
+namespace {
+
+using ::testing::ElementsAre;
+
+TEST(SparseBitSetTest, Empty) {
+  const SparseBitSet bits;
+  EXPECT_TRUE(bits.none());
+  EXPECT_FALSE(bits.any());
+  EXPECT_EQ(bits.count(), 0);
+  EXPECT_FALSE(bits.test(0));
+  EXPECT_FALSE(bits.test(100000));
+  EXPECT_EQ(bits.begin(), bits.end());
+}
+
+TEST(SparseBitSetTest, SetResetFlip) {
+  SparseBitSet bits;
+  bits.set(5).set(1).set(5000);
+  EXPECT_THAT(bits, ElementsAre(1, 5, 5000));
+  EXPECT_TRUE(bits.test(5));
+  EXPECT_FALSE(bits.test(4));
+  bits.set(5);  // already set
+  EXPECT_EQ(bits.count(), 3);
+  bits.reset(5);
+  bits.reset(6);  // not set
+  EXPECT_THAT(bits, ElementsAre(1, 5000));
+  bits.flip(3).flip(1);
+  EXPECT_THAT(bits, ElementsAre(3, 5000));
+  bits.set(3, false);
+  bits.set(7, true);
+  EXPECT_THAT(bits, ElementsAre(7, 5000));
+  bits.reset();
+  EXPECT_TRUE(bits.none());
+}
+
+TEST(SparseBitSetTest, MatchesStdBitset) {
+  std::bitset<300> expected;
+  SparseBitSet bits;
+  // Deterministic pseudo-random sequence of operations.
+  size_t pos = 7;
+  for (int i = 0; i < 2000; ++i) {
+    pos = (pos * 37 + 11) % 300;
+    switch (i % 3) {
+      case 0:
+        expected.set(pos);
+        bits.set(pos);
+        break;
+      case 1:
+        expected.flip(pos);
+        bits.flip(pos);
+        break;
+      case 2:
+        expected.reset((pos * 7) % 300);
+        bits.reset((pos * 7) % 300);
+        break;
+    }
+  }
+  EXPECT_EQ(bits.count(), expected.count());
+  for (size_t p = 0; p < expected.size(); ++p) {
+    EXPECT_EQ(bits.test(p), expected.test(p)) << p;
+  }
+  EXPECT_TRUE(std::is_sorted(bits.begin(), bits.end()));
+}
+
+TEST(SparseBitSetTest, SubsetAndIntersection) {
+  const SparseBitSet a{1, 4, 9};
+  const SparseBitSet b{1, 2, 4, 8, 9};
+  const SparseBitSet c{2, 3};
+  EXPECT_TRUE(a.IsSubsetOf(b));
+  EXPECT_FALSE(b.IsSubsetOf(a));
+  EXPECT_TRUE(SparseBitSet().IsSubsetOf(a));
+  EXPECT_TRUE(a.Intersects(b));
+  EXPECT_FALSE(a.Intersects(c));
+  EXPECT_TRUE(b.Intersects(c));
+  EXPECT_FALSE(a.Intersects(SparseBitSet()));
+}
+
+TEST(SparseBitSetTest, ComparisonAndHashing) {
+  const SparseBitSet a{1, 4};
+  SparseBitSet b;
+  b.set(4).set(1);
+  EXPECT_EQ(a, b);
+  b.set(2);
+  EXPECT_NE(a, b);
+  EXPECT_LT(a, SparseBitSet{2});
+
+  const std::set<SparseBitSet> ordered{a, b, SparseBitSet{1, 4}};
+  EXPECT_EQ(ordered.size(), 2);
+  const absl::flat_hash_set<SparseBitSet> hashed{a, b, SparseBitSet{1, 4}};
+  EXPECT_EQ(hashed.size(), 2);
+}
+
+}  // namespace
+}  // namespace verible
@@ -22,6 +22,7 @@
 #include <future>
 #include <mutex>
 #include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace verible {
@@ -45,7 +46,7 @@ class ThreadPool {
   // Return a std::future<T> with the eventual result.
   //
   // As a special case: if initialized with no threads, the function is
-  // executed synchronously.
+  // executed synchronously. T can be void.
   template <class T>
   [[nodiscard]] std::future<T> ExecAsync(const std::function<T()> &f) {
     auto *p = new std::promise<T>();
@@ -53,7 +54,12 @@ class ThreadPool {
     // NOLINT, as clang-tidy assumes memory leak where is none.
     auto promise_fulfiller = [p, f]() {  // NOLINT
       try {
-        p->set_value(f());
+        if constexpr (std::is_void_v<T>) {
+          f();
+          p->set_value();
+        } else {
+          p->set_value(f());
+        }
       } catch (...) {
         p->set_exception(std::current_exception());
       }
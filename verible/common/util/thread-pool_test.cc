@@ -65,6 +65,25 @@ TEST(ThreadPoolTest, WorkIsCompleted) {
   }
 }
 
+TEST(ThreadPoolTest, FunctionsWithoutResult) {
+  constexpr int kLoops = 10;
+  ThreadPool pool(1);
+
+  // With one thread, the functions are executed in order.
+  std::vector<int> executed;
+  std::vector<std::future<void>> results;
+  results.reserve(kLoops);
+  for (int i = 0; i < kLoops; ++i) {
+    results.emplace_back(
+        pool.ExecAsync<void>([i, &executed]() { executed.push_back(i); }));
+  }
+  for (auto &result : results) result.get();
+  ASSERT_EQ(executed.size(), kLoops);
+  for (int i = 0; i < kLoops; ++i) {
+    EXPECT_EQ(executed[i], i);
+  }
+}
+
 TEST(ThreadPoolTest, ExceptionsArePropagated) {
   constexpr int kLoops = 10;
   ThreadPool pool(3);
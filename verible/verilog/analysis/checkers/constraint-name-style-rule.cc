@@ -101,5 +101,10 @@ LintRuleStatus ConstraintNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ConstraintNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
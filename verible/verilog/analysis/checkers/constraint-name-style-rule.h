@@ -51,6 +51,8 @@ class ConstraintNameStyleRule : public verible::SyntaxTreeLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
   std::string Pattern() const { return regex->pattern(); }
 
  private:
@@ -404,5 +404,10 @@ LintRuleStatus DffNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool DffNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -98,6 +98,8 @@ class DffNameStyleRule : public verible::SyntaxTreeLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
   absl::Status Configure(std::string_view) final;
 
   // Identifiers can optionally include a trailing number
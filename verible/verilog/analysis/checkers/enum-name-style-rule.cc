@@ -108,5 +108,10 @@ LintRuleStatus EnumNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool EnumNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -106,5 +106,10 @@ LintRuleStatus InterfaceNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool InterfaceNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
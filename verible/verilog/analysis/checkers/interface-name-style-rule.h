@@ -48,6 +48,8 @@ class InterfaceNameStyleRule : public verible::SyntaxTreeLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
   absl::Status Configure(std::string_view configuration) final;
 
  private:
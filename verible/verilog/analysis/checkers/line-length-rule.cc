@@ -69,6 +69,7 @@ const LintRuleDescriptor &LineLengthRule::GetDescriptor() {
           "length. ",
       .param = {{"length", absl::StrCat(kDefaultLineLength),
                  "Desired line length"}},
+      .required_phase = LintAnalysisPhase::kTokens,
   };
   return d;
 }
@@ -166,6 +167,12 @@ void LineLengthRule::Lint(const TextStructureView &text_structure,
                           std::string_view) {
   size_t lineno = 0;
   for (const auto &line : text_structure.Lines()) {
+    // A line never has more characters than bytes, so most lines can be
+    // accepted without decoding UTF-8.
+    if (static_cast<int>(line.length()) <= line_length_limit_) {
+      ++lineno;
+      continue;
+    }
     const int observed_line_length = verible::utf8_len(line);
     if (observed_line_length > line_length_limit_) {
       const auto token_range = text_structure.TokenRangeOnLine(lineno);
@@ -147,5 +147,11 @@ LintRuleStatus MacroNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool MacroNameStyleRule::Reset() {
+  state_ = State::kNormal;
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
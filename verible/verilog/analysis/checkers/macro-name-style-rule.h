@@ -47,6 +47,8 @@ class MacroNameStyleRule : public verible::TokenStreamLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
   absl::Status Configure(std::string_view configuration) final;
 
  private:
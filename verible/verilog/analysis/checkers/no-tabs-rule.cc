@@ -16,8 +16,10 @@
 
 #include <set>
 #include <string_view>
+#include <vector>
 
 #include "verible/common/analysis/lint-rule-status.h"
+#include "verible/common/strings/line-scan.h"
 #include "verible/common/text/token-info.h"
 #include "verible/verilog/analysis/descriptions.h"
 #include "verible/verilog/analysis/lint-rule-registry.h"
@@ -56,6 +58,13 @@ void NoTabsRule::HandleLine(std::string_view line) {
   }
 }
 
+void NoTabsRule::HandleLines(const std::vector<std::string_view> &lines) {
+  for (const auto &match : verible::FindFirstInEachLine(lines, '\t')) {
+    TokenInfo token(TK_SPACE, lines[match.line].substr(match.column, 1));
+    violations_.insert(LintViolation(token, kMessage));
+  }
+}
+
 LintRuleStatus NoTabsRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
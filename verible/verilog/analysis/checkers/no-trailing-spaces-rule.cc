@@ -20,6 +20,7 @@
 #include <set>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/strings/strip.h"
 #include "verible/common/analysis/lint-rule-status.h"
@@ -50,7 +51,14 @@ const LintRuleDescriptor &NoTrailingSpacesRule::GetDescriptor() {
   return d;
 }
 
+// Most lines end with a visible character, so test the last byte before
+// doing anything else.
+static bool MayHaveTrailingSpace(std::string_view line) {
+  return !line.empty() && std::isspace(static_cast<unsigned char>(line.back()));
+}
+
 void NoTrailingSpacesRule::HandleLine(std::string_view line) {
+  if (!MayHaveTrailingSpace(line)) return;
   // Lines may end with \n or \r\n. '\n' is already excluded.
   // Exclude '\r'
   absl::ConsumeSuffix(&line, "\r");
@@ -72,6 +80,12 @@ void NoTrailingSpacesRule::HandleLine(std::string_view line) {
   }
 }
 
+void NoTrailingSpacesRule::HandleLines(
+    const std::vector<std::string_view> &lines) {
+  // HandleLine() is final, so these calls are not virtual.
+  for (const std::string_view line : lines) HandleLine(line);
+}
+
 LintRuleStatus NoTrailingSpacesRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
@@ -17,6 +17,7 @@
 
 #include <set>
 #include <string_view>
+#include <vector>
 
 #include "verible/common/analysis/line-lint-rule.h"
 #include "verible/common/analysis/lint-rule-status.h"
@@ -36,6 +37,9 @@ class NoTrailingSpacesRule : public verible::LineLintRule {
 
   void HandleLine(std::string_view line) final;
 
+  // Same as HandleLine() on each line, without per-line virtual dispatch.
+  void HandleLines(const std::vector<std::string_view> &lines) final;
+
   verible::LintRuleStatus Report() const final;
 
  private:
@@ -239,5 +239,10 @@ LintRuleStatus ParameterNameStyleRule::Report() const {
   return LintRuleStatus(violations_, GetDescriptor());
 }
 
+bool ParameterNameStyleRule::Reset() {
+  violations_.clear();
+  return true;
+}
+
 }  // namespace analysis
 }  // namespace verilog
@@ -50,6 +50,8 @@ class ParameterNameStyleRule : public verible::SyntaxTreeLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
   absl::Status Configure(std::string_view configuration) final;
 
   const RE2 *localparam_style_regex() const {
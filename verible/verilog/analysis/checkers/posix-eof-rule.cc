@@ -44,6 +44,7 @@ const LintRuleDescriptor &PosixEOFRule::GetDescriptor() {
       .name = "posix-eof",
       .topic = "posix-file-endings",
       .desc = "Checks that the file ends with a newline.",
+      .required_phase = LintAnalysisPhase::kText,
   };
   return d;
 }
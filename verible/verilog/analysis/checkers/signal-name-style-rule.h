@@ -50,6 +50,8 @@ class SignalNameStyleRule : public verible::SyntaxTreeLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
   absl::Status Configure(std::string_view configuration) final;
 
  private:
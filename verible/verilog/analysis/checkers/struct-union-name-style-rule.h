@@ -44,6 +44,8 @@ class StructUnionNameStyleRule : public verible::SyntaxTreeLintRule {
 
   verible::LintRuleStatus Report() const final;
 
+  bool Reset() final;
+
  private:
   std::set<std::string> exceptions_;
 
@@ -42,12 +42,24 @@ struct LintConfigParameterDescriptor {
   std::string description;
 };
 
+// Analysis results that a lint rule inspects, ordered from cheapest to most
+// expensive to produce.
+enum class LintAnalysisPhase {
+  kText,        // File contents and lines only.
+  kTokens,      // Lexed token stream.
+  kSyntaxTree,  // Preprocessed and parsed concrete syntax tree.
+};
+
 struct LintRuleDescriptor {
   LintRuleId name;         // ID/name of the rule.
   std::string_view topic;  // section in style-guide
   std::string desc;        // Detailed description.
   std::vector<LintConfigParameterDescriptor> param;
   LintRuleSeverity severity = LintRuleSeverity::kError;  // Default to error
+  // Deepest analysis phase used by a TextStructureLintRule.  Rules that do not
+  // look at the syntax tree should lower this, so that the linter can skip
+  // parsing.  The inputs of other rule types are implied by their type.
+  LintAnalysisPhase required_phase = LintAnalysisPhase::kSyntaxTree;
 };
 
 }  // namespace analysis
@@ -14,10 +14,14 @@
 
 #include "verible/verilog/analysis/flow-tree.h"
 
+#include <cstddef>
+#include <iterator>
 #include <map>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "verible/common/text/token-info.h"
+#include "verible/common/text/token-stream-view.h"
 #include "verible/common/util/logging.h"
 #include "verible/verilog/parser/verilog-token-enum.h"
 
@@ -249,96 +253,156 @@ absl::Status FlowTree::GenerateControlFlowTree() {
   return absl::OkStatus();
 }
 
+bool FlowTree::Variant::IsSatisfiedBy(const BitSet &defined_macros) const {
+  for (const size_t macro_id : visited) {
+    if (defined_macros.test(macro_id) != macros_mask.test(macro_id)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t FlowTree::Variant::size() const {
+  size_t result = 0;
+  for (const auto &segment : segments) {
+    result += std::distance(segment.begin(), segment.end());
+  }
+  return result;
+}
+
+verible::TokenSequence FlowTree::Variant::Sequence() const {
+  verible::TokenSequence sequence;
+  sequence.reserve(size());
+  for (const auto &segment : segments) {
+    sequence.insert(sequence.end(), segment.begin(), segment.end());
+  }
+  return sequence;
+}
+
+// Returns true if the token is part of the variants, i.e. it is neither a
+// directive nor the macro name following one.
+static bool IsVariantToken(const verible::TokenInfo &token) {
+  switch (token.token_enum()) {
+    case PP_Identifier:
+    case PP_ifndef:
+    case PP_ifdef:
+    case PP_define:
+    case PP_define_body:
+    case PP_elsif:
+    case PP_else:
+    case PP_endif:
+      return false;
+    default:
+      return true;
+  }
+}
+
+void FlowTree::AppendToCurrentVariant(TokenSequenceConstIterator iter) {
+  auto &segments = current_variant_.segments;
+  if (!segments.empty() && segments.back().end() == iter) {
+    segments.back() = verible::TokenRange(segments.back().begin(), iter + 1);
+  } else {
+    segments.emplace_back(iter, iter + 1);
+  }
+}
+
 // Traveses the control flow tree in a depth first manner, appending the visited
 // tokens to current_variant_, then provide the completed variant to the user
 // using a callback function (VariantReceiver).
+// Straight runs of tokens are followed iteratively, so the recursion depth is
+// bounded by the number of conditionals rather than the number of tokens.
 absl::Status FlowTree::DepthFirstSearch(
     const VariantReceiver &receiver, TokenSequenceConstIterator current_node) {
   if (!wants_more_) return absl::OkStatus();
 
-  // Skips directives so that current_variant_ doesn't contain any.
-  if (current_node->token_enum() != PP_Identifier &&
-      current_node->token_enum() != PP_ifndef &&
-      current_node->token_enum() != PP_ifdef &&
-      current_node->token_enum() != PP_define &&
-      current_node->token_enum() != PP_define_body &&
-      current_node->token_enum() != PP_elsif &&
-      current_node->token_enum() != PP_else &&
-      current_node->token_enum() != PP_endif) {
-    current_variant_.sequence.push_back(*current_node);
-  }
+  // Remember the extent of current_variant_ to back track into other
+  // variants.
+  auto &segments = current_variant_.segments;
+  const size_t saved_segments_size = segments.size();
+  const TokenSequenceConstIterator saved_segments_end =
+      segments.empty() ? source_sequence_.end() : segments.back().end();
 
-  // Checks if the current token is a `ifdef/`ifndef/`elsif.
-  if (current_node->token_enum() == PP_ifdef ||
-      current_node->token_enum() == PP_ifndef ||
-      current_node->token_enum() == PP_elsif) {
-    int macro_id = GetMacroIDOfConditional(current_node);
-    bool negated = (current_node->token_enum() == PP_ifndef);
-    // Checks if this macro is already visited (either defined/undefined).
-    if (current_variant_.visited.test(macro_id)) {
-      bool assume_condition_is_true =
-          (negated ^ current_variant_.macros_mask.test(macro_id));
-      if (auto status = DepthFirstSearch(
-              receiver, edges_[current_node][!assume_condition_is_true]);
-          !status.ok()) {
-        LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
-        return status;
-      }
-    } else {
-      current_variant_.visited.flip(macro_id);
-      // This macro wans't visited before, then we can check both edges.
-      // Assume the condition is true.
-      if (negated) {
-        current_variant_.macros_mask.reset(macro_id);
-      } else {
-        current_variant_.macros_mask.set(macro_id);
-      }
-      if (auto status = DepthFirstSearch(receiver, edges_[current_node][0]);
-          !status.ok()) {
-        LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
-        return status;
-      }
+  while (true) {
+    // Skips directives so that current_variant_ doesn't contain any.
+    if (IsVariantToken(*current_node)) {
+      AppendToCurrentVariant(current_node);
+    }
 
-      // Assume the condition is false.
-      if (!negated) {
-        current_variant_.macros_mask.reset(macro_id);
+    // Checks if the current token is a `ifdef/`ifndef/`elsif.
+    if (current_node->token_enum() == PP_ifdef ||
+        current_node->token_enum() == PP_ifndef ||
+        current_node->token_enum() == PP_elsif) {
+      int macro_id = GetMacroIDOfConditional(current_node);
+      bool negated = (current_node->token_enum() == PP_ifndef);
+      // Checks if this macro is already visited (either defined/undefined).
+      if (current_variant_.visited.test(macro_id)) {
+        bool assume_condition_is_true =
+            (negated ^ current_variant_.macros_mask.test(macro_id));
+        if (auto status = DepthFirstSearch(
+                receiver, edges_[current_node][!assume_condition_is_true]);
+            !status.ok()) {
+          LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
+          return status;
+        }
       } else {
-        current_variant_.macros_mask.set(macro_id);
-      }
-      if (auto status = DepthFirstSearch(receiver, edges_[current_node][1]);
-          !status.ok()) {
-        LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
-        return status;
+        current_variant_.visited.flip(macro_id);
+        // This macro wans't visited before, then we can check both edges.
+        // Assume the condition is true.
+        if (negated) {
+          current_variant_.macros_mask.reset(macro_id);
+        } else {
+          current_variant_.macros_mask.set(macro_id);
+        }
+        if (auto status = DepthFirstSearch(receiver, edges_[current_node][0]);
+            !status.ok()) {
+          LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
+          return status;
+        }
+
+        // Assume the condition is false.
+        if (!negated) {
+          current_variant_.macros_mask.reset(macro_id);
+        } else {
+          current_variant_.macros_mask.set(macro_id);
+        }
+        if (auto status = DepthFirstSearch(receiver, edges_[current_node][1]);
+            !status.ok()) {
+          LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
+          return status;
+        }
+        // Undo the change to allow for backtracking.
+        current_variant_.visited.flip(macro_id);
       }
-      // Undo the change to allow for backtracking.
-      current_variant_.visited.flip(macro_id);
+      break;
+    }
+
+    const auto &next_nodes = edges_[current_node];
+    // A single edge continues the current straight run of tokens.
+    if (next_nodes.size() == 1) {
+      current_node = next_nodes.front();
+      continue;
     }
-  } else {
     // Do recursive search through every possible edge.
-    // Expected to be only one edge in this case.
-    for (auto next_node : edges_[current_node]) {
+    for (auto next_node : next_nodes) {
       if (auto status = FlowTree::DepthFirstSearch(receiver, next_node);
           !status.ok()) {
         LOG(ERROR) << "ERROR: DepthFirstSearch fails. " << status;
         return status;
       }
     }
+    // If the current node is the last one, the current_variant_ is completed,
+    // then it is ready to be sent.
+    if (current_node == source_sequence_.end() - 1) {
+      wants_more_ &= receiver(current_variant_);
+    }
+    break;
   }
-  // If the current node is the last one, push the completed current_variant_
-  // then it is ready to be sent.
-  if (current_node == source_sequence_.end() - 1) {
-    wants_more_ &= receiver(current_variant_);
-  }
-  if (current_node->token_enum() != PP_Identifier &&
-      current_node->token_enum() != PP_ifndef &&
-      current_node->token_enum() != PP_ifdef &&
-      current_node->token_enum() != PP_define &&
-      current_node->token_enum() != PP_define_body &&
-      current_node->token_enum() != PP_elsif &&
-      current_node->token_enum() != PP_else &&
-      current_node->token_enum() != PP_endif) {
-    // Remove tokens to back track into other variants.
-    current_variant_.sequence.pop_back();
+
+  // Remove tokens to back track into other variants.
+  segments.erase(segments.begin() + saved_segments_size, segments.end());
+  if (!segments.empty()) {
+    segments.back() =
+        verible::TokenRange(segments.back().begin(), saved_segments_end);
   }
   return absl::OkStatus();
 }
@@ -15,7 +15,7 @@
 #ifndef VERIBLE_VERILOG_FLOW_TREE_H_
 #define VERIBLE_VERILOG_FLOW_TREE_H_
 
-#include <bitset>
+#include <cstddef>
 #include <functional>
 #include <map>
 #include <string_view>
@@ -24,6 +24,7 @@
 
 #include "absl/status/status.h"
 #include "verible/common/text/token-stream-view.h"
+#include "verible/common/util/sparse-bitset.h"
 
 namespace verilog {
 
@@ -31,13 +32,11 @@ namespace verilog {
 // source code. Furthermore, enabling doing the following queries on the graph:
 // - Generating all the possible variants (provided via a callback function).
 class FlowTree {
- private:
-  // 'kMaxDistinctMacros' shows the maximum number of distinct macros that can
-  // be considered in conditonal directives.
-  static constexpr int kMaxDistinctMacros = 128;
-
  public:
-  using BitSet = std::bitset<kMaxDistinctMacros>;
+  // Sets of macro IDs.  There is no limit on the number of distinct macros,
+  // and a set only stores the IDs that are in it, so copying a variant's sets
+  // costs memory proportional to the number of macros it visited.
+  using BitSet = verible::SparseBitSet;
   using TokenSequenceConstIterator = verible::TokenSequence::const_iterator;
 
   // "ConditionalBlock" saves locations of conditionals in a "TokenSequence".
@@ -48,8 +47,12 @@ class FlowTree {
   //  'source_sequence_.end()'.
 
   struct Variant {
-    // Contains the token sequence of the variant.
-    verible::TokenSequence sequence;
+    // The token sequence of the variant, as a list of non-empty contiguous
+    // ranges of the FlowTree's source sequence.  Segments are shared by all
+    // variants rather than copied, so a Variant costs memory proportional to
+    // the number of conditional branches taken, not to the size of the file.
+    // Segments are only valid for the lifetime of the FlowTree.
+    std::vector<verible::TokenRange> segments;
 
     // The i-th bit in "macros_mask" is 1 when the macro (with ID = i) is
     // assumed to be defined, otherwise it is assumed to be undefined.
@@ -70,10 +73,23 @@ class FlowTree {
     // we notice that B doesn't affect the variant.
     // Then the bit corresponding to B in "visited" is 0.
     BitSet visited;
+
+    // Returns true if this variant is the one selected when exactly the
+    // macros in 'defined_macros' are defined, i.e. if every visited macro is
+    // defined in 'defined_macros' iff it is assumed to be defined here.
+    bool IsSatisfiedBy(const BitSet &defined_macros) const;
+
+    // Returns the number of tokens in the variant.
+    size_t size() const;
+
+    // Returns a copy of the variant's tokens, concatenated.
+    verible::TokenSequence Sequence() const;
   };
 
   // Receive a complete token sequence of one variant.
-  // variant_sequence: the generated variant token sequence.
+  // Variants are generated lazily, one at a time, and the receiver returns
+  // false to stop the generation.
+  // variant: the generated variant, which the receiver may copy cheaply.
   using VariantReceiver = std::function<bool(const Variant &variant)>;
 
   explicit FlowTree(verible::TokenSequence source_sequence)
@@ -110,6 +126,10 @@ class FlowTree {
   absl::Status DepthFirstSearch(const VariantReceiver &receiver,
                                 TokenSequenceConstIterator current_node);
 
+  // Appends the token at 'iter' to the current variant, extending its last
+  // segment if possible.
+  void AppendToCurrentVariant(TokenSequenceConstIterator iter);
+
   // Checks if the iterator points to a conditonal directive (`ifdef/ifndef...).
   static bool IsConditional(TokenSequenceConstIterator iterator);
 
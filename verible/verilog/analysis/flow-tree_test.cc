@@ -14,10 +14,12 @@
 
 #include "verible/verilog/analysis/flow-tree.h"
 
+#include <string>
 #include <string_view>
 #include <vector>
 
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "verible/common/text/token-stream-view.h"
@@ -79,16 +81,58 @@ TEST(FlowTree, MultipleConditionalsSameMacro) {
   // First variant: A is defined.
   EXPECT_TRUE(variants[0].macros_mask.test(0));
   EXPECT_TRUE(variants[0].visited.test(0));
-  EXPECT_THAT(variants[0].sequence[0].text(), "A_TRUE_1");
-  EXPECT_THAT(variants[0].sequence[1].text(), "A_TRUE_2");
-  EXPECT_THAT(variants[0].sequence[2].text(), "A_TRUE_3");
+  EXPECT_THAT(variants[0].Sequence()[0].text(), "A_TRUE_1");
+  EXPECT_THAT(variants[0].Sequence()[1].text(), "A_TRUE_2");
+  EXPECT_THAT(variants[0].Sequence()[2].text(), "A_TRUE_3");
 
   // Second variant: A is undefined.
   EXPECT_FALSE(variants[1].macros_mask.test(0));
   EXPECT_TRUE(variants[1].visited.test(0));
-  EXPECT_THAT(variants[1].sequence[0].text(), "A_FALSE_1");
-  EXPECT_THAT(variants[1].sequence[1].text(), "A_FALSE_2");
-  EXPECT_THAT(variants[1].sequence[2].text(), "A_FALSE_3");
+  EXPECT_THAT(variants[1].Sequence()[0].text(), "A_FALSE_1");
+  EXPECT_THAT(variants[1].Sequence()[1].text(), "A_FALSE_2");
+  EXPECT_THAT(variants[1].Sequence()[2].text(), "A_FALSE_3");
+}
+
+TEST(FlowTree, VariantsShareSegments) {
+  const std::string_view test_case =
+      R"(
+    module m;
+      wire w;
+    `ifdef A
+      A_TRUE
+    `else
+      A_FALSE_1 A_FALSE_2
+    `endif
+    endmodule)";
+
+  FlowTree tree_test(LexToSequence(test_case));
+  std::vector<FlowTree::Variant> variants;
+  auto status =
+      tree_test.GenerateVariants([&variants](const FlowTree::Variant &variant) {
+        variants.push_back(variant);
+        return true;
+      });
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(variants.size(), 2);
+
+  // Adjacent tokens form a single segment: the common prefix, the branch,
+  // and the common suffix.
+  ASSERT_EQ(variants[0].segments.size(), 3);
+  ASSERT_EQ(variants[1].segments.size(), 3);
+  EXPECT_EQ(variants[0].size(), 8);
+  EXPECT_EQ(variants[1].size(), 9);
+  EXPECT_EQ(variants[1].segments[1].begin()->text(), "A_FALSE_1");
+
+  // The common parts reference the same tokens.
+  EXPECT_EQ(&*variants[0].segments[0].begin(),
+            &*variants[1].segments[0].begin());
+  EXPECT_EQ(&*variants[0].segments[2].begin(),
+            &*variants[1].segments[2].begin());
+
+  const verible::TokenSequence sequence = variants[0].Sequence();
+  ASSERT_EQ(sequence.size(), 8);
+  EXPECT_EQ(sequence[6].text(), "A_TRUE");
+  EXPECT_EQ(sequence[7].text(), "endmodule");
 }
 
 TEST(FlowTree, UnmatchedElses) {
@@ -212,7 +256,7 @@ TEST(FlowTree, NestedConditionals) {
     EXPECT_TRUE(status.ok());
     EXPECT_EQ(variants.size(), 3);
     for (const auto &variant : variants) {
-      EXPECT_EQ(variant.sequence.size(), 1);
+      EXPECT_EQ(variant.size(), 1);
       if (variant.macros_mask.test(0) == 0) {
         // Check that if A is undefined, then B is not visited.
         EXPECT_FALSE(variant.visited.test(1));
@@ -259,19 +303,19 @@ TEST(FlowTree, MultipleElseIfs) {
 
   // A is defined.
   EXPECT_TRUE(variants[0].macros_mask.test(0));
-  EXPECT_THAT(variants[0].sequence[0].text(), "A_TRUE");
+  EXPECT_THAT(variants[0].Sequence()[0].text(), "A_TRUE");
 
   // B is defined.
   EXPECT_TRUE(variants[1].macros_mask.test(1));
-  EXPECT_THAT(variants[1].sequence[0].text(), "B_TRUE");
+  EXPECT_THAT(variants[1].Sequence()[0].text(), "B_TRUE");
 
   // EMPTY is defined.
   EXPECT_TRUE(variants[2].macros_mask.test(2));
-  EXPECT_TRUE(variants[2].sequence.empty());
+  EXPECT_TRUE(variants[2].segments.empty());
 
   // C is defined.
   EXPECT_TRUE(variants[3].macros_mask.test(3));
-  EXPECT_THAT(variants[3].sequence[0].text(), "C_TRUE");
+  EXPECT_THAT(variants[3].Sequence()[0].text(), "C_TRUE");
 }
 
 TEST(FlowTree, SwappedNegatedIfs) {
@@ -304,15 +348,15 @@ TEST(FlowTree, SwappedNegatedIfs) {
   EXPECT_THAT(used_macros[0]->text(), "A");
   EXPECT_THAT(used_macros[1]->text(), "B");
 
-  EXPECT_THAT(variants[0].sequence[0].text(), "A_FALSE");
-  EXPECT_THAT(variants[0].sequence[1].text(), "B_FALSE");
+  EXPECT_THAT(variants[0].Sequence()[0].text(), "A_FALSE");
+  EXPECT_THAT(variants[0].Sequence()[1].text(), "B_FALSE");
 
-  EXPECT_THAT(variants[1].sequence[0].text(), "A_FALSE");
+  EXPECT_THAT(variants[1].Sequence()[0].text(), "A_FALSE");
 
-  EXPECT_THAT(variants[2].sequence[0].text(), "B_TRUE");
-  EXPECT_THAT(variants[2].sequence[1].text(), "A_TRUE");
+  EXPECT_THAT(variants[2].Sequence()[0].text(), "B_TRUE");
+  EXPECT_THAT(variants[2].Sequence()[1].text(), "A_TRUE");
 
-  EXPECT_THAT(variants[3].sequence[0].text(), "B_FALSE");
+  EXPECT_THAT(variants[3].Sequence()[0].text(), "B_FALSE");
 }
 
 TEST(FlowTree, CompleteConditional) {
@@ -345,15 +389,55 @@ TEST(FlowTree, CompleteConditional) {
   EXPECT_THAT(used_macros[2]->text(), "C");
 
   EXPECT_TRUE(variants[0].macros_mask.test(0));
-  EXPECT_THAT(variants[0].sequence[0].text(), "A_TRUE");
+  EXPECT_THAT(variants[0].Sequence()[0].text(), "A_TRUE");
 
   EXPECT_TRUE(variants[1].macros_mask.test(1));
-  EXPECT_THAT(variants[1].sequence[0].text(), "B_TRUE");
+  EXPECT_THAT(variants[1].Sequence()[0].text(), "B_TRUE");
 
   EXPECT_TRUE(variants[2].macros_mask.test(2));
-  EXPECT_THAT(variants[2].sequence[0].text(), "C_TRUE");
+  EXPECT_THAT(variants[2].Sequence()[0].text(), "C_TRUE");
+
+  EXPECT_THAT(variants[3].Sequence()[0].text(), "ALL_FALSE");
+}
+
+TEST(FlowTree, ManyDistinctMacros) {
+  constexpr int kNumMacros = 200;
+  std::string test_case;
+  for (int i = 0; i < kNumMacros; ++i) {
+    absl::StrAppend(&test_case, "`ifdef M", i, "\n  T", i,
+                    "\n`else\n  F\n`endif\n");
+  }
 
-  EXPECT_THAT(variants[3].sequence[0].text(), "ALL_FALSE");
+  FlowTree tree_test(LexToSequence(test_case));
+  std::vector<FlowTree::Variant> variants;
+  // There are 2^200 variants, so stop after the first two.
+  auto status =
+      tree_test.GenerateVariants([&variants](const FlowTree::Variant &variant) {
+        variants.push_back(variant);
+        return variants.size() < 2;
+      });
+  EXPECT_TRUE(status.ok());
+  ASSERT_EQ(variants.size(), 2);
+  EXPECT_EQ(tree_test.GetUsedMacros().size(), kNumMacros);
+
+  // All macros are defined in the first variant.
+  EXPECT_EQ(variants[0].visited.count(), kNumMacros);
+  EXPECT_EQ(variants[0].macros_mask.count(), kNumMacros);
+  EXPECT_EQ(variants[0].size(), kNumMacros);
+  EXPECT_THAT(variants[0].Sequence().back().text(), "T199");
+
+  // Only the last macro is undefined in the second one.
+  EXPECT_EQ(variants[1].visited.count(), kNumMacros);
+  EXPECT_EQ(variants[1].macros_mask.count(), kNumMacros - 1);
+  EXPECT_FALSE(variants[1].macros_mask.test(kNumMacros - 1));
+  EXPECT_THAT(variants[1].Sequence().back().text(), "F");
+
+  EXPECT_TRUE(variants[0].IsSatisfiedBy(variants[0].macros_mask));
+  EXPECT_FALSE(variants[0].IsSatisfiedBy(variants[1].macros_mask));
+  EXPECT_TRUE(variants[1].IsSatisfiedBy(variants[1].macros_mask));
+  FlowTree::BitSet defined = variants[1].macros_mask;
+  defined.set(kNumMacros);  // unrelated macro
+  EXPECT_TRUE(variants[1].IsSatisfiedBy(defined));
 }
 
 }  // namespace
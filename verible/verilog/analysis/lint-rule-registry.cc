@@ -158,6 +158,21 @@ std::unique_ptr<TextStructureLintRule> CreateTextStructureLintRule(
   return LintRuleRegistry<TextStructureLintRule>::CreateLintRule(rule_name);
 }
 
+LintAnalysisPhase GetRequiredAnalysisPhase(const LintRuleId &rule_name) {
+  if (LintRuleRegistry<LineLintRule>::ContainsLintRule(rule_name)) {
+    return LintAnalysisPhase::kText;
+  }
+  if (LintRuleRegistry<TokenStreamLintRule>::ContainsLintRule(rule_name)) {
+    return LintAnalysisPhase::kTokens;
+  }
+  if (LintRuleRegistry<TextStructureLintRule>::ContainsLintRule(rule_name)) {
+    return LintRuleRegistry<TextStructureLintRule>::GetRuleDescription(
+               rule_name)
+        .required_phase;
+  }
+  return LintAnalysisPhase::kSyntaxTree;
+}
+
 std::set<LintRuleId> GetAllRegisteredLintRuleNames() {
   std::set<LintRuleId> result;
   for (const auto name : RegisteredSyntaxTreeRulesNames()) {
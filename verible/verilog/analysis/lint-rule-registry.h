@@ -143,6 +143,12 @@ std::vector<LintRuleId> RegisteredTextStructureRulesNames();
 std::unique_ptr<verible::TextStructureLintRule> CreateTextStructureLintRule(
     const LintRuleId &rule_name);
 
+// Returns the deepest analysis phase that the rule named rule_name needs:
+// kText for line rules, kTokens for token stream rules, kSyntaxTree for
+// syntax tree rules, and the descriptor's required_phase for text structure
+// rules.  Unregistered names conservatively yield kSyntaxTree.
+LintAnalysisPhase GetRequiredAnalysisPhase(const LintRuleId &rule_name);
+
 // Returns set of all registered lint rule names.
 // When storing string_views to the lint rule keys, use the ones returned in
 // this set, because their lifetime is guaranteed by the registration process.
@@ -16,8 +16,10 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <stack>
@@ -34,6 +36,7 @@
 #include "absl/time/clock.h"
 #include "absl/time/time.h"
 #include "verible/common/strings/display-utils.h"
+#include "verible/common/strings/line-column-map.h"
 #include "verible/common/text/concrete-syntax-leaf.h"
 #include "verible/common/text/concrete-syntax-tree.h"
 #include "verible/common/text/token-info.h"
@@ -1500,9 +1503,20 @@ class SymbolTable::Builder : public TreeContextVisitor {
     here_print << source_->GetTextStructure()->GetRangeForText(name);
 
     std::ostringstream previous_print;
-    previous_print << previous_symbol.Value()
-                          .file_origin->GetTextStructure()
-                          ->GetRangeForText(*previous_symbol.Key());
+    const VerilogSourceFile &previous_file =
+        *previous_symbol.Value().file_origin;
+    if (const auto *text_structure = previous_file.GetTextStructure()) {
+      previous_print << text_structure->GetRangeForText(*previous_symbol.Key());
+    } else {
+      // The syntax tree was released, but the content is still there.
+      const std::string_view content = previous_file.GetContent();
+      const std::string_view name = *previous_symbol.Key();
+      const int offset = name.data() - content.data();
+      const verible::LineColumnMap line_map(content);
+      previous_print << verible::LineColumnRange{
+          line_map.GetLineColAtOffset(content, offset),
+          line_map.GetLineColAtOffset(content, offset + name.size())};
+    }
 
     // TODO(hzeller): output in some structured form easy to use downstream.
     diagnostics_.push_back(absl::AlreadyExistsError(absl::StrCat(
@@ -2309,6 +2323,113 @@ void SymbolTable::Resolve(std::vector<absl::Status> *diagnostics) {
   VLOG(1) << "SymbolTable::Resolve took " << (absl::Now() - start);
 }
 
+// Fields of SymbolInfo that point into a syntax tree: a non-negative value
+// is an index into declared_type.type_specifications.
+static constexpr int kSymbolSyntaxOrigin = -2;
+static constexpr int kDeclaredTypeSyntaxOrigin = -1;
+
+static const verible::Symbol *&SyntaxOriginField(SymbolInfo *symbol,
+                                                 int field) {
+  switch (field) {
+    case kSymbolSyntaxOrigin:
+      return symbol->syntax_origin;
+    case kDeclaredTypeSyntaxOrigin:
+      return symbol->declared_type.syntax_origin;
+    default:
+      return symbol->declared_type.type_specifications[field];
+  }
+}
+
+// Calls "f" with each node and leaf of "tree" and its pre-order position.
+static void ForEachSymbolPreOrder(
+    const verible::Symbol &tree,
+    const std::function<void(const verible::Symbol &, size_t)> &f) {
+  size_t index = 0;
+  std::stack<const verible::Symbol *> pending({&tree});
+  while (!pending.empty()) {
+    const verible::Symbol *symbol = pending.top();
+    pending.pop();
+    f(*symbol, index++);
+    if (symbol->Kind() != verible::SymbolKind::kNode) continue;
+    const auto &children = verible::SymbolCastToNode(*symbol).children();
+    for (auto child = children.end(); child != children.begin();) {
+      --child;
+      if (*child) pending.push(child->get());
+    }
+  }
+}
+
+void SymbolTable::ReleaseSyntaxTrees(
+    const std::vector<VerilogSourceFile *> &files) {
+  // Which fields point to each syntax tree element.
+  struct Field {
+    SymbolInfo *symbol;
+    int field;
+  };
+  std::map<const verible::Symbol *, std::vector<Field>> fields_pointing_to;
+  symbol_table_root_.ApplyPreOrder([&fields_pointing_to](SymbolInfo &symbol) {
+    const auto add = [&](const verible::Symbol *origin, int field) {
+      if (origin) fields_pointing_to[origin].push_back({&symbol, field});
+    };
+    add(symbol.syntax_origin, kSymbolSyntaxOrigin);
+    add(symbol.declared_type.syntax_origin, kDeclaredTypeSyntaxOrigin);
+    const auto &type_specifications = symbol.declared_type.type_specifications;
+    for (size_t i = 0; i < type_specifications.size(); ++i) {
+      add(type_specifications[i], static_cast<int>(i));
+    }
+  });
+
+  for (VerilogSourceFile *file : files) {
+    if (!file->OwnsParsedStructure()) continue;
+    const verible::ConcreteSyntaxTree &tree =
+        file->GetTextStructure()->SyntaxTree();
+    if (tree != nullptr) {
+      std::vector<DetachedSyntaxOrigin> &detached =
+          detached_syntax_origins_[file];
+      ForEachSymbolPreOrder(*tree, [&](const verible::Symbol &element,
+                                       size_t index) {
+        const auto found = fields_pointing_to.find(&element);
+        if (found == fields_pointing_to.end()) return;
+        for (const Field &field : found->second) {
+          SyntaxOriginField(field.symbol, field.field) = nullptr;
+          detached.push_back({field.symbol, field.field, index});
+        }
+      });
+      // The file may have been released before, and re-parsed since.
+      std::stable_sort(detached.begin(), detached.end(),
+                       [](const DetachedSyntaxOrigin &a,
+                          const DetachedSyntaxOrigin &b) {
+                         return a.pre_order_index < b.pre_order_index;
+                       });
+    }
+    file->ReleaseParsedStructure();
+  }
+}
+
+absl::Status SymbolTable::ReattachSyntaxTree(VerilogSourceFile *file) {
+  const absl::Status status = file->Parse();
+  const auto found = detached_syntax_origins_.find(file);
+  if (found == detached_syntax_origins_.end()) return status;
+  const std::vector<DetachedSyntaxOrigin> detached = std::move(found->second);
+  detached_syntax_origins_.erase(found);
+
+  // The same content parses into the same tree.
+  const verible::TextStructureView *text_structure = file->GetTextStructure();
+  if (text_structure == nullptr || text_structure->SyntaxTree() == nullptr) {
+    return status;
+  }
+  auto next = detached.begin();
+  ForEachSymbolPreOrder(
+      *text_structure->SyntaxTree(),
+      [&](const verible::Symbol &element, size_t index) {
+        for (; next != detached.end() && next->pre_order_index == index;
+             ++next) {
+          SyntaxOriginField(next->symbol, next->field) = &element;
+        }
+      });
+  return status;
+}
+
 void SymbolTable::ResolveLocallyOnly() {
   symbol_table_root_.ApplyPreOrder(
       [=](SymbolTableNode &node) { node.Value().ResolveLocally(node); });
@@ -497,6 +497,16 @@ class SymbolTable {
   // is intended.
   void ResolveLocallyOnly();
 
+  // Releases the syntax trees of "files" to save memory (see
+  // VerilogSourceFile::ReleaseParsedStructure()).  Symbols keep their names,
+  // scopes and references, which point into the file contents, but their
+  // syntax origins in these files become nullptr until ReattachSyntaxTree().
+  void ReleaseSyntaxTrees(const std::vector<VerilogSourceFile *> &files);
+
+  // Parses a file whose syntax tree was released again, and points the
+  // syntax origins back into the new syntax tree.  Returns the parse status.
+  absl::Status ReattachSyntaxTree(VerilogSourceFile *file);
+
   // Print only the information about symbols defined (no references).
   // This will print the results of Build().
   std::ostream &PrintSymbolDefinitions(std::ostream &) const;
@@ -523,6 +533,18 @@ class SymbolTable {
   // before symbol table construction, and this can become read-only.
   VerilogProject *const project_;
 
+  // A syntax origin that pointed into a released syntax tree: the field of
+  // the symbol, and the position of the pointee in a pre-order traversal
+  // of that tree.
+  struct DetachedSyntaxOrigin {
+    SymbolInfo *symbol;
+    int field;  // See SyntaxOriginField() in the implementation.
+    size_t pre_order_index;
+  };
+  // Per file whose syntax tree is released, in pre-order.
+  std::map<const VerilogSourceFile *, std::vector<DetachedSyntaxOrigin>>
+      detached_syntax_origins_;
+
   // Global symbol table root for SystemVerilog language elements:
   // modules, packages, classes, tasks, functions, interfaces, etc.
   // Known limitation: All of the above elements share the same namespace,
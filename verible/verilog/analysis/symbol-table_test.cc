@@ -9402,6 +9402,65 @@ TEST_F(BuildSymbolTableTest, InterfaceDeclarationDuplicateSeparateFiles) {
   }
 }
 
+TEST_F(BuildSymbolTableTest, ReleaseAndReattachSyntaxTree) {
+  TestVerilogSourceFile src("foobar.sv",
+                            "module foo;\n"
+                            "  logic [3:0] bar;\n"
+                            "endmodule\n");
+  const auto status = src.Parse();
+  ASSERT_TRUE(status.ok()) << status.message();
+  SymbolTable symbol_table(nullptr);
+  const SymbolTableNode &root_symbol(symbol_table.Root());
+
+  const auto build_diagnostics = BuildSymbolTable(src, &symbol_table);
+  EXPECT_EMPTY_STATUSES(build_diagnostics);
+
+  MUST_ASSIGN_LOOKUP_SYMBOL(foo, root_symbol, "foo");
+  MUST_ASSIGN_LOOKUP_SYMBOL(bar, foo, "bar");
+  ASSERT_NE(foo_info.syntax_origin, nullptr);
+  ASSERT_NE(bar_info.declared_type.syntax_origin, nullptr);
+  const std::string_view foo_text =
+      verible::StringSpanOfSymbol(*foo_info.syntax_origin);
+  const std::string_view bar_type_text =
+      verible::StringSpanOfSymbol(*bar_info.declared_type.syntax_origin);
+
+  symbol_table.ReleaseSyntaxTrees({&src});
+  EXPECT_FALSE(src.OwnsParsedStructure());
+  EXPECT_EQ(src.GetTextStructure(), nullptr);
+  EXPECT_EQ(foo_info.syntax_origin, nullptr);
+  EXPECT_EQ(bar_info.declared_type.syntax_origin, nullptr);
+  // The symbols themselves are still there.
+  EXPECT_EQ(*foo.Key(), "foo");
+  EXPECT_EQ(bar_info.file_origin, &src);
+
+  EXPECT_TRUE(symbol_table.ReattachSyntaxTree(&src).ok());
+  ASSERT_NE(src.GetTextStructure(), nullptr);
+  ASSERT_NE(foo_info.syntax_origin, nullptr);
+  ASSERT_NE(bar_info.declared_type.syntax_origin, nullptr);
+  // Same text, in the new syntax tree.
+  EXPECT_EQ(verible::StringSpanOfSymbol(*foo_info.syntax_origin), foo_text);
+  EXPECT_EQ(
+      verible::StringSpanOfSymbol(*bar_info.declared_type.syntax_origin),
+      bar_type_text);
+}
+
+TEST_F(BuildSymbolTableTest, DuplicateDefinitionInReleasedFile) {
+  TestVerilogSourceFile src("foobar.sv", "module foo;\nendmodule\n");
+  TestVerilogSourceFile src2("foobar-2.sv", "module foo;\nendmodule\n");
+  ASSERT_TRUE(src.Parse().ok());
+  ASSERT_TRUE(src2.Parse().ok());
+  SymbolTable symbol_table(nullptr);
+
+  EXPECT_EMPTY_STATUSES(BuildSymbolTable(src, &symbol_table));
+  symbol_table.ReleaseSyntaxTrees({&src});
+
+  // The location of the first definition comes from the file contents.
+  const auto build_diagnostics = BuildSymbolTable(src2, &symbol_table);
+  ASSIGN_MUST_HAVE_UNIQUE(err, build_diagnostics);
+  EXPECT_EQ(err.code(), absl::StatusCode::kAlreadyExists);
+  EXPECT_THAT(err.message(), HasSubstr("1:8-10"));
+}
+
 struct FileListTestCase {
   std::string_view contents;
   std::vector<std::string_view> expected_files;
@@ -27,6 +27,8 @@
 #include "absl/status/status.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "verible/common/analysis/file-analyzer.h"
 #include "verible/common/lexer/token-stream-adapter.h"
 #include "verible/common/strings/comment-utils.h"
@@ -61,9 +63,11 @@ using verible::container::InsertKeyOrDie;
 
 absl::Status VerilogAnalyzer::Tokenize() {
   if (!tokenized_) {
+    const absl::Time start = absl::Now();
     VerilogLexer lexer{Data().Contents()};
     tokenized_ = true;
     lex_status_ = FileAnalyzer::Tokenize(&lexer);
+    phase_times_.lex += absl::Now() - start;
   }
   return lex_status_;
 }
@@ -252,15 +256,18 @@ absl::Status VerilogAnalyzer::Analyze() {
   // Lex into tokens.
   RETURN_IF_ERROR(Tokenize());
 
+  absl::Time start = absl::Now();
   // Here would be one place to analyze the raw token stream.
   FilterTokensForSyntaxTree();
 
   // Disambiguate tokens using lexical context.
   ContextualizeTokens();
+  phase_times_.lex += absl::Now() - start;
 
   // pseudo-preprocess token stream.
   //   Not all analyses will want to preprocess.
   {
+    start = absl::Now();
     VerilogPreprocess preprocessor(preprocess_config_);
     preprocessor_data_ = preprocessor.ScanStream(Data().GetTokenStreamView());
     if (!preprocessor_data_.errors.empty()) {
@@ -270,6 +277,7 @@ absl::Status VerilogAnalyzer::Analyze() {
             error.error_message});
       }
       parse_status_ = absl::InvalidArgumentError("Preprocessor error.");
+      phase_times_.preprocess += absl::Now() - start;
       return parse_status_;
     }
 
@@ -290,8 +298,10 @@ absl::Status VerilogAnalyzer::Analyze() {
     MutableData().MutableTokenStreamView() =
         preprocessor_data_.preprocessed_token_stream;  // copy
     // TODO(fangism): could we just move, swap, or directly reference?
+    phase_times_.preprocess += absl::Now() - start;
   }
 
+  start = absl::Now();
   auto generator = MakeTokenViewer(Data().GetTokenStreamView());
   VerilogParser parser(&generator, filename_);
   parse_status_ = FileAnalyzer::Parse(&parser);
@@ -302,6 +312,7 @@ absl::Status VerilogAnalyzer::Analyze() {
   if (parse_status_.ok() && Data().SyntaxTree() != nullptr) {
     ExpandMacroCallArgExpressions();
   }
+  phase_times_.parse += absl::Now() - start;
 
   return parse_status_;
 }
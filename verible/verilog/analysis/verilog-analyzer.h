@@ -21,6 +21,7 @@
 #include <utility>
 
 #include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "verible/common/analysis/file-analyzer.h"
 #include "verible/common/strings/mem-block.h"
 #include "verible/common/text/token-stream-view.h"
@@ -69,6 +70,16 @@ class VerilogAnalyzer : public verible::FileAnalyzer {
 
   size_t MaxUsedStackSize() const { return max_used_stack_size_; }
 
+  // Time spent in each phase of Tokenize() and Analyze().  Measured with a
+  // few clock reads per call, which cost nothing next to the phases, so it
+  // is always measured.
+  struct PhaseTimes {
+    absl::Duration lex;  // Including the filtering and contextualizing.
+    absl::Duration preprocess;
+    absl::Duration parse;  // Including the expansion of macro arguments.
+  };
+  const PhaseTimes &Timing() const { return phase_times_; }
+
   // Automatically analyze with the correct parsing mode, as detected
   // by parser directive comments.
   static std::unique_ptr<VerilogAnalyzer> AnalyzeAutomaticMode(
@@ -122,6 +133,8 @@ class VerilogAnalyzer : public verible::FileAnalyzer {
   // Maximum symbol stack depth.
   size_t max_used_stack_size_ = 0;
 
+  PhaseTimes phase_times_;
+
   // Preprocessor.
   const VerilogPreprocess::Config preprocess_config_;
   VerilogPreprocessData preprocessor_data_;
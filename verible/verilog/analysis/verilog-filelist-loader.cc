@@ -0,0 +1,240 @@
+// Copyright 2017-2022 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/analysis/verilog-filelist-loader.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "verible/common/util/file-util.h"
+#include "verible/common/util/logging.h"
+#include "verible/verilog/analysis/verilog-filelist.h"
+
+namespace verilog {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// A filelist as read from its file, with paths as written.
+struct ReadFileList {
+  std::string path;  // as accessed from the current directory
+  fs::file_time_type modification_time;
+  FileList contents;
+};
+
+absl::StatusOr<ReadFileList> ReadOneFileList(const std::string &path) {
+  ReadFileList result;
+  result.path = path;
+  // Taken before reading, so that a concurrent change is seen as a change by
+  // the next FileListLoader::Load().
+  std::error_code err;
+  result.modification_time = fs::last_write_time(path, err);
+  if (absl::Status status = AppendFileListFromFile(path, &result.contents);
+      !status.ok()) {
+    return status;
+  }
+  return result;
+}
+
+// Returns the directory of 'path', which is empty for a bare filename.
+std::string DirectoryOf(std::string_view path) {
+  return fs::path(std::string(path)).parent_path().string();
+}
+
+// Returns 'path', which is relative to 'dir' (unless absolute), as a
+// normalized path relative to the directory that 'dir' is relative to.
+std::string Rebase(std::string_view dir, std::string_view path) {
+  std::string result = verible::file::JoinPath(dir, path);
+  // "dir/." normalizes to "dir/".
+  if (result.size() > 1 && result.back() == '/') result.pop_back();
+  return result;
+}
+
+// Concatenates the contents of filelists, expanding nested filelists in place.
+class FileListExpander {
+ public:
+  FileListExpander(
+      const absl::flat_hash_map<std::string, ReadFileList> &file_lists,
+      FileList *output)
+      : file_lists_(file_lists), output_(output) {}
+
+  // Appends the filelist 'path' (relative to the top-level directory), unless
+  // it was appended before.
+  void Expand(const std::string &path) {
+    if (!expanded_.insert(path).second) return;  // also breaks cycles
+    const auto found = file_lists_.find(path);
+    CHECK(found != file_lists_.end()) << path;
+    const FileList &file_list = found->second.contents;
+    const std::string dir = DirectoryOf(path);
+
+    for (const std::string &include_dir :
+         file_list.preprocessing.include_dirs) {
+      std::string rebased = Rebase(dir, include_dir);
+      if (include_dirs_.insert(rebased).second) {
+        output_->preprocessing.include_dirs.push_back(std::move(rebased));
+      }
+    }
+    output_->preprocessing.defines.insert(
+        output_->preprocessing.defines.end(),
+        file_list.preprocessing.defines.begin(),
+        file_list.preprocessing.defines.end());
+
+    size_t next_file = 0;
+    const auto append_files_until = [&](size_t end) {
+      for (; next_file < end; ++next_file) {
+        std::string rebased = Rebase(dir, file_list.file_paths[next_file]);
+        if (files_.insert(rebased).second) {
+          output_->file_paths.push_back(std::move(rebased));
+        }
+      }
+    };
+    for (const FileList::NestedFileList &nested : file_list.nested_file_lists) {
+      append_files_until(nested.position);
+      Expand(Rebase(dir, nested.path));
+    }
+    append_files_until(file_list.file_paths.size());
+  }
+
+ private:
+  const absl::flat_hash_map<std::string, ReadFileList> &file_lists_;
+  FileList *const output_;
+
+  absl::flat_hash_set<std::string> expanded_;
+  absl::flat_hash_set<std::string> files_;
+  absl::flat_hash_set<std::string> include_dirs_;
+};
+
+// Returns true if none of the filelists of 'loaded' changed since it was
+// loaded.
+bool IsUpToDate(const LoadedFileList &loaded) {
+  for (const auto &[path, modification_time] : loaded.file_list_files) {
+    std::error_code err;
+    if (fs::last_write_time(path, err) != modification_time || err) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+FileListLoader::FileListLoader(int threads)
+    : pool_(threads), threads_(threads) {}
+
+absl::StatusOr<std::shared_ptr<const LoadedFileList>> FileListLoader::Load(
+    std::string_view file_list_path) {
+  const std::string key(file_list_path);
+  std::shared_ptr<const LoadedFileList> cached;
+  {
+    const std::lock_guard<std::mutex> lock(cache_mutex_);
+    const auto found = cache_.find(key);
+    if (found != cache_.end()) cached = found->second;
+  }
+  if (cached && IsUpToDate(*cached)) return cached;
+
+  absl::StatusOr<std::shared_ptr<const LoadedFileList>> loaded =
+      LoadUncached(file_list_path);
+  if (loaded.ok()) {
+    const std::lock_guard<std::mutex> lock(cache_mutex_);
+    cache_[key] = *loaded;
+  }
+  return loaded;
+}
+
+absl::StatusOr<std::shared_ptr<const LoadedFileList>>
+FileListLoader::LoadUncached(std::string_view file_list_path) {
+  const std::string base_dir = DirectoryOf(file_list_path);
+  const std::string top_level =
+      fs::path(std::string(file_list_path)).filename().string();
+
+  // Read the filelists one nesting level at a time, all filelists of a level
+  // concurrently.  Filelists are identified by their path relative to
+  // 'base_dir'.
+  absl::flat_hash_map<std::string, ReadFileList> file_lists;
+  absl::flat_hash_set<std::string> seen = {top_level};
+  std::vector<std::pair<std::string, std::string>> level = {
+      {top_level, std::string(file_list_path)}};
+  auto result = std::make_shared<LoadedFileList>();
+  while (!level.empty()) {
+    std::vector<std::future<absl::StatusOr<ReadFileList>>> reads;
+    reads.reserve(level.size());
+    for (const auto &[name, path] : level) {
+      reads.push_back(pool_.ExecAsync<absl::StatusOr<ReadFileList>>(
+          [path = path] { return ReadOneFileList(path); }));
+    }
+    std::vector<std::pair<std::string, std::string>> next_level;
+    for (size_t i = 0; i < level.size(); ++i) {
+      absl::StatusOr<ReadFileList> read = reads[i].get();
+      if (!read.ok()) return read.status();
+      const std::string dir = DirectoryOf(level[i].first);
+      for (const FileList::NestedFileList &nested :
+           read->contents.nested_file_lists) {
+        std::string name = Rebase(dir, nested.path);
+        if (!seen.insert(name).second) continue;
+        std::string path = verible::file::JoinPath(base_dir, name);
+        next_level.emplace_back(std::move(name), std::move(path));
+      }
+      result->file_list_files.emplace_back(read->path,
+                                           read->modification_time);
+      file_lists.emplace(level[i].first, *std::move(read));
+    }
+    level = std::move(next_level);
+  }
+
+  FileListExpander(file_lists, &result->file_list).Expand(top_level);
+  FindMissingFiles(base_dir, result.get());
+  return result;
+}
+
+void FileListLoader::FindMissingFiles(std::string_view base_dir,
+                                      LoadedFileList *result) {
+  const std::vector<std::string> &files = result->file_list.file_paths;
+  if (files.empty()) return;
+  // A few chunks per thread even out differences in file system latency.
+  const size_t chunks = std::max(threads_, 1) * 4;
+  const size_t chunk_size = (files.size() + chunks - 1) / chunks;
+  std::vector<char> exists(files.size());
+  std::vector<std::future<bool>> checks;
+  for (size_t begin = 0; begin < files.size(); begin += chunk_size) {
+    const size_t end = std::min(begin + chunk_size, files.size());
+    checks.push_back(pool_.ExecAsync<bool>([&, begin, end] {
+      for (size_t i = begin; i < end; ++i) {
+        exists[i] = verible::file::FileExists(
+                        verible::file::JoinPath(base_dir, files[i]))
+                        .ok();
+      }
+      return true;
+    }));
+  }
+  for (auto &check : checks) check.get();
+  for (size_t i = 0; i < files.size(); ++i) {
+    if (!exists[i]) result->missing_files.push_back(files[i]);
+  }
+}
+
+}  // namespace verilog
@@ -0,0 +1,90 @@
+// Copyright 2017-2022 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_ANALYSIS_VERILOG_FILELIST_LOADER_H_
+#define VERIBLE_VERILOG_ANALYSIS_VERILOG_FILELIST_LOADER_H_
+
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/statusor.h"
+#include "verible/common/util/thread-pool.h"
+#include "verible/verilog/analysis/verilog-filelist.h"
+
+namespace verilog {
+
+// A filelist with all its nested filelists expanded.
+struct LoadedFileList {
+  // Files, include directories and defines of the filelist and its nested
+  // filelists, in order.  Every file and include directory is listed once,
+  // where it is first mentioned; nested_file_lists is empty.
+  // Relative paths are lexically normalized and relative to the directory of
+  // the top-level filelist, also those from nested filelists, which are
+  // written relative to the nested filelist.
+  FileList file_list;
+
+  // The files of file_list.file_paths that don't exist, in the same order.
+  std::vector<std::string> missing_files;
+
+  // The filelists that were read, with their modification times.
+  std::vector<std::pair<std::string, std::filesystem::file_time_type>>
+      file_list_files;
+};
+
+// Loads filelists that may include other filelists with "-f <path>" or
+// "-F <path>" (both relative to the including filelist), and may list files
+// many times over.  Nested filelists and the existence of the files are
+// checked concurrently.
+//
+// Loaded filelists are cached, and reloaded only once any of the filelists
+// that were read has a different modification time.  Changes to the listed
+// files don't invalidate the cache.
+//
+// Load() is thread-safe.
+class FileListLoader {
+ public:
+  // Accesses the file system with 'threads' threads; if zero, uses the
+  // calling thread only.
+  explicit FileListLoader(int threads);
+
+  // Loads the filelist 'file_list_path', or returns the cached result if it
+  // is up to date.  Fails if any filelist can't be read; missing source files
+  // are reported in LoadedFileList::missing_files instead.
+  absl::StatusOr<std::shared_ptr<const LoadedFileList>> Load(
+      std::string_view file_list_path);
+
+ private:
+  absl::StatusOr<std::shared_ptr<const LoadedFileList>> LoadUncached(
+      std::string_view file_list_path);
+
+  // Sets missing_files of 'result'.
+  void FindMissingFiles(std::string_view base_dir, LoadedFileList *result);
+
+  verible::ThreadPool pool_;
+  const int threads_;
+
+  std::mutex cache_mutex_;
+  absl::flat_hash_map<std::string, std::shared_ptr<const LoadedFileList>>
+      cache_;
+};
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_ANALYSIS_VERILOG_FILELIST_LOADER_H_
@@ -0,0 +1,139 @@
+// Copyright 2017-2022 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/analysis/verilog-filelist-loader.h"
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/common/util/file-util.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::verible::file::JoinPath;
+using ::verible::file::testing::ScopedTestFile;
+
+// Creates a fresh directory for a test.
+std::string MakeTestDir(std::string_view name) {
+  const std::string dir = JoinPath(::testing::TempDir(), name);
+  EXPECT_TRUE(verible::file::CreateDir(dir).ok());
+  return dir;
+}
+
+TEST(FileListLoaderTest, ExpandsNestedFileListsInOrder) {
+  const std::string dir = MakeTestDir("filelist_loader_nested");
+  const std::string sub_dir = JoinPath(dir, "sub");
+  ASSERT_TRUE(verible::file::CreateDir(sub_dir).ok());
+  const ScopedTestFile top(dir,
+                           "a.sv\n"
+                           "+incdir+inc\n"
+                           "-f sub/nested.f\n"
+                           "c.sv\n"
+                           "sub/b.sv\n",
+                           "top.f");
+  const ScopedTestFile nested(sub_dir,
+                              "b.sv\n"
+                              "./../a.sv\n"
+                              "+incdir+.\n"
+                              "+define+FOO=1\n"
+                              "-F ../top.f\n",  // already expanded
+                              "nested.f");
+  const ScopedTestFile a(dir, "", "a.sv");
+  const ScopedTestFile b(sub_dir, "", "b.sv");
+
+  for (const int threads : {0, 3}) {
+    FileListLoader loader(threads);
+    const auto loaded = loader.Load(top.filename());
+    ASSERT_TRUE(loaded.ok()) << loaded.status();
+    const FileList &file_list = (*loaded)->file_list;
+    EXPECT_THAT(file_list.file_paths, ElementsAre("a.sv", "sub/b.sv", "c.sv"));
+    EXPECT_THAT(file_list.preprocessing.include_dirs,
+                ElementsAre(".", "inc", "sub"));
+    EXPECT_THAT(file_list.preprocessing.defines,
+                ElementsAre(TextMacroDefinition("FOO", "1")));
+    EXPECT_THAT(file_list.nested_file_lists, IsEmpty());
+    EXPECT_THAT((*loaded)->missing_files, ElementsAre("c.sv"));
+    EXPECT_EQ((*loaded)->file_list_files.size(), 2);
+  }
+}
+
+TEST(FileListLoaderTest, RemovesDuplicates) {
+  const std::string dir = MakeTestDir("filelist_loader_duplicates");
+  std::string content;
+  std::vector<ScopedTestFile> files;
+  for (int i = 0; i < 500; ++i) {
+    const std::string name = absl::StrCat("f", i % 100, ".sv");
+    absl::StrAppend(&content, name, "\n./", name, "\n");
+    if (i < 100 && i % 2 == 0) files.emplace_back(dir, "", name);
+  }
+  const ScopedTestFile top(dir, content, "top.f");
+
+  FileListLoader loader(4);
+  const auto loaded = loader.Load(top.filename());
+  ASSERT_TRUE(loaded.ok()) << loaded.status();
+  const std::vector<std::string> &paths = (*loaded)->file_list.file_paths;
+  ASSERT_EQ(paths.size(), 100);
+  EXPECT_EQ(paths[0], "f0.sv");
+  EXPECT_EQ(paths[99], "f99.sv");
+  ASSERT_EQ((*loaded)->missing_files.size(), 50);
+  EXPECT_EQ((*loaded)->missing_files[0], "f1.sv");
+}
+
+TEST(FileListLoaderTest, MissingNestedFileListIsAnError) {
+  const std::string dir = MakeTestDir("filelist_loader_missing");
+  const ScopedTestFile top(dir, "a.sv\n-f does_not_exist.f\n", "top.f");
+  FileListLoader loader(2);
+  EXPECT_FALSE(loader.Load(top.filename()).ok());
+  EXPECT_FALSE(loader.Load(JoinPath(dir, "no_top.f")).ok());
+}
+
+TEST(FileListLoaderTest, ReloadsWhenAnyFileListChanges) {
+  const std::string dir = MakeTestDir("filelist_loader_reload");
+  const ScopedTestFile top(dir, "a.sv\n-f nested.f\n", "top.f");
+  const std::string nested = JoinPath(dir, "nested.f");
+  ASSERT_TRUE(verible::file::SetContents(nested, "b.sv\n").ok());
+
+  FileListLoader loader(2);
+  const auto first = loader.Load(top.filename());
+  ASSERT_TRUE(first.ok()) << first.status();
+  EXPECT_THAT((*first)->file_list.file_paths, ElementsAre("a.sv", "b.sv"));
+
+  // Unchanged: the same result.
+  const auto second = loader.Load(top.filename());
+  ASSERT_TRUE(second.ok()) << second.status();
+  EXPECT_EQ(first->get(), second->get());
+
+  // Modification times may be coarse, so make the change visible.
+  ASSERT_TRUE(verible::file::SetContents(nested, "c.sv\n").ok());
+  const auto modified = std::filesystem::last_write_time(nested);
+  std::filesystem::last_write_time(nested, modified + std::chrono::seconds(2));
+
+  const auto third = loader.Load(top.filename());
+  ASSERT_TRUE(third.ok()) << third.status();
+  EXPECT_THAT((*third)->file_list.file_paths, ElementsAre("a.sv", "c.sv"));
+  std::filesystem::remove(nested);
+}
+
+}  // namespace
+}  // namespace verilog
@@ -70,6 +70,15 @@ absl::Status AppendFileListFromContent(std::string_view file_list_path,
       continue;
     }
 
+    if (file_path.size() > 3 && file_path[0] == '-' &&
+        (file_path[1] == 'f' || file_path[1] == 'F') &&
+        absl::ascii_isspace(file_path[2])) {
+      // A nested filelist.  Whitespace was reduced to one character above.
+      append_to->nested_file_lists.push_back(
+          {file_path.substr(3), append_to->file_paths.size()});
+      continue;
+    }
+
     if (file_path[0] == '+' || file_path[0] == '-') {
       // Ignore unsupported parameter
       continue;
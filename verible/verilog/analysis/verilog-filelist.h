@@ -15,6 +15,7 @@
 #ifndef VERIBLE_VERILOG_ANALYSIS_VERILOG_FILELIST_H_
 #define VERIBLE_VERILOG_ANALYSIS_VERILOG_FILELIST_H_
 
+#include <cstddef>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -54,12 +55,23 @@ struct FileList {
     std::vector<TextMacroDefinition> defines;
   };
 
+  // A filelist included with "-f <path>" or "-F <path>".
+  struct NestedFileList {
+    std::string path;
+    // Number of file_paths that precede the files of the nested filelist.
+    size_t position;
+  };
+
   // Ordered list of files to compile.
   std::vector<std::string> file_paths;
 
   // Information relevant to the preprocessor.
   PreprocessingInfo preprocessing;
 
+  // Nested filelists, in order.  These are only recorded here; they are
+  // expanded by FileListLoader (see verilog-filelist-loader.h).
+  std::vector<NestedFileList> nested_file_lists;
+
   // Returns the file list in Icarus Verilog format
   // (http://iverilog.wikia.com/wiki/Command_File_Format)
   std::string ToString() const;
@@ -79,7 +91,8 @@ absl::Status AppendFileListFromFile(std::string_view file_list_file,
                                     FileList *append_to);
 
 // Reads in a list of files line-by-line from the given string. The include
-// directories are prefixed by "+incdir+" (TODO: +define+)
+// directories are prefixed by "+incdir+" (TODO: +define+).
+// Nested filelists ("-f <path>", "-F <path>") are recorded, not read.
 absl::Status AppendFileListFromContent(std::string_view file_list_path,
                                        const std::string &file_list_content,
                                        FileList *append_to);
@@ -56,6 +56,26 @@ TEST(FileListTest, AppendFileListFromFile) {
               ElementsAre(TextMacroDefinition("macro1", "a")));
 }
 
+TEST(FileListTest, AppendFileListFromContentRecordsNestedFileLists) {
+  const std::string file_list_content = R"(
+    a.sv
+    -f   nested/one.f
+    b.sv
+    -F two.f
+    -y ignored_library_dir
+  )";
+  FileList result;
+  auto status = AppendFileListFromContent("", file_list_content, &result);
+  ASSERT_TRUE(status.ok()) << status;
+
+  EXPECT_THAT(result.file_paths, ElementsAre("a.sv", "b.sv"));
+  ASSERT_EQ(result.nested_file_lists.size(), 2);
+  EXPECT_EQ(result.nested_file_lists[0].path, "nested/one.f");
+  EXPECT_EQ(result.nested_file_lists[0].position, 1);
+  EXPECT_EQ(result.nested_file_lists[1].path, "two.f");
+  EXPECT_EQ(result.nested_file_lists[1].position, 2);
+}
+
 TEST(FileListTest, AppendFileListFromInvalidCommandline) {
   std::vector<std::vector<std::string_view>> test_cases = {
       {"+define+macro1="},
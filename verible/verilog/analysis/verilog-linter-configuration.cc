@@ -278,6 +278,29 @@ void LinterConfiguration::GetRuleBundle(RuleBundle *rule_bundle) const {
   rule_bundle->rules = configuration_;
 }
 
+// Constructs an instance of "rule" using the "factory"-function, and
+// configures it if a configuration string is available.
+// Returns nullptr if the factory does not produce rules of this kind.
+//
+// T should be a descendant of verible::LintRule.
+template <typename T>
+static absl::StatusOr<std::unique_ptr<T>> CreateConfiguredRule(
+    const analysis::LintRuleId &rule, const RuleSetting &setting,
+    const std::function<std::unique_ptr<T>(const analysis::LintRuleId &)>
+        &factory) {
+  std::unique_ptr<T> rule_ptr = factory(rule);
+  if (rule_ptr == nullptr) return rule_ptr;
+
+  if (!setting.configuration.empty()) {
+    if (absl::Status status = rule_ptr->Configure(setting.configuration);
+        !status.ok()) {
+      std::string error_msg = absl::StrCat(rule, " ", status.message());
+      return absl::InvalidArgumentError(error_msg);
+    }
+  }
+  return rule_ptr;
+}
+
 // Iterates through all rules that are mentioned and enabled
 // in the "config" map. Constructs instances using the
 // "factory"-function, and configures them if a configuration string is
@@ -294,23 +317,49 @@ static absl::StatusOr<std::vector<std::unique_ptr<T>>> CreateRules(
     const RuleSetting &setting = rule_pair.second;
     if (!setting.enabled) continue;
 
-    std::unique_ptr<T> rule_ptr = factory(rule_pair.first);
-    if (rule_ptr == nullptr) continue;
+    auto rule_or = CreateConfiguredRule<T>(rule_pair.first, setting, factory);
+    if (!rule_or.ok()) return rule_or.status();
+    if (*rule_or == nullptr) continue;
 
-    if (!setting.configuration.empty()) {
-      if (absl::Status status = rule_ptr->Configure(setting.configuration);
-          !status.ok()) {
-        std::string error_msg =
-            absl::StrCat(rule_pair.first, " ", status.message());
-        return absl::InvalidArgumentError(error_msg);
-      }
-    }
-
-    rule_instances.push_back(std::move(rule_ptr));
+    rule_instances.push_back(*std::move(rule_or));
   }
   return rule_instances;
 }
 
+template <typename T>
+absl::StatusOr<std::unique_ptr<T>> LinterConfiguration::CreateRule(
+    const analysis::LintRuleId &rule,
+    const std::function<std::unique_ptr<T>(const analysis::LintRuleId &)>
+        &factory) const {
+  const RuleSetting *setting = FindOrNull(configuration_, rule);
+  if (setting == nullptr || !setting->enabled) return nullptr;
+  return CreateConfiguredRule<T>(rule, *setting, factory);
+}
+
+template absl::StatusOr<std::unique_ptr<SyntaxTreeLintRule>>
+LinterConfiguration::CreateRule(
+    const analysis::LintRuleId &,
+    const std::function<
+        std::unique_ptr<SyntaxTreeLintRule>(const analysis::LintRuleId &)> &)
+    const;
+template absl::StatusOr<std::unique_ptr<TokenStreamLintRule>>
+LinterConfiguration::CreateRule(
+    const analysis::LintRuleId &,
+    const std::function<
+        std::unique_ptr<TokenStreamLintRule>(const analysis::LintRuleId &)> &)
+    const;
+template absl::StatusOr<std::unique_ptr<LineLintRule>>
+LinterConfiguration::CreateRule(
+    const analysis::LintRuleId &,
+    const std::function<
+        std::unique_ptr<LineLintRule>(const analysis::LintRuleId &)> &) const;
+template absl::StatusOr<std::unique_ptr<TextStructureLintRule>>
+LinterConfiguration::CreateRule(
+    const analysis::LintRuleId &,
+    const std::function<
+        std::unique_ptr<TextStructureLintRule>(const analysis::LintRuleId &)> &)
+    const;
+
 absl::StatusOr<std::vector<std::unique_ptr<SyntaxTreeLintRule>>>
 LinterConfiguration::CreateSyntaxTreeRules() const {
   return CreateRules<SyntaxTreeLintRule>(configuration_,
@@ -335,10 +384,45 @@ LinterConfiguration::CreateTextStructureRules() const {
       configuration_, analysis::CreateTextStructureLintRule);
 }
 
+analysis::LintAnalysisPhase LinterConfiguration::RequiredAnalysisPhase()
+    const {
+  auto phase = analysis::LintAnalysisPhase::kText;
+  for (const auto &rule_pair : configuration_) {
+    if (!rule_pair.second.enabled) continue;
+    phase =
+        std::max(phase, analysis::GetRequiredAnalysisPhase(rule_pair.first));
+  }
+  return phase;
+}
+
 bool LinterConfiguration::operator==(const LinterConfiguration &config) const {
   return ActiveRuleIds() == config.ActiveRuleIds();
 }
 
+bool LinterConfiguration::HasSameRuleSettings(
+    const LinterConfiguration &config) const {
+  if (external_waivers != config.external_waivers) return false;
+  // Disabled rules and their configuration strings do not matter.
+  auto left = configuration_.begin();
+  auto right = config.configuration_.begin();
+  while (true) {
+    while (left != configuration_.end() && !left->second.enabled) ++left;
+    while (right != config.configuration_.end() && !right->second.enabled) {
+      ++right;
+    }
+    if (left == configuration_.end() || right == config.configuration_.end()) {
+      return left == configuration_.end() &&
+             right == config.configuration_.end();
+    }
+    if (left->first != right->first ||
+        left->second.configuration != right->second.configuration) {
+      return false;
+    }
+    ++left;
+    ++right;
+  }
+}
+
 absl::Status LinterConfiguration::AppendFromFile(
     std::string_view config_filename) {
   // Read local configuration file
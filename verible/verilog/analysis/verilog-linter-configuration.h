@@ -15,6 +15,7 @@
 #ifndef VERIBLE_VERILOG_ANALYSIS_VERILOG_LINTER_CONFIGURATION_H_
 #define VERIBLE_VERILOG_ANALYSIS_VERILOG_LINTER_CONFIGURATION_H_
 
+#include <functional>
 #include <iosfwd>
 #include <map>
 #include <memory>
@@ -239,6 +240,20 @@ class LinterConfiguration {
   absl::StatusOr<std::vector<std::unique_ptr<verible::TextStructureLintRule>>>
   CreateTextStructureRules() const;
 
+  // Creates and configures an instance of the single rule 'rule' using
+  // 'factory', one of the analysis::Create*LintRule functions.
+  // Returns nullptr if the rule is disabled or is not of type T.
+  // T is one of the four verible::*LintRule base classes.
+  template <typename T>
+  absl::StatusOr<std::unique_ptr<T>> CreateRule(
+      const analysis::LintRuleId &rule,
+      const std::function<std::unique_ptr<T>(const analysis::LintRuleId &)>
+          &factory) const;
+
+  // Returns the deepest analysis phase needed by any enabled rule, or kText
+  // if no rules are enabled.
+  analysis::LintAnalysisPhase RequiredAnalysisPhase() const;
+
   // Path to external lint waivers configuration file
   std::string external_waivers;
 
@@ -247,6 +262,12 @@ class LinterConfiguration {
 
   bool operator!=(const LinterConfiguration &r) const { return !(*this == r); }
 
+  // Returns true if both configurations enable the same rules with the same
+  // configuration strings, and use the same waiver file, i.e. if rule
+  // instances created from one are interchangeable with the other's.
+  // This is stricter than operator==, which only compares the rule names.
+  bool HasSameRuleSettings(const LinterConfiguration &) const;
+
   // Appends linter rules configuration from a file
   absl::Status AppendFromFile(std::string_view filename);
 
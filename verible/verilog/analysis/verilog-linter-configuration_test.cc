@@ -45,6 +45,7 @@
 namespace verilog {
 namespace {
 
+using analysis::LintAnalysisPhase;
 using analysis::LintRuleDescriptor;
 using verible::LineLintRule;
 using verible::SyntaxTreeLintRule;
@@ -330,6 +331,22 @@ TEST(VerilogTextStructureLinterConfigurationTest, AddsExpectedNumber) {
   EXPECT_THAT(status, SizeIs(1));
 }
 
+// Verifies that the required analysis phase follows the enabled rules.
+TEST(LinterConfigurationTest, RequiredAnalysisPhase) {
+  LinterConfiguration config;
+  EXPECT_EQ(config.RequiredAnalysisPhase(), LintAnalysisPhase::kText);
+  config.TurnOn("test-rule-4");  // line rule
+  EXPECT_EQ(config.RequiredAnalysisPhase(), LintAnalysisPhase::kText);
+  config.TurnOn("test-rule-3");  // token stream rule
+  EXPECT_EQ(config.RequiredAnalysisPhase(), LintAnalysisPhase::kTokens);
+  config.TurnOn("test-rule-5");  // text structure rule, default phase
+  EXPECT_EQ(config.RequiredAnalysisPhase(), LintAnalysisPhase::kSyntaxTree);
+  config.TurnOff("test-rule-5");
+  EXPECT_EQ(config.RequiredAnalysisPhase(), LintAnalysisPhase::kTokens);
+  config.TurnOn("test-rule-1");  // syntax tree rule
+  EXPECT_EQ(config.RequiredAnalysisPhase(), LintAnalysisPhase::kSyntaxTree);
+}
+
 // Verifies that turning on-off rules works.
 TEST(VerilogSyntaxTreeLinterConfigurationTest, TurnOnTurnOff) {
   LinterConfiguration config;
@@ -374,6 +391,50 @@ TEST(LinterConfigurationTest, ComparisonSameDifferentElement) {
   EXPECT_EQ(config1, config2);
 }
 
+TEST(LinterConfigurationTest, HasSameRuleSettings) {
+  LinterConfiguration config1, config2;
+  EXPECT_TRUE(config1.HasSameRuleSettings(config2));
+  config1.TurnOn("rule-x");
+  EXPECT_FALSE(config1.HasSameRuleSettings(config2));
+  config2.TurnOn("rule-x");
+  EXPECT_TRUE(config1.HasSameRuleSettings(config2));
+  // Disabled rules do not matter.
+  config2.TurnOff("rule-y");
+  EXPECT_TRUE(config1.HasSameRuleSettings(config2));
+  EXPECT_TRUE(config2.HasSameRuleSettings(config1));
+
+  RuleBundle bundle;
+  bundle.rules["rule-x"] = {true, "style=foo"};
+  config2.UseRuleBundle(bundle);
+  EXPECT_EQ(config1, config2);
+  EXPECT_FALSE(config1.HasSameRuleSettings(config2));
+  config1.UseRuleBundle(bundle);
+  EXPECT_TRUE(config1.HasSameRuleSettings(config2));
+
+  config1.external_waivers = "waivers.vbl";
+  EXPECT_FALSE(config1.HasSameRuleSettings(config2));
+}
+
+// Confirms that a reset linter yields the same results as a fresh one.
+TEST(VerilogLinterTest, ResetKeepsRules) {
+  LinterConfiguration config;
+  config.TurnOn("test-rule-1");
+  config.TurnOn("test-rule-3");
+  config.TurnOn("test-rule-4");
+  config.TurnOn("test-rule-5");
+
+  VerilogLinter linter;
+  EXPECT_TRUE(linter.Configure(config, filename).ok());
+  EXPECT_TRUE(linter.Configuration().HasSameRuleSettings(config));
+  for (int i = 0; i < 2; ++i) {
+    FakeTextStructureView text_structure;
+    linter.Lint(text_structure, filename);
+    auto status = linter.ReportStatus(dummy_map, text_structure.Contents());
+    EXPECT_THAT(status, SizeIs(4));
+    EXPECT_TRUE(linter.Reset(filename).ok());
+  }
+}
+
 TEST(LinterConfigurationTest, StreamOperator) {
   LinterConfiguration config;
   {
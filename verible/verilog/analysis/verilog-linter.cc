@@ -15,6 +15,7 @@
 #include "verible/verilog/analysis/verilog-linter.h"
 
 #include <cstddef>
+#include <functional>
 #include <iomanip>
 #include <ios>
 #include <map>
@@ -33,6 +34,8 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "verible/common/analysis/citation.h"
 #include "verible/common/analysis/line-linter.h"
 #include "verible/common/analysis/lint-rule-status.h"
@@ -117,21 +120,47 @@ int LintOneFile(std::ostream *stream, std::string_view filename,
     return 2;
   }
 
-  // Lex and parse the contents of the file.
-  // Attempt first to run without preprocessing to capture more information,
-  // but if that results in parse issues, filter out preprocessing branches
-  // as that is often the reason.
-  // TODO(hzeller): this behavior could be configurable, but then again this
-  //   is something the user is expecting to work as best as possible (which
-  //   is also why we use automatic mode).
-  const auto analyzer = VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
-      *content_or, filename);
+  // Only parse if syntax errors are to be reported, or if an enabled rule
+  // looks at the syntax tree.  Otherwise lexing suffices: lint waivers and
+  // the remaining rules only need the token stream and lines.
+  const bool needs_syntax_tree =
+      check_syntax || config.RequiredAnalysisPhase() ==
+                          analysis::LintAnalysisPhase::kSyntaxTree;
+  std::unique_ptr<VerilogAnalyzer> analyzer;
+  if (needs_syntax_tree) {
+    // Lex and parse the contents of the file.
+    // Attempt first to run without preprocessing to capture more information,
+    // but if that results in parse issues, filter out preprocessing branches
+    // as that is often the reason.
+    // TODO(hzeller): this behavior could be configurable, but then again this
+    //   is something the user is expecting to work as best as possible (which
+    //   is also why we use automatic mode).
+    analyzer = VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(*content_or,
+                                                                   filename);
+  } else {
+    VLOG(1) << "No enabled rule needs a syntax tree, only lexing.";
+    analyzer = std::make_unique<VerilogAnalyzer>(*content_or, filename);
+    // Lexical errors are not reported without check_syntax; rules operate on
+    // whatever tokens were produced.
+    (void)analyzer->Tokenize();
+  }
+  return LintAnalyzedFile(stream, filename, *ABSL_DIE_IF_NULL(analyzer),
+                          config, violation_handler, check_syntax, parse_fatal,
+                          lint_fatal, show_context);
+}
+
+int LintAnalyzedFile(std::ostream *stream, std::string_view filename,
+                     const VerilogAnalyzer &analyzer,
+                     const LinterConfiguration &config,
+                     verible::ViolationHandler *violation_handler,
+                     bool check_syntax, bool parse_fatal, bool lint_fatal,
+                     bool show_context) {
   if (check_syntax) {
-    const auto lex_status = ABSL_DIE_IF_NULL(analyzer)->LexStatus();
-    const auto parse_status = analyzer->ParseStatus();
+    const auto lex_status = analyzer.LexStatus();
+    const auto parse_status = analyzer.ParseStatus();
     if (!lex_status.ok() || !parse_status.ok()) {
       const std::vector<std::string> syntax_error_messages(
-          analyzer->LinterTokenErrorMessages(show_context));
+          analyzer.LinterTokenErrorMessages(show_context));
       for (const auto &message : syntax_error_messages) {
         *stream << message << std::endl;
       }
@@ -144,7 +173,7 @@ int LintOneFile(std::ostream *stream, std::string_view filename,
   }
 
   // Analyze the parsed structure for lint violations.
-  const auto &text_structure = analyzer->Data();
+  const auto &text_structure = analyzer.Data();
   const auto linter_result =
       VerilogLintTextStructure(filename, config, text_structure);
   if (!linter_result.ok()) {
@@ -178,16 +207,51 @@ int LintOneFile(std::ostream *stream, std::string_view filename,
   return 0;
 }
 
-VerilogLinter::VerilogLinter()
-    : lint_waiver_(
-          [](const TokenInfo &t) {
-            return IsComment(verilog_tokentype(t.token_enum()));
-          },
-          [](const TokenInfo &t) {
-            return IsWhitespace(verilog_tokentype(t.token_enum()));
-          },
-          kLinterTrigger, kLinterWaiveLineCommand, kLinterWaiveStartCommand,
-          kLinterWaiveStopCommand) {}
+static verible::LintWaiverBuilder MakeVerilogLintWaiverBuilder() {
+  return verible::LintWaiverBuilder(
+      [](const TokenInfo &t) {
+        return IsComment(verilog_tokentype(t.token_enum()));
+      },
+      [](const TokenInfo &t) {
+        return IsWhitespace(verilog_tokentype(t.token_enum()));
+      },
+      kLinterTrigger, kLinterWaiveLineCommand, kLinterWaiveStartCommand,
+      kLinterWaiveStopCommand);
+}
+
+VerilogLinter::VerilogLinter() : lint_waiver_(MakeVerilogLintWaiverBuilder()) {}
+
+// Creates the rule 'rule_id' if it is of type T, and adds it to 'linter',
+// recording its id in 'rule_ids'.
+template <typename T, typename Linter>
+static absl::Status AddConfiguredRule(
+    const LinterConfiguration &configuration,
+    const analysis::LintRuleId &rule_id,
+    const std::function<std::unique_ptr<T>(const analysis::LintRuleId &)>
+        &factory,
+    Linter *linter, std::vector<analysis::LintRuleId> *rule_ids) {
+  auto rule = configuration.CreateRule<T>(rule_id, factory);
+  if (!rule.ok()) return rule.status();
+  if (*rule != nullptr) {
+    linter->AddRule(*std::move(rule));
+    rule_ids->push_back(rule_id);
+  }
+  return absl::OkStatus();
+}
+
+// Re-creates the rule 'rule_id' for a rule that cannot be Reset().
+// The configuration was already accepted once, so this cannot fail.
+template <typename T>
+static std::unique_ptr<T> RecreateRule(
+    const LinterConfiguration &configuration,
+    const analysis::LintRuleId &rule_id,
+    const std::function<std::unique_ptr<T>(const analysis::LintRuleId &)>
+        &factory) {
+  auto rule = configuration.CreateRule<T>(rule_id, factory);
+  CHECK(rule.ok()) << rule.status();
+  CHECK(*rule != nullptr) << rule_id;
+  return *std::move(rule);
+}
 
 absl::Status VerilogLinter::Configure(const LinterConfiguration &configuration,
                                       std::string_view lintee_filename) {
@@ -196,34 +260,61 @@ absl::Status VerilogLinter::Configure(const LinterConfiguration &configuration,
       LOG(INFO) << "active rule: '" << name << '\'';
     }
   }
-  auto text_rules = configuration.CreateTextStructureRules();
-  if (!text_rules.ok()) return text_rules.status();
-  for (auto &rule : *text_rules) {
-    text_structure_linter_.AddRule(std::move(rule));
-  }
-  auto line_rules = configuration.CreateLineRules();
-  if (!line_rules.ok()) return line_rules.status();
-  for (auto &rule : *line_rules) {
-    line_linter_.AddRule(std::move(rule));
-  }
-  auto token_rules = configuration.CreateTokenStreamRules();
-  if (!token_rules.ok()) return token_rules.status();
-  for (auto &rule : *token_rules) {
-    token_stream_linter_.AddRule(std::move(rule));
-  }
-  auto syntax_rules = configuration.CreateSyntaxTreeRules();
-  if (!syntax_rules.ok()) return syntax_rules.status();
-  for (auto &rule : *syntax_rules) {
-    syntax_tree_linter_.AddRule(std::move(rule));
+  configuration_ = configuration;
+  // Rules are added to each linter in the same (sorted) order as the
+  // Create*Rules() functions of the configuration would produce them.
+  for (const auto &rule_id : configuration.ActiveRuleIds()) {
+    RETURN_IF_ERROR(AddConfiguredRule<verible::TextStructureLintRule>(
+        configuration, rule_id, analysis::CreateTextStructureLintRule,
+        &text_structure_linter_, &text_structure_rule_ids_));
+    RETURN_IF_ERROR(AddConfiguredRule<verible::LineLintRule>(
+        configuration, rule_id, analysis::CreateLineLintRule, &line_linter_,
+        &line_rule_ids_));
+    RETURN_IF_ERROR(AddConfiguredRule<verible::TokenStreamLintRule>(
+        configuration, rule_id, analysis::CreateTokenStreamLintRule,
+        &token_stream_linter_, &token_stream_rule_ids_));
+    RETURN_IF_ERROR(AddConfiguredRule<verible::SyntaxTreeLintRule>(
+        configuration, rule_id, analysis::CreateSyntaxTreeLintRule,
+        &syntax_tree_linter_, &syntax_tree_rule_ids_));
   }
 
+  return ApplyExternalWaivers(lintee_filename);
+}
+
+absl::Status VerilogLinter::Reset(std::string_view lintee_filename) {
+  line_linter_.ResetRules([this](size_t i) {
+    return RecreateRule<verible::LineLintRule>(
+        configuration_, line_rule_ids_[i], analysis::CreateLineLintRule);
+  });
+  token_stream_linter_.ResetRules([this](size_t i) {
+    return RecreateRule<verible::TokenStreamLintRule>(
+        configuration_, token_stream_rule_ids_[i],
+        analysis::CreateTokenStreamLintRule);
+  });
+  syntax_tree_linter_.ResetRules([this](size_t i) {
+    return RecreateRule<verible::SyntaxTreeLintRule>(
+        configuration_, syntax_tree_rule_ids_[i],
+        analysis::CreateSyntaxTreeLintRule);
+  });
+  text_structure_linter_.ResetRules([this](size_t i) {
+    return RecreateRule<verible::TextStructureLintRule>(
+        configuration_, text_structure_rule_ids_[i],
+        analysis::CreateTextStructureLintRule);
+  });
+
+  lint_waiver_ = MakeVerilogLintWaiverBuilder();
+  return ApplyExternalWaivers(lintee_filename);
+}
+
+absl::Status VerilogLinter::ApplyExternalWaivers(
+    std::string_view lintee_filename) {
   absl::Status rc = absl::OkStatus();
-  for (const auto &waiver_file :
-       absl::StrSplit(configuration.external_waivers, ',', absl::SkipEmpty())) {
+  for (const auto &waiver_file : absl::StrSplit(
+           configuration_.external_waivers, ',', absl::SkipEmpty())) {
     auto content_or = verible::file::GetContentAsString(waiver_file);
     if (!content_or.ok()) continue;  // Couldn't read lint file: ignore
     auto status = lint_waiver_.ApplyExternalWaivers(
-        configuration.ActiveRuleIds(), lintee_filename, waiver_file,
+        configuration_.ActiveRuleIds(), lintee_filename, waiver_file,
         *content_or);
     if (!status.ok()) {
       rc.Update(status);
@@ -235,23 +326,38 @@ absl::Status VerilogLinter::Configure(const LinterConfiguration &configuration,
 
 void VerilogLinter::Lint(const TextStructureView &text_structure,
                          std::string_view filename) {
+  times_ = {};
+  absl::Time start = absl::Now();
+  // Returns the time since the last call, or since the start.
+  const auto lap = [&start]() {
+    const absl::Time now = absl::Now();
+    const absl::Duration elapsed = now - start;
+    start = now;
+    return elapsed;
+  };
+
   // Collect all lint waivers in an initial pass.
   lint_waiver_.ProcessTokenRangesByLine(text_structure);
+  times_.waivers = lap();
 
   // Analyze general text structure.
   text_structure_linter_.Lint(text_structure, filename);
+  times_.text_structure = lap();
 
   // Analyze lines of text.
   line_linter_.Lint(text_structure.Lines());
+  times_.line = lap();
 
   // Analyze token stream.
   token_stream_linter_.Lint(text_structure.TokenStream());
+  times_.token_stream = lap();
 
   // Analyze syntax tree.
   const verible::ConcreteSyntaxTree &syntax_tree = text_structure.SyntaxTree();
   if (syntax_tree != nullptr) {
     syntax_tree_linter_.Lint(*syntax_tree);
   }
+  times_.syntax_tree = lap();
 }
 
 static void AppendLintRuleStatuses(
@@ -316,14 +422,25 @@ absl::StatusOr<LinterConfiguration> LinterConfigurationFromFlags(
 
 absl::StatusOr<std::vector<LintRuleStatus>> VerilogLintTextStructure(
     std::string_view filename, const LinterConfiguration &config,
-    const TextStructureView &text_structure) {
-  // Create the linter, add rules, and run it.
-  VerilogLinter linter;
-  if (absl::Status status = linter.Configure(config, filename); !status.ok()) {
-    return status;
+    const TextStructureView &text_structure, LinterTimes *times) {
+  // Creating and configuring the rules (e.g. compiling regular expressions)
+  // can cost more than linting a small file, so reuse the linter of the
+  // previous call on this thread if its rule settings are the same.
+  thread_local std::unique_ptr<VerilogLinter> cached_linter;
+  if (cached_linter != nullptr &&
+      cached_linter->Configuration().HasSameRuleSettings(config)) {
+    RETURN_IF_ERROR(cached_linter->Reset(filename));
+  } else {
+    // Create the linter and add rules.
+    auto linter = std::make_unique<VerilogLinter>();
+    cached_linter.reset();
+    RETURN_IF_ERROR(linter->Configure(config, filename));
+    cached_linter = std::move(linter);
   }
+  VerilogLinter &linter = *cached_linter;
 
   linter.Lint(text_structure, filename);
+  if (times != nullptr) *times = linter.Timing();
 
   std::string_view text_base = text_structure.Contents();
   // Each enabled lint rule yields a collection of violations.
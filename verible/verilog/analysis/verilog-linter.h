@@ -23,6 +23,7 @@
 #include "absl/flags/declare.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/time/time.h"
 #include "verible/common/analysis/line-linter.h"
 #include "verible/common/analysis/lint-rule-status.h"
 #include "verible/common/analysis/lint-waiver.h"
@@ -33,6 +34,7 @@
 #include "verible/common/strings/line-column-map.h"
 #include "verible/common/text/text-structure.h"
 #include "verible/verilog/analysis/lint-rule-registry.h"
+#include "verible/verilog/analysis/verilog-analyzer.h"
 #include "verible/verilog/analysis/verilog-linter-configuration.h"
 
 // Flag is declared for testing purposes (used e.g. in
@@ -68,6 +70,27 @@ int LintOneFile(std::ostream *stream, std::string_view filename,
                 verible::ViolationHandler *violation_handler, bool check_syntax,
                 bool parse_fatal, bool lint_fatal, bool show_context = false);
 
+// Like LintOneFile(), but for a file that "analyzer" already lexed and
+// parsed, e.g. by a tool that keeps parsed files around.
+int LintAnalyzedFile(std::ostream *stream, std::string_view filename,
+                     const VerilogAnalyzer &analyzer,
+                     const LinterConfiguration &config,
+                     verible::ViolationHandler *violation_handler,
+                     bool check_syntax, bool parse_fatal, bool lint_fatal,
+                     bool show_context = false);
+
+// Time that the last VerilogLinter::Lint() spent in each kind of linter,
+// i.e. in all the rules of that kind together.  Like
+// VerilogAnalyzer::PhaseTimes, it takes one clock read per kind, and is
+// always measured.
+struct LinterTimes {
+  absl::Duration waivers;
+  absl::Duration text_structure;
+  absl::Duration line;
+  absl::Duration token_stream;
+  absl::Duration syntax_tree;
+};
+
 // VerilogLinter analyzes a TextStructureView of Verilog source code.
 // This uses syntax-tree based analyses and lexical token-stream analyses.
 class VerilogLinter {
@@ -78,6 +101,15 @@ class VerilogLinter {
   absl::Status Configure(const LinterConfiguration &configuration,
                          std::string_view lintee_filename);
 
+  // Prepares a configured linter for linting another file, keeping the
+  // configured rules where possible.  Rules that cannot be Reset() are
+  // re-created from the configuration.  Waivers are re-read for
+  // 'lintee_filename'.
+  absl::Status Reset(std::string_view lintee_filename);
+
+  // Returns the configuration that was passed to Configure().
+  const LinterConfiguration &Configuration() const { return configuration_; }
+
   // Analyzes text structure.
   void Lint(const verible::TextStructureView &text_structure,
             std::string_view filename);
@@ -86,7 +118,12 @@ class VerilogLinter {
   std::vector<verible::LintRuleStatus> ReportStatus(
       const verible::LineColumnMap &, std::string_view text_base);
 
+  const LinterTimes &Timing() const { return times_; }
+
  private:
+  // Applies the configured external waiver files to 'lintee_filename'.
+  absl::Status ApplyExternalWaivers(std::string_view lintee_filename);
+
   // Line based linter.
   verible::LineLinter line_linter_;
 
@@ -101,6 +138,17 @@ class VerilogLinter {
 
   // Tracks the set of waived lines per rule.
   verible::LintWaiverBuilder lint_waiver_;
+
+  // Configuration that the rules were created from.
+  LinterConfiguration configuration_;
+
+  // Ids of the rules in each of the linters, in the same order.
+  std::vector<analysis::LintRuleId> line_rule_ids_;
+  std::vector<analysis::LintRuleId> token_stream_rule_ids_;
+  std::vector<analysis::LintRuleId> syntax_tree_rule_ids_;
+  std::vector<analysis::LintRuleId> text_structure_rule_ids_;
+
+  LinterTimes times_;
 };
 
 // Creates a linter configuration from global flags.
@@ -126,12 +174,14 @@ absl::Status AppendLinterConfigurationFromFile(
 //   filename: (optional) name of input file, that can appear in logs.
 //   text_structure: contains the syntax tree that will be lint-analyzed.
 //   show_context: print additional line with vulnerable code
+//   times: (optional) receives the time spent in each kind of linter.
 //
 // Returns:
 //   Vector of LintRuleStatuses on success, otherwise error code.
 absl::StatusOr<std::vector<verible::LintRuleStatus>> VerilogLintTextStructure(
     std::string_view filename, const LinterConfiguration &config,
-    const verible::TextStructureView &text_structure);
+    const verible::TextStructureView &text_structure,
+    LinterTimes *times = nullptr);
 
 // Prints the rule, description and default_enabled.
 absl::Status PrintRuleInfo(std::ostream *,
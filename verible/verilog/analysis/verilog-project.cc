@@ -96,6 +96,19 @@ const verible::TextStructureView *VerilogSourceFile::GetTextStructure() const {
   return &analyzed_structure_->Data();
 }
 
+const VerilogPreprocessData *VerilogSourceFile::GetPreprocessorData() const {
+  if (analyzed_structure_ == nullptr) return nullptr;
+  return &analyzed_structure_->PreprocessorData();
+}
+
+void VerilogSourceFile::ReleaseParsedStructure() {
+  if (analyzed_structure_ == nullptr) return;
+  analyzed_structure_.reset();
+  // The content was loaded successfully before it was parsed.
+  processing_state_ = ProcessingState::kOpened;
+  status_ = absl::OkStatus();
+}
+
 std::vector<std::string> VerilogSourceFile::ErrorMessages() const {
   std::vector<std::string> result;
   if (!analyzed_structure_) return result;
@@ -82,6 +82,19 @@ class VerilogSourceFile {
   // Before successful Parse(), this is not initialized and returns nullptr.
   virtual const verible::TextStructureView *GetTextStructure() const;
 
+  // After Parse(), the results of preprocessing, like the macro definitions.
+  // Before successful Parse(), this is not initialized and returns nullptr.
+  virtual const VerilogPreprocessData *GetPreprocessorData() const;
+
+  // Returns true if this file owns the token streams and syntax tree that
+  // Parse() created, which can then be released.
+  bool OwnsParsedStructure() const { return analyzed_structure_ != nullptr; }
+
+  // Frees the token streams and syntax tree, but keeps the content, that
+  // other structures like the symbol table refer to.  The next Parse()
+  // analyzes the content again.
+  void ReleaseParsedStructure();
+
   // Returns the first non-Ok status if there is one, else OkStatus().
   absl::Status Status() const { return status_; }
 
@@ -224,6 +237,11 @@ class ParsedVerilogSourceFile final : public VerilogSourceFile {
     return &not_owned_analyzer_->Data();
   }
 
+  // Return preprocessing results of the analyzer provided in constructor.
+  const VerilogPreprocessData *GetPreprocessorData() const final {
+    return &not_owned_analyzer_->PreprocessorData();
+  }
+
   // Return string-view content range of text structure.
   std::string_view GetContent() const final {
     return not_owned_analyzer_->Data().Contents();
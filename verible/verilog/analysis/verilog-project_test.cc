@@ -209,6 +209,45 @@ TEST(InMemoryVerilogSourceFileTest, ParseInvalidFile) {
   EXPECT_EQ(&text_structure->SyntaxTree(), tree);
 }
 
+TEST(InMemoryVerilogSourceFileTest, ReleaseParsedStructure) {
+  constexpr std::string_view text("class \"dismissed\"!\n");
+  InMemoryVerilogSourceFile file("/not/using/file/system.v", text);
+  EXPECT_FALSE(file.OwnsParsedStructure());
+  EXPECT_FALSE(file.Parse().ok());
+  EXPECT_TRUE(file.OwnsParsedStructure());
+  const std::string_view content = file.GetContent();
+
+  file.ReleaseParsedStructure();
+  EXPECT_FALSE(file.OwnsParsedStructure());
+  EXPECT_FALSE(file.is_parsed());
+  EXPECT_EQ(file.GetTextStructure(), nullptr);
+  EXPECT_TRUE(file.Status().ok());
+  // The content stays where it was.
+  EXPECT_EQ(file.GetContent().data(), content.data());
+  EXPECT_EQ(file.GetContent(), text);
+
+  // Parsing again gives the same result.
+  EXPECT_FALSE(file.Parse().ok());
+  const TextStructureView *text_structure =
+      ABSL_DIE_IF_NULL(file.GetTextStructure());
+  EXPECT_EQ(text_structure->Contents().data(), content.data());
+}
+
+TEST(InMemoryVerilogSourceFileTest, PreprocessorData) {
+  constexpr std::string_view text("`define WIDTH 8\nwire [`WIDTH-1:0] w;\n");
+  InMemoryVerilogSourceFile file("/not/using/file/system.v", text);
+  EXPECT_EQ(file.GetPreprocessorData(), nullptr);
+  EXPECT_TRUE(file.Parse().ok());
+  const VerilogPreprocessData *preprocessed =
+      ABSL_DIE_IF_NULL(file.GetPreprocessorData());
+  EXPECT_EQ(preprocessed->macro_definitions.size(), 1);
+  EXPECT_TRUE(preprocessed->macro_definitions.find("WIDTH") !=
+              preprocessed->macro_definitions.end());
+
+  file.ReleaseParsedStructure();
+  EXPECT_EQ(file.GetPreprocessorData(), nullptr);
+}
+
 TEST(ParsedVerilogSourceFileTest, PreparsedValidFile) {
   constexpr std::string_view text("localparam int p = 1;\n");
   std::unique_ptr<VerilogAnalyzer> analyzed_structure =
@@ -223,6 +262,8 @@ TEST(ParsedVerilogSourceFileTest, PreparsedValidFile) {
   const TextStructureView *text_structure =
       ABSL_DIE_IF_NULL(file.GetTextStructure());
   EXPECT_EQ(&analyzed_structure->Data(), text_structure);
+  EXPECT_EQ(file.GetPreprocessorData(),
+            &analyzed_structure->PreprocessorData());
   const std::string_view owned_string_range(text_structure->Contents());
   EXPECT_EQ(owned_string_range, text);
   const auto *tokens = &text_structure->TokenStream();
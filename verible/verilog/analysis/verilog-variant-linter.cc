@@ -0,0 +1,418 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/analysis/verilog-variant-linter.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "verible/common/analysis/lint-rule-status.h"
+#include "verible/common/text/token-info.h"
+#include "verible/common/text/token-stream-view.h"
+#include "verible/common/util/logging.h"
+#include "verible/common/util/thread-pool.h"
+#include "verible/verilog/analysis/flow-tree.h"
+#include "verible/verilog/analysis/verilog-analyzer.h"
+#include "verible/verilog/analysis/verilog-linter-configuration.h"
+#include "verible/verilog/analysis/verilog-linter.h"
+#include "verible/verilog/parser/verilog-lexer.h"
+#include "verible/verilog/parser/verilog-token-enum.h"
+
+namespace verilog {
+
+using verible::AutoFix;
+using verible::LintRuleStatus;
+using verible::LintViolation;
+using verible::ReplacementEdit;
+using verible::TokenInfo;
+
+// Turns text[begin, end) into a block comment of the same length and line
+// structure.  The comment is filled with '*' so that line-based rules do not
+// find anything in it, except for the characters for which keep(i) is true.
+static void CommentOut(std::string *text, size_t begin, size_t end,
+                       const std::function<bool(size_t)> &keep) {
+  std::string &s = *text;
+  const auto is_newline = [&s](size_t i) {
+    return s[i] == '\n' || s[i] == '\r';
+  };
+  for (size_t i = begin; i < end; ++i) {
+    if (!is_newline(i) && !keep(i)) s[i] = '*';
+  }
+  // After a '/', the opener would start a line comment instead.
+  size_t open = begin;
+  if (begin > 0 && s[begin - 1] == '/') s[open++] = ' ';
+  // The closer needs two characters on one line.  What is left of the last
+  // line, at most a one-character macro name, is blanked out.
+  size_t close = end;
+  while (close - open > 4 && (is_newline(close - 1) || is_newline(close - 2))) {
+    if (!is_newline(close - 1)) s[close - 1] = ' ';
+    --close;
+  }
+  // Every masked range starts with a conditional directive, which is long
+  // enough for both.
+  CHECK_GE(close - open, 4);
+  CHECK(!is_newline(close - 1) && !is_newline(close - 2));
+  s[open] = '/';
+  s[open + 1] = '*';
+  s[close - 2] = '*';
+  s[close - 1] = '/';
+}
+
+std::string MaskInactiveBranches(
+    std::string_view text, const verible::TokenSequence &tokens,
+    const std::function<bool(std::string_view macro)> &is_defined) {
+  std::string result(text);
+
+  // State of an open `ifdef/`ifndef block.
+  struct Conditional {
+    // True if the code around the block is active.
+    bool enclosing_active;
+    // True if one of the branches of the block was taken.
+    bool taken;
+  };
+  std::vector<Conditional> conditionals;
+  bool active = true;
+
+  // Consecutive masked tokens are commented out as one range, which then
+  // also covers the whitespace and comments between them.
+  static constexpr size_t kNoRange = std::string_view::npos;
+  size_t range_begin = kNoRange;
+  size_t range_end = 0;
+  const auto mask = [&](const TokenInfo &token) {
+    if (range_begin == kNoRange) range_begin = token.left(text);
+    range_end = token.right(text);
+  };
+  // Spans of the lines of directives in active code, before and after the
+  // directive.  Their whitespace is in every configuration, so it stays for
+  // rules like no-tabs and no-trailing-spaces, even inside a masked range.
+  std::vector<std::pair<size_t, size_t>> kept_spans;
+  const auto keep = [&](size_t i) {
+    if (text[i] != ' ' && text[i] != '\t') return false;
+    auto span = std::upper_bound(
+        kept_spans.begin(), kept_spans.end(), i,
+        [](size_t offset, const std::pair<size_t, size_t> &span) {
+          return offset < span.first;
+        });
+    return span != kept_spans.begin() && i < (--span)->second;
+  };
+  const auto flush = [&]() {
+    if (range_begin == kNoRange) return;
+    CommentOut(&result, range_begin, range_end, keep);
+    range_begin = kNoRange;
+  };
+
+  for (auto iter = tokens.begin(); iter != tokens.end(); ++iter) {
+    const int token_enum = iter->token_enum();
+    const bool has_macro =
+        (token_enum == PP_ifdef || token_enum == PP_ifndef ||
+         token_enum == PP_elsif) &&
+        iter + 1 != tokens.end() && (iter + 1)->token_enum() == PP_Identifier;
+    const auto condition = [&]() {
+      return has_macro && is_defined((iter + 1)->text());
+    };
+    switch (token_enum) {
+      case PP_ifdef:
+        conditionals.push_back({active, condition()});
+        active = active && conditionals.back().taken;
+        break;
+      case PP_ifndef:
+        conditionals.push_back({active, has_macro && !condition()});
+        active = active && conditionals.back().taken;
+        break;
+      case PP_elsif:
+        if (!conditionals.empty()) {
+          Conditional &block = conditionals.back();
+          const bool branch = !block.taken && condition();
+          active = block.enclosing_active && branch;
+          block.taken |= branch;
+        }
+        break;
+      case PP_else:
+        if (!conditionals.empty()) {
+          Conditional &block = conditionals.back();
+          active = block.enclosing_active && !block.taken;
+          block.taken = true;
+        }
+        break;
+      case PP_endif:
+        if (!conditionals.empty()) {
+          active = conditionals.back().enclosing_active;
+          conditionals.pop_back();
+        }
+        break;
+      default:
+        if (active) {
+          flush();
+        } else {
+          mask(*iter);
+        }
+        continue;
+    }
+    // Conditional directives are always masked.
+    const size_t directive_left = iter->left(text);
+    mask(*iter);
+    if (has_macro) mask(*++iter);
+    const bool enclosing_active = token_enum == PP_endif || conditionals.empty()
+                                      ? active
+                                      : conditionals.back().enclosing_active;
+    // A directive later on the same line is covered already.
+    if (enclosing_active && (kept_spans.empty() ||
+                             kept_spans.back().second <= directive_left)) {
+      const size_t line_begin = text.rfind('\n', directive_left) + 1;
+      size_t line_end = text.find_first_of("\r\n", iter->right(text));
+      if (line_end == std::string_view::npos) line_end = text.size();
+      kept_spans.emplace_back(line_begin, directive_left);
+      kept_spans.emplace_back(iter->right(text), line_end);
+    }
+  }
+  flush();
+  return result;
+}
+
+// Returns a copy of 'violation' with all text references moved from 'from'
+// to the same offsets in 'to'.  The syntax tree context is dropped, as it
+// refers to the syntax tree of 'from'.
+static LintViolation RebaseViolation(const LintViolation &violation,
+                                     std::string_view from,
+                                     std::string_view to,
+                                     std::string_view reason) {
+  const auto rebase = [from, to](std::string_view text) {
+    if (text.data() < from.data() ||
+        text.data() + text.size() > from.data() + from.size()) {
+      return text;
+    }
+    return to.substr(text.data() - from.data(), text.size());
+  };
+  const auto rebase_token = [&rebase](const TokenInfo &token) {
+    return TokenInfo(token.token_enum(), rebase(token.text()));
+  };
+
+  std::vector<AutoFix> autofixes;
+  for (const auto &autofix : violation.autofixes) {
+    std::set<ReplacementEdit> edits;
+    for (const auto &edit : autofix.Edits()) {
+      edits.emplace(rebase(edit.fragment), edit.replacement);
+    }
+    autofixes.emplace_back(autofix.Description(),
+                           std::initializer_list<ReplacementEdit>{});
+    autofixes.back().AddEdits(edits);
+  }
+  std::vector<TokenInfo> related_tokens;
+  for (const auto &token : violation.related_tokens) {
+    related_tokens.push_back(rebase_token(token));
+  }
+  return LintViolation(rebase_token(violation.token), reason, autofixes,
+                       related_tokens);
+}
+
+// Lint findings of one configuration text.
+struct ConfigurationLintResult {
+  // Syntax error messages, if the text failed to parse.
+  std::vector<std::string> syntax_errors;
+  // Lint findings, located in the original text.
+  std::vector<LintRuleStatus> statuses;
+};
+
+static absl::StatusOr<ConfigurationLintResult> LintConfiguration(
+    std::string_view filename, std::string_view original_text,
+    const std::string &text, const LinterConfiguration &config) {
+  ConfigurationLintResult result;
+  VerilogAnalyzer analyzer(text, filename);
+  if (!analyzer.Analyze().ok()) {
+    result.syntax_errors = analyzer.LinterTokenErrorMessages(false);
+    return result;
+  }
+  auto statuses_or =
+      VerilogLintTextStructure(filename, config, analyzer.Data());
+  if (!statuses_or.ok()) return statuses_or.status();
+
+  // The analyzer owns a copy of the text, which the violations refer to.
+  const std::string_view analyzed_text = analyzer.Data().Contents();
+  for (const auto &status : *statuses_or) {
+    std::set<LintViolation> violations;
+    for (const auto &violation : status.violations) {
+      violations.insert(RebaseViolation(violation, analyzed_text,
+                                        original_text, violation.reason));
+    }
+    result.statuses.emplace_back(violations, status.lint_rule_name, status.url,
+                                 status.severity);
+  }
+  return result;
+}
+
+// Returns the description of the configuration of 'variant'.
+static std::string DescribeVariant(
+    const FlowTree::Variant &variant,
+    const std::vector<FlowTree::TokenSequenceConstIterator> &macros) {
+  std::vector<std::string> terms;
+  for (const size_t id : variant.visited) {
+    terms.push_back(absl::StrCat(variant.macros_mask.test(id) ? "" : "!",
+                                 macros[id]->text()));
+  }
+  return absl::StrJoin(terms, " ");
+}
+
+absl::StatusOr<VariantLintResult> LintPreprocessorVariants(
+    std::string_view filename, std::string_view text,
+    const LinterConfiguration &config, const VariantLintOptions &options) {
+  verible::TokenSequence tokens;
+  VerilogLexer lexer(text);
+  for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
+       lexer.DoNextToken()) {
+    if (VerilogLexer::KeepSyntaxTreeTokens(lexer.GetLastToken())) {
+      tokens.push_back(lexer.GetLastToken());
+    }
+  }
+
+  // Enumerate the configurations, and the text of each.  Configurations that
+  // yield the same text share one analysis.
+  VariantLintResult result;
+  // A deque keeps the texts in place, for text_index to refer to them.
+  std::deque<std::string> texts;
+  std::vector<std::vector<size_t>> configurations_of_text;
+  std::map<std::string_view, size_t> text_index;
+  if (tokens.empty()) {
+    result.configurations.emplace_back();
+    texts.emplace_back(text);
+    configurations_of_text.push_back({0});
+  } else {
+    FlowTree flow_tree(tokens);
+    std::map<std::string_view, size_t> macro_ids;
+    const absl::Status status =
+        flow_tree.GenerateVariants([&](const FlowTree::Variant &variant) {
+          if (result.configurations.size() == options.max_configurations) {
+            result.incomplete = true;
+            return false;
+          }
+          const auto &macros = flow_tree.GetUsedMacros();
+          for (size_t id = macro_ids.size(); id < macros.size(); ++id) {
+            macro_ids[macros[id]->text()] = id;
+          }
+          const size_t configuration = result.configurations.size();
+          result.configurations.push_back(DescribeVariant(variant, macros));
+          std::string variant_text = MaskInactiveBranches(
+              text, tokens, [&](std::string_view macro) {
+                const auto found = macro_ids.find(macro);
+                return found != macro_ids.end() &&
+                       variant.macros_mask.test(found->second);
+              });
+          const auto found = text_index.find(variant_text);
+          if (found != text_index.end()) {
+            configurations_of_text[found->second].push_back(configuration);
+            return true;
+          }
+          texts.push_back(std::move(variant_text));
+          configurations_of_text.push_back({configuration});
+          text_index.emplace(texts.back(), texts.size() - 1);
+          return true;
+        });
+    if (!status.ok()) return status;
+  }
+
+  // Parse and lint the distinct texts concurrently.
+  std::vector<absl::StatusOr<ConfigurationLintResult>> lint_results;
+  {
+    verible::ThreadPool pool(options.num_threads);
+    std::vector<std::future<absl::StatusOr<ConfigurationLintResult>>> futures;
+    futures.reserve(texts.size());
+    for (const std::string &variant_text : texts) {
+      futures.push_back(pool.ExecAsync<absl::StatusOr<ConfigurationLintResult>>(
+          [filename, text, &variant_text, &config]() {
+            return LintConfiguration(filename, text, variant_text, config);
+          }));
+    }
+    for (auto &future : futures) lint_results.push_back(future.get());
+  }
+
+  // Merge the findings by rule and location.
+  struct MergedViolation {
+    const LintViolation *violation;
+    std::vector<size_t> configurations;
+  };
+  struct MergedRule {
+    const LintRuleStatus *status;
+    // Keyed by location, like std::set<LintViolation>.
+    std::map<const char *, MergedViolation> violations;
+  };
+  std::map<std::string_view, MergedRule> merged_rules;
+  for (size_t i = 0; i < lint_results.size(); ++i) {
+    if (!lint_results[i].ok()) return lint_results[i].status();
+    const ConfigurationLintResult &lint_result = *lint_results[i];
+    const std::vector<size_t> &configurations = configurations_of_text[i];
+    if (!lint_result.syntax_errors.empty()) {
+      for (const size_t configuration : configurations) {
+        result.syntax_errors.emplace_back(configuration,
+                                          lint_result.syntax_errors);
+      }
+      continue;
+    }
+    for (const auto &status : lint_result.statuses) {
+      MergedRule &rule =
+          merged_rules.emplace(status.lint_rule_name, MergedRule{&status, {}})
+              .first->second;
+      for (const auto &violation : status.violations) {
+        MergedViolation &merged =
+            rule.violations
+                .emplace(violation.token.text().data(),
+                         MergedViolation{&violation, {}})
+                .first->second;
+        merged.configurations.insert(merged.configurations.end(),
+                                     configurations.begin(),
+                                     configurations.end());
+      }
+    }
+  }
+
+  for (const auto &[rule_name, rule] : merged_rules) {
+    std::set<LintViolation> violations;
+    for (const auto &[location, merged] : rule.violations) {
+      if (merged.configurations.size() == result.configurations.size()) {
+        violations.insert(*merged.violation);
+        continue;
+      }
+      std::set<size_t> configurations(merged.configurations.begin(),
+                                      merged.configurations.end());
+      const std::string reason = absl::StrCat(
+          merged.violation->reason, " [configurations: ",
+          absl::StrJoin(configurations, "; ",
+                        [&result](std::string *out, size_t configuration) {
+                          absl::StrAppend(
+                              out, "{", result.configurations[configuration],
+                              "}");
+                        }),
+          "]");
+      // Copies the violation with the annotated reason.
+      violations.insert(
+          RebaseViolation(*merged.violation, text, text, reason));
+    }
+    result.statuses.emplace_back(violations, rule_name, rule.status->url,
+                                 rule.status->severity);
+  }
+  return result;
+}
+
+}  // namespace verilog
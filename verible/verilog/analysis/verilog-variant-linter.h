@@ -0,0 +1,85 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_ANALYSIS_VERILOG_VARIANT_LINTER_H_
+#define VERIBLE_VERILOG_ANALYSIS_VERILOG_VARIANT_LINTER_H_
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "verible/common/analysis/lint-rule-status.h"
+#include "verible/common/text/token-stream-view.h"
+#include "verible/verilog/analysis/verilog-linter-configuration.h"
+
+namespace verilog {
+
+// Returns the text of one preprocessor configuration of 'text', in which
+// is_defined(macro) tells whether a macro tested by `ifdef, `ifndef or
+// `elsif is defined.  'tokens' are the lexed tokens of 'text'; only
+// conditional directives and their macro names are interpreted.
+// The conditional directives and the inactive branches are replaced by
+// block comments, so the result has the same length and line structure as
+// 'text', and every active token stays at its original offset.  The
+// whitespace around directives in active code stays as well.
+std::string MaskInactiveBranches(
+    std::string_view text, const verible::TokenSequence &tokens,
+    const std::function<bool(std::string_view macro)> &is_defined);
+
+struct VariantLintOptions {
+  // Maximum number of preprocessor configurations to lint.
+  // Files with more combinations of conditionals are only partially covered.
+  size_t max_configurations = 64;
+
+  // Number of threads that parse and lint configurations concurrently.
+  // If zero, configurations are linted sequentially.
+  int num_threads = 0;
+};
+
+// Lint findings of all preprocessor configurations of one file.
+struct VariantLintResult {
+  // Description of each configuration, listing the macros that it tests,
+  // e.g. "A !B" for A defined and B undefined.
+  std::vector<std::string> configurations;
+
+  // True if there were more configurations than
+  // VariantLintOptions::max_configurations.
+  bool incomplete = false;
+
+  // Syntax error messages of configurations that failed to parse, and thus
+  // were not linted, keyed by index into 'configurations'.
+  std::vector<std::pair<size_t, std::vector<std::string>>> syntax_errors;
+
+  // Lint findings of all configurations, located in the original text.
+  // A violation in code that is common to several configurations is reported
+  // only once.  Violations that do not occur in every configuration have the
+  // configurations that they occur in appended to their reason.
+  std::vector<verible::LintRuleStatus> statuses;
+};
+
+// Lints every relevant preprocessor configuration of 'text', as enumerated by
+// the FlowTree of its `ifdef/`ifndef conditionals.  Configurations are parsed
+// and linted concurrently, and configurations that yield the same text are
+// only linted once.
+absl::StatusOr<VariantLintResult> LintPreprocessorVariants(
+    std::string_view filename, std::string_view text,
+    const LinterConfiguration &config, const VariantLintOptions &options);
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_ANALYSIS_VERILOG_VARIANT_LINTER_H_
@@ -0,0 +1,252 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/analysis/verilog-variant-linter.h"
+
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/common/analysis/lint-rule-status.h"
+#include "verible/common/text/token-stream-view.h"
+#include "verible/verilog/analysis/verilog-linter-configuration.h"
+#include "verible/verilog/parser/verilog-lexer.h"
+
+namespace verilog {
+namespace {
+
+using testing::ElementsAre;
+using testing::EndsWith;
+using testing::HasSubstr;
+using testing::Not;
+using testing::SizeIs;
+
+verible::TokenSequence LexToSequence(std::string_view source_contents) {
+  verible::TokenSequence lexed_sequence;
+  VerilogLexer lexer(source_contents);
+  for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
+       lexer.DoNextToken()) {
+    if (VerilogLexer::KeepSyntaxTreeTokens(lexer.GetLastToken())) {
+      lexed_sequence.push_back(lexer.GetLastToken());
+    }
+  }
+  return lexed_sequence;
+}
+
+TEST(MaskInactiveBranchesTest, NoConditionals) {
+  constexpr std::string_view kText = "module m;\nendmodule\n";
+  EXPECT_EQ(MaskInactiveBranches(kText, LexToSequence(kText),
+                                 [](std::string_view) { return true; }),
+            kText);
+}
+
+TEST(MaskInactiveBranchesTest, Branches) {
+  constexpr std::string_view kText =
+      "module m;\n"
+      "`ifdef A\n"
+      "  wire a; /* a */\n"
+      "`elsif B\n"
+      "  wire b;\n"
+      "`else\n"
+      "  wire c;\n"
+      "`endif\n"
+      "endmodule\n";
+  const verible::TokenSequence tokens = LexToSequence(kText);
+  const auto masked_with = [&](std::set<std::string_view> defines) {
+    return MaskInactiveBranches(kText, tokens, [&](std::string_view macro) {
+      return defines.count(macro) != 0;
+    });
+  };
+  EXPECT_EQ(masked_with({"A"}),
+            "module m;\n"
+            "/******/\n"
+            "  wire a; /* a */\n"
+            "/*******\n"
+            "*********\n"
+            "*****\n"
+            "*********\n"
+            "*****/\n"
+            "endmodule\n");
+  EXPECT_EQ(masked_with({"B"}),
+            "module m;\n"
+            "/*******\n"
+            "*****************\n"
+            "*******/\n"
+            "  wire b;\n"
+            "/****\n"
+            "*********\n"
+            "*****/\n"
+            "endmodule\n");
+  EXPECT_EQ(masked_with({}),
+            "module m;\n"
+            "/*******\n"
+            "*****************\n"
+            "********\n"
+            "*********\n"
+            "****/\n"
+            "  wire c;\n"
+            "/****/\n"
+            "endmodule\n");
+}
+
+TEST(MaskInactiveBranchesTest, SlashBeforeDirective) {
+  // "//*" would comment out the rest of the line.
+  constexpr std::string_view kText =
+      "  x = y /`ifdef A\n"
+      "  z;\n"
+      "`else\n"
+      "  w;\n"
+      "`endif\n";
+  EXPECT_EQ(MaskInactiveBranches(kText, LexToSequence(kText),
+                                 [](std::string_view) { return false; }),
+            "  x = y / /******\n"
+            "****\n"
+            "****/\n"
+            "  w;\n"
+            "/****/\n");
+}
+
+TEST(MaskInactiveBranchesTest, ShortLastLine) {
+  // The unterminated branch ends with one character on a line of its own,
+  // which leaves no room for the closer there.
+  constexpr std::string_view kText =
+      "`ifdef A\n"
+      "  wire a;\n"
+      "`else\n"
+      "b\n";
+  EXPECT_EQ(MaskInactiveBranches(kText, LexToSequence(kText),
+                                 [](std::string_view) { return true; }),
+            "/******/\n"
+            "  wire a;\n"
+            "/***/\n"
+            " \n");
+}
+
+TEST(MaskInactiveBranchesTest, KeepsWhitespaceOfDirectiveLines) {
+  constexpr std::string_view kText =
+      "`ifdef A\t\n"
+      "  wire a;\n"
+      "`endif  \n";
+  const verible::TokenSequence tokens = LexToSequence(kText);
+  EXPECT_EQ(MaskInactiveBranches(kText, tokens,
+                                 [](std::string_view) { return true; }),
+            "/******/\t\n"
+            "  wire a;\n"
+            "/****/  \n");
+  EXPECT_EQ(MaskInactiveBranches(kText, tokens,
+                                 [](std::string_view) { return false; }),
+            "/*******\t\n"
+            "*********\n"
+            "*****/  \n");
+}
+
+TEST(LintPreprocessorVariantsTest, ReportsViolationsOnceWithConfigurations) {
+  constexpr std::string_view kText =
+      "module m;\n"
+      "\twire common;\n"
+      "`ifdef A\n"
+      "\twire a;\n"
+      "`else\n"
+      "  wire b;\n"
+      "`endif\n"
+      "endmodule\n";
+  LinterConfiguration config;
+  config.TurnOn("no-tabs");
+
+  for (int num_threads : {0, 2}) {
+    const auto result_or = LintPreprocessorVariants(
+        "file.sv", kText, config, {.num_threads = num_threads});
+    ASSERT_TRUE(result_or.ok()) << result_or.status();
+    const VariantLintResult &result = *result_or;
+    EXPECT_THAT(result.configurations, ElementsAre("A", "!A"));
+    EXPECT_FALSE(result.incomplete);
+    EXPECT_TRUE(result.syntax_errors.empty());
+
+    ASSERT_THAT(result.statuses, SizeIs(1));
+    const auto &violations = result.statuses[0].violations;
+    ASSERT_THAT(violations, SizeIs(2));
+    auto violation = violations.begin();
+    // The common violation is reported once, without configurations.
+    EXPECT_EQ(violation->token.left(kText), kText.find("\twire common"));
+    EXPECT_THAT(violation->reason, Not(HasSubstr("configurations")));
+    ++violation;
+    EXPECT_EQ(violation->token.left(kText), kText.find("\twire a"));
+    EXPECT_THAT(violation->reason, EndsWith("[configurations: {A}]"));
+  }
+}
+
+TEST(LintPreprocessorVariantsTest, ReportsWhitespaceOnDirectiveLines) {
+  constexpr std::string_view kText =
+      "module m;\n"
+      "`ifdef A\t\n"
+      "  wire a;\n"
+      "`endif  \n"
+      "endmodule\n";
+  LinterConfiguration config;
+  config.TurnOn("no-tabs");
+  config.TurnOn("no-trailing-spaces");
+
+  const auto result_or = LintPreprocessorVariants("file.sv", kText, config, {});
+  ASSERT_TRUE(result_or.ok()) << result_or.status();
+  const auto &statuses = result_or->statuses;
+  ASSERT_THAT(statuses, SizeIs(2));
+  // Both are in every configuration, so they come without configurations.
+  std::vector<size_t> tabs, trailing_spaces;
+  for (const auto &violation : statuses[0].violations) {
+    EXPECT_THAT(violation.reason, Not(HasSubstr("configurations")));
+    tabs.push_back(violation.token.left(kText));
+  }
+  for (const auto &violation : statuses[1].violations) {
+    EXPECT_THAT(violation.reason, Not(HasSubstr("configurations")));
+    trailing_spaces.push_back(violation.token.left(kText));
+  }
+  EXPECT_THAT(tabs, ElementsAre(kText.find('\t')));
+  EXPECT_THAT(trailing_spaces,
+              ElementsAre(kText.find('\t'), kText.find("  \nendmodule")));
+}
+
+TEST(LintPreprocessorVariantsTest, LimitsConfigurations) {
+  constexpr std::string_view kText =
+      "`ifdef A\n"
+      "`endif\n"
+      "`ifdef B\n"
+      "`endif\n";
+  LinterConfiguration config;
+  const auto result_or = LintPreprocessorVariants(
+      "file.sv", kText, config, {.max_configurations = 3});
+  ASSERT_TRUE(result_or.ok()) << result_or.status();
+  EXPECT_THAT(result_or->configurations, SizeIs(3));
+  EXPECT_TRUE(result_or->incomplete);
+}
+
+TEST(LintPreprocessorVariantsTest, ReportsSyntaxErrorsPerConfiguration) {
+  constexpr std::string_view kText =
+      "module m;\n"
+      "`ifdef A\n"
+      "  wire wire;\n"
+      "`endif\n"
+      "endmodule\n";
+  LinterConfiguration config;
+  const auto result_or =
+      LintPreprocessorVariants("file.sv", kText, config, {});
+  ASSERT_TRUE(result_or.ok()) << result_or.status();
+  ASSERT_THAT(result_or->syntax_errors, SizeIs(1));
+  EXPECT_EQ(result_or->configurations[result_or->syntax_errors[0].first], "A");
+}
+
+}  // namespace
+}  // namespace verilog
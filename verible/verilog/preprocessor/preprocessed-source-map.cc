@@ -0,0 +1,102 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/preprocessor/preprocessed-source-map.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "verible/common/util/logging.h"
+#include "verible/common/util/range.h"
+
+namespace verilog {
+
+PreprocessedSourceMap::PreprocessedSourceMap()
+    : PreprocessedSourceMap(Origin()) {}
+
+PreprocessedSourceMap::PreprocessedSourceMap(const Origin &root)
+    : origins_{root} {}
+
+int PreprocessedSourceMap::OriginIndex(size_t token_index) const {
+  // Find the last run that starts at or before 'token_index'.
+  const auto next_run = std::upper_bound(
+      runs_.begin(), runs_.end(), token_index,
+      [](size_t index, const std::pair<size_t, int> &run) {
+        return index < run.first;
+      });
+  if (next_run == runs_.begin()) return kRootOrigin;
+  return std::prev(next_run)->second;
+}
+
+std::vector<int> PreprocessedSourceMap::ExpansionStack(
+    size_t token_index) const {
+  std::vector<int> stack;
+  for (int origin = OriginIndex(token_index); origin >= 0;
+       origin = origins_[origin].parent) {
+    stack.push_back(origin);
+  }
+  return stack;
+}
+
+std::pair<int, size_t> PreprocessedSourceMap::Locate(
+    size_t token_index, std::string_view token_text) const {
+  for (int origin = OriginIndex(token_index); origin >= 0;
+       origin = origins_[origin].parent) {
+    const std::string_view contents = origins_[origin].contents;
+    if (!contents.empty() && verible::IsSubRange(token_text, contents)) {
+      return {origin, token_text.data() - contents.data()};
+    }
+  }
+  return {-1, 0};
+}
+
+int PreprocessedSourceMap::AddOrigin(const Origin &origin) {
+  DCHECK_LT(origin.parent, static_cast<int>(origins_.size()));
+  origins_.push_back(origin);
+  return static_cast<int>(origins_.size()) - 1;
+}
+
+void PreprocessedSourceMap::SetOrigin(size_t token_index, int origin) {
+  if (!runs_.empty() && runs_.back().first == token_index) {
+    // The previous run is empty.
+    runs_.pop_back();
+  }
+  CHECK(runs_.empty() || runs_.back().first < token_index);
+  const int current = runs_.empty() ? kRootOrigin : runs_.back().second;
+  if (origin == current) return;
+  runs_.emplace_back(token_index, origin);
+}
+
+void PreprocessedSourceMap::AppendNested(const PreprocessedSourceMap &nested,
+                                         size_t token_index,
+                                         const Origin &nested_root) {
+  const int base = static_cast<int>(origins_.size());
+  const int root = AddOrigin(nested_root);
+  for (size_t i = 1; i < nested.origins_.size(); ++i) {
+    Origin origin = nested.origins_[i];
+    origin.parent += base;  // Nested origins all have a parent.
+    origins_.push_back(origin);
+  }
+  // The root of 'nested' is implicit before its first run.
+  SetOrigin(token_index, root);
+  for (const auto &[index, origin] : nested.runs_) {
+    SetOrigin(token_index + index, base + origin);
+  }
+}
+
+}  // namespace verilog
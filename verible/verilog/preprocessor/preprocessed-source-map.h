@@ -0,0 +1,116 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_PREPROCESSOR_PREPROCESSED_SOURCE_MAP_H_
+#define VERIBLE_VERILOG_PREPROCESSOR_PREPROCESSED_SOURCE_MAP_H_
+
+#include <cstddef>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace verilog {
+
+// PreprocessedSourceMap tells where each token of a preprocessed token stream
+// comes from: the source file, an included file, or the expansion of a macro.
+// These origins nest: a macro may be expanded in an included file, which is
+// included from the source.
+//
+// Runs of consecutive tokens with the same origin are stored once, so the
+// map is small, and finding the origin of a token is a binary search.
+//
+// Tokens of macros that are expanded within the body of another macro are
+// attributed to the outermost macro call.
+class PreprocessedSourceMap {
+ public:
+  struct Origin {
+    enum Kind {
+      kSource,
+      kIncludedFile,
+      kMacroExpansion,
+    };
+    Kind kind = kSource;
+
+    // The text that the tokens point into: the contents of the file, or the
+    // definition text of the macro.  The arguments of a macro call point into
+    // the contents of an enclosing origin instead.
+    // For the source, this spans its tokens, from the first to the last.
+    std::string_view contents;
+
+    // Path of an included file, or name of an expanded macro.
+    std::string_view name;
+
+    // Index of the origin that contains the `include or macro call, or -1.
+    int parent = -1;
+
+    // Offset of the `include or macro call in the contents of the parent.
+    size_t offset_in_parent = 0;
+  };
+
+  // Index of the origin of all tokens that are not recorded otherwise.
+  static constexpr int kRootOrigin = 0;
+
+  // Starts with only the root origin.
+  PreprocessedSourceMap();
+  explicit PreprocessedSourceMap(const Origin &root);
+
+  const std::vector<Origin> &origins() const { return origins_; }
+  std::vector<Origin> *mutable_origins() { return &origins_; }
+
+  const Origin &root() const { return origins_[kRootOrigin]; }
+  void set_root(const Origin &root) { origins_[kRootOrigin] = root; }
+
+  // Returns the index of the origin of the token at 'token_index' in the
+  // preprocessed token stream.
+  int OriginIndex(size_t token_index) const;
+
+  const Origin &OriginOf(size_t token_index) const {
+    return origins_[OriginIndex(token_index)];
+  }
+
+  // Returns the indices of the origins that the token at 'token_index' is
+  // nested in, from its own origin to the root.
+  std::vector<int> ExpansionStack(size_t token_index) const;
+
+  // Returns the index of the innermost origin of the token at 'token_index'
+  // whose contents contain 'token_text', and the offset of 'token_text' in
+  // these contents, or {-1, 0} if there is none.
+  std::pair<int, size_t> Locate(size_t token_index,
+                                std::string_view token_text) const;
+
+  // Adds an origin, and returns its index.
+  int AddOrigin(const Origin &origin);
+
+  // Records that the tokens from 'token_index' on come from 'origin', until
+  // the next recorded change.  Changes must be recorded in increasing order
+  // of 'token_index'.
+  void SetOrigin(size_t token_index, int origin);
+
+  // Appends the map of a nested token stream, like that of an included file,
+  // whose tokens start at 'token_index'.  The root of 'nested' is replaced by
+  // 'nested_root', whose parent is an origin of this map.
+  void AppendNested(const PreprocessedSourceMap &nested, size_t token_index,
+                    const Origin &nested_root);
+
+ private:
+  std::vector<Origin> origins_;
+
+  // Index of the first token of each run, with the origin of the run.
+  // Sorted by token index.
+  std::vector<std::pair<size_t, int>> runs_;
+};
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_PREPROCESSOR_PREPROCESSED_SOURCE_MAP_H_
@@ -0,0 +1,122 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/preprocessor/preprocessed-source-map.h"
+
+#include <string_view>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+using Origin = PreprocessedSourceMap::Origin;
+
+TEST(PreprocessedSourceMapTest, OnlyRoot) {
+  constexpr std::string_view kSource = "module m; endmodule";
+  const PreprocessedSourceMap map(Origin{.contents = kSource});
+  EXPECT_EQ(map.origins().size(), 1);
+  EXPECT_EQ(map.OriginIndex(0), PreprocessedSourceMap::kRootOrigin);
+  EXPECT_EQ(map.OriginIndex(1000), PreprocessedSourceMap::kRootOrigin);
+  EXPECT_THAT(map.ExpansionStack(5), ElementsAre(0));
+  EXPECT_THAT(map.Locate(1, kSource.substr(7, 1)), Pair(0, 7));
+  EXPECT_THAT(map.Locate(1, "elsewhere"), Pair(-1, 0));
+}
+
+TEST(PreprocessedSourceMapTest, MacroExpansion) {
+  // Tokens: wire [ `W - 1 : 0 ] x ;  where `W expands to two tokens.
+  constexpr std::string_view kSource = "wire [`W-1:0] x;";
+  constexpr std::string_view kBody = "4 * 2";
+  PreprocessedSourceMap map(Origin{.contents = kSource});
+  const int expansion = map.AddOrigin({.kind = Origin::kMacroExpansion,
+                                       .contents = kBody,
+                                       .name = "W",
+                                       .parent = 0,
+                                       .offset_in_parent = 6});
+  map.SetOrigin(2, expansion);
+  map.SetOrigin(5, PreprocessedSourceMap::kRootOrigin);
+
+  EXPECT_EQ(map.OriginIndex(1), 0);
+  EXPECT_EQ(map.OriginIndex(2), expansion);
+  EXPECT_EQ(map.OriginIndex(4), expansion);
+  EXPECT_EQ(map.OriginIndex(5), 0);
+  EXPECT_EQ(map.OriginOf(3).name, "W");
+  EXPECT_THAT(map.ExpansionStack(3), ElementsAre(expansion, 0));
+  EXPECT_THAT(map.Locate(4, kBody.substr(4, 1)), Pair(expansion, 4));
+  // Macro arguments are found in the enclosing origin.
+  EXPECT_THAT(map.Locate(4, kSource.substr(9, 1)), Pair(0, 9));
+}
+
+TEST(PreprocessedSourceMapTest, EmptyRunsAreDropped) {
+  PreprocessedSourceMap map;
+  const int a = map.AddOrigin({.kind = Origin::kMacroExpansion, .parent = 0});
+  const int b = map.AddOrigin({.kind = Origin::kMacroExpansion, .parent = 0});
+  map.SetOrigin(3, a);
+  map.SetOrigin(3, b);  // 'a' expanded to nothing
+  map.SetOrigin(4, PreprocessedSourceMap::kRootOrigin);
+  map.SetOrigin(4, PreprocessedSourceMap::kRootOrigin);
+  EXPECT_EQ(map.OriginIndex(2), 0);
+  EXPECT_EQ(map.OriginIndex(3), b);
+  EXPECT_EQ(map.OriginIndex(4), 0);
+}
+
+TEST(PreprocessedSourceMapTest, AppendNested) {
+  constexpr std::string_view kHeader = "`define X 1\nwire a = `X;";
+  PreprocessedSourceMap header_map(Origin{.contents = kHeader});
+  const int header_expansion =
+      header_map.AddOrigin({.kind = Origin::kMacroExpansion,
+                            .contents = "1",
+                            .name = "X",
+                            .parent = 0,
+                            .offset_in_parent = 21});
+  header_map.SetOrigin(3, header_expansion);
+  header_map.SetOrigin(4, PreprocessedSourceMap::kRootOrigin);
+
+  constexpr std::string_view kSource = "`include \"h.svh\"\nmodule m;";
+  PreprocessedSourceMap map(Origin{.contents = kSource});
+  const int source_expansion =
+      map.AddOrigin({.kind = Origin::kMacroExpansion, .parent = 0});
+  map.SetOrigin(0, source_expansion);
+  // The header's 5 tokens come at 1..5.
+  map.AppendNested(header_map, 1,
+                   {.kind = Origin::kIncludedFile,
+                    .contents = kHeader,
+                    .name = "h.svh",
+                    .parent = 0,
+                    .offset_in_parent = 9});
+  map.SetOrigin(6, PreprocessedSourceMap::kRootOrigin);
+
+  ASSERT_EQ(map.origins().size(), 4);
+  const int included = 2;
+  const int nested_expansion = 3;
+  EXPECT_EQ(map.origins()[included].name, "h.svh");
+  EXPECT_EQ(map.origins()[nested_expansion].parent, included);
+
+  EXPECT_EQ(map.OriginIndex(0), source_expansion);
+  EXPECT_EQ(map.OriginIndex(1), included);
+  EXPECT_EQ(map.OriginIndex(3), included);
+  EXPECT_EQ(map.OriginIndex(4), nested_expansion);
+  EXPECT_EQ(map.OriginIndex(5), included);
+  EXPECT_EQ(map.OriginIndex(6), 0);
+  EXPECT_THAT(map.ExpansionStack(4),
+              ElementsAre(nested_expansion, included, 0));
+  EXPECT_THAT(map.Locate(5, kHeader.substr(17, 1)), Pair(included, 17));
+}
+
+}  // namespace
+}  // namespace verilog
@@ -14,10 +14,13 @@
 
 #include "verible/verilog/preprocessor/verilog-preprocess.h"
 
+#include <cstddef>
 #include <filesystem>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -28,12 +31,14 @@
 #include "absl/strings/str_cat.h"
 #include "verible/common/lexer/token-generator.h"
 #include "verible/common/lexer/token-stream-adapter.h"
+#include "verible/common/strings/range.h"
 #include "verible/common/text/macro-definition.h"
 #include "verible/common/text/text-structure.h"
 #include "verible/common/text/token-info.h"
 #include "verible/common/text/token-stream-view.h"
 #include "verible/common/util/container-util.h"
 #include "verible/common/util/logging.h"
+#include "verible/common/util/range.h"
 #include "verible/common/util/status-macros.h"
 #include "verible/verilog/analysis/verilog-filelist.h"
 #include "verible/verilog/parser/verilog-lexer.h"
@@ -45,7 +50,60 @@ namespace verilog {
 using verible::TokenGenerator;
 using verible::TokenStreamView;
 using verible::container::FindOrNull;
-using verible::container::InsertOrUpdate;
+using SourceOrigin = PreprocessedSourceMap::Origin;
+
+// Describes everything about 'definition' that affects its expansion.
+static VerilogIncludedFile::MacroFingerprint MacroFingerprint(
+    const verible::MacroDefinition *definition) {
+  if (definition == nullptr) return std::nullopt;
+  std::string fingerprint = definition->IsCallable() ? "(" : "";
+  // Lengths keep the parts apart.
+  for (const auto &parameter : definition->Parameters()) {
+    const std::string_view name = parameter.name.text();
+    const std::string_view default_value = parameter.default_value.text();
+    absl::StrAppend(&fingerprint, name.size(), ":", name, default_value.size(),
+                    ":", default_value);
+  }
+  absl::StrAppend(&fingerprint, ")", definition->DefinitionText().text());
+  return fingerprint;
+}
+
+std::shared_ptr<const VerilogIncludedFile> VerilogIncludeCache::Lookup(
+    std::string_view path, std::string_view contents,
+    const VerilogPreprocessData::MacroDefinitionRegistry &macros) const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  const auto found = files_.find(path);
+  if (found == files_.end()) return nullptr;
+  for (const auto &file : found->second) {
+    if (file->text_structure->Data().Contents() != contents) continue;
+    bool same_dependencies = true;
+    for (const auto &[name, fingerprint] : file->macro_dependencies) {
+      if (MacroFingerprint(macros.Lookup(name)) != fingerprint) {
+        same_dependencies = false;
+        break;
+      }
+    }
+    if (same_dependencies) {
+      ++hits_;
+      return file;
+    }
+  }
+  return nullptr;
+}
+
+void VerilogIncludeCache::Insert(
+    std::shared_ptr<const VerilogIncludedFile> file) {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  auto &versions = files_[file->path];
+  if (versions.size() < kMaxVersionsPerFile) {
+    versions.push_back(std::move(file));
+  }
+}
+
+size_t VerilogIncludeCache::hits() const {
+  const std::lock_guard<std::mutex> lock(mutex_);
+  return hits_;
+}
 
 VerilogPreprocess::VerilogPreprocess(const Config &config)
     : VerilogPreprocess(config, nullptr) {}
@@ -289,8 +347,7 @@ absl::Status VerilogPreprocess::HandleMacroIdentifier(
 
   // Finding the macro definition.
   const std::string_view sv = (*iter)->text();
-  const auto *found =
-      FindOrNull(preprocess_data_.macro_definitions, sv.substr(1));
+  const auto *found = LookupMacro(sv.substr(1));
   if (!found) {
     preprocess_data_.errors.emplace_back(
         **iter,
@@ -307,21 +364,48 @@ absl::Status VerilogPreprocess::HandleMacroIdentifier(
   }
   auto &lexed = preprocess_data_.lexed_macros_backup.back();
   if (!forward) return absl::OkStatus();
+  auto &stream = preprocess_data_.preprocessed_token_stream;
+  auto &source_map = preprocess_data_.source_map;
+  source_map.SetOrigin(
+      stream.size(),
+      source_map.AddOrigin({.kind = SourceOrigin::kMacroExpansion,
+                            .contents = found->DefinitionText().text(),
+                            .name = sv.substr(1),
+                            .parent = PreprocessedSourceMap::kRootOrigin,
+                            .offset_in_parent = SourceOffset(**iter)}));
   auto iter_generator = verible::MakeConstIteratorStreamer(lexed);
   const auto it_end = lexed.end();
   for (auto it = iter_generator(); it != it_end; it++) {
-    preprocess_data_.preprocessed_token_stream.push_back(it);
+    stream.push_back(it);
   }
+  source_map.SetOrigin(stream.size(), PreprocessedSourceMap::kRootOrigin);
   return absl::OkStatus();
 }
 
+const verible::MacroDefinition *VerilogPreprocess::LookupMacro(
+    std::string_view name) {
+  const auto *definition = preprocess_data_.macro_definitions.Lookup(name);
+  // Macros that the included file changed itself are not dependencies.
+  if (record_macro_lookups_ &&
+      changed_macros_.find(name) == changed_macros_.end()) {
+    macro_lookups_.emplace(name, MacroFingerprint(definition));
+  }
+  return definition;
+}
+
+void VerilogPreprocess::NoteMacroChange(std::string_view name) {
+  if (record_macro_lookups_) changed_macros_.emplace(name);
+}
+
 // Stores a macro definition for later use.
 void VerilogPreprocess::RegisterMacroDefinition(
     const MacroDefinition &definition) {
+  // Whether this re-defines a macro decides about the warning below.
+  if (record_macro_lookups_) LookupMacro(definition.Name());
+  NoteMacroChange(definition.Name());
   // For now, unconditionally register the macro definition, keeping the last
   // definition if macro is re-defined.
-  const bool inserted = InsertOrUpdate(&preprocess_data_.macro_definitions,
-                                       definition.Name(), definition);
+  const bool inserted = preprocess_data_.macro_definitions.Define(definition);
   if (inserted) return;
   preprocess_data_.warnings.emplace_back(definition.NameToken(),
                                          "Re-defining macro");
@@ -481,7 +565,8 @@ absl::Status VerilogPreprocess::HandleUndef(
     return macro_name_extract.status();
   }
   const auto &macro_name = *macro_name_extract.value();
-  preprocess_data_.macro_definitions.erase(macro_name->text());
+  preprocess_data_.macro_definitions.Undefine(macro_name->text());
+  NoteMacroChange(macro_name->text());
 
   // For now, forward all `undef tokens.
   if (conditional_block_.top().InSelectedBranch()) {
@@ -505,8 +590,7 @@ absl::Status VerilogPreprocess::HandleIf(
   }
   const auto &macro_name = *macro_name_extract.value();
   const bool negative_if = (*ifpos)->token_enum() == PP_ifndef;
-  const auto &defs = preprocess_data_.macro_definitions;
-  const bool name_is_defined = defs.find(macro_name->text()) != defs.end();
+  const bool name_is_defined = LookupMacro(macro_name->text()) != nullptr;
   const bool condition_met = (name_is_defined ^ negative_if);
 
   if ((*ifpos)->token_enum() == PP_elsif) {
@@ -611,58 +695,148 @@ absl::Status VerilogPreprocess::HandleInclude(
   }
   const std::string_view source_contents = *status_or_file;
 
-  // Creating a new "VerilogPreprocess" object for the included file,
-  // With the same configuration and preprocessing info (defines, incdirs) as
-  // the main one.
+  // An included file is preprocessed in the macro context at the point of
+  // inclusion, so the outcome can be reused whenever the macros it depends on
+  // have the same definitions again.
+  std::shared_ptr<const VerilogIncludedFile> included_file;
+  if (include_cache_) {
+    included_file =
+        include_cache_->Lookup(file_path.string(), source_contents,
+                               preprocess_data_.macro_definitions);
+  }
+  if (!included_file) {
+    std::unique_ptr<VerilogIncludedFile> preprocessed_file =
+        PreprocessIncludedFile(file_path.string(), source_contents);
+    // Check for errors while preprocessing the included file.
+    if (!preprocessed_file->data.errors.empty()) {
+      preprocess_data_.errors.insert(preprocess_data_.errors.end(),
+                                     preprocessed_file->data.errors.begin(),
+                                     preprocessed_file->data.errors.end());
+      // Keep the file, which owns the text of the error tokens.
+      preprocess_data_.included_files.push_back(std::move(preprocessed_file));
+      return absl::InvalidArgumentError(
+          "Error: the included file preprocessing has failed.");
+    }
+    included_file = std::move(preprocessed_file);
+    if (include_cache_) include_cache_->Insert(included_file);
+  }
+  ApplyIncludedFile(std::move(included_file), SourceOffset(**iter));
+  return absl::OkStatus();
+}
+
+std::unique_ptr<VerilogIncludedFile> VerilogPreprocess::PreprocessIncludedFile(
+    std::string_view path, std::string_view contents) {
+  auto file = std::make_unique<VerilogIncludedFile>();
+  file->path = std::string(path);
   // TODO(karimtera): Ideally modify the FileOpener to return
   // absl::StatusOr<MemBlock> to avoid doing a second copy inside TextStructure.
-  verilog::VerilogPreprocess child_preprocessor(config_, file_opener_);
-  child_preprocessor.setPreprocessingInfo(preprocess_info_);
-
   // TODO(karimtera): limit number of nested includes, detect cycles? maybe.
-  preprocess_data_.included_text_structure.emplace_back(
-      new verible::TextStructure(source_contents));
-  verible::TextStructure &included_structure =
-      *preprocess_data_.included_text_structure.back();
+  file->text_structure.reset(new verible::TextStructure(contents));
 
   // "included_sequence" should contain the lexed token sequence.
   verible::TokenSequence &included_sequence =
-      included_structure.MutableData().MutableTokenStream();
+      file->text_structure->MutableData().MutableTokenStream();
 
   // Lexing the included file content, and storing it in "included_sequence".
-  verilog::VerilogLexer lexer(included_structure.Data().Contents());
+  verilog::VerilogLexer lexer(file->text_structure->Data().Contents());
   for (lexer.DoNextToken(); !lexer.GetLastToken().isEOF();
        lexer.DoNextToken()) {
     included_sequence.push_back(lexer.GetLastToken());
   }
 
+  // Creating a new "VerilogPreprocess" object for the included file, with the
+  // same configuration, that starts with the macros defined so far.  Copying
+  // the registry is cheap: the child only stores the macros it changes.
+  verilog::VerilogPreprocess child_preprocessor(config_, file_opener_);
+  child_preprocessor.preprocess_info_ = preprocess_info_;
+  child_preprocessor.include_cache_ = include_cache_;
+  child_preprocessor.record_macro_lookups_ = true;
+  child_preprocessor.preprocess_data_.macro_definitions =
+      preprocess_data_.macro_definitions;
+
   // Preprocessing the included file tokens.
   verible::TokenStreamView lexed_streamview;
   InitTokenStreamView(included_sequence, &lexed_streamview);
-  verilog::VerilogPreprocessData child_preprocessed_data =
-      child_preprocessor.ScanStream(lexed_streamview);
-
-  // Check for errors while preprocessing the included file.
-  if (!child_preprocessed_data.errors.empty()) {
-    preprocess_data_.errors.insert(preprocess_data_.errors.end(),
-                                   child_preprocessed_data.errors.begin(),
-                                   child_preprocessed_data.errors.end());
-    return absl::InvalidArgumentError(
-        "Error: the included file preprocessing has failed.");
-  }
+  file->data = child_preprocessor.ScanStream(lexed_streamview);
+  file->macro_dependencies = std::move(child_preprocessor.macro_lookups_);
+  for (const std::string &name : child_preprocessor.changed_macros_) {
+    const auto *definition = file->data.macro_definitions.Lookup(name);
+    file->macro_changes.emplace(
+        name, definition ? std::make_optional(*definition) : std::nullopt);
+  }
+  file->data.macro_definitions.clear();
+  CopyMacroDependencyTexts(file.get());
+  return file;
+}
 
-  // Need to move the text structures of the child preprocessor to avoid
-  // destruction.
-  for (auto &u : child_preprocessed_data.included_text_structure) {
-    preprocess_data_.included_text_structure.push_back(std::move(u));
+void VerilogPreprocess::CopyMacroDependencyTexts(
+    VerilogIncludedFile *file) const {
+  // The dependencies still have the definitions the file was included with.
+  std::vector<std::string_view> texts;
+  for (const auto &[name, fingerprint] : file->macro_dependencies) {
+    const auto *definition = preprocess_data_.macro_definitions.Lookup(name);
+    if (definition == nullptr) continue;
+    texts.push_back(definition->DefinitionText().text());
+    for (const auto &parameter : definition->Parameters()) {
+      texts.push_back(parameter.default_value.text());
+    }
   }
+  file->macro_dependency_texts.assign(texts.begin(), texts.end());
+  const auto copied_text = [&](std::string_view text) {
+    for (size_t i = 0; i < texts.size(); ++i) {
+      if (texts[i].empty() || !verible::IsSubRange(text, texts[i])) continue;
+      return std::string_view(file->macro_dependency_texts[i])
+          .substr(text.data() - texts[i].data(), text.size());
+    }
+    return text;
+  };
+  for (auto &sequence : file->data.lexed_macros_backup) {
+    for (auto &token : sequence) {
+      if (!token.text().empty()) token.set_text(copied_text(token.text()));
+    }
+  }
+  for (auto &origin : *file->data.source_map.mutable_origins()) {
+    if (!origin.contents.empty()) {
+      origin.contents = copied_text(origin.contents);
+    }
+  }
+}
 
-  // Forwarding the included preprocessed view.
-  for (const auto &u : child_preprocessed_data.preprocessed_token_stream) {
-    preprocess_data_.preprocessed_token_stream.push_back(u);
+void VerilogPreprocess::ApplyIncludedFile(
+    std::shared_ptr<const VerilogIncludedFile> file, size_t include_offset) {
+  // What a nested file depends on, the including file depends on, unless it
+  // changed that macro itself before.
+  if (record_macro_lookups_) {
+    for (const auto &[name, fingerprint] : file->macro_dependencies) {
+      if (changed_macros_.find(name) == changed_macros_.end()) {
+        macro_lookups_.emplace(name, fingerprint);
+      }
+    }
+  }
+  auto &macros = preprocess_data_.macro_definitions;
+  for (const auto &[name, definition] : file->macro_changes) {
+    if (definition) {
+      macros.Define(*definition);
+    } else {
+      macros.Undefine(name);
+    }
+    NoteMacroChange(name);
   }
 
-  return absl::OkStatus();
+  // Forwarding the included preprocessed view.
+  auto &stream = preprocess_data_.preprocessed_token_stream;
+  auto &source_map = preprocess_data_.source_map;
+  source_map.AppendNested(
+      file->data.source_map, stream.size(),
+      {.kind = SourceOrigin::kIncludedFile,
+       .contents = file->text_structure->Data().Contents(),
+       .name = file->path,
+       .parent = PreprocessedSourceMap::kRootOrigin,
+       .offset_in_parent = include_offset});
+  stream.insert(stream.end(), file->data.preprocessed_token_stream.begin(),
+                file->data.preprocessed_token_stream.end());
+  source_map.SetOrigin(stream.size(), PreprocessedSourceMap::kRootOrigin);
+  preprocess_data_.included_files.push_back(std::move(file));
 }
 
 // Interprets preprocessor tokens as directives that act on this preprocessor
@@ -687,24 +861,35 @@ absl::Status VerilogPreprocess::HandleTokenIterator(
     default:
       break;  // not interested in anything else
   }
-  if (config_.expand_macros && ((*iter)->token_enum() == MacroIdentifier ||
-                                (*iter)->token_enum() == MacroIdItem ||
-                                (*iter)->token_enum() == MacroCallId)) {
+  // Macros are expanded and files included only in selected branches, so
+  // that e.g. include guards take effect.
+  const bool in_selected_branch = conditional_block_.top().InSelectedBranch();
+  if (config_.expand_macros && in_selected_branch &&
+      ((*iter)->token_enum() == MacroIdentifier ||
+       (*iter)->token_enum() == MacroIdItem ||
+       (*iter)->token_enum() == MacroCallId)) {
     return HandleMacroIdentifier(iter, generator);
   }
 
-  if (config_.include_files && (*iter)->token_enum() == PP_include) {
+  if (config_.include_files && in_selected_branch &&
+      (*iter)->token_enum() == PP_include) {
     return HandleInclude(iter, generator);
   }
 
   // If not return'ed above, any other tokens are passed through unmodified
   // unless filtered by a branch.
-  if (conditional_block_.top().InSelectedBranch()) {
+  if (in_selected_branch) {
     preprocess_data_.preprocessed_token_stream.push_back(*iter);
   }
   return absl::OkStatus();
 }
 
+size_t VerilogPreprocess::SourceOffset(const verible::TokenInfo &token) const {
+  const std::string_view source = preprocess_data_.source_map.root().contents;
+  if (source.empty() || !verible::IsSubRange(token.text(), source)) return 0;
+  return token.text().data() - source.data();
+}
+
 void VerilogPreprocess::setPreprocessingInfo(
     const verilog::FileList::PreprocessingInfo &preprocess_info) {
   preprocess_info_ = preprocess_info;
@@ -728,6 +913,15 @@ void VerilogPreprocess::setPreprocessingInfo(
 VerilogPreprocessData VerilogPreprocess::ScanStream(
     const TokenStreamView &token_stream) {
   preprocess_data_.preprocessed_token_stream.reserve(token_stream.size());
+  if (!token_stream.empty()) {
+    const std::string_view first = token_stream.front()->text();
+    const std::string_view last = token_stream.back()->text();
+    if (first.data() != nullptr && last.data() >= first.data()) {
+      preprocess_data_.source_map.set_root(
+          {.contents = verible::make_string_view_range(
+               first.begin(), last.end())});
+    }
+  }
   auto iter_generator = verible::MakeConstIteratorStreamer(token_stream);
   const auto end = token_stream.end();
   // Token-pulling loop.
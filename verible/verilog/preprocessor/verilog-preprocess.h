@@ -35,21 +35,28 @@
 #ifndef VERIBLE_VERILOG_PREPROCESSOR_VERILOG_PREPROCESS_H_
 #define VERIBLE_VERILOG_PREPROCESSOR_VERILOG_PREPROCESS_H_
 
+#include <cstddef>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
 #include <stack>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "verible/common/text/macro-definition-registry.h"
 #include "verible/common/text/macro-definition.h"
 #include "verible/common/text/text-structure.h"
 #include "verible/common/text/token-info.h"
 #include "verible/common/text/token-stream-view.h"
 #include "verible/verilog/analysis/verilog-filelist.h"
+#include "verible/verilog/preprocessor/preprocessed-source-map.h"
 
 namespace verilog {
 
@@ -66,18 +73,25 @@ struct VerilogPreprocessError {
       : token_info(token), error_message(message) {}
 };
 
+struct VerilogIncludedFile;
+
 // Information that results from preprocessing.
 struct VerilogPreprocessData {
   using MacroDefinition = verible::MacroDefinition;
-  using MacroDefinitionRegistry = std::map<std::string_view, MacroDefinition>;
+  using MacroDefinitionRegistry = verible::MacroDefinitionRegistry;
   using TokenSequence = std::vector<verible::TokenInfo>;
 
   // Resulting token stream after preprocessing
   verible::TokenStreamView preprocessed_token_stream;
   std::vector<TokenSequence> lexed_macros_backup;
 
-  // A backup memory that owns the content of the included files.
-  std::vector<std::unique_ptr<verible::TextStructure>> included_text_structure;
+  // Where the tokens of preprocessed_token_stream come from, by index.
+  PreprocessedSourceMap source_map;
+
+  // The included files, which own the memory of their tokens and of the
+  // macros they define.  They may be shared with other compilation units
+  // through a VerilogIncludeCache.
+  std::vector<std::shared_ptr<const VerilogIncludedFile>> included_files;
 
   // Map of defined macros.
   MacroDefinitionRegistry macro_definitions;
@@ -89,6 +103,70 @@ struct VerilogPreprocessData {
   std::vector<VerilogPreprocessError> warnings;
 };
 
+// The outcome of preprocessing an included file.
+// It only depends on the contents of the file and on the definitions of the
+// macros that it looked up before defining them itself: this set of relevant
+// defines is the signature under which the outcome can be reused.
+struct VerilogIncludedFile {
+  using MacroDefinition = verible::MacroDefinition;
+
+  // Describes a macro definition with everything that affects its expansion,
+  // or is nullopt for an undefined macro.
+  using MacroFingerprint = std::optional<std::string>;
+
+  // Path of the file, as written in the `include directive.
+  std::string path;
+
+  // Owns the contents of the file and its lexed tokens.
+  std::unique_ptr<verible::TextStructure> text_structure;
+
+  // The relevant defines: the macros that were looked up, with the
+  // fingerprint of their definition when the file was included.
+  std::map<std::string, MacroFingerprint, std::less<>> macro_dependencies;
+
+  // Copies of the definition texts of 'macro_dependencies' that expanded
+  // tokens point into.
+  std::vector<std::string> macro_dependency_texts;
+
+  // The macros that the file defined, or undefined (nullopt).
+  std::map<std::string, std::optional<MacroDefinition>, std::less<>>
+      macro_changes;
+
+  // The preprocessed tokens.  macro_definitions is left empty; the effect
+  // of the file on the macro table is in 'macro_changes'.
+  VerilogPreprocessData data;
+};
+
+// VerilogIncludeCache memoizes the preprocessing of included files across
+// compilation units: a header that is included again with the same relevant
+// defines is not lexed and preprocessed again.
+// It is thread-safe, so compilation units may be preprocessed concurrently.
+class VerilogIncludeCache {
+ public:
+  // Maximum number of differently preprocessed versions kept per file.
+  static constexpr size_t kMaxVersionsPerFile = 32;
+
+  // Returns a version of the file 'path' with 'contents' that was
+  // preprocessed under the same relevant defines as are in 'macros',
+  // or nullptr.
+  std::shared_ptr<const VerilogIncludedFile> Lookup(
+      std::string_view path, std::string_view contents,
+      const VerilogPreprocessData::MacroDefinitionRegistry &macros) const;
+
+  // Adds a preprocessed version of a file.
+  void Insert(std::shared_ptr<const VerilogIncludedFile> file);
+
+  // Number of successful lookups, for diagnostics.
+  size_t hits() const;
+
+ private:
+  mutable std::mutex mutex_;
+  mutable size_t hits_ = 0;
+  absl::flat_hash_map<std::string,
+                      std::vector<std::shared_ptr<const VerilogIncludedFile>>>
+      files_;
+};
+
 // VerilogPreprocess transforms a TokenStreamView.
 // The input stream view is expected to have been stripped of whitespace.
 class VerilogPreprocess {
@@ -138,6 +216,12 @@ class VerilogPreprocess {
   void setPreprocessingInfo(
       const verilog::FileList::PreprocessingInfo &preprocess_info);
 
+  // Sets the cache that included files are looked up in and added to.
+  // It must outlive this preprocessor.
+  void setIncludeCache(VerilogIncludeCache *include_cache) {
+    include_cache_ = include_cache;
+  }
+
  private:
   using StreamIteratorGenerator =
       std::function<TokenStreamView::const_iterator()>;
@@ -178,6 +262,14 @@ class VerilogPreprocess {
   static std::unique_ptr<VerilogPreprocessError> ParseMacroParameter(
       TokenStreamView::const_iterator *, MacroParameterInfo *);
 
+  // Returns the definition of macro 'name', or nullptr if it is undefined.
+  // When preprocessing an included file, records the lookup as a dependency.
+  const MacroDefinition *LookupMacro(std::string_view name);
+
+  // Notes that the included file being preprocessed (re-)defined or undefined
+  // macro 'name'.
+  void NoteMacroChange(std::string_view name);
+
   void RegisterMacroDefinition(const MacroDefinition &);
   absl::Status ExpandText(const std::string_view &);
   absl::Status ExpandMacro(const verible::MacroCall &,
@@ -185,6 +277,22 @@ class VerilogPreprocess {
   absl::Status HandleInclude(TokenStreamView::const_iterator,
                              const StreamIteratorGenerator &);
 
+  // Lexes and preprocesses an included file in the current macro context.
+  std::unique_ptr<VerilogIncludedFile> PreprocessIncludedFile(
+      std::string_view path, std::string_view contents);
+
+  // Makes the tokens that 'file' expanded from macros defined outside of it
+  // point into copies owned by 'file'.
+  void CopyMacroDependencyTexts(VerilogIncludedFile *file) const;
+
+  // Forwards the tokens of an included file and applies its macro changes.
+  // 'include_offset' is the offset of the `include in the source.
+  void ApplyIncludedFile(std::shared_ptr<const VerilogIncludedFile> file,
+                         size_t include_offset);
+
+  // Returns the offset of 'token' in the source, or 0 if it is not in it.
+  size_t SourceOffset(const verible::TokenInfo &token) const;
+
   // Generate a const_iterator to a non-whitespace token.
   static TokenStreamView::const_iterator GenerateBypassWhiteSpaces(
       const StreamIteratorGenerator &);
@@ -252,6 +360,16 @@ class VerilogPreprocess {
   // A pointer to a file opener function.
   // This is needed for opening new files while handling includes.
   const FileOpener file_opener_ = nullptr;
+
+  // Optional cache of preprocessed included files.
+  VerilogIncludeCache *include_cache_ = nullptr;
+
+  // Set when preprocessing an included file, to record the macros it depends
+  // on and the macros it changes.
+  bool record_macro_lookups_ = false;
+  std::map<std::string, VerilogIncludedFile::MacroFingerprint, std::less<>>
+      macro_lookups_;
+  std::set<std::string, std::less<>> changed_macros_;
 };
 
 }  // namespace verilog
@@ -24,6 +24,7 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "verible/common/text/macro-definition.h"
@@ -42,8 +43,11 @@ namespace verilog {
 namespace {
 
 using testing::ElementsAre;
+using testing::HasSubstr;
+using testing::Not;
 using testing::Pair;
 using testing::StartsWith;
+using testing::UnorderedElementsAre;
 using verible::container::FindOrNull;
 using verible::file::CreateDir;
 using verible::file::JoinPath;
@@ -247,8 +251,8 @@ TEST(VerilogPreprocessTest, TwoMacroDefinitions) {
   EXPECT_PARSE_OK();
 
   const auto &definitions = tester.PreprocessorData().macro_definitions;
-  EXPECT_THAT(definitions, ElementsAre(Pair("BAAAAR", testing::_),
-                                       Pair("FOOOO", testing::_)));
+  EXPECT_THAT(definitions, UnorderedElementsAre(Pair("BAAAAR", testing::_),
+                                                Pair("FOOOO", testing::_)));
   {
     auto macro = FindOrNull(definitions, "BAAAAR");
     ASSERT_NE(macro, nullptr);
@@ -1033,5 +1037,199 @@ TEST(VerilogPreprocessTest,
       << error.error_message;
 }
 
+// Returns a FileOpener that opens the files in 'files', keyed by path.
+static FileOpener InMemoryFileOpener(
+    const std::map<std::string_view, std::string_view> &files) {
+  return [files](
+             std::string_view filename) -> absl::StatusOr<std::string_view> {
+    const auto found = files.find(filename);
+    if (found == files.end()) {
+      return absl::NotFoundError(absl::StrCat(filename, " is not found"));
+    }
+    return found->second;
+  };
+}
+
+// Returns the non-whitespace token texts of 'data', separated by spaces.
+static std::string PreprocessedText(const VerilogPreprocessData &data) {
+  std::vector<std::string_view> texts;
+  for (const auto &token : data.preprocessed_token_stream) {
+    if (VerilogLexer::KeepSyntaxTreeTokens(*token)) {
+      texts.push_back(token->text());
+    }
+  }
+  return absl::StrJoin(texts, " ");
+}
+
+constexpr std::string_view kWidthHeader =
+    "`ifdef WIDE\n"
+    "wire [63:0] w;\n"
+    "`else\n"
+    "wire [31:0] w;\n"
+    "`endif\n"
+    "`define FROM_HEADER\n";
+
+TEST(VerilogPreprocessTest, IncludedFileSharesMacrosWithIncludingFile) {
+  const std::map<std::string_view, std::string_view> files = {
+      {"width.svh", kWidthHeader}};
+  VerilogPreprocess tester(VerilogPreprocess::Config({.filter_branches = true,
+                                                      .include_files = true}),
+                           InMemoryFileOpener(files));
+  LexerTester src_lexer(
+      "`define WIDE\n"
+      "`include \"width.svh\"\n"
+      "`ifdef FROM_HEADER\n"
+      "module m; endmodule\n"
+      "`endif\n");
+  const auto &pp_data = tester.ScanStream(src_lexer.GetTokenStreamView());
+  EXPECT_TRUE(pp_data.errors.empty());
+  const std::string text = PreprocessedText(pp_data);
+  EXPECT_THAT(text, HasSubstr("wire [ 63 : 0 ] w ;"));
+  EXPECT_THAT(text, Not(HasSubstr("31")));
+  EXPECT_THAT(text, HasSubstr("module m ; endmodule"));
+  EXPECT_NE(FindOrNull(pp_data.macro_definitions, "FROM_HEADER"), nullptr);
+}
+
+TEST(VerilogPreprocessTest, IncludeGuardSkipsSecondInclusion) {
+  const std::map<std::string_view, std::string_view> files = {
+      {"guarded.svh",
+       "`ifndef GUARDED_SVH\n"
+       "`define GUARDED_SVH\n"
+       "typedef int guarded_t;\n"
+       "`endif\n"}};
+  VerilogPreprocess tester(VerilogPreprocess::Config({.filter_branches = true,
+                                                      .include_files = true}),
+                           InMemoryFileOpener(files));
+  LexerTester src_lexer(
+      "`include \"guarded.svh\"\n"
+      "`include \"guarded.svh\"\n");
+  const auto &pp_data = tester.ScanStream(src_lexer.GetTokenStreamView());
+  EXPECT_TRUE(pp_data.errors.empty());
+  const std::string text = PreprocessedText(pp_data);
+  EXPECT_THAT(text, HasSubstr("typedef int guarded_t ;"));
+  EXPECT_EQ(text.find("guarded_t"), text.rfind("guarded_t")) << text;
+}
+
+// Preprocesses 'source' with a fresh preprocessor that shares 'cache', and
+// returns the preprocessed text.
+static std::string PreprocessWithCache(
+    std::string_view source,
+    const std::map<std::string_view, std::string_view> &files,
+    VerilogIncludeCache *cache) {
+  VerilogPreprocess tester(VerilogPreprocess::Config({.filter_branches = true,
+                                                      .include_files = true,
+                                                      .expand_macros = true}),
+                           InMemoryFileOpener(files));
+  tester.setIncludeCache(cache);
+  LexerTester src_lexer(source);
+  const auto pp_data = tester.ScanStream(src_lexer.GetTokenStreamView());
+  EXPECT_TRUE(pp_data.errors.empty()) << source;
+  return PreprocessedText(pp_data);
+}
+
+TEST(VerilogPreprocessTest, IncludeCacheReusesFileUnderSameRelevantDefines) {
+  const std::map<std::string_view, std::string_view> files = {
+      {"width.svh", kWidthHeader}};
+  VerilogIncludeCache cache;
+  const std::string wide = PreprocessWithCache(
+      "`define UNRELATED 1\n`define WIDE\n`include \"width.svh\"\n", files,
+      &cache);
+  EXPECT_THAT(wide, HasSubstr("63"));
+  EXPECT_EQ(cache.hits(), 0);
+
+  // UNRELATED does not matter to the header.
+  EXPECT_THAT(PreprocessWithCache("`define WIDE\n`include \"width.svh\"\n",
+                                  files, &cache),
+              HasSubstr("wire [ 63 : 0 ] w ;"));
+  EXPECT_EQ(cache.hits(), 1);
+
+  // Without WIDE, the header is preprocessed differently.
+  const std::string narrow =
+      PreprocessWithCache("`include \"width.svh\"\n", files, &cache);
+  EXPECT_THAT(narrow, HasSubstr("wire [ 31 : 0 ] w ;"));
+  EXPECT_EQ(cache.hits(), 1);
+  EXPECT_EQ(PreprocessWithCache("`include \"width.svh\"\n", files, &cache),
+            narrow);
+  EXPECT_EQ(cache.hits(), 2);
+
+  // Different contents under the same path are not confused.
+  const std::map<std::string_view, std::string_view> changed_files = {
+      {"width.svh", "wire w;\n"}};
+  EXPECT_EQ(PreprocessWithCache("`include \"width.svh\"\n", changed_files,
+                                &cache),
+            "wire w ;");
+  EXPECT_EQ(cache.hits(), 2);
+}
+
+TEST(VerilogPreprocessTest, IncludeCacheKeepsMacroExpansionsOfIncludingFile) {
+  const std::map<std::string_view, std::string_view> files = {
+      {"bus.svh", "wire [`BUS_WIDTH-1:0] bus;\n"}};
+  VerilogIncludeCache cache;
+  // The expanded tokens of the first compilation unit must not refer to its
+  // text, which is gone when the second one reuses them.
+  const std::string first = PreprocessWithCache(
+      "`define BUS_WIDTH 16\n`include \"bus.svh\"\n", files, &cache);
+  EXPECT_THAT(first, HasSubstr("wire [ 16 - 1 : 0 ] bus ;"));
+  const std::string second = PreprocessWithCache(
+      "`define BUS_WIDTH 16\n`include \"bus.svh\"\n", files, &cache);
+  EXPECT_EQ(second, first);
+  EXPECT_EQ(cache.hits(), 1);
+
+  EXPECT_THAT(
+      PreprocessWithCache("`define BUS_WIDTH 8\n`include \"bus.svh\"\n", files,
+                          &cache),
+      HasSubstr("wire [ 8 - 1 : 0 ] bus ;"));
+  EXPECT_EQ(cache.hits(), 1);
+}
+
+TEST(VerilogPreprocessTest, SourceMapOfIncludedFileAndMacroExpansion) {
+  const std::map<std::string_view, std::string_view> files = {
+      {"bus.svh", "wire [`BUS_WIDTH-1:0] bus;\n"}};
+  VerilogPreprocess tester(VerilogPreprocess::Config({.include_files = true,
+                                                      .expand_macros = true}),
+                           InMemoryFileOpener(files));
+  LexerTester src_lexer(
+      "`define BUS_WIDTH 16\n"
+      "`include \"bus.svh\"\n"
+      "module m; endmodule\n");
+  const auto pp_data = tester.ScanStream(src_lexer.GetTokenStreamView());
+  ASSERT_TRUE(pp_data.errors.empty());
+
+  using Origin = PreprocessedSourceMap::Origin;
+  const auto &stream = pp_data.preprocessed_token_stream;
+  const auto &source_map = pp_data.source_map;
+  int checked = 0;
+  for (size_t i = 0; i < stream.size(); ++i) {
+    const std::string_view text = stream[i]->text();
+    const Origin &origin = source_map.OriginOf(i);
+    const std::vector<int> stack = source_map.ExpansionStack(i);
+    const auto [located, offset] = source_map.Locate(i, text);
+    if (text == "16" && origin.kind == Origin::kMacroExpansion) {
+      EXPECT_EQ(origin.name, "BUS_WIDTH");
+      ASSERT_EQ(stack.size(), 3);
+      const Origin &included = source_map.origins()[stack[1]];
+      EXPECT_EQ(included.kind, Origin::kIncludedFile);
+      EXPECT_EQ(included.name, "bus.svh");
+      EXPECT_EQ(included.offset_in_parent, 21);
+      EXPECT_EQ(stack[2], PreprocessedSourceMap::kRootOrigin);
+      EXPECT_EQ(origin.offset_in_parent, 6);  // `BUS_WIDTH in bus.svh
+      EXPECT_EQ(located, stack[0]);
+      ++checked;
+    } else if (text == "bus") {
+      EXPECT_EQ(origin.kind, Origin::kIncludedFile);
+      EXPECT_EQ(stack.size(), 2);
+      EXPECT_EQ(located, stack[0]);
+      EXPECT_EQ(offset, 22);
+      ++checked;
+    } else if (text == "module") {
+      EXPECT_EQ(source_map.OriginIndex(i), PreprocessedSourceMap::kRootOrigin);
+      EXPECT_EQ(located, PreprocessedSourceMap::kRootOrigin);
+      EXPECT_EQ(offset, 40);
+      ++checked;
+    }
+  }
+  EXPECT_EQ(checked, 3);
+}
+
 }  // namespace
 }  // namespace verilog
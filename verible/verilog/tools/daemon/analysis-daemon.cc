@@ -0,0 +1,246 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/tools/daemon/analysis-daemon.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "verible/common/analysis/violation-handler.h"
+#include "verible/common/util/file-util.h"
+#include "verible/verilog/analysis/verilog-analyzer.h"
+#include "verible/verilog/analysis/verilog-linter-configuration.h"
+#include "verible/verilog/analysis/verilog-linter.h"
+#include "verible/verilog/formatting/format-style-init.h"
+#include "verible/verilog/formatting/format-style.h"
+#include "verible/verilog/formatting/formatter.h"
+#include "verible/verilog/preprocessor/verilog-preprocess.h"
+#include "verible/verilog/tools/daemon/tool-flags.h"
+
+namespace verilog {
+
+AnalysisDaemon::AnalysisDaemon(size_t max_cached_files, bool use_inotify)
+    : max_cached_files_(std::max<size_t>(1, max_cached_files)),
+      watcher_(use_inotify) {}
+
+void AnalysisDaemon::ForgetChangedFiles() {
+  for (const std::string &path : watcher_.TakeChanged()) files_.erase(path);
+}
+
+absl::StatusOr<AnalysisDaemon::CachedFile *> AnalysisDaemon::GetFile(
+    std::string_view cwd, std::string_view name) {
+  if (verible::file::IsStdin(name)) {
+    return absl::InvalidArgumentError("Can't read stdin in the daemon.");
+  }
+  const std::string path = verible::file::JoinPath(cwd, name);
+  auto [found, inserted] = files_.try_emplace(path);
+  CachedFile &file = found->second;
+  if (inserted) {
+    // Watched before it is read, so that no later change is missed.
+    watcher_.Watch(path);
+    absl::StatusOr<std::unique_ptr<verible::MemBlock>> content =
+        verible::file::GetContentAsMemBlock(path);
+    ++reads_;
+    if (!content.ok()) {
+      watcher_.Unwatch(path);
+      files_.erase(found);
+      return content.status();
+    }
+    file.content = std::move(*content);
+    file.name = name;
+  } else if (file.name != name) {
+    // Messages contain the name, so they are made again.
+    file.name = name;
+    file.lint_analysis.reset();
+    file.syntax_analysis.reset();
+    file.formatted.reset();
+  }
+  file.last_use = ++use_count_;
+  ForgetLeastRecentlyUsed();  // Not "file": it was just used.
+  return &file;
+}
+
+void AnalysisDaemon::ForgetLeastRecentlyUsed() {
+  while (files_.size() > max_cached_files_) {
+    const auto oldest = std::min_element(
+        files_.begin(), files_.end(), [](const auto &a, const auto &b) {
+          return a.second.last_use < b.second.last_use;
+        });
+    watcher_.Unwatch(oldest->first);
+    files_.erase(oldest);
+  }
+}
+
+ToolOutput AnalysisDaemon::Lint(std::string_view cwd,
+                                const std::vector<std::string> &files) {
+  ForgetChangedFiles();
+  std::ostringstream out;
+  std::ostringstream err;
+  verible::ViolationPrinter violation_printer(&err);
+  int exit_code = 0;
+  for (const std::string &name : files) {
+    const absl::StatusOr<CachedFile *> file = GetFile(cwd, name);
+    if (!file.ok()) {
+      err << "Can't read '" << name << "': " << file.status().message()
+          << std::endl;
+      exit_code = std::max(exit_code, 2);
+      continue;
+    }
+    // The configuration is looked up from the directory of the file.
+    const absl::StatusOr<LinterConfiguration> config =
+        LinterConfigurationFromFlags(verible::file::JoinPath(cwd, name));
+    if (!config.ok()) {
+      err << config.status().message() << std::endl;
+      exit_code = std::max(exit_code, 1);
+      continue;
+    }
+    CachedFile &cached = **file;
+    if (!cached.lint_analysis) {
+      cached.lint_analysis =
+          VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
+              cached.content->AsStringView(), cached.name);
+      ++analyses_;
+    }
+    const int lint_status = LintAnalyzedFile(
+        &out, cached.name, *cached.lint_analysis, *config, &violation_printer,
+        /*check_syntax=*/true, /*parse_fatal=*/true, /*lint_fatal=*/true);
+    exit_code = std::max(exit_code, lint_status);
+  }
+  return {.out = out.str(), .err = err.str(), .exit_code = exit_code};
+}
+
+ToolOutput AnalysisDaemon::Syntax(std::string_view cwd,
+                                  const std::vector<std::string> &files) {
+  ForgetChangedFiles();
+  std::ostringstream out;
+  std::ostringstream err;
+  int exit_code = 0;
+  const VerilogPreprocess::Config preprocess_config{
+      .filter_branches = true,
+  };
+  for (const std::string &name : files) {
+    const absl::StatusOr<CachedFile *> file = GetFile(cwd, name);
+    if (!file.ok()) {
+      err << file.status().message() << std::endl;
+      exit_code = 1;
+      continue;
+    }
+    CachedFile &cached = **file;
+    if (!cached.syntax_analysis) {
+      cached.syntax_analysis = VerilogAnalyzer::AnalyzeAutomaticMode(
+          cached.content, cached.name, preprocess_config);
+      ++analyses_;
+    }
+    const VerilogAnalyzer &analyzer = *cached.syntax_analysis;
+    if (!analyzer.LexStatus().ok() || !analyzer.ParseStatus().ok()) {
+      for (const std::string &message :
+           analyzer.LinterTokenErrorMessages(false)) {
+        out << message << std::endl;
+      }
+      exit_code = 1;
+    }
+  }
+  return {.out = out.str(), .err = err.str(), .exit_code = exit_code};
+}
+
+ToolOutput AnalysisDaemon::Format(std::string_view cwd,
+                                  const std::vector<std::string> &files,
+                                  const FormatOptions &options) {
+  ForgetChangedFiles();
+  if (!options.inplace && files.size() > 1) {
+    return {.err = "--inplace required for multiple files.\n", .exit_code = 1};
+  }
+  // The formatted texts are only valid for the style they were made with.
+  if (ToolFlags flags = GetToolFlags(); flags != formatted_with_) {
+    for (auto &[path, file] : files_) file.formatted.reset();
+    formatted_with_ = std::move(flags);
+  }
+  std::ostringstream out;
+  std::ostringstream err;
+  bool all_success = true;
+  bool any_changes = false;
+  for (const std::string &name : files) {
+    const absl::StatusOr<CachedFile *> file = GetFile(cwd, name);
+    if (!file.ok()) {
+      err << file.status().message() << std::endl;
+      all_success = false;
+      continue;
+    }
+    CachedFile &cached = **file;
+    if (!cached.formatted) {
+      formatter::FormatStyle style;
+      formatter::InitializeFromFlags(&style);
+      formatter::ExecutionControl control;
+      control.max_search_states = 100000;  // verible-verilog-format default.
+      std::ostringstream formatted;
+      const absl::Status status =
+          formatter::FormatVerilog(cached.content->AsStringView(), cached.name,
+                                   style, formatted, {}, control);
+      cached.formatted = Formatted{.status = status, .text = formatted.str()};
+      ++analyses_;
+    }
+    const std::string_view content = cached.content->AsStringView();
+    const Formatted &formatted = *cached.formatted;
+
+    if (!formatted.status.ok()) {
+      // Like the formatter, fail safe: the original text stays, and this
+      // is no failure.
+      if (!options.inplace) out << content;
+      err << name << ": " << formatted.status.message();
+      switch (formatted.status.code()) {
+        case absl::StatusCode::kCancelled:
+        case absl::StatusCode::kInvalidArgument:
+          break;
+        case absl::StatusCode::kDataLoss:
+          err << "; problematic formatter output is\n"
+              << formatted.text << "<<EOF>>";
+          break;
+        default:
+          err << "[other error status]";
+          break;
+      }
+      err << std::endl;
+      continue;
+    }
+
+    const bool changed = content != formatted.text;
+    any_changes |= changed;
+    if (options.verify) {
+      if (changed) err << name << ": Needs formatting." << std::endl;
+    } else if (options.inplace) {
+      // Unchanged files are not written, to keep their timestamp.
+      if (changed) {
+        const absl::Status status = verible::file::SetContents(
+            verible::file::JoinPath(cwd, name), formatted.text);
+        if (!status.ok()) {
+          err << name << ": error writing result " << status << std::endl;
+          all_success = false;
+        }
+      }
+    } else {
+      out << formatted.text;
+    }
+  }
+  const int exit_code = options.verify ? any_changes : (all_success ? 0 : 1);
+  return {.out = out.str(), .err = err.str(), .exit_code = exit_code};
+}
+
+}  // namespace verilog
@@ -0,0 +1,131 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_TOOLS_DAEMON_ANALYSIS_DAEMON_H_
+#define VERIBLE_VERILOG_TOOLS_DAEMON_ANALYSIS_DAEMON_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "verible/common/strings/mem-block.h"
+#include "verible/verilog/analysis/verilog-analyzer.h"
+#include "verible/verilog/tools/daemon/file-watcher.h"
+#include "verible/verilog/tools/daemon/tool-flags.h"
+
+namespace verilog {
+
+// What a tool printed, and its exit code.
+struct ToolOutput {
+  std::string out;  // stdout
+  std::string err;  // stderr
+  int exit_code = 0;
+};
+
+// What Format() does with the formatted files, as selected with the flags of
+// verible-verilog-format. Without either, it prints the formatted file;
+// several files require "inplace".
+struct FormatOptions {
+  bool inplace = false;  // --inplace: write the formatted files.
+  bool verify = false;   // --verify: only tell which files need formatting.
+};
+
+// Runs what verible-verilog-lint, verible-verilog-format and
+// verible-verilog-syntax do for files, with the same output, but keeps the
+// contents and analysis of the files until they change on disk. Repeated
+// runs on mostly unchanged files then only analyze the changed ones.
+//
+// The lint and format configuration are taken from the flags of this
+// process when each call starts, like the tools do; see SetToolFlags() for
+// taking them from a client. The tool flags that select output modes or
+// debug output are not supported, except as given by FormatOptions.
+//
+// Relative file names are relative to the "cwd" of each call, and are
+// reported as given.
+class AnalysisDaemon {
+ public:
+  // Keeps at most "max_cached_files" files; those used least recently are
+  // forgotten first. With "use_inotify" false, changes are found by
+  // comparing modification times.
+  explicit AnalysisDaemon(size_t max_cached_files = 1000,
+                          bool use_inotify = true);
+
+  // Like verible-verilog-lint <files>.
+  ToolOutput Lint(std::string_view cwd, const std::vector<std::string> &files);
+
+  // Like verible-verilog-syntax <files>.
+  ToolOutput Syntax(std::string_view cwd,
+                    const std::vector<std::string> &files);
+
+  // Like verible-verilog-format [--inplace] [--verify] <files>.
+  ToolOutput Format(std::string_view cwd, const std::vector<std::string> &files,
+                    const FormatOptions &options);
+
+  // Forgets the files that changed since they were read. Each of the tool
+  // functions does this first.
+  void ForgetChangedFiles();
+
+  size_t cached_files() const { return files_.size(); }
+
+  // Number of times a file was read, and a file was analyzed for a tool.
+  size_t reads() const { return reads_; }
+  size_t analyses() const { return analyses_; }
+
+ private:
+  struct Formatted {
+    absl::Status status;
+    std::string text;
+  };
+
+  // A file as read, and what the tools found in it.
+  struct CachedFile {
+    std::string name;  // As the tools report it.
+    std::shared_ptr<verible::MemBlock> content;
+    std::unique_ptr<VerilogAnalyzer> lint_analysis;
+    std::unique_ptr<VerilogAnalyzer> syntax_analysis;
+    std::optional<Formatted> formatted;
+    uint64_t last_use = 0;
+  };
+
+  // Returns the file "name" relative to "cwd", reading it unless cached.
+  absl::StatusOr<CachedFile *> GetFile(std::string_view cwd,
+                                       std::string_view name);
+
+  // Forgets the least recently used files above the limit.
+  void ForgetLeastRecentlyUsed();
+
+  const size_t max_cached_files_;
+  FileWatcher watcher_;
+
+  // By absolute path.
+  std::map<std::string, CachedFile> files_;
+  uint64_t use_count_ = 0;
+
+  // The flags that the cached formatted texts were made with.
+  ToolFlags formatted_with_;
+
+  size_t reads_ = 0;
+  size_t analyses_ = 0;
+};
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_TOOLS_DAEMON_ANALYSIS_DAEMON_H_
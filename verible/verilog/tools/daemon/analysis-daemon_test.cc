@@ -0,0 +1,193 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/tools/daemon/analysis-daemon.h"
+
+#include <filesystem>
+#include <string>
+
+#include "absl/flags/reflection.h"
+#include "absl/status/statusor.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/common/util/file-util.h"
+#include "verible/verilog/tools/daemon/tool-flags.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+class AnalysisDaemonTest : public ::testing::Test {
+ protected:
+  void SetUp() final {
+    std::filesystem::path dir =
+        std::filesystem::absolute(::testing::TempDir()) /
+        ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    cwd_ = dir.lexically_normal().string();
+    std::filesystem::remove_all(cwd_);
+    std::filesystem::create_directories(cwd_);
+  }
+
+  void Write(const std::string &name, const std::string &content) {
+    ASSERT_TRUE(
+        verible::file::SetContents(verible::file::JoinPath(cwd_, name), content)
+            .ok());
+  }
+
+  std::string Read(const std::string &name) {
+    const absl::StatusOr<std::string> content =
+        verible::file::GetContentAsString(verible::file::JoinPath(cwd_, name));
+    EXPECT_TRUE(content.ok());
+    return content.value_or("");
+  }
+
+  std::string cwd_;
+  AnalysisDaemon daemon_;
+};
+
+TEST_F(AnalysisDaemonTest, LintReportsFilesAsGiven) {
+  Write("good.sv", "module good;\nendmodule\n");
+  Write("no_newline.sv", "module no_newline;\nendmodule");
+  Write("broken.sv", "module broken(;\nendmodule\n");
+
+  ToolOutput output = daemon_.Lint(cwd_, {"good.sv"});
+  EXPECT_EQ(output.exit_code, 0);
+  EXPECT_THAT(output.out, IsEmpty());
+  EXPECT_THAT(output.err, IsEmpty());
+
+  output = daemon_.Lint(cwd_, {"good.sv", "no_newline.sv", "broken.sv"});
+  EXPECT_EQ(output.exit_code, 1);
+  EXPECT_THAT(output.err, HasSubstr("no_newline.sv:2:"));
+  EXPECT_THAT(output.err, HasSubstr("[posix-eof]"));
+  EXPECT_THAT(output.out, HasSubstr("broken.sv:1:"));
+  EXPECT_THAT(output.out, HasSubstr("syntax error"));
+
+  output = daemon_.Lint(cwd_, {"missing.sv"});
+  EXPECT_EQ(output.exit_code, 2);
+  EXPECT_THAT(output.err, HasSubstr("Can't read 'missing.sv'"));
+}
+
+TEST_F(AnalysisDaemonTest, OnlyChangedFilesAreAnalyzedAgain) {
+  Write("a.sv", "module a;\nendmodule\n");
+  Write("b.sv", "module b;\nendmodule\n");
+  EXPECT_EQ(daemon_.Lint(cwd_, {"a.sv", "b.sv"}).exit_code, 0);
+  EXPECT_EQ(daemon_.Lint(cwd_, {"a.sv", "b.sv"}).exit_code, 0);
+  EXPECT_EQ(daemon_.reads(), 2);
+  EXPECT_EQ(daemon_.analyses(), 2);
+
+  Write("a.sv", "module a(;\nendmodule\n");
+  EXPECT_EQ(daemon_.Lint(cwd_, {"a.sv", "b.sv"}).exit_code, 1);
+  EXPECT_EQ(daemon_.reads(), 3);
+  EXPECT_EQ(daemon_.analyses(), 3);
+
+  // Same file, named differently: the messages name it as given.
+  const ToolOutput output = daemon_.Lint("/", {cwd_ + "/a.sv"});
+  EXPECT_THAT(output.out, HasSubstr(cwd_ + "/a.sv:1:"));
+  EXPECT_EQ(daemon_.reads(), 3);
+  EXPECT_EQ(daemon_.analyses(), 4);
+}
+
+TEST_F(AnalysisDaemonTest, SyntaxReportsErrors) {
+  Write("good.sv", "module good;\nendmodule\n");
+  Write("broken.sv", "module broken(;\nendmodule\n");
+  EXPECT_EQ(daemon_.Syntax(cwd_, {"good.sv"}).exit_code, 0);
+  const ToolOutput output = daemon_.Syntax(cwd_, {"good.sv", "broken.sv"});
+  EXPECT_EQ(output.exit_code, 1);
+  EXPECT_THAT(output.out, HasSubstr("broken.sv:1:"));
+  EXPECT_THAT(output.err, IsEmpty());
+}
+
+TEST_F(AnalysisDaemonTest, FormatModes) {
+  Write("a.sv", "module   a;\nendmodule\n");
+  Write("b.sv", "module b;\nendmodule\n");
+
+  ToolOutput output = daemon_.Format(cwd_, {"a.sv"}, {});
+  EXPECT_EQ(output.exit_code, 0);
+  EXPECT_EQ(output.out, "module a;\nendmodule\n");
+
+  // Like the formatter, several files are only taken with --inplace.
+  for (const FormatOptions options : {FormatOptions{}, {.verify = true}}) {
+    output = daemon_.Format(cwd_, {"a.sv", "b.sv"}, options);
+    EXPECT_EQ(output.exit_code, 1);
+    EXPECT_THAT(output.err, HasSubstr("--inplace required"));
+  }
+
+  // --verify takes precedence over --inplace.
+  output = daemon_.Format(cwd_, {"a.sv", "b.sv"},
+                          {.inplace = true, .verify = true});
+  EXPECT_EQ(output.exit_code, 1);
+  EXPECT_EQ(output.err, "a.sv: Needs formatting.\n");
+  EXPECT_EQ(Read("a.sv"), "module   a;\nendmodule\n");
+
+  output = daemon_.Format(cwd_, {"a.sv", "b.sv"}, {.inplace = true});
+  EXPECT_EQ(output.exit_code, 0);
+  EXPECT_EQ(Read("a.sv"), "module a;\nendmodule\n");
+
+  // The written file is read again.
+  output = daemon_.Format(cwd_, {"a.sv", "b.sv"},
+                          {.inplace = true, .verify = true});
+  EXPECT_EQ(output.exit_code, 0);
+  EXPECT_THAT(output.err, IsEmpty());
+}
+
+// The client sends its lint and format flags, so that the output does not
+// depend on whether a daemon or the client itself does the work.
+TEST_F(AnalysisDaemonTest, FollowsToolFlagsOfEachCall) {
+  const absl::FlagSaver restore_flags;
+  Write("a.sv", "module a;\nwire w;\nendmodule");
+  const ToolFlags daemon_flags = GetToolFlags();
+  ToolFlags client_flags = daemon_flags;
+  client_flags["rules"] = "-posix-eof";
+  client_flags["indentation_spaces"] = "4";
+
+  ASSERT_TRUE(SetToolFlags(client_flags).ok());
+  ToolOutput output = daemon_.Lint(cwd_, {"a.sv"});
+  EXPECT_EQ(output.exit_code, 0);
+  EXPECT_THAT(output.err, IsEmpty());
+  output = daemon_.Format(cwd_, {"a.sv"}, {});
+  EXPECT_EQ(output.out, "module a;\n    wire w;\nendmodule\n");
+
+  ASSERT_TRUE(SetToolFlags(daemon_flags).ok());
+  output = daemon_.Lint(cwd_, {"a.sv"});
+  EXPECT_EQ(output.exit_code, 1);
+  EXPECT_THAT(output.err, HasSubstr("[posix-eof]"));
+  output = daemon_.Format(cwd_, {"a.sv"}, {});
+  EXPECT_EQ(output.out, "module a;\n  wire w;\nendmodule\n");
+}
+
+TEST(AnalysisDaemonLimitTest, ForgetsLeastRecentlyUsedFiles) {
+  const std::string dir = (std::filesystem::absolute(::testing::TempDir()) /
+                           "ForgetsLeastRecentlyUsedFiles")
+                              .lexically_normal()
+                              .string();
+  std::filesystem::create_directories(dir);
+  for (const char *name : {"a.sv", "b.sv", "c.sv"}) {
+    ASSERT_TRUE(verible::file::SetContents(verible::file::JoinPath(dir, name),
+                                           "module m;\nendmodule\n")
+                    .ok());
+  }
+  AnalysisDaemon daemon(2);
+  daemon.Syntax(dir, {"a.sv", "b.sv", "a.sv", "c.sv"});
+  EXPECT_EQ(daemon.cached_files(), 2);
+  EXPECT_EQ(daemon.reads(), 3);
+
+  // "b.sv" was used least recently.
+  daemon.Syntax(dir, {"a.sv", "c.sv", "b.sv"});
+  EXPECT_EQ(daemon.reads(), 4);
+}
+
+}  // namespace
+}  // namespace verilog
@@ -0,0 +1,153 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/tools/daemon/file-watcher.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include "verible/common/util/logging.h"
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace verilog {
+
+#ifdef __linux__
+// Everything that makes a name in a directory refer to other contents.
+static constexpr uint32_t kInotifyMask =
+    IN_MODIFY | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+    IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+#endif
+
+static std::string DirectoryOf(const std::string &path) {
+  return std::filesystem::path(path).parent_path().string();
+}
+
+FileWatcher::FileWatcher(bool use_inotify) {
+#ifdef __linux__
+  if (use_inotify) {
+    inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd_ < 0) {
+      LOG(WARNING) << "No inotify; comparing file modification times instead.";
+    }
+  }
+#endif
+}
+
+FileWatcher::~FileWatcher() {
+#ifdef __linux__
+  if (inotify_fd_ >= 0) close(inotify_fd_);
+#endif
+}
+
+FileWatcher::Stamp FileWatcher::StampOf(const std::string &path) {
+  std::error_code error;
+  const auto size = std::filesystem::file_size(path, error);
+  if (error) return {};
+  const auto mtime = std::filesystem::last_write_time(path, error);
+  if (error) return {};
+  return {
+      .mtime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                      mtime.time_since_epoch())
+                      .count(),
+      .size = static_cast<int64_t>(size),
+  };
+}
+
+void FileWatcher::Watch(const std::string &path) {
+  WatchedFile &watched = files_[path];
+  watched.stamp = StampOf(path);
+  watched.polled = true;
+  changed_.erase(path);
+#ifdef __linux__
+  if (inotify_fd_ < 0) return;
+  // A directory watched already keeps its watch descriptor.
+  const std::string dir = DirectoryOf(path);
+  const int wd = inotify_add_watch(inotify_fd_, dir.c_str(), kInotifyMask);
+  if (wd < 0) {
+    LOG(WARNING) << "Can't watch " << dir << " (" << strerror(errno)
+                 << "); polling " << path;
+    return;
+  }
+  watched_dirs_[wd] = dir;
+  watched.polled = false;
+#endif
+}
+
+void FileWatcher::Unwatch(const std::string &path) {
+  // The directory stays watched; events about unwatched files are ignored.
+  files_.erase(path);
+  changed_.erase(path);
+}
+
+void FileWatcher::MarkDirectory(const std::string &dir) {
+  for (const auto &[path, watched] : files_) {
+    if (DirectoryOf(path) == dir) changed_.insert(path);
+  }
+}
+
+void FileWatcher::ReadEvents() {
+#ifdef __linux__
+  if (inotify_fd_ < 0) return;
+  alignas(struct inotify_event) char buffer[4096];
+  for (;;) {
+    const ssize_t length = read(inotify_fd_, buffer, sizeof(buffer));
+    if (length <= 0) return;  // Nothing pending anymore.
+    for (const char *pos = buffer; pos < buffer + length;) {
+      const auto *event = reinterpret_cast<const struct inotify_event *>(pos);
+      pos += sizeof(struct inotify_event) + event->len;
+      if (event->mask & IN_Q_OVERFLOW) {
+        // Events were lost, so anything could have changed.
+        for (const auto &[path, watched] : files_) changed_.insert(path);
+        continue;
+      }
+      const auto dir = watched_dirs_.find(event->wd);
+      if (dir == watched_dirs_.end()) continue;
+      if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+        MarkDirectory(dir->second);
+        if (event->mask & IN_IGNORED) watched_dirs_.erase(dir);
+        continue;
+      }
+      if (event->len == 0) continue;
+      const std::string path =
+          (std::filesystem::path(dir->second) / event->name).string();
+      if (files_.find(path) != files_.end()) changed_.insert(path);
+    }
+  }
+#endif
+}
+
+std::vector<std::string> FileWatcher::TakeChanged() {
+  ReadEvents();
+  for (const auto &[path, watched] : files_) {
+    if (watched.polled && !(StampOf(path) == watched.stamp)) {
+      changed_.insert(path);
+    }
+  }
+  std::vector<std::string> changed(changed_.begin(), changed_.end());
+  for (const std::string &path : changed) files_.erase(path);
+  changed_.clear();
+  return changed;
+}
+
+}  // namespace verilog
@@ -0,0 +1,93 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_TOOLS_DAEMON_FILE_WATCHER_H_
+#define VERIBLE_VERILOG_TOOLS_DAEMON_FILE_WATCHER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace verilog {
+
+// Tells which of a set of files changed since they were last looked at.
+// Files are identified by their absolute, normalized path.
+//
+// On Linux, this uses inotify on the directories of the files, so that
+// asking is cheap and also notices files that editors replace by renaming
+// a new version over them. Elsewhere, or if inotify is not available, the
+// modification time and size of every watched file are compared, which
+// misses a change of the same size within the resolution of the clock.
+class FileWatcher {
+ public:
+  // With "use_inotify" false, changes are always found by polling.
+  explicit FileWatcher(bool use_inotify = true);
+  ~FileWatcher();
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  // Starts watching "path" for changes: modification, removal or
+  // replacement. Watching a file again starts over.
+  void Watch(const std::string &path);
+
+  // Stops watching "path".
+  void Unwatch(const std::string &path);
+
+  // Returns the watched files that changed since they were watched or
+  // returned last, sorted. These need to be watched again.
+  std::vector<std::string> TakeChanged();
+
+  // Number of files watched.
+  size_t size() const { return files_.size(); }
+
+  // Whether changes are noticed with inotify, not by polling.
+  bool uses_inotify() const { return inotify_fd_ >= 0; }
+
+ private:
+  // What polling compares.
+  struct Stamp {
+    int64_t mtime_ns = -1;
+    int64_t size = -1;
+    bool operator==(const Stamp &other) const {
+      return mtime_ns == other.mtime_ns && size == other.size;
+    }
+  };
+  static Stamp StampOf(const std::string &path);
+
+  // Reads the pending inotify events, and marks the files they are about.
+  void ReadEvents();
+
+  // Marks all watched files in "dir" as changed.
+  void MarkDirectory(const std::string &dir);
+
+  struct WatchedFile {
+    Stamp stamp;          // When it was watched.
+    bool polled = false;  // Not covered by inotify.
+  };
+  std::map<std::string, WatchedFile> files_;
+
+  // Files that changed, and are not returned yet.
+  std::set<std::string> changed_;
+
+  // inotify: file descriptor, and watched directory of each watch.
+  int inotify_fd_ = -1;
+  std::map<int, std::string> watched_dirs_;
+};
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_TOOLS_DAEMON_FILE_WATCHER_H_
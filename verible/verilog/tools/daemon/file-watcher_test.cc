@@ -0,0 +1,104 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/tools/daemon/file-watcher.h"
+
+#include <filesystem>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/common/util/file-util.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Runs each test with inotify, and with polling.
+class FileWatcherTest : public ::testing::TestWithParam<bool> {
+ protected:
+  void SetUp() final {
+    dir_ = std::filesystem::absolute(::testing::TempDir()) /
+           ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    dir_ = dir_.lexically_normal();
+    std::filesystem::remove_all(dir_);
+    std::filesystem::create_directories(dir_);
+  }
+
+  // Writes "content" to "name" in the test directory; returns its path.
+  std::string Write(const std::string &name, const std::string &content) {
+    const std::string path = (dir_ / name).string();
+    EXPECT_TRUE(verible::file::SetContents(path, content).ok());
+    return path;
+  }
+
+  std::filesystem::path dir_;
+};
+
+TEST_P(FileWatcherTest, ReportsModifiedFileOnce) {
+  FileWatcher watcher(GetParam());
+  const std::string a = Write("a.sv", "module a;");
+  const std::string b = Write("b.sv", "module b;");
+  watcher.Watch(a);
+  watcher.Watch(b);
+  EXPECT_EQ(watcher.size(), 2);
+  EXPECT_THAT(watcher.TakeChanged(), IsEmpty());
+
+  Write("a.sv", "module a; endmodule");
+  EXPECT_THAT(watcher.TakeChanged(), ElementsAre(a));
+  EXPECT_EQ(watcher.size(), 1);
+
+  // Not watched anymore, until watched again.
+  Write("a.sv", "module a; wire w; endmodule");
+  EXPECT_THAT(watcher.TakeChanged(), IsEmpty());
+  watcher.Watch(a);
+  Write("a.sv", "module a; endmodule");
+  EXPECT_THAT(watcher.TakeChanged(), ElementsAre(a));
+}
+
+TEST_P(FileWatcherTest, ReportsReplacedAndRemovedFiles) {
+  FileWatcher watcher(GetParam());
+  const std::string a = Write("a.sv", "module a;");
+  const std::string b = Write("b.sv", "module b;");
+  watcher.Watch(a);
+  watcher.Watch(b);
+
+  // Editors often write a new file, and rename it over the old one.
+  const std::string new_a = Write("a.sv.new", "module a; endmodule");
+  std::filesystem::rename(new_a, a);
+  std::filesystem::remove(b);
+  EXPECT_THAT(watcher.TakeChanged(), ElementsAre(a, b));
+}
+
+TEST_P(FileWatcherTest, IgnoresUnwatchedFiles) {
+  FileWatcher watcher(GetParam());
+  const std::string a = Write("a.sv", "module a;");
+  const std::string b = Write("b.sv", "module b;");
+  watcher.Watch(a);
+  watcher.Watch(b);
+  watcher.Unwatch(b);
+
+  Write("b.sv", "module b; endmodule");
+  Write("c.sv", "module c;");
+  EXPECT_THAT(watcher.TakeChanged(), IsEmpty());
+  EXPECT_EQ(watcher.size(), 1);
+}
+
+INSTANTIATE_TEST_SUITE_P(InotifyAndPolling, FileWatcherTest,
+                         ::testing::Bool());
+
+}  // namespace
+}  // namespace verilog
@@ -0,0 +1,69 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/tools/daemon/tool-flags.h"
+
+#include <string>
+#include <string_view>
+
+#include "absl/flags/commandlineflag.h"
+#include "absl/flags/reflection.h"
+#include "absl/status/status.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
+namespace verilog {
+
+// The files that define the lint and format flags. New flags in these files
+// are passed on without further ado.
+static constexpr std::string_view kToolFlagFiles[] = {
+    "verible/common/formatting/basic-format-style-init.cc",
+    "verible/verilog/analysis/top-modules-flag.cc",
+    "verible/verilog/analysis/verilog-linter.cc",
+    "verible/verilog/formatting/format-style-init.cc",
+};
+
+static bool IsToolFlag(const absl::CommandLineFlag &flag) {
+  const std::string filename = flag.Filename();
+  for (std::string_view file : kToolFlagFiles) {
+    if (absl::EndsWith(filename, file)) return true;
+  }
+  return false;
+}
+
+ToolFlags GetToolFlags() {
+  ToolFlags flags;
+  for (const auto &[name, flag] : absl::GetAllFlags()) {
+    if (IsToolFlag(*flag)) flags.emplace(name, flag->CurrentValue());
+  }
+  return flags;
+}
+
+absl::Status SetToolFlags(const ToolFlags &flags) {
+  for (const auto &[name, value] : flags) {
+    absl::CommandLineFlag *flag = absl::FindCommandLineFlag(name);
+    if (flag == nullptr || !IsToolFlag(*flag)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Not a lint or format flag: --", name));
+    }
+    std::string error;
+    if (!flag->ParseFrom(value, &error)) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid value for --", name, ": ", error));
+    }
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace verilog
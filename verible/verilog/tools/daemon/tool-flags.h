@@ -0,0 +1,41 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef VERIBLE_VERILOG_TOOLS_DAEMON_TOOL_FLAGS_H_
+#define VERIBLE_VERILOG_TOOLS_DAEMON_TOOL_FLAGS_H_
+
+#include <map>
+#include <string>
+
+#include "absl/status/status.h"
+
+namespace verilog {
+
+// Values of the flags that configure linting and formatting, by flag name.
+// These are the flags that the lint and format libraries define, like
+// --rules or --indentation_spaces; not those of the tools themselves.
+using ToolFlags = std::map<std::string, std::string>;
+
+// Returns the current values of the lint and format flags of this process.
+ToolFlags GetToolFlags();
+
+// Sets the lint and format flags of this process to "flags", e.g. as another
+// process returned them from GetToolFlags(). Flags that are not mentioned
+// keep their value. Other flags, and values that do not parse, are an error;
+// the flags before that are set nonetheless.
+absl::Status SetToolFlags(const ToolFlags &flags);
+
+}  // namespace verilog
+
+#endif  // VERIBLE_VERILOG_TOOLS_DAEMON_TOOL_FLAGS_H_
@@ -0,0 +1,75 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "verible/verilog/tools/daemon/tool-flags.h"
+
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/status/status.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+// From the format libraries.
+ABSL_DECLARE_FLAG(int, indentation_spaces);
+ABSL_DECLARE_FLAG(bool, try_wrap_long_lines);
+
+// Like the flags of the daemon itself.
+ABSL_FLAG(int, not_a_tool_flag, 0, "Only for this test.");
+
+namespace verilog {
+namespace {
+
+using ::testing::Contains;
+using ::testing::Key;
+using ::testing::Not;
+using ::testing::Pair;
+
+TEST(ToolFlagsTest, GetOnlyLintAndFormatFlags) {
+  const absl::FlagSaver restore_flags;
+  absl::SetFlag(&FLAGS_indentation_spaces, 3);
+  const ToolFlags flags = GetToolFlags();
+  EXPECT_THAT(flags, Contains(Pair("indentation_spaces", "3")));
+  EXPECT_THAT(flags, Contains(Pair("try_wrap_long_lines", "false")));
+  EXPECT_THAT(flags, Not(Contains(Key("not_a_tool_flag"))));
+}
+
+TEST(ToolFlagsTest, SetRoundTrips) {
+  const absl::FlagSaver restore_flags;
+  absl::SetFlag(&FLAGS_indentation_spaces, 4);
+  absl::SetFlag(&FLAGS_try_wrap_long_lines, true);
+  const ToolFlags client_flags = GetToolFlags();
+
+  absl::SetFlag(&FLAGS_indentation_spaces, 2);
+  absl::SetFlag(&FLAGS_try_wrap_long_lines, false);
+  EXPECT_TRUE(SetToolFlags(client_flags).ok());
+  EXPECT_EQ(absl::GetFlag(FLAGS_indentation_spaces), 4);
+  EXPECT_TRUE(absl::GetFlag(FLAGS_try_wrap_long_lines));
+  EXPECT_EQ(GetToolFlags(), client_flags);
+}
+
+TEST(ToolFlagsTest, SetRejectsOtherFlagsAndBadValues) {
+  const absl::FlagSaver restore_flags;
+  EXPECT_EQ(SetToolFlags({{"not_a_tool_flag", "1"}}).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(absl::GetFlag(FLAGS_not_a_tool_flag), 0);
+  EXPECT_EQ(SetToolFlags({{"no_such_flag", "1"}}).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(SetToolFlags({{"indentation_spaces", "many"}}).code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(absl::GetFlag(FLAGS_indentation_spaces), 2);
+}
+
+}  // namespace
+}  // namespace verilog
@@ -0,0 +1,346 @@
+// Copyright 2025 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// verible-verilog-daemon keeps Verilog files read and analyzed between runs
+// of lint, format and syntax checks, e.g. from editor integrations and
+// pre-commit hooks, which otherwise start from scratch every time.
+//
+// Example usage:
+//   verible-verilog-daemon serve &
+//   verible-verilog-daemon lint files...
+//   verible-verilog-daemon format --inplace files...
+//
+// The client commands send the request over a UNIX socket to the daemon,
+// with the lint and format flags of the client, and print what it answers.
+// If no daemon is running, they do the work themselves.
+
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/reflection.h"
+#include "absl/flags/usage.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "nlohmann/json.hpp"
+#include "verible/common/lsp/json-rpc-dispatcher.h"
+#include "verible/common/lsp/message-stream-splitter.h"
+#include "verible/common/util/init-command-line.h"
+#include "verible/verilog/tools/daemon/analysis-daemon.h"
+#include "verible/verilog/tools/daemon/tool-flags.h"
+
+ABSL_FLAG(std::string, socket, "",
+          "UNIX socket of the daemon. Default: "
+          "$XDG_RUNTIME_DIR/verible-verilog-daemon.socket, or "
+          "/tmp/verible-verilog-daemon-<uid>.socket without XDG_RUNTIME_DIR.");
+ABSL_FLAG(int, max_cached_files, 1000,
+          "serve: Maximum number of files the daemon keeps analyzed.");
+ABSL_FLAG(bool, inplace, false,
+          "format: If true, overwrite the files, like "
+          "verible-verilog-format --inplace.");
+ABSL_FLAG(bool, verify, false,
+          "format: If true, only tell which files need formatting, like "
+          "verible-verilog-format --verify.");
+
+using nlohmann::json;
+using verilog::AnalysisDaemon;
+using verilog::ToolOutput;
+
+static std::string SocketPath() {
+  const std::string flag = absl::GetFlag(FLAGS_socket);
+  if (!flag.empty()) return flag;
+  if (const char *runtime_dir = getenv("XDG_RUNTIME_DIR")) {
+    return absl::StrCat(runtime_dir, "/verible-verilog-daemon.socket");
+  }
+  return absl::StrCat("/tmp/verible-verilog-daemon-", getuid(), ".socket");
+}
+
+static std::optional<sockaddr_un> SocketAddress(const std::string &path) {
+  sockaddr_un address = {};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "Socket path too long: " << path << std::endl;
+    return std::nullopt;
+  }
+  memcpy(address.sun_path, path.c_str(), path.size() + 1);
+  return address;
+}
+
+// Returns the connection to the daemon, or -1 if none is running.
+static int Connect(const std::string &path) {
+  const std::optional<sockaddr_un> address = SocketAddress(path);
+  if (!address) return -1;
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  if (connect(fd, reinterpret_cast<const sockaddr *>(&*address),
+              sizeof(*address)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+// Writes a message with the header the MessageStreamSplitter expects.
+static bool WriteMessage(int fd, std::string_view body) {
+  const std::string message =
+      absl::StrCat("Content-Length: ", body.size(), "\r\n\r\n", body);
+  for (size_t written = 0; written < message.size();) {
+    const ssize_t w =
+        write(fd, message.data() + written, message.size() - written);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) return false;
+    written += w;
+  }
+  return true;
+}
+
+static json ToJson(const ToolOutput &output) {
+  return {
+      {"stdout", output.out},
+      {"stderr", output.err},
+      {"exitCode", output.exit_code},
+  };
+}
+
+// Changes the working directory while it exists.
+class ScopedWorkingDirectory {
+ public:
+  explicit ScopedWorkingDirectory(const std::string &dir)
+      : previous_(std::filesystem::current_path()) {
+    std::error_code error;
+    std::filesystem::current_path(dir, error);
+  }
+  ~ScopedWorkingDirectory() {
+    std::error_code error;
+    std::filesystem::current_path(previous_, error);
+  }
+
+ private:
+  const std::filesystem::path previous_;
+};
+
+// Runs the tool request "method", which the daemon or a client that could
+// not reach it handles alike.
+static ToolOutput RunToolRequest(AnalysisDaemon *daemon,
+                                 std::string_view method, const json &params) {
+  const std::string cwd = params.at("cwd");
+  // The lint and format flags of the client only apply to its request, and
+  // the paths in them, like --rules_config, are relative to its directory.
+  const absl::FlagSaver restore_flags;
+  const ScopedWorkingDirectory client_directory(cwd);
+  if (params.contains("flags")) {
+    const absl::Status status =
+        verilog::SetToolFlags(params["flags"].get<verilog::ToolFlags>());
+    if (!status.ok()) {
+      return {.err = absl::StrCat(status.message(), "\n"), .exit_code = 2};
+    }
+  }
+  const std::vector<std::string> files = params.at("files");
+  if (method == "lint") return daemon->Lint(cwd, files);
+  if (method == "syntax") return daemon->Syntax(cwd, files);
+  return daemon->Format(cwd, files,
+                        {.inplace = params.value("inplace", false),
+                         .verify = params.value("verify", false)});
+}
+
+static int Serve(const std::string &path) {
+  if (const int fd = Connect(path); fd >= 0) {
+    close(fd);
+    std::cerr << "A daemon is already serving " << path << std::endl;
+    return 1;
+  }
+  const std::optional<sockaddr_un> address = SocketAddress(path);
+  if (!address) return 1;
+  unlink(path.c_str());  // Left behind by a daemon that did not stop.
+  const int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  // Only this user may connect: requests read and write their files.
+  const mode_t previous_umask = umask(0077);
+  const bool listening =
+      listen_fd >= 0 &&
+      bind(listen_fd, reinterpret_cast<const sockaddr *>(&*address),
+           sizeof(*address)) == 0 &&
+      listen(listen_fd, 16) == 0;
+  umask(previous_umask);
+  if (!listening) {
+    std::cerr << "Can't listen on " << path << ": " << strerror(errno)
+              << std::endl;
+    return 1;
+  }
+  std::cerr << "Serving on " << path << std::endl;
+  signal(SIGPIPE, SIG_IGN);  // Clients that went away are no reason to stop.
+
+  AnalysisDaemon daemon(absl::GetFlag(FLAGS_max_cached_files));
+  bool stop = false;
+  // Clients are served one at a time, in the order they connect.
+  while (!stop) {
+    const int connection = accept(listen_fd, nullptr, nullptr);
+    if (connection < 0) {
+      if (errno == EINTR) continue;
+      std::cerr << "accept: " << strerror(errno) << std::endl;
+      break;
+    }
+    verible::lsp::JsonRpcDispatcher dispatcher(
+        [connection](std::string_view reply) {
+          WriteMessage(connection, reply);
+        });
+    for (const char *method : {"lint", "syntax", "format"}) {
+      dispatcher.AddRequestHandler(method, [&daemon, method](const json &p) {
+        return ToJson(RunToolRequest(&daemon, method, p));
+      });
+    }
+    dispatcher.AddRequestHandler("status", [&daemon](const json &) -> json {
+      return {
+          {"cachedFiles", daemon.cached_files()},
+          {"reads", daemon.reads()},
+          {"analyses", daemon.analyses()},
+      };
+    });
+    dispatcher.AddRequestHandler("shutdown", [&stop](const json &) {
+      stop = true;
+      return nullptr;
+    });
+
+    verible::lsp::MessageStreamSplitter splitter;
+    splitter.SetMessageProcessor(
+        [&dispatcher](std::string_view, std::string_view body) {
+          dispatcher.DispatchMessage(body);
+        });
+    // Until the client closes the connection.
+    while (splitter
+               .PullFrom([connection](char *buf, int size) -> int {
+                 return read(connection, buf, size);
+               })
+               .ok()) {
+    }
+    close(connection);
+  }
+  close(listen_fd);
+  unlink(path.c_str());
+  return stop ? 0 : 1;
+}
+
+// Sends the request to the daemon and returns the response, or nullopt if
+// no daemon is running.
+static std::optional<json> Request(std::string_view method,
+                                   const json &params) {
+  const int fd = Connect(SocketPath());
+  if (fd < 0) return std::nullopt;
+  const json request = {
+      {"jsonrpc", "2.0"}, {"id", 1}, {"method", method}, {"params", params}};
+  json response;
+  if (WriteMessage(fd, request.dump())) {
+    verible::lsp::MessageStreamSplitter splitter;
+    splitter.SetMessageProcessor([&](std::string_view, std::string_view body) {
+      response = json::parse(body);
+    });
+    while (response.is_null() && splitter
+                                     .PullFrom([fd](char *buf, int size) {
+                                       return read(fd, buf, size);
+                                     })
+                                     .ok()) {
+    }
+  }
+  close(fd);
+  if (response.is_null()) {
+    response = {{"error", {{"message", "No response from the daemon."}}}};
+  }
+  return response;
+}
+
+static int RunTool(std::string_view method,
+                   const std::vector<std::string> &files) {
+  json params = {
+      {"cwd", std::filesystem::current_path().string()},
+      {"files", files},
+      {"flags", verilog::GetToolFlags()},
+  };
+  if (absl::GetFlag(FLAGS_inplace)) params["inplace"] = true;
+  if (absl::GetFlag(FLAGS_verify)) params["verify"] = true;
+
+  ToolOutput output;
+  if (const std::optional<json> response = Request(method, params)) {
+    if (response->contains("error")) {
+      std::cerr << (*response)["error"].value("message", "") << std::endl;
+      return 2;
+    }
+    const json &result = (*response)["result"];
+    output = {.out = result.value("stdout", ""),
+              .err = result.value("stderr", ""),
+              .exit_code = result.value("exitCode", 2)};
+  } else {
+    // No daemon, so no files analyzed before; do the work here.
+    AnalysisDaemon local(files.size(), /*use_inotify=*/false);
+    output = RunToolRequest(&local, method, params);
+  }
+  std::cout << output.out << std::flush;
+  std::cerr << output.err << std::flush;
+  return output.exit_code;
+}
+
+int main(int argc, char **argv) {
+  const auto usage = absl::StrCat(
+      "usage: ", argv[0], " <command> [options] [<file>...]\n",
+      "Commands:\n"
+      "  serve             start the daemon\n"
+      "  lint <file>...    like verible-verilog-lint <file>...\n"
+      "  syntax <file>...  like verible-verilog-syntax <file>...\n"
+      "  format <file>...  like verible-verilog-format [--inplace] [--verify]\n"
+      "  status            print what the daemon keeps\n"
+      "  stop              stop the daemon");
+  const auto args = verible::InitCommandLine(usage, &argc, &argv);
+  if (args.size() < 2) {
+    std::cerr << absl::ProgramUsageMessage() << std::endl;
+    return 1;
+  }
+  const std::string_view command = args[1];
+  const std::vector<std::string> files(args.begin() + 2, args.end());
+
+  if (command == "serve") return Serve(SocketPath());
+  if (command == "lint" || command == "syntax" || command == "format") {
+    return RunTool(command, files);
+  }
+  if (command == "status" || command == "stop") {
+    const std::optional<json> response =
+        Request(command == "stop" ? "shutdown" : "status", json::object());
+    if (!response) {
+      std::cerr << "No daemon is serving " << SocketPath() << std::endl;
+      return 1;
+    }
+    if (response->contains("error")) {
+      std::cerr << (*response)["error"].value("message", "") << std::endl;
+      return 1;
+    }
+    if (command == "status") {
+      std::cout << (*response)["result"].dump(2) << std::endl;
+    }
+    return 0;
+  }
+  std::cerr << absl::ProgramUsageMessage() << std::endl;
+  return 1;
+}
@@ -12,8 +12,10 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <memory>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <vector>
 
 #include "absl/flags/flag.h"
@@ -23,6 +25,7 @@
 #include "verible/common/util/file-util.h"
 #include "verible/common/util/init-command-line.h"
 #include "verible/common/util/logging.h"
+#include "verible/verilog/analysis/verilog-filelist-loader.h"
 #include "verible/verilog/analysis/verilog-filelist.h"
 #include "verible/verilog/tools/kythe/kzip-creator.h"
 
@@ -51,7 +54,7 @@ Produces Kythe KZip from the given SystemVerilog source files.
 
 Input: A file which lists paths to the SystemVerilog top-level translation
        unit files (one per line; the path is relative to the location of the
-       file list).
+       file list).  It may include other file lists with "-f <path>".
 Output: Produces Kythe KZip (https://kythe.io/docs/kythe-kzip.html).
 )");
   const auto args = verible::InitCommandLine(usage, &argc, &argv);
@@ -67,18 +70,17 @@ Output: Produces Kythe KZip (https://kythe.io/docs/kythe-kzip.html).
     return 1;
   }
 
-  // Load file list.
-  const absl::StatusOr<std::string> filelist_content_or =
-      verible::file::GetContentAsString(filelist_path);
-  CHECK(filelist_content_or.ok())
-      << "Failed to open the file list at " << filelist_path;
-  verilog::FileList filelist;
-  if (auto status = verilog::AppendFileListFromContent(
-          filelist_path, *filelist_content_or, &filelist);
-      !status.ok()) {
-    LOG(ERROR) << "Filelist parse error " << status;
+  // Load file list, including nested file lists, without duplicates.
+  verilog::FileListLoader loader(
+      static_cast<int>(std::thread::hardware_concurrency()));
+  const absl::StatusOr<std::shared_ptr<const verilog::LoadedFileList>>
+      loaded_or = loader.Load(filelist_path);
+  if (!loaded_or.ok()) {
+    LOG(ERROR) << "Failed to load the file list at " << filelist_path << ": "
+               << loaded_or.status();
     return 1;
   }
+  verilog::FileList filelist = (*loaded_or)->file_list;
   // Normalize the file list
   std::string_view filelist_root = verible::file::Dirname(filelist_path);
   for (std::string &file_path : filelist.file_paths) {
@@ -19,6 +19,7 @@
 // verilog_lint files...
 
 #include <algorithm>
+#include <cstddef>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -29,15 +30,18 @@
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "verible/common/analysis/lint-rule-status.h"
 #include "verible/common/analysis/violation-handler.h"
 #include "verible/common/util/enum-flags.h"
+#include "verible/common/util/file-util.h"
 #include "verible/common/util/init-command-line.h"
 #include "verible/common/util/iterator-range.h"
 #include "verible/common/util/logging.h"  // for operator<<, LOG, LogMessage, etc
 #include "verible/verilog/analysis/verilog-linter-configuration.h"
 #include "verible/verilog/analysis/verilog-linter.h"
+#include "verible/verilog/analysis/verilog-variant-linter.h"
 
 // From least to most disruptive
 enum class AutofixMode {
@@ -96,6 +100,16 @@ ABSL_FLAG(bool, print_rules_file, false,
           "Print the current set of lint rules in a format that can be used to "
           "create a lint rules configuration file (i.e. .rules.verible_lint) "
           "and exit immediately.");
+ABSL_FLAG(bool, lint_variants, false,
+          "If true, lint every combination of `ifdef/`ifndef conditions "
+          "of each file, and report each violation once, with the "
+          "configurations it occurs in.");
+ABSL_FLAG(int, lint_variants_limit, 64,
+          "Maximum number of preprocessor configurations to lint per file "
+          "with --lint_variants.");
+ABSL_FLAG(int, lint_variants_threads, 4,
+          "Number of threads that lint preprocessor configurations "
+          "concurrently with --lint_variants.");
 ABSL_FLAG(bool, show_diagnostic_context, false,
           "prints an additional "
           "line on which the diagnostic was found,"
@@ -116,6 +130,57 @@ using verilog::LinterConfiguration;
 // LintOneFile returns 0, 1, or 2
 static const int kAutofixErrorExitStatus = 3;
 
+// Lints all preprocessor configurations of one file.
+// Returns an exit code like LintOneFile.
+static int LintOneFileVariants(std::string_view filename,
+                               const LinterConfiguration &config,
+                               verible::ViolationHandler *violation_handler) {
+  const absl::StatusOr<std::string> content_or =
+      verible::file::GetContentAsString(filename);
+  if (!content_or.ok()) {
+    LOG(ERROR) << "Can't read '" << filename
+               << "': " << content_or.status().message();
+    return 2;
+  }
+  const verilog::VariantLintOptions options{
+      .max_configurations = static_cast<size_t>(
+          std::max(1, absl::GetFlag(FLAGS_lint_variants_limit))),
+      .num_threads = absl::GetFlag(FLAGS_lint_variants_threads),
+  };
+  const auto result_or = verilog::LintPreprocessorVariants(
+      filename, *content_or, config, options);
+  if (!result_or.ok()) {
+    LOG(ERROR) << "Fatal error: " << result_or.status().message();
+    return 2;
+  }
+  const verilog::VariantLintResult &result = *result_or;
+  if (result.incomplete) {
+    std::cerr << filename << ": only the first " << options.max_configurations
+              << " preprocessor configurations were linted." << std::endl;
+  }
+
+  int exit_status = 0;
+  if (absl::GetFlag(FLAGS_check_syntax)) {
+    for (const auto &[configuration, messages] : result.syntax_errors) {
+      std::cout << filename << ": syntax errors in configuration {"
+                << result.configurations[configuration] << "}:" << std::endl;
+      for (const auto &message : messages) {
+        std::cout << message << std::endl;
+      }
+    }
+    if (!result.syntax_errors.empty() && absl::GetFlag(FLAGS_parse_fatal)) {
+      exit_status = 1;
+    }
+  }
+
+  const auto violations = verilog::GetSortedViolations(result.statuses);
+  if (!violations.empty()) {
+    violation_handler->HandleViolations(violations, *content_or, filename);
+    if (absl::GetFlag(FLAGS_lint_fatal)) exit_status = 1;
+  }
+  return exit_status;
+}
+
 int main(int argc, char **argv) {
   const auto usage =
       absl::StrCat("usage: ", argv[0], " [options] <file> [<file>...]");
@@ -228,6 +293,13 @@ int main(int argc, char **argv) {
     }
     const LinterConfiguration &config = *config_status;
 
+    if (absl::GetFlag(FLAGS_lint_variants)) {
+      exit_status = std::max(
+          LintOneFileVariants(filename, config, violation_handler.get()),
+          exit_status);
+      continue;
+    }
+
     const int lint_status = verilog::LintOneFile(
         &std::cout, filename, config, violation_handler.get(),
         absl::GetFlag(FLAGS_check_syntax), absl::GetFlag(FLAGS_parse_fatal),
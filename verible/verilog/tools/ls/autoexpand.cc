@@ -55,7 +55,9 @@
 #include "verible/verilog/CST/type.h"
 #include "verible/verilog/CST/verilog-matchers.h"  // IWYU pragma: keep
 #include "verible/verilog/CST/verilog-nonterminals.h"
+#include "verible/verilog/analysis/symbol-table.h"
 #include "verible/verilog/analysis/verilog-analyzer.h"
+#include "verible/verilog/analysis/verilog-project.h"
 #include "verible/verilog/formatting/format-style-init.h"
 #include "verible/verilog/formatting/format-style.h"
 #include "verible/verilog/formatting/formatter.h"
@@ -213,15 +215,135 @@ class AutoExpander {
     kCommaSeparatorExceptLast
   };
 
-  // Module information relevant to AUTO expansion
-  class Module {
+  // A module instance found in the syntax tree
+  struct Instance {
+    const verible::Symbol *symbol;             // The gate instance
+    std::optional<std::string_view> autoinst;  // Span of its AUTOINST comment
+  };
+
+  // A data declaration with a user-defined type, like module instances
+  struct TypedDeclaration {
+    std::string_view type_id;         // Name of the type
+    std::vector<Instance> instances;  // Instances declared with it
+  };
+
+  // What AUTO expansion reads from the syntax tree of a module. It does not
+  // change while AUTOs are expanded, so it is found once per version of the
+  // buffer, and each expansion starts from a copy of the declared ports.
+  // Everything but the ports is only needed for modules that are expanded,
+  // not for those that are only instantiated, and is found on first use.
+  class ModuleSummary {
    public:
-    explicit Module(const Symbol &module)
+    explicit ModuleSummary(const verible::Symbol &module)
         : symbol_(module), name_(GetModuleName(symbol_)->get().text()) {
       RetrieveModuleHeaderPorts();
       RetrieveModuleBodyPorts();
     }
 
+    // Returns the Symbol representing this module
+    const verible::Symbol &Symbol() const { return symbol_; }
+
+    // Returns the module name
+    std::string_view Name() const { return name_; }
+
+    // Returns the ports declared in the module header and body
+    const std::vector<Port> &Ports() const { return ports_; }
+
+    // Returns the AUTO_TEMPLATEs of the module
+    const Template::Map &Templates() const;
+
+    // Returns the data declarations with a user-defined type, in order
+    const std::vector<TypedDeclaration> &TypedDeclarations() const;
+
+    // Returns the names of declared nets and regs
+    const std::vector<std::string_view> &NetNames() const;
+    const std::vector<std::string_view> &RegNames() const;
+
+    // Returns the AUTOINPUT/AUTOINOUT/AUTOOUTPUT/AUTOWIRE/AUTOREG match of the
+    // given kind, if the module has one
+    const std::optional<Match> &FindAuto(AutoKind kind) const;
+
+   private:
+    //  Gets ports from the header of the module
+    void RetrieveModuleHeaderPorts();
+
+    // Gets ports from the body of the module
+    void RetrieveModuleBodyPorts();
+
+    // Store the given port in the internal vector
+    void PutDeclaredPort(const SyntaxTreeNode &port_node);
+
+    // The symbol that represents this module
+    const verible::Symbol &symbol_;
+
+    // The name of this module
+    const std::string_view name_;
+
+    // This module's declared ports
+    std::vector<Port> ports_;
+
+    // Found on first use
+    mutable std::optional<Template::Map> templates_;
+    mutable std::optional<std::vector<TypedDeclaration>> typed_declarations_;
+    mutable std::optional<std::vector<std::string_view>> net_names_;
+    mutable std::optional<std::vector<std::string_view>> reg_names_;
+    mutable absl::node_hash_map<AutoKind, std::optional<Match>> auto_matches_;
+  };
+
+  // Module summaries, shared by the expanders of a code action request.
+  // The summaries of the modules of the buffer can be kept for later
+  // requests, as long as the buffer does not change. Those of modules from
+  // other files can be kept until the symbol table handler may have parsed
+  // their files again, as told by its generation.
+  class SummaryCache {
+   public:
+    using SummaryMap =
+        absl::flat_hash_map<const verible::Symbol *,
+                            std::unique_ptr<const ModuleSummary>>;
+
+    // Summaries of modules from other files, by file
+    struct OtherFiles {
+      uint64_t generation = 0;
+      absl::flat_hash_map<const VerilogSourceFile *, SummaryMap> files;
+    };
+
+    // Counts the summaries made from syntax trees in "summaries_made", if
+    // given. Keeps the summaries of other files in "other_files", if given,
+    // so that they can be shared with the caches of other buffers.
+    explicit SummaryCache(size_t *summaries_made = nullptr,
+                          OtherFiles *other_files = nullptr)
+        : other_files_(other_files ? other_files : &own_other_files_),
+          summaries_made_(summaries_made) {}
+    SummaryCache(const SummaryCache &) = delete;
+    SummaryCache &operator=(const SummaryCache &) = delete;
+
+    // Returns the modules declared in the buffer, in order
+    const std::vector<const ModuleSummary *> &BufferModules(
+        const TextStructureView &text_structure);
+
+    // Returns the summary of the given module, from the buffer or from
+    // "file", while the symbol table handler is at "generation"
+    const ModuleSummary &Get(const verible::Symbol &module,
+                             const VerilogSourceFile *file,
+                             uint64_t generation);
+
+   private:
+    // Makes a new summary in the given map
+    const ModuleSummary &Add(const verible::Symbol &module, SummaryMap *map);
+
+    std::optional<std::vector<const ModuleSummary *>> buffer_modules_;
+    SummaryMap buffer_;
+    OtherFiles own_other_files_;
+    OtherFiles *other_files_;
+    size_t *summaries_made_;
+  };
+
+  // Module information relevant to AUTO expansion
+  class Module {
+   public:
+    explicit Module(const ModuleSummary &summary)
+        : summary_(summary), ports_(summary.Ports()) {}
+
     // Writes all port names that match the predicate to the output stream,
     // under the specified heading comment
     void EmitNonAnsiPortList(
@@ -270,9 +392,6 @@ class AutoExpander {
     // Sort ports by location in the source
     void SortPortsByLocation();
 
-    // Gets all AUTO_TEMPLATEs from the module
-    void RetrieveAutoTemplates();
-
     // Gets all dependencies of the module (modules instantiated within it)
     void RetrieveDependencies(
         const absl::node_hash_map<std::string_view, Module> &modules);
@@ -305,22 +424,16 @@ class AutoExpander {
       ports_.erase(it, ports_.end());
     }
 
+    // Returns what was found in the syntax tree of this module
+    const ModuleSummary &Summary() const { return summary_; }
+
     // Returns the Symbol representing this module
-    const verible::Symbol &Symbol() const { return symbol_; }
+    const verible::Symbol &Symbol() const { return summary_.Symbol(); }
 
     // Returns the module name
-    std::string_view Name() const { return name_; }
+    std::string_view Name() const { return summary_.Name(); }
 
    private:
-    //  Gets ports from the header of the module
-    void RetrieveModuleHeaderPorts();
-
-    // Gets ports from the body of the module
-    void RetrieveModuleBodyPorts();
-
-    // Store the given port in the internal vector
-    void PutDeclaredPort(const SyntaxTreeNode &port_node);
-
     // Recurses into dependencies to check if we depend on a given module.
     // Stores visited modules in a set to avoid infinite loops. For big
     // dependency graphs one should build a proper graph and do a
@@ -331,11 +444,8 @@ class AutoExpander {
     bool DependsOn(const Module *module,
                    absl::flat_hash_set<const Module *> *visited) const;
 
-    // The symbol that represents this module
-    const verible::Symbol &symbol_;
-
-    // The name of this module
-    const std::string_view name_;
+    // What was found in the syntax tree of this module
+    const ModuleSummary &summary_;
 
     // This module's ports
     std::vector<Port> ports_;
@@ -345,22 +455,21 @@ class AutoExpander {
 
     // This module's direct dependencies
     absl::flat_hash_set<const Module *> dependencies_;
-
-    // This module's AUTO_TEMPLATEs
-    Template::Map templates_;
   };
 
   AutoExpander(const TextStructureView &text_structure,
-               SymbolTableHandler *symbol_table_handler)
+               SymbolTableHandler *symbol_table_handler,
+               SummaryCache *summaries)
       : text_structure_(text_structure),
-        symbol_table_handler_(symbol_table_handler) {
+        symbol_table_handler_(symbol_table_handler),
+        summaries_(summaries) {
     expand_span_ = text_structure_.Contents();
   }
 
   AutoExpander(const TextStructureView &text_structure,
                SymbolTableHandler *symbol_table_handler,
-               Interval<size_t> line_range)
-      : AutoExpander(text_structure, symbol_table_handler) {
+               SummaryCache *summaries, Interval<size_t> line_range)
+      : AutoExpander(text_structure, symbol_table_handler, summaries) {
     size_t min = line_range.min < text_structure.Lines().size()
                      ? line_range.min
                      : text_structure.Lines().size() - 1;
@@ -375,8 +484,9 @@ class AutoExpander {
 
   AutoExpander(const TextStructureView &text_structure,
                SymbolTableHandler *symbol_table_handler,
+               SummaryCache *summaries,
                const absl::flat_hash_set<AutoKind> &allowed_autos)
-      : AutoExpander(text_structure, symbol_table_handler) {
+      : AutoExpander(text_structure, symbol_table_handler, summaries) {
     allowed_autos_ = allowed_autos;
   }
 
@@ -394,7 +504,7 @@ class AutoExpander {
 
   // Expands AUTOINST for the given module instance
   std::optional<Expansion> ExpandAutoinst(Module *module,
-                                          const Symbol &instance,
+                                          const Instance &instance,
                                           std::string_view type_id);
 
   // Expands AUTO<port-direction/data-type> for the given module
@@ -425,7 +535,7 @@ class AutoExpander {
   // Matches the given regex and erases ports from the module that are in the
   // match span
   std::optional<Match> FindMatchAndErasePorts(AutoExpander::Module *module,
-                                              AutoKind kind, const RE2 &re);
+                                              AutoKind kind);
 
   // Finds the span that should be replaced in the symbol (from the start of
   // the comment span to the end of the symbol span. Used by AUTOARG and
@@ -450,6 +560,9 @@ class AutoExpander {
   // Symbol table wrapper for the language server
   SymbolTableHandler *symbol_table_handler_;
 
+  // What was found in the syntax trees of modules
+  SummaryCache *summaries_;
+
   // Gathered module information (module name -> module info)
   absl::node_hash_map<std::string_view, Module> modules_;
 
@@ -733,10 +846,7 @@ bool SpansOverlapping(const std::string_view first,
 void AutoExpander::Module::EmitUndeclaredWireDeclarations(
     std::ostream &output, const std::string_view auto_span) const {
   absl::flat_hash_set<std::string_view> declared_wires;
-  for (const auto &reg : FindAllNetVariables(symbol_)) {
-    const SyntaxTreeLeaf *const net_name_leaf =
-        GetNameLeafOfNetVariable(*reg.match);
-    const std::string_view net_name = net_name_leaf->get().text();
+  for (const std::string_view net_name : summary_.NetNames()) {
     if (!SpansOverlapping(net_name, auto_span)) {
       declared_wires.insert(net_name);
     }
@@ -765,10 +875,7 @@ void AutoExpander::Module::EmitUndeclaredWireDeclarations(
 void AutoExpander::Module::EmitUnconnectedOutputRegDeclarations(
     std::ostream &output, const std::string_view auto_span) const {
   absl::flat_hash_set<std::string_view> declared_regs;
-  for (const auto &reg : FindAllRegisterVariables(symbol_)) {
-    const SyntaxTreeLeaf *const reg_name_leaf =
-        GetNameLeafOfRegisterVariable(*reg.match);
-    const std::string_view reg_name = reg_name_leaf->get().text();
+  for (const std::string_view reg_name : summary_.RegNames()) {
     if (!SpansOverlapping(reg_name, auto_span)) {
       declared_regs.insert(reg_name);
     }
@@ -859,7 +966,33 @@ void AutoExpander::Module::SortPortsByLocation() {
       [](const Port &left, const Port &right) { return left.it < right.it; });
 }
 
-void AutoExpander::Module::RetrieveAutoTemplates() {
+// Does a regex search in the span of the given symbol, returns match
+std::optional<AutoExpander::Match> FindMatchInSymbol(const Symbol &symbol,
+                                                     const RE2 &re) {
+  const std::string_view symbol_span = StringSpanOfSymbol(symbol);
+  std::string_view match;
+  std::string_view comment;
+  if (RE2::PartialMatch(symbol_span, re, &match, &comment)) {
+    return AutoExpander::Match{.auto_span = match, .comment_span = comment};
+  }
+  return std::nullopt;
+}
+
+// Does a regex search in the span of the given symbol, returns matched span
+std::optional<std::string_view> FindSpanInSymbol(const Symbol &symbol,
+                                                 const RE2 &re) {
+  const std::string_view symbol_span = StringSpanOfSymbol(symbol);
+  std::string_view match;
+  if (RE2::PartialMatch(symbol_span, re, &match)) {
+    return match;
+  }
+  return std::nullopt;
+}
+
+const AutoExpander::Template::Map &AutoExpander::ModuleSummary::Templates()
+    const {
+  if (templates_) return *templates_;
+  templates_.emplace();
   std::string_view autotmpl_search_span = StringSpanOfSymbol(symbol_);
   std::string_view autotmpl_span;
   std::string_view autotmpl_inst_name;
@@ -891,20 +1024,126 @@ void AutoExpander::Module::RetrieveAutoTemplates() {
     std::string_view instance_type_name;
     while (RE2::FindAndConsume(&autotmpl_type_search_span,
                                *autotemplate_type_re_, &instance_type_name)) {
-      templates_[instance_type_name].push_back(tmpl);
+      (*templates_)[instance_type_name].push_back(tmpl);
     }
   }
+  return *templates_;
 }
 
-void AutoExpander::Module::RetrieveDependencies(
-    const absl::node_hash_map<std::string_view, Module> &modules) {
+const std::vector<AutoExpander::TypedDeclaration>
+    &AutoExpander::ModuleSummary::TypedDeclarations() const {
+  if (typed_declarations_) return *typed_declarations_;
+  typed_declarations_.emplace();
   for (const auto &data : FindAllDataDeclarations(symbol_)) {
     const verible::Symbol *const type_id_node =
         GetTypeIdentifierFromDataDeclaration(*data.match);
     // Some data declarations do not have a type id, ignore those
     if (!type_id_node) continue;
-    const std::string_view dependency_name = StringSpanOfSymbol(*type_id_node);
-    const auto it = modules.find(dependency_name);
+    TypedDeclaration &declaration = typed_declarations_->emplace_back();
+    declaration.type_id = StringSpanOfSymbol(*type_id_node);
+    for (const auto &instance : FindAllGateInstances(*data.match)) {
+      Instance &found = declaration.instances.emplace_back();
+      found.symbol = instance.match;
+      const SyntaxTreeNode *const parens =
+          GetParenGroupFromModuleInstantiation(*instance.match);
+      if (parens) found.autoinst = FindSpanInSymbol(*parens, *autoinst_re_);
+    }
+  }
+  return *typed_declarations_;
+}
+
+const std::vector<std::string_view> &AutoExpander::ModuleSummary::NetNames()
+    const {
+  if (net_names_) return *net_names_;
+  net_names_.emplace();
+  for (const auto &net : FindAllNetVariables(symbol_)) {
+    net_names_->push_back(GetNameLeafOfNetVariable(*net.match)->get().text());
+  }
+  return *net_names_;
+}
+
+const std::vector<std::string_view> &AutoExpander::ModuleSummary::RegNames()
+    const {
+  if (reg_names_) return *reg_names_;
+  reg_names_.emplace();
+  for (const auto &reg : FindAllRegisterVariables(symbol_)) {
+    reg_names_->push_back(
+        GetNameLeafOfRegisterVariable(*reg.match)->get().text());
+  }
+  return *reg_names_;
+}
+
+const std::optional<AutoExpander::Match> &
+AutoExpander::ModuleSummary::FindAuto(const AutoKind kind) const {
+  const auto found = auto_matches_.find(kind);
+  if (found != auto_matches_.end()) return found->second;
+  const RE2 *re = nullptr;
+  switch (kind) {
+    case AutoKind::kAutoinput:
+      re = &*autoinput_re_;
+      break;
+    case AutoKind::kAutoinout:
+      re = &*autoinout_re_;
+      break;
+    case AutoKind::kAutooutput:
+      re = &*autooutput_re_;
+      break;
+    case AutoKind::kAutowire:
+      re = &*autowire_re_;
+      break;
+    case AutoKind::kAutoreg:
+      re = &*autoreg_re_;
+      break;
+    default:
+      LOG(ERROR) << "Not a module-wide AUTO";
+      break;
+  }
+  std::optional<Match> &match = auto_matches_[kind];
+  if (re) match = FindMatchInSymbol(symbol_, *re);
+  return match;
+}
+
+const std::vector<const AutoExpander::ModuleSummary *>
+    &AutoExpander::SummaryCache::BufferModules(
+        const TextStructureView &text_structure) {
+  if (buffer_modules_) return *buffer_modules_;
+  buffer_modules_.emplace();
+  for (const auto &mod_decl :
+       FindAllModuleDeclarations(*text_structure.SyntaxTree())) {
+    buffer_modules_->push_back(&Add(*mod_decl.match, &buffer_));
+  }
+  return *buffer_modules_;
+}
+
+const AutoExpander::ModuleSummary &AutoExpander::SummaryCache::Get(
+    const verible::Symbol &module, const VerilogSourceFile *file,
+    uint64_t generation) {
+  const auto in_buffer = buffer_.find(&module);
+  if (in_buffer != buffer_.end()) return *in_buffer->second;
+  // The symbol table is only built again before the first definition of a
+  // request is looked up, so no summary of this request is dropped.
+  if (other_files_->generation != generation) {
+    other_files_->files.clear();
+    other_files_->generation = generation;
+  }
+  SummaryMap &file_summaries = other_files_->files[file];
+  const auto in_other_file = file_summaries.find(&module);
+  if (in_other_file != file_summaries.end()) return *in_other_file->second;
+  return Add(module, &file_summaries);
+}
+
+const AutoExpander::ModuleSummary &AutoExpander::SummaryCache::Add(
+    const verible::Symbol &module, SummaryMap *map) {
+  if (summaries_made_) ++*summaries_made_;
+  auto &summary = (*map)[&module];
+  summary = std::make_unique<const ModuleSummary>(module);
+  return *summary;
+}
+
+void AutoExpander::Module::RetrieveDependencies(
+    const absl::node_hash_map<std::string_view, Module> &modules) {
+  for (const TypedDeclaration &declaration : summary_.TypedDeclarations()) {
+    const auto it = modules.find(declaration.type_id);
     if (it != modules.end()) {
       dependencies_.insert(&it->second);
     }
@@ -914,8 +1153,9 @@ void AutoExpander::Module::RetrieveDependencies(
 const AutoExpander::Template *AutoExpander::Module::GetAutoTemplate(
     const std::string_view type_id, const std::string_view instance_name,
     const std::string_view::const_iterator instance_it) const {
-  const auto it = templates_.find(type_id);
-  if (it == templates_.end()) return nullptr;
+  const Template::Map &templates = summary_.Templates();
+  const auto it = templates.find(type_id);
+  if (it == templates.end()) return nullptr;
   const Template *matching_tmpl = nullptr;
   // Linear search for the matching template (there should be very few
   // templates per type, often just one)
@@ -948,7 +1188,7 @@ void AutoExpander::Module::EmitPortDeclarations(
   }
 }
 
-void AutoExpander::Module::RetrieveModuleHeaderPorts() {
+void AutoExpander::ModuleSummary::RetrieveModuleHeaderPorts() {
   const auto module_ports = GetModulePortDeclarationList(symbol_);
   if (!module_ports) return;
   for (const SymbolPtr &port : module_ports->children()) {
@@ -961,7 +1201,7 @@ void AutoExpander::Module::RetrieveModuleHeaderPorts() {
   }
 }
 
-void AutoExpander::Module::RetrieveModuleBodyPorts() {
+void AutoExpander::ModuleSummary::RetrieveModuleBodyPorts() {
   for (const auto &port : FindAllModulePortDeclarations(symbol_)) {
     PutDeclaredPort(SymbolCastToNode(*port.match));
   }
@@ -1007,7 +1247,8 @@ std::vector<AutoExpander::Dimension> GetDimensionsFromNodes(
   return dimensions;
 }
 
-void AutoExpander::Module::PutDeclaredPort(const SyntaxTreeNode &port_node) {
+void AutoExpander::ModuleSummary::PutDeclaredPort(
+    const SyntaxTreeNode &port_node) {
   const NodeEnum tag = NodeEnum(port_node.Tag().tag);
   const SyntaxTreeLeaf *const dir_leaf =
       tag == NodeEnum::kPortDeclaration
@@ -1113,29 +1354,6 @@ absl::flat_hash_set<std::string_view> AutoExpander::GetPortsConnectedBefore(
   return ports_before;
 }
 
-// Does a regex search in the span of the given symbol, returns match
-std::optional<AutoExpander::Match> FindMatchInSymbol(const Symbol &symbol,
-                                                     const RE2 &re) {
-  const std::string_view symbol_span = StringSpanOfSymbol(symbol);
-  std::string_view match;
-  std::string_view comment;
-  if (RE2::PartialMatch(symbol_span, re, &match, &comment)) {
-    return AutoExpander::Match{.auto_span = match, .comment_span = comment};
-  }
-  return std::nullopt;
-}
-
-// Does a regex search in the span of the given symbol, returns matched span
-std::optional<std::string_view> FindSpanInSymbol(const Symbol &symbol,
-                                                 const RE2 &re) {
-  const std::string_view symbol_span = StringSpanOfSymbol(symbol);
-  std::string_view match;
-  if (RE2::PartialMatch(symbol_span, re, &match)) {
-    return match;
-  }
-  return std::nullopt;
-}
-
 // Returns the deepest node that contains the given span
 const Symbol *FindNodeContainingSpan(const Symbol &root,
                                      const std::string_view span) {
@@ -1205,12 +1423,13 @@ bool IsSpanDirectlyUnderPortActualList(const Symbol &instance_parens,
 }
 
 std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutoinst(
-    Module *module, const Symbol &instance, std::string_view type_id) {
+    Module *module, const Instance &inst, std::string_view type_id) {
   if (!ShouldExpand(AutoKind::kAutoinst)) return std::nullopt;
+  const std::optional<std::string_view> &auto_span = inst.autoinst;
+  if (!auto_span) return std::nullopt;
+  const Symbol &instance = *inst.symbol;
   const SyntaxTreeNode *parens = GetParenGroupFromModuleInstantiation(instance);
 
-  auto auto_span = FindSpanInSymbol(*parens, *autoinst_re_);
-  if (!auto_span) return std::nullopt;
   auto replaced_span = FindSpanToReplace(*parens, *auto_span);
   if (!replaced_span) return std::nullopt;
   if (!IsSpanDirectlyUnderPortActualList(*parens, *auto_span)) {
@@ -1218,8 +1437,10 @@ std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutoinst(
     return std::nullopt;
   }
 
+  const SymbolTableNode *const type_node =
+      symbol_table_handler_->FindDefinitionNode(type_id);
   const Symbol *const type_def =
-      symbol_table_handler_->FindDefinitionSymbol(type_id);
+      type_node ? type_node->Value().syntax_origin : nullptr;
   if (!type_def) {
     LOG(ERROR) << "AUTOINST: No definition found for module type: " << type_id;
     return std::nullopt;
@@ -1231,7 +1452,10 @@ std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutoinst(
     return std::nullopt;
   }
   if (!modules_.contains(type_id)) {
-    modules_.insert(std::make_pair(type_id, Module(*type_def)));
+    modules_.insert(std::make_pair(
+        type_id, Module(summaries_->Get(*type_def,
+                                        type_node->Value().file_origin,
+                                        symbol_table_handler_->generation()))));
   }
   const Module &inst_module = modules_.at(type_id);
 
@@ -1379,7 +1603,7 @@ std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutoPorts(
 std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutowire(
     const Module &module) const {
   if (!ShouldExpand(AutoKind::kAutowire)) return std::nullopt;
-  const auto match = FindMatchInSymbol(module.Symbol(), *autowire_re_);
+  const auto &match = module.Summary().FindAuto(AutoKind::kAutowire);
   if (!match) return std::nullopt;
   if (!SpansOverlapping(match->auto_span, expand_span_)) {
     return std::nullopt;
@@ -1398,7 +1622,7 @@ std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutowire(
 std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutoreg(
     const Module &module) const {
   if (!ShouldExpand(AutoKind::kAutoreg)) return std::nullopt;
-  const auto match = FindMatchInSymbol(module.Symbol(), *autoreg_re_);
+  const auto &match = module.Summary().FindAuto(AutoKind::kAutoreg);
   if (!match) return std::nullopt;
   if (!SpansOverlapping(match->auto_span, expand_span_)) {
     return std::nullopt;
@@ -1415,9 +1639,9 @@ std::optional<AutoExpander::Expansion> AutoExpander::ExpandAutoreg(
 }
 
 std::optional<AutoExpander::Match> AutoExpander::FindMatchAndErasePorts(
-    AutoExpander::Module *module, const AutoKind kind, const RE2 &re) {
+    AutoExpander::Module *module, const AutoKind kind) {
   if (!ShouldExpand(kind)) return std::nullopt;
-  const auto match = FindMatchInSymbol(module->Symbol(), re);
+  const auto &match = module->Summary().FindAuto(kind);
   if (match) {
     if (SpansOverlapping(StringSpanOfSymbol(module->Symbol()),
                          match->auto_span)) {
@@ -1453,9 +1677,9 @@ std::vector<AutoExpander::Expansion> AutoExpander::Expand() {
   }
   std::vector<Module *> buffer_modules;  // Ordered list of all modules
                                          // in the buffer being modified
-  for (const auto &mod_decl :
-       FindAllModuleDeclarations(*text_structure_.SyntaxTree())) {
-    Module module(*mod_decl.match);
+  for (const ModuleSummary *summary :
+       summaries_->BufferModules(text_structure_)) {
+    Module module(*summary);
     buffer_modules.push_back(
         &modules_.insert(std::make_pair(module.Name(), std::move(module)))
              .first->second);
@@ -1474,22 +1698,17 @@ std::vector<AutoExpander::Expansion> AutoExpander::Expand() {
     // the module, as they should be regenerated every time (in case they get
     // removed or their names change)
     const auto autoinput_match =
-        FindMatchAndErasePorts(module, AutoKind::kAutoinput, *autoinput_re_);
+        FindMatchAndErasePorts(module, AutoKind::kAutoinput);
     const auto autoinout_match =
-        FindMatchAndErasePorts(module, AutoKind::kAutoinout, *autoinout_re_);
+        FindMatchAndErasePorts(module, AutoKind::kAutoinout);
     const auto autooutput_match =
-        FindMatchAndErasePorts(module, AutoKind::kAutooutput, *autooutput_re_);
+        FindMatchAndErasePorts(module, AutoKind::kAutooutput);
     // Do AUTOINST expansion
-    module->RetrieveAutoTemplates();
-    for (const auto &data : FindAllDataDeclarations(module->Symbol())) {
-      const Symbol *const type_id_node =
-          GetTypeIdentifierFromDataDeclaration(*data.match);
-      // Some data declarations do not have a type id, ignore those
-      if (!type_id_node) continue;
-      const std::string_view type_id = StringSpanOfSymbol(*type_id_node);
-      for (const auto &instance : FindAllGateInstances(*data.match)) {
+    for (const TypedDeclaration &declaration :
+         module->Summary().TypedDeclarations()) {
+      for (const Instance &instance : declaration.instances) {
         if (const auto expansion =
-                ExpandAutoinst(module, *instance.match, type_id)) {
+                ExpandAutoinst(module, instance, declaration.type_id)) {
           expansions.push_back(*expansion);
         }
       }
@@ -1684,21 +1903,42 @@ std::vector<TextEdit> ConvertAutoExpansionsToFormattedTextEdits(
 
 }  // namespace
 
-std::vector<CodeAction> GenerateAutoExpandCodeActions(
+// Kept for each buffer whose code actions were requested
+struct AutoExpandCache::BufferSummaries {
+  BufferSummaries(size_t *summaries_made,
+                  AutoExpander::SummaryCache::OtherFiles *other_files)
+      : summaries(summaries_made, other_files) {}
+
+  // Holds on to the syntax tree the summaries point into
+  std::shared_ptr<const ParsedBuffer> buffer;
+  AutoExpander::SummaryCache summaries;
+};
+
+// Shared by the buffers
+struct AutoExpandCache::OtherFileSummaries {
+  AutoExpander::SummaryCache::OtherFiles summaries;
+};
+
+AutoExpandCache::AutoExpandCache()
+    : other_files_(std::make_unique<OtherFileSummaries>()) {}
+AutoExpandCache::~AutoExpandCache() = default;
+
+void AutoExpandCache::Remove(const std::string &uri) { buffers_.erase(uri); }
+
+namespace {
+// Generates the code actions for the given buffer contents, from the given
+// module summaries
+std::vector<CodeAction> GenerateCodeActionsFromSummaries(
     SymbolTableHandler *symbol_table_handler,
-    const BufferTracker *const tracker, const CodeActionParams &p) {
-  Interval<size_t> line_range{static_cast<size_t>(p.range.start.line),
-                              static_cast<size_t>(p.range.end.line)};
-  if (!line_range.valid()) return {};
-  if (!tracker) return {};
-  const auto current = tracker->current();
-  if (!current) return {};  // Can only expand if we have latest version
-  const TextStructureView &text_structure = current->parser().Data();
-  AutoExpander range_expander(text_structure, symbol_table_handler, line_range);
+    const TextStructureView &text_structure,
+    AutoExpander::SummaryCache *summaries, Interval<size_t> line_range,
+    const CodeActionParams &p) {
+  AutoExpander range_expander(text_structure, symbol_table_handler, summaries,
+                              line_range);
   const auto &auto_kinds = range_expander.FindAutoKinds();
   if (auto_kinds.empty()) return {};
 
-  AutoExpander full_expander(text_structure, symbol_table_handler);
+  AutoExpander full_expander(text_structure, symbol_table_handler, summaries);
   const auto &expansions_full = full_expander.Expand();
   if (expansions_full.empty()) return {};
   std::vector<CodeAction> result;
@@ -1725,7 +1965,8 @@ std::vector<CodeAction> GenerateAutoExpandCodeActions(
                                 text_structure, expansions_range)}}},
   });
 
-  AutoExpander kind_expander(text_structure, symbol_table_handler, auto_kinds);
+  AutoExpander kind_expander(text_structure, symbol_table_handler, summaries,
+                             auto_kinds);
   const auto &expansions_kind = kind_expander.Expand();
   if (expansions_kind.empty() ||
       expansions_kind.size() == expansions_range.size()) {
@@ -1743,4 +1984,37 @@ std::vector<CodeAction> GenerateAutoExpandCodeActions(
   return result;
 }
 
+}  // namespace
+
+std::vector<CodeAction> GenerateAutoExpandCodeActions(
+    SymbolTableHandler *symbol_table_handler,
+    const BufferTracker *const tracker, const CodeActionParams &p,
+    AutoExpandCache *cache) {
+  Interval<size_t> line_range{static_cast<size_t>(p.range.start.line),
+                              static_cast<size_t>(p.range.end.line)};
+  if (!line_range.valid()) return {};
+  if (!tracker) return {};
+  const auto current = tracker->current();
+  if (!current) return {};  // Can only expand if we have latest version
+  const TextStructureView &text_structure = current->parser().Data();
+  if (!cache) {
+    AutoExpander::SummaryCache summaries;
+    return GenerateCodeActionsFromSummaries(
+        symbol_table_handler, text_structure, &summaries, line_range, p);
+  }
+
+  auto found = cache->buffers_.find(current->uri());
+  if (found == cache->buffers_.end() || found->second->buffer != current) {
+    auto buffer_summaries = std::make_unique<AutoExpandCache::BufferSummaries>(
+        &cache->summaries_made_, &cache->other_files_->summaries);
+    buffer_summaries->buffer = current;
+    found = cache->buffers_.insert_or_assign(current->uri(),
+                                             std::move(buffer_summaries))
+                .first;
+  }
+  return GenerateCodeActionsFromSummaries(symbol_table_handler, text_structure,
+                                          &found->second->summaries,
+                                          line_range, p);
+}
+
 }  // namespace verilog
@@ -16,8 +16,13 @@
 #ifndef VERILOG_TOOLS_LS_AUTOEXPAND_H
 #define VERILOG_TOOLS_LS_AUTOEXPAND_H
 
+#include <cstddef>
+#include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+
 #include "verible/common/lsp/lsp-protocol.h"
 #include "verible/verilog/tools/ls/lsp-parse-buffer.h"
 #include "verible/verilog/tools/ls/symbol-table-handler.h"
@@ -25,10 +30,47 @@
 // Functions for Emacs' Verilog-Mode-style AUTO expansion.
 
 namespace verilog {
-// Generate AUTO expansion code actions for the given code action params
+class AutoExpandCache;
+
+// Generate AUTO expansion code actions for the given code action params.
+// If a cache is given, what is found in the syntax trees of the modules of
+// the buffer is kept there for later requests of the same buffer version,
+// and that of the instantiated modules of other files until the generation
+// of the symbol table handler changes.
 std::vector<verible::lsp::CodeAction> GenerateAutoExpandCodeActions(
     SymbolTableHandler *symbol_table_handler, const BufferTracker *tracker,
-    const verible::lsp::CodeActionParams &p);
+    const verible::lsp::CodeActionParams &p, AutoExpandCache *cache = nullptr);
+
+// Ports, instances and AUTO_TEMPLATEs of the modules of open buffers, and of
+// the modules they instantiate.
+// Editors request code actions whenever the cursor moves, and finding these
+// in the syntax tree for each request gets slow with large modules.
+class AutoExpandCache {
+ public:
+  AutoExpandCache();
+  AutoExpandCache(const AutoExpandCache &) = delete;
+  AutoExpandCache &operator=(const AutoExpandCache &) = delete;
+  ~AutoExpandCache();
+
+  // Forgets the buffer "uri", e.g. because it changed or was closed.
+  void Remove(const std::string &uri);
+
+  // Number of modules whose syntax tree was searched so far.
+  size_t summaries_made() const { return summaries_made_; }
+
+ private:
+  friend std::vector<verible::lsp::CodeAction> GenerateAutoExpandCodeActions(
+      SymbolTableHandler *, const BufferTracker *,
+      const verible::lsp::CodeActionParams &, AutoExpandCache *);
+
+  struct BufferSummaries;
+  struct OtherFileSummaries;
+
+  absl::flat_hash_map<std::string, std::unique_ptr<BufferSummaries>> buffers_;
+  // Modules from files other than the buffers, e.g. instantiated ones.
+  std::unique_ptr<OtherFileSummaries> other_files_;
+  size_t summaries_made_ = 0;
+};
 
 }  // namespace verilog
 #endif  // VERILOG_TOOLS_LS_AUTOEXPAND_H
@@ -3790,5 +3790,82 @@ endmodule
   );
 }
 
+TEST(Autoexpand, CacheSummariesOfBufferVersion) {
+  const std::shared_ptr<VerilogProject> proj =
+      std::make_shared<VerilogProject>(".", std::vector<std::string>());
+  proj->AddVirtualFile("<<project-file>>", R"(
+module bar (
+    input i1,
+    output o1
+);
+endmodule
+)");
+  EditTextBuffer buffer(R"(
+module foo (  /*AUTOARG*/);
+  /*AUTOINPUT*/
+  /*AUTOOUTPUT*/
+  bar b1 (  /*AUTOINST*/);
+  bar b2 (  /*AUTOINST*/);
+endmodule
+module qux (  /*AUTOARG*/);
+  input clk;
+endmodule
+)");
+  BufferTracker tracker;
+  tracker.Update("<<tested-file>>", buffer);
+  SymbolTableHandler symbol_table_handler;
+  symbol_table_handler.SetProject(proj);
+  symbol_table_handler.UpdateFileContent("<<tested-file>>",
+                                         &tracker.current()->parser());
+  symbol_table_handler.BuildProjectSymbolTable();
+
+  const CodeActionParams p = {.textDocument = {"<<tested-file>>"},
+                              .range = {.start = {.line = 4},
+                                        .end = {.line = 4}}};
+  const nlohmann::json uncached =
+      GenerateAutoExpandCodeActions(&symbol_table_handler, &tracker, p);
+  ASSERT_EQ(uncached.size(), 3);
+
+  // The modules of the buffer, and the one from the project file.
+  AutoExpandCache cache;
+  EXPECT_EQ(nlohmann::json(GenerateAutoExpandCodeActions(
+                &symbol_table_handler, &tracker, p, &cache)),
+            uncached);
+  EXPECT_EQ(cache.summaries_made(), 3);
+
+  // Nothing is searched again while the symbol table stays the same.
+  EXPECT_EQ(nlohmann::json(GenerateAutoExpandCodeActions(
+                &symbol_table_handler, &tracker, p, &cache)),
+            uncached);
+  EXPECT_EQ(cache.summaries_made(), 3);
+
+  // A new version of the buffer is searched again, and so is the project
+  // file, as the symbol table is built again.
+  buffer.ApplyChange(TextDocumentContentChangeEvent{
+      .range = {.start = {.line = 8, .character = 8},
+                .end = {.line = 8, .character = 11}},
+      .has_range = true,
+      .text = "rst"});
+  tracker.Update("<<tested-file>>", buffer);
+  symbol_table_handler.UpdateFileContent("<<tested-file>>",
+                                         &tracker.current()->parser());
+  const nlohmann::json changed =
+      GenerateAutoExpandCodeActions(&symbol_table_handler, &tracker, p);
+  EXPECT_NE(changed, uncached);
+  EXPECT_EQ(nlohmann::json(GenerateAutoExpandCodeActions(
+                &symbol_table_handler, &tracker, p, &cache)),
+            changed);
+  EXPECT_EQ(cache.summaries_made(), 6);
+
+  // The project file is kept for other versions of the buffer.
+  cache.Remove("<<tested-file>>");
+  GenerateAutoExpandCodeActions(&symbol_table_handler, &tracker, p, &cache);
+  EXPECT_EQ(cache.summaries_made(), 8);
+
+  symbol_table_handler.BuildProjectSymbolTable();
+  GenerateAutoExpandCodeActions(&symbol_table_handler, &tracker, p, &cache);
+  EXPECT_EQ(cache.summaries_made(), 9);
+}
+
 }  // namespace
 }  // namespace verilog
@@ -0,0 +1,190 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/completion-index.h"
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "verible/common/text/macro-definition-registry.h"
+#include "verible/verilog/analysis/symbol-table.h"
+#include "verible/verilog/analysis/verilog-project.h"
+
+namespace verilog {
+
+static bool EntryLess(const CompletionIndex::Entry &a,
+                      const CompletionIndex::Entry &b) {
+  return a.name < b.name;
+}
+
+// Collects the names declared in "node", and in the named scopes below it.
+// If "only_file" is given, only names from that file are collected.
+static void CollectEntries(
+    const SymbolTableNode &node, const std::string &scope,
+    const std::string_view *only_file,
+    std::map<std::string, std::vector<CompletionIndex::Entry>> *entries) {
+  for (const auto &[name, child] : node.Children()) {
+    // Anonymous scopes start with a character that no identifier starts
+    // with.  The names in them can not be referenced from outside, except
+    // for enum constants, which are also declared in the enclosing scope.
+    if (name.empty() || name.front() == '%') continue;
+    const SymbolInfo &info = child.Value();
+    if (info.file_origin == nullptr) continue;
+    const std::string_view file = info.file_origin->ReferencedPath();
+    if (only_file == nullptr || file == *only_file) {
+      CompletionIndex::Entry entry{
+          .name = std::string(name),
+          .metatype = info.metatype,
+          .is_port = info.is_port_identifier,
+          .file = std::string(file),
+      };
+      const ReferenceComponentNode *type = info.declared_type.user_defined_type;
+      if (type != nullptr && !type->Value().identifier.empty() &&
+          type->Value().identifier.front() != '%') {
+        entry.type_name = std::string(type->Value().identifier);
+      }
+      (*entries)[scope].push_back(std::move(entry));
+    }
+    if (!child.Children().empty()) {
+      CollectEntries(child,
+                     scope.empty() ? std::string(name)
+                                   : absl::StrCat(scope, "::", name),
+                     only_file, entries);
+    }
+  }
+}
+
+void CompletionIndex::IndexSymbolTable(const SymbolTable &symbol_table) {
+  // Forget all but the macros.
+  for (auto it = scopes_.begin(); it != scopes_.end();) {
+    if (it->first == kMacroScope) {
+      ++it;
+      continue;
+    }
+    size_ -= it->second.size();
+    it = scopes_.erase(it);
+  }
+  for (auto it = file_scopes_.begin(); it != file_scopes_.end();) {
+    ScopeSet &file_scopes = it->second;
+    const bool has_macros = file_scopes.find(kMacroScope) != file_scopes.end();
+    file_scopes.clear();
+    if (has_macros) {
+      file_scopes.emplace(kMacroScope);
+      ++it;
+    } else {
+      it = file_scopes_.erase(it);
+    }
+  }
+
+  std::map<std::string, EntryList> entries;
+  CollectEntries(symbol_table.Root(), "", nullptr, &entries);
+  AddEntries(&entries);
+}
+
+void CompletionIndex::UpdateFile(std::string_view file,
+                                 const SymbolTable &symbol_table) {
+  RemoveFile(file, false);
+  std::map<std::string, EntryList> entries;
+  CollectEntries(symbol_table.Root(), "", &file, &entries);
+  AddEntries(&entries);
+}
+
+void CompletionIndex::UpdateMacros(
+    std::string_view file, const verible::MacroDefinitionRegistry &macros) {
+  RemoveFile(file, true);
+  std::map<std::string, EntryList> entries;
+  EntryList &macro_entries = entries[std::string(kMacroScope)];
+  for (const auto &[name, definition] : macros) {
+    macro_entries.push_back(Entry{
+        .name = std::string(name),
+        .is_callable = definition.IsCallable(),
+        .file = std::string(file),
+    });
+  }
+  if (macro_entries.empty()) return;
+  AddEntries(&entries);
+}
+
+void CompletionIndex::Clear() {
+  scopes_.clear();
+  file_scopes_.clear();
+  size_ = 0;
+}
+
+void CompletionIndex::RemoveFile(std::string_view file, bool macros) {
+  const auto found = file_scopes_.find(file);
+  if (found == file_scopes_.end()) return;
+  ScopeSet &file_scopes = found->second;
+  for (auto scope = file_scopes.begin(); scope != file_scopes.end();) {
+    if ((*scope == kMacroScope) != macros) {
+      ++scope;
+      continue;
+    }
+    const auto entries = scopes_.find(*scope);
+    if (entries != scopes_.end()) {
+      EntryList &list = entries->second;
+      const auto removed =
+          std::remove_if(list.begin(), list.end(),
+                         [file](const Entry &e) { return e.file == file; });
+      size_ -= std::distance(removed, list.end());
+      list.erase(removed, list.end());
+      if (list.empty()) scopes_.erase(entries);
+    }
+    scope = file_scopes.erase(scope);
+  }
+  if (file_scopes.empty()) file_scopes_.erase(found);
+}
+
+void CompletionIndex::AddEntries(
+    std::map<std::string, EntryList> *entries_by_scope) {
+  for (auto &[scope, entries] : *entries_by_scope) {
+    if (entries.empty()) continue;
+    EntryList &list = scopes_[scope];
+    const size_t old_size = list.size();
+    for (Entry &entry : entries) {
+      file_scopes_[entry.file].insert(scope);
+      list.push_back(std::move(entry));
+    }
+    size_ += list.size() - old_size;
+    // The new entries are mostly few, compared to the ones already there.
+    std::stable_sort(list.begin() + old_size, list.end(), EntryLess);
+    std::inplace_merge(list.begin(), list.begin() + old_size, list.end(),
+                       EntryLess);
+  }
+}
+
+void CompletionIndex::ForEachInScope(
+    std::string_view scope, std::string_view prefix,
+    const std::function<bool(const Entry &)> &visit) const {
+  const auto found = scopes_.find(scope);
+  if (found == scopes_.end()) return;
+  const EntryList &list = found->second;
+  auto it = std::lower_bound(
+      list.begin(), list.end(), prefix,
+      [](const Entry &e, std::string_view p) { return e.name < p; });
+  for (; it != list.end() && absl::StartsWith(it->name, prefix); ++it) {
+    if (!visit(*it)) return;
+  }
+}
+
+}  // namespace verilog
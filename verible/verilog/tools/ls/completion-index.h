@@ -0,0 +1,124 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef VERILOG_TOOLS_LS_COMPLETION_INDEX_H
+#define VERILOG_TOOLS_LS_COMPLETION_INDEX_H
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "verible/common/text/macro-definition-registry.h"
+#include "verible/verilog/analysis/symbol-table.h"
+
+namespace verilog {
+
+// Names that can be completed in the editor, from the symbol table and the
+// macro definitions of the project.
+//
+// The names are grouped by scope, and sorted by name in each scope, so that
+// all names that start with a given prefix are found with a binary search.
+// A scope is the "::"-joined path of the symbols enclosing the names, like
+// "my_pkg" or "my_module::my_function"; the root scope is "".
+//
+// The names are copied, and remember the file they come from, so that a
+// changed file is indexed again without touching the other files.
+class CompletionIndex {
+ public:
+  struct Entry {
+    std::string name;
+
+    // Kind of symbol, or kUnspecified for macros.
+    SymbolMetaType metatype = SymbolMetaType::kUnspecified;
+
+    bool is_port = false;
+
+    // For macros: if they take arguments.
+    bool is_callable = false;
+
+    // Name of the user-defined type of data and instances, if any.
+    std::string type_name;
+
+    // Referenced path of the file of the definition.
+    std::string file;
+  };
+
+  // Replaces all names with those of "symbol_table", whose symbols may come
+  // from any number of files.  Macros are kept.
+  void IndexSymbolTable(const SymbolTable &symbol_table);
+
+  // Replaces the names that come from "file" with the symbols of
+  // "symbol_table" that come from a file with that referenced path.
+  void UpdateFile(std::string_view file, const SymbolTable &symbol_table);
+
+  // Replaces the macros defined in "file".
+  void UpdateMacros(std::string_view file,
+                    const verible::MacroDefinitionRegistry &macros);
+
+  // Forgets all names.
+  void Clear();
+
+  // Calls "visit" for each name in "scope" that starts with "prefix", in
+  // order of names.  Names defined in several files are visited once for
+  // each.  Stops early if "visit" returns false.
+  void ForEachInScope(std::string_view scope, std::string_view prefix,
+                      const std::function<bool(const Entry &)> &visit) const;
+
+  // Calls "visit" for each macro name that starts with "prefix", like
+  // ForEachInScope().
+  void ForEachMacro(std::string_view prefix,
+                    const std::function<bool(const Entry &)> &visit) const {
+    ForEachInScope(kMacroScope, prefix, visit);
+  }
+
+  // Returns if there are names in "scope".
+  bool HasScope(std::string_view scope) const {
+    return scopes_.find(scope) != scopes_.end();
+  }
+
+  // Number of names in all scopes.
+  size_t size() const { return size_; }
+
+ private:
+  using EntryList = std::vector<Entry>;
+  using ScopeSet = std::set<std::string, std::less<>>;
+
+  // Macros are not scoped, and are kept apart in a scope that can not be
+  // the path of a symbol.
+  static constexpr std::string_view kMacroScope = "`";
+
+  // Removes the entries of "file" from all scopes but the macros, or only
+  // from the macros.
+  void RemoveFile(std::string_view file, bool macros);
+
+  // Adds the entries, and keeps the scopes sorted.
+  void AddEntries(std::map<std::string, EntryList> *entries_by_scope);
+
+  std::map<std::string, EntryList, std::less<>> scopes_;
+
+  // For each file, the scopes in which it has names, to find them again
+  // when the file changes.
+  std::map<std::string, ScopeSet, std::less<>> file_scopes_;
+
+  size_t size_ = 0;
+};
+
+}  // namespace verilog
+
+#endif  // VERILOG_TOOLS_LS_COMPLETION_INDEX_H
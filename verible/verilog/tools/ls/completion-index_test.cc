@@ -0,0 +1,224 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/completion-index.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/common/text/macro-definition-registry.h"
+#include "verible/common/text/macro-definition.h"
+#include "verible/common/text/token-info.h"
+#include "verible/verilog/analysis/symbol-table.h"
+#include "verible/verilog/analysis/verilog-project.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Returns "file:name" of the names in "scope" that start with "prefix".
+std::vector<std::string> Find(const CompletionIndex &index,
+                              std::string_view scope, std::string_view prefix) {
+  std::vector<std::string> found;
+  index.ForEachInScope(scope, prefix, [&](const CompletionIndex::Entry &e) {
+    found.push_back(e.file + ":" + e.name);
+    return true;
+  });
+  return found;
+}
+
+std::vector<std::string> FindMacros(const CompletionIndex &index,
+                                    std::string_view prefix) {
+  std::vector<std::string> found;
+  index.ForEachMacro(prefix, [&](const CompletionIndex::Entry &e) {
+    found.push_back(e.file + ":" + e.name);
+    return true;
+  });
+  return found;
+}
+
+class CompletionIndexTest : public ::testing::Test {
+ protected:
+  // Parses "text" as the file "name", and adds its symbols to the table.
+  const VerilogSourceFile &AddFile(std::string_view name,
+                                   std::string_view text,
+                                   SymbolTable *symbol_table) {
+    files_.push_back(std::make_unique<InMemoryVerilogSourceFile>(name, text));
+    EXPECT_TRUE(files_.back()->Parse().ok());
+    EXPECT_THAT(BuildSymbolTable(*files_.back(), symbol_table), IsEmpty());
+    return *files_.back();
+  }
+
+  std::vector<std::unique_ptr<InMemoryVerilogSourceFile>> files_;
+};
+
+TEST_F(CompletionIndexTest, IndexSymbolTable) {
+  SymbolTable symbol_table(nullptr);
+  AddFile("a.sv",
+          "module alpha(input clk, output logic [1:0] data);\n"
+          "  parameter int WIDTH = 2;\n"
+          "  wire w;\n"
+          "  function automatic int add(int x);\n"
+          "    int sum;\n"
+          "  endfunction\n"
+          "endmodule\n",
+          &symbol_table);
+  AddFile("b.sv",
+          "package pkg;\n"
+          "  typedef int count_t;\n"
+          "endpackage\n"
+          "module beta;\n"
+          "  alpha a1(.clk(), .data());\n"
+          "endmodule\n",
+          &symbol_table);
+
+  CompletionIndex index;
+  index.IndexSymbolTable(symbol_table);
+  EXPECT_THAT(Find(index, "", ""),
+              ElementsAre("a.sv:alpha", "b.sv:beta", "b.sv:pkg"));
+  EXPECT_THAT(Find(index, "", "b"), ElementsAre("b.sv:beta"));
+  EXPECT_THAT(Find(index, "alpha", ""),
+              ElementsAre("a.sv:WIDTH", "a.sv:add", "a.sv:clk", "a.sv:data",
+                          "a.sv:w"));
+  EXPECT_THAT(Find(index, "alpha::add", ""),
+              ElementsAre("a.sv:sum", "a.sv:x"));
+  EXPECT_THAT(Find(index, "pkg", "co"), ElementsAre("b.sv:count_t"));
+  EXPECT_THAT(Find(index, "alpha", "z"), IsEmpty());
+  EXPECT_THAT(Find(index, "gamma", ""), IsEmpty());
+  EXPECT_TRUE(index.HasScope("pkg"));
+  EXPECT_FALSE(index.HasScope("gamma"));
+  EXPECT_EQ(index.size(), 12);
+
+  // What is known about the names.
+  std::vector<CompletionIndex::Entry> entries;
+  index.ForEachInScope("alpha", "", [&](const CompletionIndex::Entry &e) {
+    entries.push_back(e);
+    return true;
+  });
+  ASSERT_EQ(entries.size(), 5);
+  EXPECT_EQ(entries[0].metatype, SymbolMetaType::kParameter);
+  EXPECT_EQ(entries[1].metatype, SymbolMetaType::kFunction);
+  EXPECT_TRUE(entries[2].is_port);
+  EXPECT_FALSE(entries[4].is_port);
+
+  std::vector<CompletionIndex::Entry> instances;
+  index.ForEachInScope("beta", "", [&](const CompletionIndex::Entry &e) {
+    instances.push_back(e);
+    return true;
+  });
+  ASSERT_EQ(instances.size(), 1);
+  EXPECT_EQ(instances[0].name, "a1");
+  EXPECT_EQ(instances[0].type_name, "alpha");
+}
+
+TEST_F(CompletionIndexTest, StopsWhenAsked) {
+  SymbolTable symbol_table(nullptr);
+  AddFile("a.sv", "module m1; endmodule\nmodule m2; endmodule\n",
+          &symbol_table);
+  CompletionIndex index;
+  index.IndexSymbolTable(symbol_table);
+  int visited = 0;
+  index.ForEachInScope("", "m", [&](const CompletionIndex::Entry &) {
+    ++visited;
+    return false;
+  });
+  EXPECT_EQ(visited, 1);
+}
+
+TEST_F(CompletionIndexTest, UpdateFileKeepsOtherFiles) {
+  SymbolTable symbol_table(nullptr);
+  AddFile("a.sv", "module a; wire a_old; endmodule\n", &symbol_table);
+  AddFile("b.sv", "module b; wire b_wire; endmodule\n", &symbol_table);
+  CompletionIndex index;
+  index.IndexSymbolTable(symbol_table);
+
+  // The file changed: a new module, and another wire.
+  SymbolTable changed(nullptr);
+  AddFile("a.sv",
+          "module a; wire a_new; endmodule\nmodule aa; endmodule\n",
+          &changed);
+  index.UpdateFile("a.sv", changed);
+  EXPECT_THAT(Find(index, "", ""),
+              ElementsAre("a.sv:a", "a.sv:aa", "b.sv:b"));
+  EXPECT_THAT(Find(index, "a", ""), ElementsAre("a.sv:a_new"));
+  EXPECT_THAT(Find(index, "b", ""), ElementsAre("b.sv:b_wire"));
+  EXPECT_EQ(index.size(), 5);
+
+  // Names of other files in the symbol table are ignored.
+  index.UpdateFile("a.sv", symbol_table);
+  EXPECT_THAT(Find(index, "", ""), ElementsAre("a.sv:a", "b.sv:b"));
+  EXPECT_THAT(Find(index, "a", ""), ElementsAre("a.sv:a_old"));
+  EXPECT_EQ(index.size(), 4);
+}
+
+TEST_F(CompletionIndexTest, SameNameInSeveralFiles) {
+  SymbolTable symbol_table(nullptr);
+  AddFile("a.sv", "module m; endmodule\n", &symbol_table);
+  SymbolTable other(nullptr);
+  AddFile("b.sv", "module m; endmodule\n", &other);
+  CompletionIndex index;
+  index.IndexSymbolTable(symbol_table);
+  index.UpdateFile("b.sv", other);
+  EXPECT_THAT(Find(index, "", "m"), ElementsAre("a.sv:m", "b.sv:m"));
+}
+
+TEST(CompletionIndexMacroTest, UpdateMacros) {
+  verible::MacroDefinitionRegistry a_macros;
+  a_macros.Define(verible::MacroDefinition(verible::TokenInfo(1, "`define"),
+                                           verible::TokenInfo(2, "WIDTH")));
+  verible::MacroDefinition callable(verible::TokenInfo(1, "`define"),
+                                    verible::TokenInfo(2, "WITH_ARGS"));
+  callable.SetCallable();
+  a_macros.Define(callable);
+  verible::MacroDefinitionRegistry b_macros;
+  b_macros.Define(verible::MacroDefinition(verible::TokenInfo(1, "`define"),
+                                           verible::TokenInfo(2, "DEPTH")));
+
+  CompletionIndex index;
+  index.UpdateMacros("a.sv", a_macros);
+  index.UpdateMacros("b.sv", b_macros);
+  EXPECT_THAT(FindMacros(index, ""),
+              ElementsAre("b.sv:DEPTH", "a.sv:WIDTH", "a.sv:WITH_ARGS"));
+  EXPECT_THAT(FindMacros(index, "WI"),
+              ElementsAre("a.sv:WIDTH", "a.sv:WITH_ARGS"));
+  std::vector<bool> callables;
+  index.ForEachMacro("WI", [&](const CompletionIndex::Entry &e) {
+    callables.push_back(e.is_callable);
+    return true;
+  });
+  EXPECT_THAT(callables, ElementsAre(false, true));
+
+  // Macros are not in the scopes of symbols, and stay when these are
+  // indexed again.
+  EXPECT_THAT(Find(index, "", ""), IsEmpty());
+  index.IndexSymbolTable(SymbolTable(nullptr));
+  EXPECT_EQ(index.size(), 3);
+
+  index.UpdateMacros("a.sv", verible::MacroDefinitionRegistry());
+  EXPECT_THAT(FindMacros(index, ""), ElementsAre("b.sv:DEPTH"));
+
+  index.Clear();
+  EXPECT_EQ(index.size(), 0);
+  EXPECT_THAT(FindMacros(index, ""), IsEmpty());
+}
+
+}  // namespace
+}  // namespace verilog
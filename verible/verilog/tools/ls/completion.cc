@@ -0,0 +1,449 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/completion.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "verible/common/lsp/lsp-protocol-enums.h"
+#include "verible/common/lsp/lsp-protocol.h"
+#include "verible/common/strings/line-column-map.h"
+#include "verible/common/text/text-structure.h"
+#include "verible/common/text/token-info.h"
+#include "verible/verilog/analysis/symbol-table.h"
+#include "verible/verilog/parser/verilog-token-classifications.h"
+#include "verible/verilog/parser/verilog-token-enum.h"
+#include "verible/verilog/tools/ls/completion-index.h"
+#include "verible/verilog/tools/ls/lsp-parse-buffer.h"
+#include "verible/verilog/tools/ls/symbol-table-handler.h"
+
+namespace verilog {
+
+namespace {
+
+using verible::TokenInfo;
+using verible::lsp::CompletionItemKind;
+
+// Editors ask again as the user types on, so there is no use in sending all
+// names of a large project for a short prefix.
+constexpr size_t kMaxCompletionItems = 200;
+
+bool IsIdentifierChar(char c) {
+  return absl::ascii_isalnum(c) || c == '_' || c == '$';
+}
+
+// Returns the tokens that start before "end", without whitespace and
+// comments.
+std::vector<const TokenInfo *> SignificantTokensBefore(
+    const verible::TextStructureView &text, size_t end) {
+  std::vector<const TokenInfo *> tokens;
+  for (const TokenInfo &token : text.TokenStream()) {
+    if (token.isEOF()) break;
+    if (static_cast<size_t>(token.left(text.Contents())) >= end) break;
+    const auto token_enum = static_cast<verilog_tokentype>(token.token_enum());
+    if (IsWhitespace(token_enum) || IsComment(token_enum)) continue;
+    tokens.push_back(&token);
+  }
+  return tokens;
+}
+
+// Returns the index of the opening bracket that matches the closing one at
+// "close_index", or -1.
+int MatchingOpenBracket(const std::vector<const TokenInfo *> &tokens,
+                        int close_index) {
+  const int close = tokens[close_index]->token_enum();
+  const int open = close == ')' ? '(' : '[';
+  int depth = 0;
+  for (int i = close_index; i >= 0; --i) {
+    const int token_enum = tokens[i]->token_enum();
+    if (token_enum == close) {
+      ++depth;
+    } else if (token_enum == open && --depth == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+// If the tokens end within the port connections or the parameter
+// assignments of a module instance, returns the module name, and if it is
+// the parameters.
+std::optional<std::pair<std::string_view, bool>> EnclosingModuleInstance(
+    const std::vector<const TokenInfo *> &tokens) {
+  // Find the unmatched opening parenthesis.
+  int i = static_cast<int>(tokens.size()) - 1;
+  for (int depth = 0; i >= 0; --i) {
+    const int token_enum = tokens[i]->token_enum();
+    if (token_enum == ')') {
+      ++depth;
+    } else if (token_enum == '(') {
+      if (depth == 0) break;
+      --depth;
+    } else if (token_enum == ';') {
+      return std::nullopt;
+    }
+  }
+  if (i < 2) return std::nullopt;
+
+  //   module_name #( . ...
+  int j = i - 1;
+  if (tokens[j]->token_enum() == '#') {
+    if (tokens[j - 1]->token_enum() != SymbolIdentifier) return std::nullopt;
+    return std::make_pair(tokens[j - 1]->text(), true);
+  }
+
+  //   module_name [#(...)] instance_name [ranges] ( . ...
+  while (j > 0 && tokens[j]->token_enum() == ']') {
+    j = MatchingOpenBracket(tokens, j) - 1;
+  }
+  if (j < 1 || tokens[j]->token_enum() != SymbolIdentifier) return std::nullopt;
+  --j;
+  if (tokens[j]->token_enum() == ')') {
+    j = MatchingOpenBracket(tokens, j) - 1;
+    if (j < 1 || tokens[j]->token_enum() != '#') return std::nullopt;
+    --j;
+  }
+  if (tokens[j]->token_enum() != SymbolIdentifier) return std::nullopt;
+  return std::make_pair(tokens[j]->text(), false);
+}
+
+// Tells if the function or task keyword at "index" starts a prototype,
+// which has no body and no matching end keyword.
+bool IsPrototype(const std::vector<const TokenInfo *> &tokens, int index) {
+  for (int i = index - 1; i >= 0; --i) {
+    switch (tokens[i]->token_enum()) {
+      case TK_virtual:
+      case TK_static:
+      case TK_protected:
+      case TK_local:
+      case TK_context:
+      case TK_StringLiteral:  // import "DPI-C"
+      case SymbolIdentifier:  // import "DPI-C" c_name = function
+      case '=':
+        continue;
+      case TK_extern:
+      case TK_pure:
+      case TK_import:
+      case TK_export:
+        return true;
+      default:
+        return false;
+    }
+  }
+  return false;
+}
+
+// Finds the scopes that enclose the end of "tokens", innermost first, down to
+// the root scope, followed by the packages imported with a wildcard or a
+// single name.
+std::vector<std::string> EnclosingScopes(
+    const std::vector<const TokenInfo *> &tokens) {
+  struct OpenScope {
+    int end_keyword;
+    std::string_view name;
+    // While looking for the name.  Functions and tasks are named by the last
+    // identifier before their ports, the others by the first identifier.
+    bool naming = true;
+    bool named_by_last_identifier = false;
+  };
+  std::vector<OpenScope> open_scopes;
+  std::vector<std::string_view> imported_packages;
+
+  const int size = static_cast<int>(tokens.size());
+  for (int i = 0; i < size; ++i) {
+    const int token_enum = tokens[i]->token_enum();
+    const int next = i + 1 < size ? tokens[i + 1]->token_enum() : 0;
+    if (!open_scopes.empty() && open_scopes.back().naming) {
+      OpenScope &open = open_scopes.back();
+      if (token_enum == SymbolIdentifier || token_enum == TK_new) {
+        open.name = tokens[i]->text();
+        open.naming = open.named_by_last_identifier;
+        continue;
+      }
+      if (token_enum == '(' || token_enum == ';' || token_enum == '#') {
+        open.naming = false;
+      }
+    }
+    switch (token_enum) {
+      case TK_module:
+      case TK_macromodule:
+        open_scopes.push_back({.end_keyword = TK_endmodule});
+        break;
+      case TK_package:
+        open_scopes.push_back({.end_keyword = TK_endpackage});
+        break;
+      case TK_program:
+        open_scopes.push_back({.end_keyword = TK_endprogram});
+        break;
+      case TK_interface:
+        // Not a virtual interface type, and not an interface class.
+        if (i > 0 && tokens[i - 1]->token_enum() == TK_virtual) break;
+        if (next == TK_class) break;
+        open_scopes.push_back({.end_keyword = TK_endinterface});
+        break;
+      case TK_class:
+        if (i > 0 && tokens[i - 1]->token_enum() == TK_typedef) break;
+        open_scopes.push_back({.end_keyword = TK_endclass});
+        break;
+      case TK_function:
+      case TK_task:
+        if (IsPrototype(tokens, i)) break;
+        open_scopes.push_back({
+            .end_keyword = token_enum == TK_function ? TK_endfunction
+                                                     : TK_endtask,
+            .named_by_last_identifier = true,
+        });
+        break;
+      case TK_begin:
+        // Only labeled blocks are scopes with a name, others are transparent.
+        open_scopes.push_back({.end_keyword = TK_end, .naming = next == ':'});
+        break;
+      case TK_import:
+        if (next == SymbolIdentifier && i + 2 < size &&
+            tokens[i + 2]->token_enum() == TK_SCOPE_RES) {
+          imported_packages.push_back(tokens[i + 1]->text());
+        }
+        break;
+      case TK_endmodule:
+      case TK_endpackage:
+      case TK_endprogram:
+      case TK_endinterface:
+      case TK_endclass:
+      case TK_endfunction:
+      case TK_endtask:
+      case TK_end: {
+        // Close what was left open inside as well.
+        const auto found = std::find_if(
+            open_scopes.rbegin(), open_scopes.rend(),
+            [token_enum](const OpenScope &s) {
+              return s.end_keyword == token_enum;
+            });
+        if (found != open_scopes.rend()) {
+          open_scopes.erase(std::prev(found.base()), open_scopes.end());
+        }
+        break;
+      }
+      default:
+        break;
+    }
+  }
+
+  std::vector<std::string_view> path;
+  for (const OpenScope &open : open_scopes) {
+    if (!open.name.empty()) path.push_back(open.name);
+  }
+  std::vector<std::string> scopes;
+  for (size_t n = path.size() + 1; n-- > 0;) {
+    scopes.push_back(absl::StrJoin(path.begin(), path.begin() + n, "::"));
+  }
+  for (std::string_view package : imported_packages) {
+    scopes.emplace_back(package);
+  }
+  return scopes;
+}
+
+int CompletionItemKindOf(const CompletionIndex::Entry &entry) {
+  switch (entry.metatype) {
+    case SymbolMetaType::kModule:
+    case SymbolMetaType::kPackage:
+    case SymbolMetaType::kGenerate:
+      return CompletionItemKind::kModule;
+    case SymbolMetaType::kClass:
+      return CompletionItemKind::kClass;
+    case SymbolMetaType::kInterface:
+      return CompletionItemKind::kInterface;
+    case SymbolMetaType::kFunction:
+    case SymbolMetaType::kTask:
+      return CompletionItemKind::kFunction;
+    case SymbolMetaType::kParameter:
+      return CompletionItemKind::kConstant;
+    case SymbolMetaType::kTypeAlias:
+      return CompletionItemKind::kTypeParameter;
+    case SymbolMetaType::kStruct:
+      return CompletionItemKind::kStruct;
+    case SymbolMetaType::kEnumType:
+      return CompletionItemKind::kEnum;
+    case SymbolMetaType::kEnumConstant:
+      return CompletionItemKind::kEnumMember;
+    case SymbolMetaType::kDataNetVariableInstance:
+      return CompletionItemKind::kVariable;
+    default:  // Macros
+      return CompletionItemKind::kConstant;
+  }
+}
+
+std::string CompletionItemDetail(const CompletionIndex::Entry &entry) {
+  if (entry.metatype == SymbolMetaType::kUnspecified) {
+    return entry.is_callable ? "macro with arguments" : "macro";
+  }
+  if (entry.is_port) {
+    if (entry.type_name.empty()) return "port";
+    return absl::StrCat("port ", entry.type_name);
+  }
+  if (entry.metatype == SymbolMetaType::kDataNetVariableInstance) {
+    return entry.type_name;
+  }
+  return std::string(SymbolMetaTypeAsString(entry.metatype));
+}
+
+}  // namespace
+
+CompletionContext FindCompletionContext(const verible::TextStructureView &text,
+                                        const verible::LineColumn &cursor) {
+  CompletionContext context;
+  const std::string_view contents = text.Contents();
+  const verible::LineColumnMap &line_map = text.GetLineColumnMap();
+  if (line_map.empty() || cursor.line < 0 || cursor.column < 0) return context;
+  const size_t offset =
+      std::min(static_cast<size_t>(line_map.OffsetAtLine(cursor.line) +
+                                   cursor.column),
+               contents.size());
+
+  size_t prefix_begin = offset;
+  while (prefix_begin > 0 && IsIdentifierChar(contents[prefix_begin - 1])) {
+    --prefix_begin;
+  }
+  context.prefix =
+      std::string(contents.substr(prefix_begin, offset - prefix_begin));
+  if (!context.prefix.empty() && absl::ascii_isdigit(context.prefix[0])) {
+    return context;  // A number.
+  }
+  if (prefix_begin > 0 && contents[prefix_begin - 1] == '`') {
+    context.kind = CompletionContext::kMacro;
+    return context;
+  }
+
+  size_t before = prefix_begin;  // What is before the prefix.
+  while (before > 0 && absl::ascii_isspace(contents[before - 1])) --before;
+
+  if (before >= 2 && contents.substr(before - 2, 2) == "::") {
+    // Collect the whole path, like in pkg::cls::
+    std::vector<std::string_view> path;
+    while (before >= 2 && contents.substr(before - 2, 2) == "::") {
+      size_t name_begin = before - 2;
+      while (name_begin > 0 && IsIdentifierChar(contents[name_begin - 1])) {
+        --name_begin;
+      }
+      if (name_begin == before - 2) break;
+      path.insert(path.begin(),
+                  contents.substr(name_begin, before - 2 - name_begin));
+      before = name_begin;
+    }
+    if (!path.empty() && (path[0] == "$unit" || path[0] == "$root")) {
+      path.erase(path.begin());
+    }
+    context.kind = CompletionContext::kScopeMember;
+    context.scopes.push_back(absl::StrJoin(path, "::"));
+    return context;
+  }
+
+  if (before >= 1 && contents[before - 1] == '.') {
+    const auto instance =
+        EnclosingModuleInstance(SignificantTokensBefore(text, before - 1));
+    if (!instance.has_value()) return context;
+    context.kind = instance->second ? CompletionContext::kParameterAssignment
+                                    : CompletionContext::kPortConnection;
+    context.scopes.emplace_back(instance->first);
+    return context;
+  }
+
+  context.kind = CompletionContext::kIdentifier;
+  context.scopes = EnclosingScopes(SignificantTokensBefore(text, prefix_begin));
+  return context;
+}
+
+verible::lsp::CompletionList CompleteFromIndex(
+    const CompletionIndex &index, const CompletionContext &context) {
+  verible::lsp::CompletionList result;
+  // Names in inner scopes hide the same names further out.
+  std::set<std::string_view> seen;
+  const auto add_item = [&](const CompletionIndex::Entry &entry) {
+    if (seen.find(entry.name) != seen.end()) return true;
+    if (result.items.size() >= kMaxCompletionItems) {
+      result.isIncomplete = true;
+      return false;
+    }
+    seen.insert(entry.name);
+    result.items.push_back({
+        .label = entry.name,
+        .kind = CompletionItemKindOf(entry),
+        .has_kind = true,
+        .detail = CompletionItemDetail(entry),
+        .has_detail = true,
+    });
+    return true;
+  };
+
+  switch (context.kind) {
+    case CompletionContext::kNone:
+      break;
+    case CompletionContext::kMacro:
+      index.ForEachMacro(context.prefix, add_item);
+      break;
+    case CompletionContext::kIdentifier:
+    case CompletionContext::kScopeMember:
+      for (const std::string &scope : context.scopes) {
+        index.ForEachInScope(scope, context.prefix, add_item);
+        if (result.isIncomplete) break;
+      }
+      break;
+    case CompletionContext::kPortConnection:
+      index.ForEachInScope(context.scopes.front(), context.prefix,
+                           [&](const CompletionIndex::Entry &entry) {
+                             return !entry.is_port || add_item(entry);
+                           });
+      break;
+    case CompletionContext::kParameterAssignment:
+      index.ForEachInScope(
+          context.scopes.front(), context.prefix,
+          [&](const CompletionIndex::Entry &entry) {
+            return entry.metatype != SymbolMetaType::kParameter ||
+                   add_item(entry);
+          });
+      break;
+  }
+  return result;
+}
+
+verible::lsp::CompletionList CreateCompletionList(
+    SymbolTableHandler *symbol_table_handler,
+    const BufferTrackerContainer &tracker,
+    const verible::lsp::CompletionParams &p) {
+  const BufferTracker *buffer =
+      tracker.FindBufferTrackerOrNull(p.textDocument.uri);
+  if (!buffer) return {};
+  std::shared_ptr<const ParsedBuffer> parsed_buffer = buffer->current();
+  if (!parsed_buffer) return {};
+  const CompletionContext context = FindCompletionContext(
+      parsed_buffer->parser().Data(),
+      {p.position.line, p.position.character});
+  if (context.kind == CompletionContext::kNone) return {};
+  return CompleteFromIndex(symbol_table_handler->PreparedCompletionIndex(),
+                           context);
+}
+
+}  // namespace verilog
@@ -0,0 +1,69 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef VERILOG_TOOLS_LS_COMPLETION_H
+#define VERILOG_TOOLS_LS_COMPLETION_H
+
+#include <string>
+#include <vector>
+
+#include "verible/common/lsp/lsp-protocol.h"
+#include "verible/common/strings/line-column-map.h"
+#include "verible/common/text/text-structure.h"
+#include "verible/verilog/tools/ls/completion-index.h"
+#include "verible/verilog/tools/ls/lsp-parse-buffer.h"
+#include "verible/verilog/tools/ls/symbol-table-handler.h"
+
+namespace verilog {
+
+// What the text before the cursor asks to complete.
+struct CompletionContext {
+  enum Kind {
+    kNone,                 // e.g. a member of a struct
+    kIdentifier,           // any name visible in the enclosing scopes
+    kMacro,                // after a backtick
+    kScopeMember,          // after "pkg::"
+    kPortConnection,       // after "." in the ports of a module instance
+    kParameterAssignment,  // after "." in "#(" of a module instance
+  };
+  Kind kind = kNone;
+
+  // The part of the identifier before the cursor.
+  std::string prefix;
+
+  // The scopes to look in, in order of precedence.  For identifiers, the
+  // enclosing scopes, innermost first, down to the root scope "", followed
+  // by the imported packages.  For module instances, the module.
+  std::vector<std::string> scopes;
+};
+
+// Finds out what to complete at the cursor, from the tokens before it.
+CompletionContext FindCompletionContext(const verible::TextStructureView &text,
+                                        const verible::LineColumn &cursor);
+
+// Returns the names in "index" that match "context".  The list is cut short,
+// and marked incomplete, when there are many.
+verible::lsp::CompletionList CompleteFromIndex(
+    const CompletionIndex &index, const CompletionContext &context);
+
+// Provides the completion list for the given location.
+verible::lsp::CompletionList CreateCompletionList(
+    SymbolTableHandler *symbol_table_handler,
+    const BufferTrackerContainer &tracker,
+    const verible::lsp::CompletionParams &p);
+
+}  // namespace verilog
+
+#endif  // VERILOG_TOOLS_LS_COMPLETION_H
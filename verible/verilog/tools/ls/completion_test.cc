@@ -0,0 +1,283 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/completion.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/common/lsp/lsp-protocol-enums.h"
+#include "verible/common/lsp/lsp-protocol.h"
+#include "verible/verilog/analysis/symbol-table.h"
+#include "verible/verilog/analysis/verilog-analyzer.h"
+#include "verible/verilog/analysis/verilog-project.h"
+#include "verible/verilog/tools/ls/completion-index.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Finds the completion context at the "@" in "text", which is removed.
+CompletionContext ContextAt(std::string_view text) {
+  const size_t cursor = text.find('@');
+  EXPECT_NE(cursor, std::string_view::npos);
+  const std::string code = absl::StrCat(text.substr(0, cursor),
+                                        text.substr(cursor + 1));
+  VerilogAnalyzer analyzer(code, "completion.sv");
+  analyzer.Analyze().IgnoreError();  // Mostly incomplete code.
+  return FindCompletionContext(analyzer.Data(),
+                               analyzer.Data().GetLineColAtOffset(cursor));
+}
+
+TEST(FindCompletionContextTest, Identifier) {
+  const CompletionContext context = ContextAt(
+      "module top;\n"
+      "  wire w = fo@\n");
+  EXPECT_EQ(context.kind, CompletionContext::kIdentifier);
+  EXPECT_EQ(context.prefix, "fo");
+  EXPECT_THAT(context.scopes, ElementsAre("top", ""));
+}
+
+TEST(FindCompletionContextTest, NestedScopes) {
+  const CompletionContext context = ContextAt(
+      "package p;\n"
+      "endpackage\n"
+      "module top import p::*; #(parameter W = 1) (input clk);\n"
+      "  function automatic int f(int x);\n"
+      "  endfunction\n"
+      "  for (genvar i = 0; i < 2; ++i) begin : gen\n"
+      "    if (1) begin\n"
+      "      initial begin : blk\n"
+      "        @\n");
+  EXPECT_EQ(context.kind, CompletionContext::kIdentifier);
+  EXPECT_EQ(context.prefix, "");
+  EXPECT_THAT(context.scopes, ElementsAre("top::gen::blk", "top::gen", "top",
+                                          "", "p"));
+}
+
+TEST(FindCompletionContextTest, FunctionsAndClasses) {
+  EXPECT_THAT(ContextAt("class c;\n"
+                        "  extern function void e();\n"
+                        "  pure virtual task t();\n"
+                        "  typedef class d;\n"
+                        "  function automatic my_pkg::my_t f(int x);\n"
+                        "    return x@")
+                  .scopes,
+              ElementsAre("c::f", "c", ""));
+  EXPECT_THAT(ContextAt("class c;\n"
+                        "  function new();\n"
+                        "  endfunction\n"
+                        "  task run;\n"
+                        "    @")
+                  .scopes,
+              ElementsAre("c::run", "c", ""));
+  EXPECT_THAT(ContextAt("module m;\n"
+                        "  virtual interface bus vif;\n"
+                        "  import \"DPI-C\" function void dpi();\n"
+                        "endmodule\n"
+                        "interface class ic;\n"
+                        "endclass\n"
+                        "module n;\n"
+                        "  @")
+                  .scopes,
+              ElementsAre("n", ""));
+}
+
+TEST(FindCompletionContextTest, Macro) {
+  CompletionContext context = ContextAt("module m;\n  wire [`WI@");
+  EXPECT_EQ(context.kind, CompletionContext::kMacro);
+  EXPECT_EQ(context.prefix, "WI");
+  EXPECT_THAT(context.scopes, IsEmpty());
+
+  context = ContextAt("`@");
+  EXPECT_EQ(context.kind, CompletionContext::kMacro);
+  EXPECT_EQ(context.prefix, "");
+}
+
+TEST(FindCompletionContextTest, ScopeMember) {
+  CompletionContext context = ContextAt("module m;\n  wire w = pkg::co@");
+  EXPECT_EQ(context.kind, CompletionContext::kScopeMember);
+  EXPECT_EQ(context.prefix, "co");
+  EXPECT_THAT(context.scopes, ElementsAre("pkg"));
+
+  context = ContextAt("module m;\n  wire w = pkg::cls::@");
+  EXPECT_EQ(context.kind, CompletionContext::kScopeMember);
+  EXPECT_THAT(context.scopes, ElementsAre("pkg::cls"));
+
+  context = ContextAt("module m;\n  wire w = $unit::@");
+  EXPECT_EQ(context.kind, CompletionContext::kScopeMember);
+  EXPECT_THAT(context.scopes, ElementsAre(""));
+}
+
+TEST(FindCompletionContextTest, ModuleInstance) {
+  CompletionContext context = ContextAt(
+      "module m;\n"
+      "  sub u_sub(.clk(clk), .da@");
+  EXPECT_EQ(context.kind, CompletionContext::kPortConnection);
+  EXPECT_EQ(context.prefix, "da");
+  EXPECT_THAT(context.scopes, ElementsAre("sub"));
+
+  context = ContextAt(
+      "module m;\n"
+      "  sub #(.W(8)) u_sub[1:0] (\n"
+      "    .clk(f(a, b)),\n"
+      "    .@");
+  EXPECT_EQ(context.kind, CompletionContext::kPortConnection);
+  EXPECT_THAT(context.scopes, ElementsAre("sub"));
+
+  context = ContextAt(
+      "module m;\n"
+      "  sub #(.W(8), .D@");
+  EXPECT_EQ(context.kind, CompletionContext::kParameterAssignment);
+  EXPECT_EQ(context.prefix, "D");
+  EXPECT_THAT(context.scopes, ElementsAre("sub"));
+}
+
+TEST(FindCompletionContextTest, NothingToComplete) {
+  // Member of a struct.
+  EXPECT_EQ(ContextAt("module m;\n  assign x = s.@").kind,
+            CompletionContext::kNone);
+  // Argument of a function call.
+  EXPECT_EQ(ContextAt("module m;\n  assign x = f(s.@").kind,
+            CompletionContext::kNone);
+  // A number.
+  EXPECT_EQ(ContextAt("module m;\n  assign x = 12@").kind,
+            CompletionContext::kNone);
+}
+
+class CompleteFromIndexTest : public ::testing::Test {
+ protected:
+  void SetUp() final {
+    file_ = std::make_unique<InMemoryVerilogSourceFile>(
+        "a.sv",
+        "package pkg;\n"
+        "  parameter int COUNT = 1;\n"
+        "endpackage\n"
+        "module sub #(parameter int W = 1, parameter int D = 2)\n"
+        "    (input clk, input [W-1:0] data);\n"
+        "  wire data_valid;\n"
+        "endmodule\n"
+        "module top;\n"
+        "  wire data;\n"
+        "  sub u_sub();\n"
+        "endmodule\n");
+    ASSERT_TRUE(file_->Parse().ok());
+    SymbolTable symbol_table(nullptr);
+    BuildSymbolTable(*file_, &symbol_table);
+    index_.IndexSymbolTable(symbol_table);
+  }
+
+  std::vector<std::string> Labels(const CompletionContext &context) {
+    std::vector<std::string> labels;
+    for (const auto &item : CompleteFromIndex(index_, context).items) {
+      labels.push_back(item.label);
+    }
+    return labels;
+  }
+
+  std::unique_ptr<InMemoryVerilogSourceFile> file_;
+  CompletionIndex index_;
+};
+
+TEST_F(CompleteFromIndexTest, Identifiers) {
+  EXPECT_THAT(Labels({.kind = CompletionContext::kIdentifier,
+                      .prefix = "d",
+                      .scopes = {"top", ""}}),
+              ElementsAre("data"));
+  EXPECT_THAT(Labels({.kind = CompletionContext::kIdentifier,
+                      .prefix = "",
+                      .scopes = {"top", ""}}),
+              ElementsAre("data", "u_sub", "pkg", "sub", "top"));
+  EXPECT_THAT(Labels({.kind = CompletionContext::kIdentifier,
+                      .prefix = "C",
+                      .scopes = {"top", "", "pkg"}}),
+              ElementsAre("COUNT"));
+  EXPECT_THAT(Labels({.kind = CompletionContext::kScopeMember,
+                      .prefix = "",
+                      .scopes = {"pkg"}}),
+              ElementsAre("COUNT"));
+  EXPECT_THAT(Labels({.kind = CompletionContext::kNone}), IsEmpty());
+}
+
+TEST_F(CompleteFromIndexTest, PortsAndParameters) {
+  EXPECT_THAT(Labels({.kind = CompletionContext::kPortConnection,
+                      .prefix = "",
+                      .scopes = {"sub"}}),
+              ElementsAre("clk", "data"));
+  EXPECT_THAT(Labels({.kind = CompletionContext::kPortConnection,
+                      .prefix = "d",
+                      .scopes = {"sub"}}),
+              ElementsAre("data"));
+  EXPECT_THAT(Labels({.kind = CompletionContext::kParameterAssignment,
+                      .prefix = "",
+                      .scopes = {"sub"}}),
+              ElementsAre("D", "W"));
+  EXPECT_THAT(Labels({.kind = CompletionContext::kPortConnection,
+                      .prefix = "",
+                      .scopes = {"unknown"}}),
+              IsEmpty());
+}
+
+TEST_F(CompleteFromIndexTest, ItemDetails) {
+  const verible::lsp::CompletionList list =
+      CompleteFromIndex(index_, {.kind = CompletionContext::kIdentifier,
+                                 .prefix = "",
+                                 .scopes = {"top", ""}});
+  ASSERT_EQ(list.items.size(), 5);
+  EXPECT_FALSE(list.isIncomplete);
+  EXPECT_EQ(list.items[1].label, "u_sub");
+  EXPECT_EQ(list.items[1].detail, "sub");
+  EXPECT_EQ(list.items[2].label, "pkg");
+  EXPECT_EQ(list.items[2].detail, "package");
+  EXPECT_EQ(list.items[2].kind, verible::lsp::CompletionItemKind::kModule);
+}
+
+TEST(CompleteFromIndexLimitTest, ManyNamesAreIncomplete) {
+  std::string text = "module m;\n";
+  for (int i = 0; i < 300; ++i) {
+    text += "  wire w" + std::to_string(i) + ";\n";
+  }
+  text += "endmodule\n";
+  InMemoryVerilogSourceFile file("a.sv", text);
+  ASSERT_TRUE(file.Parse().ok());
+  SymbolTable symbol_table(nullptr);
+  BuildSymbolTable(file, &symbol_table);
+  CompletionIndex index;
+  index.IndexSymbolTable(symbol_table);
+
+  verible::lsp::CompletionList list = CompleteFromIndex(
+      index, {.kind = CompletionContext::kIdentifier,
+              .prefix = "w",
+              .scopes = {"m", ""}});
+  EXPECT_TRUE(list.isIncomplete);
+  EXPECT_EQ(list.items.size(), 200);
+
+  // More typing narrows it down.
+  list = CompleteFromIndex(index, {.kind = CompletionContext::kIdentifier,
+                                   .prefix = "w29",
+                                   .scopes = {"m", ""}});
+  EXPECT_FALSE(list.isIncomplete);
+  EXPECT_EQ(list.items.size(), 11);
+}
+
+}  // namespace
+}  // namespace verilog
@@ -0,0 +1,91 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/diagnostic-publisher.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/hash/hash.h"
+#include "absl/time/time.h"
+#include "nlohmann/json.hpp"
+#include "verible/common/lsp/lsp-protocol.h"
+
+namespace verilog {
+
+void DiagnosticPublisher::Schedule(const std::string &uri, absl::Time now) {
+  const std::lock_guard<std::mutex> l(mutex_);
+  due_[uri] = now + delay_;
+}
+
+void DiagnosticPublisher::Remove(const std::string &uri) {
+  const std::lock_guard<std::mutex> l(mutex_);
+  due_.erase(uri);
+  published_hash_.erase(uri);
+}
+
+void DiagnosticPublisher::PublishDue(absl::Time now) {
+  const std::lock_guard<std::mutex> l(mutex_);
+  // Buffers that changed first are published first.
+  std::vector<std::pair<absl::Time, std::string>> due_uris;
+  for (const auto &[uri, due] : due_) {
+    if (due <= now) due_uris.emplace_back(due, uri);
+  }
+  std::sort(due_uris.begin(), due_uris.end());
+  for (const auto &[due, uri] : due_uris) {
+    due_.erase(uri);
+    Send(uri);
+  }
+}
+
+void DiagnosticPublisher::Publish(const std::string &uri) {
+  const std::lock_guard<std::mutex> l(mutex_);
+  if (due_.erase(uri) > 0) Send(uri);
+}
+
+void DiagnosticPublisher::Send(const std::string &uri) {
+  const std::optional<verible::lsp::PublishDiagnosticsParams> params =
+      create_(uri);
+  if (!params) {
+    published_hash_.erase(uri);
+    return;
+  }
+  const size_t hash =
+      absl::Hash<std::string>()(nlohmann::json(params->diagnostics).dump());
+  const auto published = published_hash_.find(uri);
+  if (published != published_hash_.end() && published->second == hash) {
+    ++unchanged_;
+    return;
+  }
+  published_hash_[uri] = hash;
+  send_(*params);
+  ++sent_;
+}
+
+absl::Time DiagnosticPublisher::NextDue() const {
+  const std::lock_guard<std::mutex> l(mutex_);
+  absl::Time next = absl::InfiniteFuture();
+  for (const auto &[uri, due] : due_) {
+    if (due < next) next = due;
+  }
+  return next;
+}
+
+}  // namespace verilog
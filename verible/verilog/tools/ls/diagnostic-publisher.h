@@ -0,0 +1,121 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef VERILOG_TOOLS_LS_DIAGNOSTIC_PUBLISHER_H
+#define VERILOG_TOOLS_LS_DIAGNOSTIC_PUBLISHER_H
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "absl/time/time.h"
+#include "verible/common/lsp/lsp-protocol.h"
+
+namespace verilog {
+
+// Sends textDocument/publishDiagnostics notifications for open buffers,
+// without flooding the client when many buffers change at once, e.g. with
+// a search-and-replace over all open files, or a new lint configuration.
+//
+// A buffer is published once it did not change for the delay, so a burst
+// of changes results in one notification with the diagnostics of the last
+// version.  Diagnostics are only created then, and not sent at all if they
+// are the same as those published last for that buffer.
+//
+// Can be used from several threads; "create" and "send" are called by one
+// at a time.
+class DiagnosticPublisher {
+ public:
+  // Creates the diagnostics of "uri", or returns nullopt if the buffer is
+  // not open anymore.
+  using CreateFun =
+      std::function<std::optional<verible::lsp::PublishDiagnosticsParams>(
+          const std::string &uri)>;
+
+  // Sends the notification.
+  using SendFun =
+      std::function<void(const verible::lsp::PublishDiagnosticsParams &)>;
+
+  DiagnosticPublisher(absl::Duration delay, CreateFun create, SendFun send)
+      : delay_(delay), create_(std::move(create)), send_(std::move(send)) {}
+
+  // The buffer "uri" changed at "now": publishes its diagnostics once it did
+  // not change for the delay.
+  void Schedule(const std::string &uri, absl::Time now);
+
+  // Forgets the buffer "uri", e.g. when it was closed, so that it is
+  // published again when it is opened the next time.
+  void Remove(const std::string &uri);
+
+  // Publishes the buffers that did not change for the delay before "now".
+  void PublishDue(absl::Time now);
+
+  // Publishes all scheduled buffers, e.g. before responding to a request
+  // that the client relates to the diagnostics it shows.
+  void PublishAll() { PublishDue(absl::InfiniteFuture()); }
+
+  // Publishes "uri" now if it is scheduled, e.g. before responding to a
+  // request about that buffer alone.
+  void Publish(const std::string &uri);
+
+  // Returns when the next scheduled buffer is due, or absl::InfiniteFuture()
+  // if none is scheduled.
+  absl::Time NextDue() const;
+
+  // Number of buffers scheduled, but not published yet.
+  size_t scheduled() const {
+    const std::lock_guard<std::mutex> l(mutex_);
+    return due_.size();
+  }
+
+  // Number of notifications sent, and of those not sent because the
+  // diagnostics did not change.
+  size_t sent() const {
+    const std::lock_guard<std::mutex> l(mutex_);
+    return sent_;
+  }
+  size_t unchanged() const {
+    const std::lock_guard<std::mutex> l(mutex_);
+    return unchanged_;
+  }
+
+ private:
+  // Sends the diagnostics of "uri", which is not scheduled anymore, unless
+  // they did not change. Called with mutex_ held.
+  void Send(const std::string &uri);
+
+  const absl::Duration delay_;
+  const CreateFun create_;
+  const SendFun send_;
+
+  mutable std::mutex mutex_;
+
+  // When each scheduled buffer is due.
+  std::unordered_map<std::string, absl::Time> due_;
+
+  // Hash of the diagnostics published last for each buffer.
+  std::unordered_map<std::string, size_t> published_hash_;
+
+  size_t sent_ = 0;
+  size_t unchanged_ = 0;
+};
+
+}  // namespace verilog
+
+#endif  // VERILOG_TOOLS_LS_DIAGNOSTIC_PUBLISHER_H
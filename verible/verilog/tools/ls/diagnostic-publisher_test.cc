@@ -0,0 +1,153 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/diagnostic-publisher.h"
+
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/common/lsp/lsp-protocol.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using verible::lsp::PublishDiagnosticsParams;
+
+class DiagnosticPublisherTest : public ::testing::Test {
+ protected:
+  DiagnosticPublisherTest()
+      : publisher_(
+            absl::Milliseconds(100),
+            [this](const std::string &uri)
+                -> std::optional<PublishDiagnosticsParams> {
+              ++created_;
+              const auto found = messages_.find(uri);
+              if (found == messages_.end()) return std::nullopt;
+              PublishDiagnosticsParams params{.uri = uri};
+              for (const std::string &message : found->second) {
+                params.diagnostics.push_back({.message = message});
+              }
+              return params;
+            },
+            [this](const PublishDiagnosticsParams &params) {
+              sent_.push_back(params.uri + ":" +
+                              std::to_string(params.diagnostics.size()));
+            }) {}
+
+  const absl::Time start_ = absl::FromUnixSeconds(1000);
+
+  // Diagnostic messages of the open buffers.
+  std::map<std::string, std::vector<std::string>> messages_;
+  int created_ = 0;
+  std::vector<std::string> sent_;  // "uri:number of diagnostics"
+  DiagnosticPublisher publisher_;
+};
+
+TEST_F(DiagnosticPublisherTest, PublishesOnceBufferIsQuiet) {
+  messages_["a.sv"] = {"unused"};
+  EXPECT_EQ(publisher_.NextDue(), absl::InfiniteFuture());
+
+  publisher_.Schedule("a.sv", start_);
+  EXPECT_EQ(publisher_.NextDue(), start_ + absl::Milliseconds(100));
+  publisher_.PublishDue(start_ + absl::Milliseconds(50));
+  EXPECT_THAT(sent_, IsEmpty());
+
+  // Every change postpones publishing.
+  publisher_.Schedule("a.sv", start_ + absl::Milliseconds(60));
+  publisher_.Schedule("a.sv", start_ + absl::Milliseconds(120));
+  publisher_.PublishDue(start_ + absl::Milliseconds(200));
+  EXPECT_THAT(sent_, IsEmpty());
+  EXPECT_EQ(created_, 0);
+
+  publisher_.PublishDue(start_ + absl::Milliseconds(220));
+  EXPECT_THAT(sent_, ElementsAre("a.sv:1"));
+  EXPECT_EQ(created_, 1);
+  EXPECT_EQ(publisher_.scheduled(), 0);
+  EXPECT_EQ(publisher_.NextDue(), absl::InfiniteFuture());
+}
+
+TEST_F(DiagnosticPublisherTest, SuppressesUnchangedDiagnostics) {
+  messages_["a.sv"] = {"unused"};
+  messages_["b.sv"] = {};
+  publisher_.Schedule("a.sv", start_);
+  publisher_.Schedule("b.sv", start_);
+  publisher_.PublishAll();
+  EXPECT_THAT(sent_, ElementsAre("a.sv:1", "b.sv:0"));
+
+  // Same diagnostics after an edit: nothing sent.
+  publisher_.Schedule("a.sv", start_);
+  publisher_.PublishAll();
+  EXPECT_EQ(sent_.size(), 2);
+  EXPECT_EQ(publisher_.unchanged(), 1);
+
+  // Changed diagnostics are sent.
+  messages_["a.sv"] = {"unused", "too long"};
+  publisher_.Schedule("a.sv", start_);
+  publisher_.PublishAll();
+  EXPECT_THAT(sent_, ElementsAre("a.sv:1", "b.sv:0", "a.sv:2"));
+  EXPECT_EQ(publisher_.sent(), 3);
+}
+
+TEST_F(DiagnosticPublisherTest, PublishesOneBuffer) {
+  messages_["a.sv"] = {"unused"};
+  messages_["b.sv"] = {};
+  publisher_.Schedule("a.sv", start_);
+  publisher_.Schedule("b.sv", start_);
+  publisher_.Publish("b.sv");
+  EXPECT_THAT(sent_, ElementsAre("b.sv:0"));
+  EXPECT_EQ(publisher_.scheduled(), 1);
+
+  // Not scheduled anymore: nothing to do.
+  publisher_.Publish("b.sv");
+  EXPECT_EQ(created_, 1);
+
+  publisher_.PublishAll();
+  EXPECT_THAT(sent_, ElementsAre("b.sv:0", "a.sv:1"));
+}
+
+TEST_F(DiagnosticPublisherTest, RemovedBufferIsPublishedAgain) {
+  messages_["a.sv"] = {"unused"};
+  publisher_.Schedule("a.sv", start_);
+  publisher_.PublishAll();
+
+  // Closed before it was due: not published.
+  publisher_.Schedule("a.sv", start_);
+  publisher_.Remove("a.sv");
+  publisher_.PublishAll();
+  EXPECT_EQ(created_, 1);
+
+  // Opened again: the client forgot the diagnostics, so they are sent
+  // even if unchanged.
+  publisher_.Schedule("a.sv", start_);
+  publisher_.PublishAll();
+  EXPECT_THAT(sent_, ElementsAre("a.sv:1", "a.sv:1"));
+}
+
+TEST_F(DiagnosticPublisherTest, BufferClosedWhenDue) {
+  publisher_.Schedule("gone.sv", start_);
+  publisher_.PublishAll();
+  EXPECT_EQ(created_, 1);
+  EXPECT_THAT(sent_, IsEmpty());
+}
+
+}  // namespace
+}  // namespace verilog
@@ -23,49 +23,98 @@
 #include <utility>
 #include <vector>
 
+#include "absl/flags/flag.h"
+#include "absl/hash/hash.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "verible/common/analysis/lint-rule-status.h"
 #include "verible/common/lsp/lsp-file-utils.h"
 #include "verible/common/lsp/lsp-text-buffer.h"
 #include "verible/common/util/logging.h"
+#include "verible/verilog/analysis/top-modules-flag.h"
 #include "verible/verilog/analysis/verilog-analyzer.h"
 #include "verible/verilog/analysis/verilog-linter-configuration.h"
 #include "verible/verilog/analysis/verilog-linter.h"
 
 namespace verilog {
-static absl::StatusOr<std::vector<verible::LintRuleStatus>> RunLinter(
-    std::string_view filename, const verilog::VerilogAnalyzer &parser) {
-  const auto &text_structure = parser.Data();
-
+static verilog::LinterConfiguration LinterConfigurationForUri(
+    std::string_view uri) {
   verilog::LinterConfiguration config;
-  const std::string file_path = verible::lsp::LSPUriToPath(filename);
+  const std::string file_path = verible::lsp::LSPUriToPath(uri);
   if (auto from_flags = LinterConfigurationFromFlags(file_path);
       from_flags.ok()) {
     config = *from_flags;
   } else {
     LOG(ERROR) << from_flags.status().message() << std::endl;
   }
+  return config;
+}
+
+static uint64_t Fingerprint(const verilog::LinterConfiguration &config) {
+  verilog::RuleBundle bundle;
+  config.GetRuleBundle(&bundle);
+  // Rules that look at the top modules are also configured by these.
+  const auto &top_modules =
+      verilog::analysis::TopModulesCache::GetInstance().GetTopModules();
+  return absl::Hash<std::string>()(absl::StrCat(
+      bundle.UnparseConfiguration(','), "\n", config.external_waivers, "\n",
+      absl::GetFlag(FLAGS_top_modules), "\n",
+      absl::StrJoin(top_modules, ",")));
+}
+
+uint64_t LintConfigurationFingerprint(std::string_view uri) {
+  return Fingerprint(LinterConfigurationForUri(uri));
+}
+
+static absl::StatusOr<std::vector<verible::LintRuleStatus>> RunLinter(
+    std::string_view filename, const verilog::VerilogAnalyzer &parser,
+    uint64_t *config_fingerprint, ParsedBuffer::Timing *timing) {
+  const absl::Time start = absl::Now();
+  const auto &text_structure = parser.Data();
+  const verilog::LinterConfiguration config =
+      LinterConfigurationForUri(filename);
+  *config_fingerprint = Fingerprint(config);
+  auto result = VerilogLintTextStructure(filename, config, text_structure,
+                                         &timing->lint_phases);
+  timing->lint = absl::Now() - start;
+  return result;
+}
 
-  return VerilogLintTextStructure(filename, config, text_structure);
+// Returns the analysis of "content", and stores how long it took.
+static std::unique_ptr<verilog::VerilogAnalyzer> TimedAnalyze(
+    std::string_view content, std::string_view uri,
+    ParsedBuffer::Timing *timing) {
+  const absl::Time start = absl::Now();
+  auto parser =
+      VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(content, uri);
+  timing->analyze = absl::Now() - start;
+  timing->analyze_phases = parser->Timing();
+  return parser;
 }
 
 ParsedBuffer::ParsedBuffer(int64_t version, std::string_view uri,
                            std::string_view content)
     : version_(version),
       uri_(uri),
-      parser_(verilog::VerilogAnalyzer::AnalyzeAutomaticPreprocessFallback(
-          content, uri)) {
+      parser_(TimedAnalyze(content, uri, &timing_)) {
   VLOG(1) << "Analyzed " << uri << " lex:" << parser_->LexStatus()
           << "; parser:" << parser_->ParseStatus() << std::endl;
   // TODO(hzeller): should we use a filename not URI ?
-  if (auto lint_result = RunLinter(uri, *parser_); lint_result.ok()) {
+  if (auto lint_result =
+          RunLinter(uri, *parser_, &lint_fingerprint_, &timing_);
+      lint_result.ok()) {
     lint_statuses_ = std::move(lint_result.value());
   }
 }
 
 void ParsedBuffer::ReLint() const {
-  if (auto lint_result = RunLinter(uri_, *parser_); lint_result.ok()) {
+  if (auto lint_result =
+          RunLinter(uri_, *parser_, &lint_fingerprint_, &timing_);
+      lint_result.ok()) {
     lint_statuses_ = std::move(lint_result.value());
   }
 }
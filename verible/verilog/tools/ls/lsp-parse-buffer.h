@@ -24,10 +24,12 @@
 #include <unordered_map>
 #include <vector>
 
+#include "absl/time/time.h"
 #include "verible/common/analysis/lint-rule-status.h"
 #include "verible/common/lsp/lsp-text-buffer.h"
 #include "verible/common/util/logging.h"
 #include "verible/verilog/analysis/verilog-analyzer.h"
+#include "verible/verilog/analysis/verilog-linter.h"
 
 // ParseBuffer and BufferTrackerContainer are tracking fully parsed content
 // and are corresponding to verible::lsp::EditTextBuffer and
@@ -35,6 +37,11 @@
 // bare editor text.
 
 namespace verilog {
+// Returns a fingerprint of the linter configuration that applies to the file
+// at "uri". Lint results only change with the file content or with this.
+// Only comparable within the same process.
+uint64_t LintConfigurationFingerprint(std::string_view uri);
+
 // A parsed buffer collects all the artifacts generated from a text buffer
 // from parsing or running the linter.
 //
@@ -61,12 +68,29 @@ class ParsedBuffer {
   int64_t version() const { return version_; }
   const std::string &uri() const { return uri_; }
 
+  // Fingerprint of the linter configuration of the last (re-)lint.
+  uint64_t lint_fingerprint() const { return lint_fingerprint_; }
+
+  // Where the time went when the buffer was analyzed, and (re-)linted.
+  struct Timing {
+    // All attempts of the analysis with and without preprocessing.
+    absl::Duration analyze;
+    // The phases of the attempt that was kept.
+    VerilogAnalyzer::PhaseTimes analyze_phases;
+    absl::Duration lint;
+    LinterTimes lint_phases;
+  };
+  const Timing &timing() const { return timing_; }
+
  private:
   const int64_t version_;
   const std::string uri_;
+  // Before parser_, as it is filled while parser_ is initialized.
+  mutable Timing timing_;
   const std::unique_ptr<verilog::VerilogAnalyzer> parser_;
   // Mutable to allow re-linting when global configuration changes.
   mutable std::vector<verible::LintRuleStatus> lint_statuses_;
+  mutable uint64_t lint_fingerprint_ = 0;
 };
 
 // A buffer tracker tracks of a single file EditTextBuffer content and stores
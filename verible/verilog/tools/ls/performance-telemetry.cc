@@ -0,0 +1,130 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/performance-telemetry.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "absl/time/time.h"
+#include "nlohmann/json.hpp"
+
+namespace verilog {
+
+int64_t ResidentMemoryBytes() {
+#ifdef __linux__
+  std::ifstream statm("/proc/self/statm");
+  int64_t size_pages;
+  int64_t resident_pages;
+  if (statm >> size_pages >> resident_pages) {
+    return resident_pages * sysconf(_SC_PAGESIZE);
+  }
+#endif
+  return -1;
+}
+
+void PerformanceTelemetry::Record(TelemetryEvent event) {
+  if (!enabled()) return;
+  if (events_.size() < capacity_) {
+    events_.push_back(std::move(event));
+    return;
+  }
+  events_[next_] = std::move(event);
+  next_ = (next_ + 1) % capacity_;
+  ++dropped_;
+}
+
+std::vector<TelemetryEvent> PerformanceTelemetry::Events() const {
+  std::vector<TelemetryEvent> events;
+  events.reserve(events_.size());
+  for (size_t i = 0; i < events_.size(); ++i) {
+    events.push_back(events_[(next_ + i) % events_.size()]);
+  }
+  return events;
+}
+
+static int64_t Microseconds(absl::Duration d) {
+  return absl::ToInt64Microseconds(d);
+}
+
+nlohmann::json PerformanceTelemetry::ToJson() const {
+  nlohmann::json events = nlohmann::json::array();
+  for (const TelemetryEvent &event : Events()) {
+    nlohmann::json phases = nlohmann::json::object();
+    for (const auto &[name, duration] : event.phases) {
+      phases[name] = Microseconds(duration);
+    }
+    events.push_back({
+        {"name", event.name},
+        {"subject", event.subject},
+        {"startUs", absl::ToUnixMicros(event.start)},
+        {"durationUs", Microseconds(event.duration)},
+        {"bytes", event.bytes},
+        {"memoryDeltaBytes", event.memory_delta},
+        {"phasesUs", phases},
+    });
+  }
+  return {
+      {"capacity", capacity_},
+      {"dropped", dropped_},
+      {"events", events},
+  };
+}
+
+nlohmann::json PerformanceTelemetry::ToChromeTrace() const {
+  nlohmann::json trace_events = nlohmann::json::array();
+  // All on one thread: the server does one thing at a time.
+  const auto complete_event = [](const std::string &name, absl::Time start,
+                                 absl::Duration duration) -> nlohmann::json {
+    return {
+        {"name", name},
+        {"cat", "verible-verilog-ls"},
+        {"ph", "X"},
+        {"ts", absl::ToUnixMicros(start)},
+        {"dur", Microseconds(duration)},
+        {"pid", 1},
+        {"tid", 1},
+    };
+  };
+  for (const TelemetryEvent &event : Events()) {
+    nlohmann::json outer =
+        complete_event(event.name, event.start, event.duration);
+    outer["args"] = {
+        {"subject", event.subject},
+        {"bytes", event.bytes},
+        {"memoryDeltaBytes", event.memory_delta},
+    };
+    trace_events.push_back(std::move(outer));
+    absl::Time phase_start = event.start;
+    for (const auto &[name, duration] : event.phases) {
+      trace_events.push_back(complete_event(name, phase_start, duration));
+      phase_start += duration;
+    }
+  }
+  return {
+      {"traceEvents", trace_events},
+      {"displayTimeUnit", "ms"},
+  };
+}
+
+}  // namespace verilog
@@ -0,0 +1,99 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef VERILOG_TOOLS_LS_PERFORMANCE_TELEMETRY_H
+#define VERILOG_TOOLS_LS_PERFORMANCE_TELEMETRY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "nlohmann/json.hpp"
+
+namespace verilog {
+
+// Returns the resident set size of this process in bytes, or -1 if it is
+// not known on this platform.
+int64_t ResidentMemoryBytes();
+
+// Something the language server did, and where the time went.
+struct TelemetryEvent {
+  // What was done, e.g. "parse" or "symbol-table".
+  std::string name;
+
+  // What it was done to, e.g. the URI of the buffer; may be empty.
+  std::string subject;
+
+  absl::Time start;
+  absl::Duration duration;
+
+  // Size of the input in bytes, or -1 if not known.
+  int64_t bytes = -1;
+
+  // Change of the resident memory of the process, or 0 if not known.
+  int64_t memory_delta = 0;
+
+  // Consecutive parts of the duration, in order; they need not add up to
+  // all of it.
+  std::vector<std::pair<std::string, absl::Duration>> phases;
+};
+
+// Keeps the last events, for field reports of a slow language server.
+//
+// Events are kept in a ring buffer of fixed capacity, so that the memory
+// use does not grow with the lifetime of the server.  With a capacity of
+// 0, nothing is recorded, and the callers should not spend time on
+// measuring.
+class PerformanceTelemetry {
+ public:
+  explicit PerformanceTelemetry(size_t capacity = 0) : capacity_(capacity) {}
+
+  bool enabled() const { return capacity_ > 0; }
+
+  // Keeps "event", forgetting the oldest event if the buffer is full.
+  void Record(TelemetryEvent event);
+
+  // Returns the kept events, oldest first.
+  std::vector<TelemetryEvent> Events() const;
+
+  size_t size() const { return events_.size(); }
+
+  // Number of events forgotten because the buffer was full.
+  size_t dropped() const { return dropped_; }
+
+  // Returns the kept events as JSON, for a custom request of the client.
+  // Times are in microseconds.
+  nlohmann::json ToJson() const;
+
+  // Returns the kept events in the Chrome trace event format, to be opened
+  // in chrome://tracing or https://ui.perfetto.dev.  Phases become nested
+  // events.
+  nlohmann::json ToChromeTrace() const;
+
+ private:
+  const size_t capacity_;
+
+  // Ring buffer; the oldest event is at next_ once it is full.
+  std::vector<TelemetryEvent> events_;
+  size_t next_ = 0;
+  size_t dropped_ = 0;
+};
+
+}  // namespace verilog
+
+#endif  // VERILOG_TOOLS_LS_PERFORMANCE_TELEMETRY_H
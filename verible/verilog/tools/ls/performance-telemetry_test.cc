@@ -0,0 +1,128 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/performance-telemetry.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "nlohmann/json.hpp"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+const absl::Time kStart = absl::FromUnixMicros(1'000'000);
+
+TelemetryEvent MakeEvent(const std::string &subject) {
+  return {
+      .name = "parse",
+      .subject = subject,
+      .start = kStart,
+      .duration = absl::Microseconds(30),
+      .bytes = 100,
+      .memory_delta = 4096,
+      .phases = {{"lex", absl::Microseconds(10)},
+                 {"parse", absl::Microseconds(15)}},
+  };
+}
+
+std::vector<std::string> Subjects(const PerformanceTelemetry &telemetry) {
+  std::vector<std::string> subjects;
+  for (const TelemetryEvent &event : telemetry.Events()) {
+    subjects.push_back(event.subject);
+  }
+  return subjects;
+}
+
+TEST(PerformanceTelemetryTest, DisabledRecordsNothing) {
+  PerformanceTelemetry telemetry;
+  EXPECT_FALSE(telemetry.enabled());
+  telemetry.Record(MakeEvent("a.sv"));
+  EXPECT_EQ(telemetry.size(), 0);
+  EXPECT_THAT(telemetry.Events(), IsEmpty());
+}
+
+TEST(PerformanceTelemetryTest, KeepsLastEventsOldestFirst) {
+  PerformanceTelemetry telemetry(3);
+  EXPECT_TRUE(telemetry.enabled());
+  telemetry.Record(MakeEvent("a.sv"));
+  telemetry.Record(MakeEvent("b.sv"));
+  EXPECT_THAT(Subjects(telemetry), ElementsAre("a.sv", "b.sv"));
+  EXPECT_EQ(telemetry.dropped(), 0);
+
+  for (const char *subject : {"c.sv", "d.sv", "e.sv", "f.sv"}) {
+    telemetry.Record(MakeEvent(subject));
+  }
+  EXPECT_THAT(Subjects(telemetry), ElementsAre("d.sv", "e.sv", "f.sv"));
+  EXPECT_EQ(telemetry.size(), 3);
+  EXPECT_EQ(telemetry.dropped(), 3);
+}
+
+TEST(PerformanceTelemetryTest, ToJson) {
+  PerformanceTelemetry telemetry(2);
+  telemetry.Record(MakeEvent("a.sv"));
+  EXPECT_EQ(telemetry.ToJson(), nlohmann::json::parse(R"({
+    "capacity": 2,
+    "dropped": 0,
+    "events": [{
+      "name": "parse",
+      "subject": "a.sv",
+      "startUs": 1000000,
+      "durationUs": 30,
+      "bytes": 100,
+      "memoryDeltaBytes": 4096,
+      "phasesUs": {"lex": 10, "parse": 15}
+    }]
+  })"));
+}
+
+TEST(PerformanceTelemetryTest, ToChromeTraceNestsPhases) {
+  PerformanceTelemetry telemetry(2);
+  telemetry.Record(MakeEvent("a.sv"));
+  const nlohmann::json trace = telemetry.ToChromeTrace();
+  const nlohmann::json &events = trace["traceEvents"];
+  ASSERT_EQ(events.size(), 3);
+  EXPECT_EQ(events[0]["name"], "parse");
+  EXPECT_EQ(events[0]["ph"], "X");
+  EXPECT_EQ(events[0]["ts"], 1000000);
+  EXPECT_EQ(events[0]["dur"], 30);
+  EXPECT_EQ(events[0]["args"]["subject"], "a.sv");
+  EXPECT_EQ(events[0]["args"]["bytes"], 100);
+
+  // One after the other, within the event.
+  EXPECT_EQ(events[1]["name"], "lex");
+  EXPECT_EQ(events[1]["ts"], 1000000);
+  EXPECT_EQ(events[1]["dur"], 10);
+  EXPECT_EQ(events[2]["name"], "parse");
+  EXPECT_EQ(events[2]["ts"], 1000010);
+  EXPECT_EQ(events[2]["dur"], 15);
+}
+
+TEST(PerformanceTelemetryTest, ResidentMemoryBytes) {
+#ifdef __linux__
+  EXPECT_GT(ResidentMemoryBytes(), 0);
+#else
+  EXPECT_EQ(ResidentMemoryBytes(), -1);
+#endif
+}
+
+}  // namespace
+}  // namespace verilog
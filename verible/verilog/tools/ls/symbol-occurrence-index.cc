@@ -0,0 +1,178 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/symbol-occurrence-index.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <string_view>
+#include <vector>
+
+#include "verible/common/util/range.h"
+#include "verible/verilog/analysis/symbol-table.h"
+
+namespace verilog {
+
+static const SymbolTableNode *ScanSymbolTreeForDefinitionReferenceComponents(
+    const ReferenceComponentNode *ref, std::string_view symbol) {
+  if (verible::IsSubRange(symbol, ref->Value().identifier)) {
+    return ref->Value().resolved_symbol;
+  }
+  for (const auto &childref : ref->Children()) {
+    const SymbolTableNode *resolved =
+        ScanSymbolTreeForDefinitionReferenceComponents(&childref, symbol);
+    if (resolved) return resolved;
+  }
+  return nullptr;
+}
+
+const SymbolTableNode *ScanSymbolTreeForDefinition(
+    const SymbolTableNode *context, std::string_view symbol) {
+  if (!context) {
+    return nullptr;
+  }
+  if (context->Key() && verible::IsSubRange(*context->Key(), symbol)) {
+    return context;
+  }
+  for (const auto &sdef : context->Value().supplement_definitions) {
+    if (verible::IsSubRange(sdef, symbol)) {
+      return context;
+    }
+  }
+  for (const auto &ref : context->Value().local_references_to_bind) {
+    if (ref.Empty()) continue;
+    const SymbolTableNode *resolved =
+        ScanSymbolTreeForDefinitionReferenceComponents(ref.components.get(),
+                                                       symbol);
+    if (resolved) return resolved;
+  }
+  for (const auto &child : context->Children()) {
+    const SymbolTableNode *res =
+        ScanSymbolTreeForDefinition(&child.second, symbol);
+    if (res) {
+      return res;
+    }
+  }
+  return nullptr;
+}
+
+using Occurrence = SymbolOccurrenceIndex::Occurrence;
+
+// Addresses of different files are only comparable with std::less.
+static bool Before(const char *a, const char *b) {
+  return std::less<const char *>()(a, b);
+}
+
+static void CollectReferenceOccurrences(const ReferenceComponentNode &ref,
+                                        std::vector<Occurrence> *occurrences) {
+  const ReferenceComponent &component = ref.Value();
+  if (component.resolved_symbol != nullptr) {
+    occurrences->push_back({.text = component.identifier,
+                            .definition = component.resolved_symbol,
+                            .order = occurrences->size()});
+  }
+  for (const auto &child : ref.Children()) {
+    CollectReferenceOccurrences(child, occurrences);
+  }
+}
+
+// Collects the occurrences in the order ScanSymbolTreeForDefinition() visits
+// them.
+static void CollectOccurrences(const SymbolTableNode &node,
+                               std::vector<Occurrence> *occurrences) {
+  const SymbolInfo &info = node.Value();
+  if (node.Key()) {
+    occurrences->push_back({.text = *node.Key(),
+                            .definition = &node,
+                            .order = occurrences->size()});
+  }
+  for (std::string_view sdef : info.supplement_definitions) {
+    occurrences->push_back(
+        {.text = sdef, .definition = &node, .order = occurrences->size()});
+  }
+  for (const DependentReferences &ref : info.local_references_to_bind) {
+    if (ref.Empty()) continue;
+    CollectReferenceOccurrences(*ref.components, occurrences);
+  }
+  for (const auto &child : node.Children()) {
+    CollectOccurrences(child.second, occurrences);
+  }
+}
+
+void SymbolOccurrenceIndex::Build(const SymbolTable &symbol_table) {
+  occurrences_.clear();
+  CollectOccurrences(symbol_table.Root(), &occurrences_);
+  std::sort(occurrences_.begin(), occurrences_.end(),
+            [](const Occurrence &a, const Occurrence &b) {
+              if (a.text.data() != b.text.data()) {
+                return Before(a.text.data(), b.text.data());
+              }
+              if (a.text.size() != b.text.size()) {
+                return a.text.size() < b.text.size();
+              }
+              return a.order < b.order;
+            });
+  // Of the same text, only the first found by the scan counts.
+  occurrences_.erase(
+      std::unique(occurrences_.begin(), occurrences_.end(),
+                  [](const Occurrence &a, const Occurrence &b) {
+                    return a.text.data() == b.text.data() &&
+                           a.text.size() == b.text.size();
+                  }),
+      occurrences_.end());
+}
+
+// The string views may point into different files, so their ranges are
+// compared with std::less, unlike verible::IsSubRange().
+static bool Contains(std::string_view outer, std::string_view inner) {
+  return !Before(inner.data(), outer.data()) &&
+         !Before(outer.data() + outer.size(), inner.data() + inner.size());
+}
+
+static std::vector<Occurrence>::const_iterator FirstAtOrAfter(
+    const std::vector<Occurrence> &occurrences, const char *position) {
+  return std::lower_bound(occurrences.begin(), occurrences.end(), position,
+                          [](const Occurrence &o, const char *p) {
+                            return Before(o.text.data(), p);
+                          });
+}
+
+const Occurrence *SymbolOccurrenceIndex::Find(std::string_view text) const {
+  auto it = FirstAtOrAfter(occurrences_, text.data());
+  // Texts in one file do not overlap, so only the one before can contain
+  // "text".
+  if (it != occurrences_.begin()) --it;
+  const Occurrence *found = nullptr;
+  for (; it != occurrences_.end() &&
+         !Before(text.data() + text.size(), it->text.data());
+       ++it) {
+    if (!Contains(text, it->text) && !Contains(it->text, text)) continue;
+    if (found == nullptr || it->order < found->order) found = &*it;
+  }
+  return found;
+}
+
+std::vector<std::string_view> SymbolOccurrenceIndex::FindAllIn(
+    std::string_view content, const SymbolTableNode *definition) const {
+  std::vector<std::string_view> found;
+  for (auto it = FirstAtOrAfter(occurrences_, content.data());
+       it != occurrences_.end() && Contains(content, it->text); ++it) {
+    if (it->definition == definition) found.push_back(it->text);
+  }
+  return found;
+}
+
+}  // namespace verilog
@@ -0,0 +1,80 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef VERILOG_TOOLS_LS_SYMBOL_OCCURRENCE_INDEX_H
+#define VERILOG_TOOLS_LS_SYMBOL_OCCURRENCE_INDEX_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+#include "verible/verilog/analysis/symbol-table.h"
+
+namespace verilog {
+
+// Returns the definition of the symbol whose definition or resolved
+// reference in the symbol table is the text "symbol", by visiting all
+// symbols and references below "context".  Slow for large projects; this is
+// what the SymbolOccurrenceIndex answers with a binary search.
+const SymbolTableNode *ScanSymbolTreeForDefinition(
+    const SymbolTableNode *context, std::string_view symbol);
+
+// Where each symbol of a resolved symbol table is defined or referenced,
+// i.e. the names of definitions, and the identifiers of resolved
+// references, with the definition they refer to.
+//
+// Occurrences are found by their text, which is a substring of the contents
+// of a source file, like the text of a token: they are sorted by address,
+// so all occurrences in one file are adjacent and sorted by position.
+//
+// The index points into the symbol table and the file contents, and must be
+// built again when they change.
+class SymbolOccurrenceIndex {
+ public:
+  struct Occurrence {
+    // Substring of the file contents.
+    std::string_view text;
+
+    const SymbolTableNode *definition = nullptr;
+
+    // Position in the pre-order of the symbol table, in which
+    // ScanSymbolTreeForDefinition() visits the occurrences.
+    size_t order = 0;
+  };
+
+  // Replaces all occurrences with those of "symbol_table".
+  void Build(const SymbolTable &symbol_table);
+
+  void Clear() { occurrences_.clear(); }
+
+  // Returns the occurrence that is, contains, or is contained in "text",
+  // or nullptr if there is none.  If there are several, returns the one
+  // that ScanSymbolTreeForDefinition() finds first.
+  const Occurrence *Find(std::string_view text) const;
+
+  // Returns the occurrences in "content", e.g. the contents of a file, that
+  // refer to "definition", in order of position.
+  std::vector<std::string_view> FindAllIn(
+      std::string_view content, const SymbolTableNode *definition) const;
+
+  size_t size() const { return occurrences_.size(); }
+
+ private:
+  std::vector<Occurrence> occurrences_;
+};
+
+}  // namespace verilog
+
+#endif  // VERILOG_TOOLS_LS_SYMBOL_OCCURRENCE_INDEX_H
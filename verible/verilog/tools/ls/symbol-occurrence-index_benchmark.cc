@@ -0,0 +1,151 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+// Compares finding the definition at a cursor by scanning the symbol table,
+// as the language server did, with the SymbolOccurrenceIndex, on a generated
+// project of modules that each instantiate the one before.
+//
+// Usage: symbol-occurrence-index_benchmark [--modules=N] [--signals=N]
+//            [--lookups=N]
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "verible/common/text/token-info.h"
+#include "verible/common/util/init-command-line.h"
+#include "verible/verilog/analysis/symbol-table.h"
+#include "verible/verilog/analysis/verilog-project.h"
+#include "verible/verilog/parser/verilog-token-enum.h"
+#include "verible/verilog/tools/ls/symbol-occurrence-index.h"
+
+ABSL_FLAG(int, modules, 500, "Number of generated modules.");
+ABSL_FLAG(int, signals, 20, "Number of signals in each module.");
+ABSL_FLAG(int, lookups, 2000,
+          "Number of identifiers looked up, evenly spread over the project.");
+
+// Returns a module with "signals" signals, which are assigned from each
+// other, and connected to an instance of the module "index" - 1.
+static std::string GenerateModule(int index, int signals) {
+  std::string text = absl::StrCat("module m", index, "(input logic clk");
+  for (int s = 0; s < signals; ++s) absl::StrAppend(&text, ", output p", s);
+  absl::StrAppend(&text, ");\n");
+  for (int s = 0; s < signals; ++s) {
+    absl::StrAppend(&text, "  logic s", s, ";\n");
+    absl::StrAppend(&text, "  assign p", s, " = s", s, " ^ s",
+                    (s + 1) % signals, ";\n");
+  }
+  if (index > 0) {
+    absl::StrAppend(&text, "  m", index - 1, " sub(.clk(clk)");
+    for (int s = 0; s < signals; ++s) {
+      absl::StrAppend(&text, ", .p", s, "(s", s, ")");
+    }
+    absl::StrAppend(&text, ");\n");
+  }
+  absl::StrAppend(&text, "endmodule\n");
+  return text;
+}
+
+int main(int argc, char **argv) {
+  const auto usage = absl::StrCat("usage: ", argv[0], " [options]");
+  verible::InitCommandLine(usage, &argc, &argv);
+  const int modules = std::max(absl::GetFlag(FLAGS_modules), 1);
+  const int signals = std::max(absl::GetFlag(FLAGS_signals), 1);
+  const size_t lookups = std::max(absl::GetFlag(FLAGS_lookups), 1);
+
+  std::vector<std::unique_ptr<verilog::InMemoryVerilogSourceFile>> files;
+  verilog::SymbolTable symbol_table(nullptr);
+  size_t total_bytes = 0;
+  absl::Time start = absl::Now();
+  for (int m = 0; m < modules; ++m) {
+    files.push_back(std::make_unique<verilog::InMemoryVerilogSourceFile>(
+        absl::StrCat("m", m, ".sv"), GenerateModule(m, signals)));
+    const absl::Status status = files.back()->Parse();
+    if (!status.ok()) {
+      std::cerr << status << std::endl;
+      return 1;
+    }
+    verilog::BuildSymbolTable(*files.back(), &symbol_table);
+    total_bytes += files.back()->GetContent().size();
+  }
+  std::vector<absl::Status> diagnostics;
+  symbol_table.Resolve(&diagnostics);
+  std::cout << absl::StrFormat("%d files, %d bytes: parse and resolve %s\n",
+                               files.size(), total_bytes,
+                               absl::FormatDuration(absl::Now() - start));
+
+  start = absl::Now();
+  verilog::SymbolOccurrenceIndex index;
+  index.Build(symbol_table);
+  std::cout << absl::StrFormat("index %d occurrences: %s\n", index.size(),
+                               absl::FormatDuration(absl::Now() - start));
+
+  std::vector<std::string_view> identifiers;
+  for (const auto &file : files) {
+    for (const verible::TokenInfo &token :
+         file->GetTextStructure()->TokenStream()) {
+      if (token.token_enum() == verilog_tokentype::SymbolIdentifier) {
+        identifiers.push_back(token.text());
+      }
+    }
+  }
+  std::vector<std::string_view> sample;
+  const size_t step = std::max<size_t>(identifiers.size() / lookups, 1);
+  for (size_t i = 0; i < identifiers.size() && sample.size() < lookups;
+       i += step) {
+    sample.push_back(identifiers[i]);
+  }
+
+  std::vector<const verilog::SymbolTableNode *> scanned;
+  start = absl::Now();
+  for (std::string_view identifier : sample) {
+    scanned.push_back(
+        verilog::ScanSymbolTreeForDefinition(&symbol_table.Root(), identifier));
+  }
+  const absl::Duration scan_time = absl::Now() - start;
+
+  std::vector<const verilog::SymbolTableNode *> indexed;
+  start = absl::Now();
+  for (std::string_view identifier : sample) {
+    const verilog::SymbolOccurrenceIndex::Occurrence *occurrence =
+        index.Find(identifier);
+    indexed.push_back(occurrence ? occurrence->definition : nullptr);
+  }
+  const absl::Duration index_time = absl::Now() - start;
+
+  const int64_t count = sample.size();
+  const int64_t found =
+      count - std::count(scanned.begin(), scanned.end(), nullptr);
+  std::cout << absl::StrFormat(
+      "%d lookups (%d found): scan %s, index %s per lookup\n", count, found,
+      absl::FormatDuration(scan_time / count),
+      absl::FormatDuration(index_time / count));
+  if (scanned != indexed) {
+    std::cerr << "Scan and index found different definitions." << std::endl;
+    return 1;
+  }
+  return 0;
+}
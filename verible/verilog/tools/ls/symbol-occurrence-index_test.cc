@@ -0,0 +1,171 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/symbol-occurrence-index.h"
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/common/text/token-info.h"
+#include "verible/verilog/analysis/symbol-table.h"
+#include "verible/verilog/analysis/verilog-project.h"
+#include "verible/verilog/parser/verilog-token-enum.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+class SymbolOccurrenceIndexTest : public ::testing::Test {
+ protected:
+  // Parses "text" as the file "name", and adds its symbols to the table.
+  const VerilogSourceFile &AddFile(std::string_view name,
+                                   std::string_view text) {
+    files_.push_back(std::make_unique<InMemoryVerilogSourceFile>(name, text));
+    EXPECT_TRUE(files_.back()->Parse().ok());
+    EXPECT_THAT(BuildSymbolTable(*files_.back(), &symbol_table_), IsEmpty());
+    return *files_.back();
+  }
+
+  // Returns the first occurrence of "name" in "file" after "after".
+  static std::string_view Text(const VerilogSourceFile &file,
+                               std::string_view name, size_t after = 0) {
+    const std::string_view content = file.GetContent();
+    return content.substr(content.find(name, after), name.size());
+  }
+
+  SymbolTable symbol_table_{nullptr};
+  std::vector<std::unique_ptr<InMemoryVerilogSourceFile>> files_;
+};
+
+TEST_F(SymbolOccurrenceIndexTest, FindsDefinitionsAndReferences) {
+  const VerilogSourceFile &a = AddFile(
+      "a.sv",
+      "module alpha(input clk);\n"
+      "  wire sig;\n"
+      "  assign sig = clk;\n"
+      "endmodule\n");
+  const VerilogSourceFile &b = AddFile(
+      "b.sv",
+      "module beta;\n"
+      "  wire sig;\n"
+      "  alpha a1(.clk(sig));\n"
+      "endmodule\n");
+  std::vector<absl::Status> diagnostics;
+  symbol_table_.Resolve(&diagnostics);
+  EXPECT_THAT(diagnostics, IsEmpty());
+
+  SymbolOccurrenceIndex index;
+  index.Build(symbol_table_);
+  EXPECT_GT(index.size(), 0);
+
+  const SymbolTableNode &root = symbol_table_.Root();
+  const SymbolTableNode &alpha = root.Children().at("alpha");
+  const SymbolTableNode &alpha_sig = alpha.Children().at("sig");
+  const SymbolTableNode &beta_sig =
+      root.Children().at("beta").Children().at("sig");
+
+  // Definitions.
+  const SymbolOccurrenceIndex::Occurrence *found =
+      index.Find(Text(a, "alpha"));
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->definition, &alpha);
+  found = index.Find(Text(b, "sig"));
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->definition, &beta_sig);
+
+  // References, also to other files.
+  found = index.Find(Text(a, "sig", a.GetContent().find("assign")));
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->definition, &alpha_sig);
+  found = index.Find(Text(b, "alpha"));
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->definition, &alpha);
+  found = index.Find(Text(b, "clk"));
+  ASSERT_NE(found, nullptr);
+  EXPECT_EQ(found->definition, &alpha.Children().at("clk"));
+
+  // Not a symbol.
+  EXPECT_EQ(index.Find(Text(a, "assign")), nullptr);
+  EXPECT_EQ(index.Find("alpha"), nullptr);  // Not in any file.
+
+  // In order of position, only in the given file.
+  EXPECT_THAT(index.FindAllIn(a.GetContent(), &alpha_sig),
+              ElementsAre(Text(a, "sig"),
+                          Text(a, "sig", a.GetContent().find("assign"))));
+  EXPECT_THAT(index.FindAllIn(b.GetContent(), &alpha_sig), IsEmpty());
+  EXPECT_THAT(index.FindAllIn(b.GetContent(), &alpha),
+              ElementsAre(Text(b, "alpha")));
+
+  index.Clear();
+  EXPECT_EQ(index.size(), 0);
+  EXPECT_EQ(index.Find(Text(a, "alpha")), nullptr);
+}
+
+TEST_F(SymbolOccurrenceIndexTest, SameAsScanForEachIdentifier) {
+  AddFile("pkg.sv",
+          "package pkg;\n"
+          "  typedef logic [7:0] byte_t;\n"
+          "  parameter int N = 4;\n"
+          "endpackage\n");
+  AddFile("m.sv",
+          "module m #(parameter int W = pkg::N) (input pkg::byte_t d,\n"
+          "                                      output logic q);\n"
+          "  function automatic logic f(input pkg::byte_t x);\n"
+          "    return ^x;\n"
+          "  endfunction\n"
+          "  always_comb begin : blk\n"
+          "    logic t;\n"
+          "    t = f(d);\n"
+          "    q = t;\n"
+          "  end\n"
+          "endmodule\n");
+  AddFile("top.sv",
+          "module top;\n"
+          "  pkg::byte_t data;\n"
+          "  logic out;\n"
+          "  m #(.W(2)) inst(.d(data), .q(out));\n"
+          "  assign inst.blk.t = out;\n"
+          "endmodule\n");
+  std::vector<absl::Status> diagnostics;
+  symbol_table_.Resolve(&diagnostics);
+
+  SymbolOccurrenceIndex index;
+  index.Build(symbol_table_);
+  int found = 0;
+  for (const auto &file : files_) {
+    for (const verible::TokenInfo &token :
+         file->GetTextStructure()->TokenStream()) {
+      if (token.token_enum() != SymbolIdentifier) continue;
+      const SymbolTableNode *scanned =
+          ScanSymbolTreeForDefinition(&symbol_table_.Root(), token.text());
+      const SymbolOccurrenceIndex::Occurrence *occurrence =
+          index.Find(token.text());
+      EXPECT_EQ(occurrence ? occurrence->definition : nullptr, scanned)
+          << file->ReferencedPath() << ": " << token.text();
+      if (scanned) ++found;
+    }
+  }
+  EXPECT_GT(found, 20);
+}
+
+}  // namespace
+}  // namespace verilog
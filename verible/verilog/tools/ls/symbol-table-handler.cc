@@ -16,6 +16,7 @@
 #include "verible/verilog/tools/ls/symbol-table-handler.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <filesystem>
 #include <map>
 #include <memory>
@@ -48,6 +49,7 @@
 #include "verible/common/util/range.h"
 #include "verible/verilog/analysis/symbol-table.h"
 #include "verible/verilog/analysis/verilog-analyzer.h"
+#include "verible/verilog/analysis/verilog-filelist-loader.h"
 #include "verible/verilog/analysis/verilog-filelist.h"
 #include "verible/verilog/analysis/verilog-project.h"
 #include "verible/verilog/tools/ls/lsp-conversion.h"
@@ -61,6 +63,11 @@
 ABSL_FLAG(std::string, file_list_path, "verible.filelist",
           "Name of the file with Verible FileList for the project");
 
+ABSL_FLAG(int, lsp_syntax_tree_memory_budget_mb, 512,
+          "Approximate memory for the syntax trees of project files that are "
+          "not open in the editor. Beyond this, the least recently used ones "
+          "are released and parsed again when needed. 0 means unlimited.");
+
 using verible::lsp::LSPUriToPath;
 using verible::lsp::PathToLSPUri;
 
@@ -117,44 +124,107 @@ void SymbolTableHandler::SetProject(
     const std::shared_ptr<VerilogProject> &project) {
   curr_project_ = project;
   ResetSymbolTable();
+  completion_index_.Clear();
+  completion_index_ready_ = false;
   if (curr_project_) LoadProjectFileList(curr_project_->TranslationUnitRoot());
 }
 
 void SymbolTableHandler::ResetSymbolTable() {
+  ++generation_;
   symbol_table_ = std::make_unique<SymbolTable>(curr_project_.get());
+  occurrences_.Clear();
+  // The previous symbol table was the only one to know how to restore the
+  // released syntax trees.
+  syntax_trees_ = SyntaxTreeWorkingSet(
+      static_cast<size_t>(
+          std::max(absl::GetFlag(FLAGS_lsp_syntax_tree_memory_budget_mb), 0))
+      << 20);
 }
 
-void SymbolTableHandler::ParseProjectFiles() {
-  if (!curr_project_) return;
+std::vector<absl::Status> SymbolTableHandler::BuildProjectSymbolTable() {
+  if (!curr_project_) {
+    return {absl::UnavailableError("VerilogProject is not set")};
+  }
+  ResetSymbolTable();
+  completion_index_.Clear();
+
+  const bool record_telemetry = telemetry_ != nullptr && telemetry_->enabled();
+  const int64_t memory_before = record_telemetry ? ResidentMemoryBytes() : -1;
+  int64_t project_bytes = 0;
 
-  // Parse all files separate from SymbolTable::Build() to report parse duration
+  // Parse and build one file at a time, so that not all syntax trees need to
+  // be in memory at once.
   VLOG(1) << "Parsing project files...";
   const absl::Time start = absl::Now();
-  std::vector<absl::Status> results;
+  std::vector<absl::Status> parse_results;
+  std::vector<absl::Status> buildstatus;
+  // Included files are parsed while building, and count as building.
+  absl::Duration parse_time;
   for (auto &unit : *curr_project_) {
     VerilogSourceFile *const verilog_file = unit.second.get();
-    if (verilog_file->is_parsed()) continue;
-    results.emplace_back(verilog_file->Parse());
+    if (!verilog_file->is_parsed()) {
+      const absl::Time parse_start = absl::Now();
+      parse_results.emplace_back(verilog_file->Parse());
+      parse_time += absl::Now() - parse_start;
+    }
+    project_bytes += verilog_file->GetContent().size();
+    const std::vector<absl::Status> statuses = BuildSymbolTable(
+        *verilog_file, symbol_table_.get(), curr_project_.get());
+    buildstatus.insert(buildstatus.end(), statuses.begin(), statuses.end());
+    // Macros are only known while the file is parsed.
+    const VerilogPreprocessData *preprocessed =
+        verilog_file->GetPreprocessorData();
+    if (preprocessed != nullptr) {
+      completion_index_.UpdateMacros(verilog_file->ReferencedPath(),
+                                     preprocessed->macro_definitions);
+    }
+    UseSyntaxTree(verilog_file);
+    EnforceSyntaxTreeBudget();
   }
-  LogFullIfVLog(results);
-
-  VLOG(1) << "VerilogSourceFile::Parse() for " << results.size()
-          << " files: " << (absl::Now() - start);
-}
-
-std::vector<absl::Status> SymbolTableHandler::BuildProjectSymbolTable() {
-  if (!curr_project_) {
-    return {absl::UnavailableError("VerilogProject is not set")};
+  // Included files were parsed while building the files including them.
+  for (auto &unit : *curr_project_) {
+    VerilogSourceFile *const verilog_file = unit.second.get();
+    if (verilog_file->OwnsParsedStructure() &&
+        !syntax_trees_.IsResident(verilog_file)) {
+      UseSyntaxTree(verilog_file);
+    }
   }
-  ResetSymbolTable();
-  ParseProjectFiles();
+  EnforceSyntaxTreeBudget();
+  LogFullIfVLog(parse_results);
+  const absl::Time resolve_start = absl::Now();
+  VLOG(1) << "Parse and build symbol table for " << parse_results.size()
+          << " files: " << (resolve_start - start);
 
-  std::vector<absl::Status> buildstatus;
-  symbol_table_->Build(&buildstatus);
   symbol_table_->Resolve(&buildstatus);
   LogFullIfVLog(buildstatus);
 
+  const absl::Time index_start = absl::Now();
+  occurrences_.Build(*symbol_table_);
+  VLOG(1) << "Indexed " << occurrences_.size()
+          << " symbol occurrences: " << (absl::Now() - index_start);
+
+  completion_index_.IndexSymbolTable(*symbol_table_);
+  completion_index_ready_ = true;
+
   files_dirty_ = false;
+  if (record_telemetry) {
+    const absl::Time end = absl::Now();
+    const int64_t memory_after = ResidentMemoryBytes();
+    telemetry_->Record({
+        .name = "symbol-table",
+        .subject = std::string(curr_project_->TranslationUnitRoot()),
+        .start = start,
+        .duration = end - start,
+        .bytes = project_bytes,
+        .memory_delta = (memory_before >= 0 && memory_after >= 0)
+                            ? memory_after - memory_before
+                            : 0,
+        .phases = {{"parse", parse_time},
+                   {"build", resolve_start - start - parse_time},
+                   {"resolve", index_start - resolve_start},
+                   {"index", end - index_start}},
+    });
+  }
   return buildstatus;
 }
 
@@ -166,32 +236,32 @@ bool SymbolTableHandler::LoadProjectFileList(std::string_view current_dir) {
     std::string projectpath = FindFileList(current_dir);
     if (projectpath.empty()) {
       filelist_path_ = "";
-      last_filelist_update_ = {};
+      loaded_filelist_ = nullptr;
       return false;
     }
     filelist_path_ = projectpath;
   }
 
-  if (!last_filelist_update_) {
-    last_filelist_update_ = std::filesystem::last_write_time(filelist_path_);
-  } else if (*last_filelist_update_ ==
-             std::filesystem::last_write_time(filelist_path_)) {
-    // filelist file is unchanged, keeping it
-    return true;
-  }
-
-  VLOG(1) << "Updating the filelist";
-  // fill the FileList object
-  FileList filelist;
-  if (absl::Status status = AppendFileListFromFile(filelist_path_, &filelist);
-      !status.ok()) {
+  // The loader only reloads the file list if any of the (nested) filelist
+  // files changed.
+  absl::StatusOr<std::shared_ptr<const LoadedFileList>> loaded =
+      filelist_loader_.Load(filelist_path_);
+  if (!loaded.ok()) {
     // if failed to parse
     LOG(WARNING) << "Failed to parse file list in " << filelist_path_ << ":  "
-                 << status;
+                 << loaded.status();
     filelist_path_ = "";
-    last_filelist_update_ = {};
+    loaded_filelist_ = nullptr;
     return false;
   }
+  if (*loaded == loaded_filelist_) {
+    // filelist file is unchanged, keeping it
+    return true;
+  }
+  loaded_filelist_ = *std::move(loaded);
+
+  VLOG(1) << "Updating the filelist";
+  const FileList &filelist = loaded_filelist_->file_list;
 
   // add directory containing filelist to includes
   // TODO (glatosinski): should we do this?
@@ -204,19 +274,20 @@ bool SymbolTableHandler::LoadProjectFileList(std::string_view current_dir) {
     curr_project_->AddIncludePath(incdir);
   }
 
-  // Add files from file list to the project
-  VLOG(1) << "Resolving " << filelist.file_paths.size() << " files.";
+  // Add files from file list to the project.  The paths are already
+  // normalized and without duplicates.
+  VLOG(1) << "Resolving " << filelist.file_paths.size() << " files ("
+          << loaded_filelist_->missing_files.size()
+          << " not found next to the file list).";
   int actually_opened = 0;
   const absl::Time start = absl::Now();
-  for (const auto &file_in_project : filelist.file_paths) {
-    const std::string canonicalized =
-        std::filesystem::path(file_in_project).lexically_normal().string();
+  for (const std::string &file_in_project : filelist.file_paths) {
     absl::StatusOr<VerilogSourceFile *> source =
-        curr_project_->OpenTranslationUnit(canonicalized);
-    if (!source.ok()) source = curr_project_->OpenIncludedFile(canonicalized);
+        curr_project_->OpenTranslationUnit(file_in_project);
+    if (!source.ok()) source = curr_project_->OpenIncludedFile(file_in_project);
     if (!source.ok()) {
       VLOG(1) << "File included in " << filelist_path_
-              << " not found:  " << canonicalized << ":  " << source.status();
+              << " not found:  " << file_in_project << ":  " << source.status();
       continue;
     }
     ++actually_opened;
@@ -226,55 +297,19 @@ bool SymbolTableHandler::LoadProjectFileList(std::string_view current_dir) {
   // setting files_dirty_ here might overstate it. However, good conservative
   // estimate.
   files_dirty_ |= (actually_opened > 0);
+  // The new files are indexed with the next build of the symbol table.
+  if (actually_opened > 0) completion_index_ready_ = false;
 
   VLOG(1) << "Successfully opened " << actually_opened
           << " files from file-list: " << (absl::Now() - start);
   return true;
 }
 
-static const SymbolTableNode *ScanSymbolTreeForDefinitionReferenceComponents(
-    const ReferenceComponentNode *ref, std::string_view symbol) {
-  if (verible::IsSubRange(symbol, ref->Value().identifier)) {
-    return ref->Value().resolved_symbol;
-  }
-  for (const auto &childref : ref->Children()) {
-    const SymbolTableNode *resolved =
-        ScanSymbolTreeForDefinitionReferenceComponents(&childref, symbol);
-    if (resolved) return resolved;
-  }
-  return nullptr;
-}
-
-const SymbolTableNode *SymbolTableHandler::ScanSymbolTreeForDefinition(
-    const SymbolTableNode *context, std::string_view symbol) {
-  if (!context) {
-    return nullptr;
-  }
-  // TODO (glatosinski): reduce searched scope by utilizing information from
-  // syntax tree?
-  if (context->Key() && verible::IsSubRange(*context->Key(), symbol)) {
-    return context;
-  }
-  for (const auto &sdef : context->Value().supplement_definitions) {
-    if (verible::IsSubRange(sdef, symbol)) {
-      return context;
-    }
-  }
-  for (const auto &ref : context->Value().local_references_to_bind) {
-    if (ref.Empty()) continue;
-    const SymbolTableNode *resolved =
-        ScanSymbolTreeForDefinitionReferenceComponents(ref.components.get(),
-                                                       symbol);
-    if (resolved) return resolved;
-  }
-  for (const auto &child : context->Children()) {
-    const SymbolTableNode *res =
-        ScanSymbolTreeForDefinition(&child.second, symbol);
-    if (res) {
-      return res;
-    }
-  }
-  return nullptr;
+const SymbolTableNode *SymbolTableHandler::LookupDefinition(
+    std::string_view symbol) const {
+  const SymbolOccurrenceIndex::Occurrence *occurrence =
+      occurrences_.Find(symbol);
+  return occurrence ? occurrence->definition : nullptr;
 }
 
 void SymbolTableHandler::Prepare() {
@@ -286,6 +321,55 @@ void SymbolTableHandler::Prepare() {
   }
 }
 
+void SymbolTableHandler::EnforceSyntaxTreeBudget() {
+  const std::vector<VerilogSourceFile *> evicted = syntax_trees_.Enforce();
+  if (evicted.empty()) return;
+  ++generation_;
+  symbol_table_->ReleaseSyntaxTrees(evicted);
+  VLOG(1) << "Released " << evicted.size() << " syntax trees, "
+          << syntax_trees_.resident_files() << " remain ("
+          << (syntax_trees_.resident_bytes() >> 10) << " KiB)";
+}
+
+void SymbolTableHandler::UseSyntaxTree(VerilogSourceFile *file) {
+  if (syntax_trees_.ReleasedFile(file) != nullptr) {
+    const absl::Status status = symbol_table_->ReattachSyntaxTree(file);
+    if (!status.ok()) VLOG(1) << "Re-parsing released file: " << status;
+  }
+  syntax_trees_.Use(file);
+}
+
+void SymbolTableHandler::RestoreSyntaxTree(const VerilogSourceFile *file) {
+  if (file == nullptr) return;
+  VerilogSourceFile *const released = syntax_trees_.ReleasedFile(file);
+  if (released != nullptr) UseSyntaxTree(released);
+}
+
+const CompletionIndex &SymbolTableHandler::PreparedCompletionIndex() {
+  if (curr_project_ && !completion_index_ready_) Prepare();
+  return completion_index_;
+}
+
+void SymbolTableHandler::UpdateCompletionIndex(const VerilogSourceFile &file) {
+  // While typing, the buffer often does not parse; keep the names from the
+  // last time it did.
+  if (!file.Status().ok()) return;
+  SymbolTable file_symbol_table(nullptr);
+  BuildSymbolTable(file, &file_symbol_table);
+  completion_index_.UpdateFile(file.ReferencedPath(), file_symbol_table);
+  const VerilogPreprocessData *preprocessed = file.GetPreprocessorData();
+  if (preprocessed != nullptr) {
+    completion_index_.UpdateMacros(file.ReferencedPath(),
+                                   preprocessed->macro_definitions);
+  }
+}
+
+const VerilogProject *SymbolTableHandler::PreparedProject() {
+  if (!curr_project_) return nullptr;
+  Prepare();
+  return curr_project_.get();
+}
+
 void SymbolTableHandler::UpdateTopModulesFlag() {
   std::vector<std::string> top_modules = GetTopModules();
   if (!top_modules.empty()) {
@@ -379,6 +463,17 @@ SymbolTableHandler::GetLocationFromSymbolName(
   verible::lsp::Location location;
   location.uri = PathToLSPUri(file_origin->ResolvedPath());
   const verible::TextStructureView *text_view = file_origin->GetTextStructure();
+  if (text_view == nullptr) {
+    // The syntax tree was released; the symbol still points into the content.
+    const std::string_view content = file_origin->GetContent();
+    if (!verible::IsSubRange(symbol_name, content)) return std::nullopt;
+    const int offset = symbol_name.data() - content.data();
+    const verible::LineColumnMap line_map(content);
+    location.range = RangeFromLineColumn(
+        {line_map.GetLineColAtOffset(content, offset),
+         line_map.GetLineColAtOffset(content, offset + symbol_name.size())});
+    return location;
+  }
   if (!text_view->ContainsText(symbol_name)) return std::nullopt;
   location.range = RangeFromLineColumn(text_view->GetRangeForText(symbol_name));
 
@@ -405,9 +500,7 @@ std::vector<verible::lsp::Location> SymbolTableHandler::FindDefinitionLocation(
     return {};
   }
 
-  const SymbolTableNode &root = symbol_table_->Root();
-
-  const SymbolTableNode *node = ScanSymbolTreeForDefinition(&root, symbol);
+  const SymbolTableNode *node = LookupDefinition(symbol);
   // Symbol not found
   if (!node) return {};
   std::vector<verible::lsp::Location> locations;
@@ -425,7 +518,10 @@ std::vector<verible::lsp::Location> SymbolTableHandler::FindDefinitionLocation(
 const SymbolTableNode *SymbolTableHandler::FindDefinitionNode(
     std::string_view symbol) {
   Prepare();
-  return ScanSymbolTreeForDefinition(&symbol_table_->Root(), symbol);
+  const SymbolTableNode *node = LookupDefinition(symbol);
+  // Callers look at the syntax tree of the definition.
+  if (node) RestoreSyntaxTree(node->Value().file_origin);
+  return node;
 }
 
 const verible::Symbol *SymbolTableHandler::FindDefinitionSymbol(
@@ -444,7 +540,7 @@ std::vector<verible::lsp::Location> SymbolTableHandler::FindReferencesLocations(
   if (!token) return {};
   const std::string_view symbol = token->text();
   const SymbolTableNode &root = symbol_table_->Root();
-  const SymbolTableNode *node = ScanSymbolTreeForDefinition(&root, symbol);
+  const SymbolTableNode *node = LookupDefinition(symbol);
   if (!node) {
     return {};
   }
@@ -463,9 +559,7 @@ SymbolTableHandler::FindRenameableRangeAtCursor(
       GetTokenInfoAtTextDocumentPosition(params, parsed_buffers);
   if (symbol) {
     verible::TokenInfo token = symbol.value();
-    const SymbolTableNode &root = symbol_table_->Root();
-    const SymbolTableNode *node =
-        ScanSymbolTreeForDefinition(&root, token.text());
+    const SymbolTableNode *node = LookupDefinition(token.text());
     if (!node) return {};
     return RangeFromLineColumn(
         GetTokenRangeAtTextDocumentPosition(params, parsed_buffers));
@@ -473,6 +567,36 @@ SymbolTableHandler::FindRenameableRangeAtCursor(
   return {};
 }
 
+std::optional<std::vector<verible::lsp::DocumentHighlight>>
+SymbolTableHandler::FindHighlightRanges(
+    const verible::lsp::DocumentHighlightParams &params,
+    const verilog::BufferTrackerContainer &parsed_buffers) {
+  // Highlights follow the cursor, so they do not wait for the symbol table
+  // to be built again after each change.
+  if (files_dirty_ || !symbol_table_) return std::nullopt;
+  const verilog::BufferTracker *tracker =
+      parsed_buffers.FindBufferTrackerOrNull(params.textDocument.uri);
+  if (!tracker) return std::nullopt;
+  std::shared_ptr<const ParsedBuffer> parsedbuffer = tracker->current();
+  if (!parsedbuffer) return std::nullopt;
+  const verible::TextStructureView &text = parsedbuffer->parser().Data();
+  const verible::TokenInfo cursor_token =
+      text.FindTokenAt({params.position.line, params.position.character});
+  if (cursor_token.text().empty()) return std::nullopt;
+  const SymbolOccurrenceIndex::Occurrence *occurrence =
+      occurrences_.Find(cursor_token.text());
+  if (!occurrence) return std::nullopt;
+
+  std::vector<verible::lsp::DocumentHighlight> result;
+  for (std::string_view found :
+       occurrences_.FindAllIn(text.Contents(), occurrence->definition)) {
+    result.push_back(verible::lsp::DocumentHighlight{
+        .range = RangeFromLineColumn(text.GetRangeForText(found)),
+    });
+  }
+  return result;
+}
+
 verible::lsp::WorkspaceEdit
 SymbolTableHandler::FindRenameLocationsAndCreateEdits(
     const verible::lsp::RenameParams &params,
@@ -483,7 +607,7 @@ SymbolTableHandler::FindRenameLocationsAndCreateEdits(
   if (!token) return {};
   std::string_view symbol = token->text();
   const SymbolTableNode &root = symbol_table_->Root();
-  const SymbolTableNode *node = ScanSymbolTreeForDefinition(&root, symbol);
+  const SymbolTableNode *node = LookupDefinition(symbol);
   if (!node) return {};
   std::optional<verible::lsp::Location> location =
       GetLocationFromSymbolName(*node->Key(), node->Value().file_origin);
@@ -540,7 +664,7 @@ void SymbolTableHandler::CollectReferencesReferenceComponents(
 void SymbolTableHandler::CollectReferences(
     const SymbolTableNode *context, const SymbolTableNode *definition_node,
     std::vector<verible::lsp::Location> *references) {
-  if (!context) return;
+  if (!context || is_cancelled_()) return;
   for (const auto &ref : context->Value().local_references_to_bind) {
     if (ref.Empty()) continue;
     CollectReferencesReferenceComponents(ref.components.get(), context,
@@ -554,7 +678,14 @@ void SymbolTableHandler::CollectReferences(
 void SymbolTableHandler::UpdateFileContent(
     std::string_view path, const verilog::VerilogAnalyzer *parsed) {
   files_dirty_ = true;
+  // The file object is replaced, and the symbol table will be re-built.
+  ++generation_;
+  syntax_trees_.Reset();
   curr_project_->UpdateFileContents(path, parsed);
+  if (parsed == nullptr || !completion_index_ready_) return;
+  const VerilogSourceFile *file = curr_project_->LookupRegisteredFile(
+      curr_project_->GetRelativePathToSource(path));
+  if (file != nullptr) UpdateCompletionIndex(*file);
 }
 
 BufferTrackerContainer::ChangeCallback
@@ -602,6 +733,8 @@ void SymbolTableHandler::SetWorkspaceFiles(
   }
 
   files_dirty_ |= (actually_opened > 0);
+  // The new files are indexed with the next build of the symbol table.
+  if (actually_opened > 0) completion_index_ready_ = false;
   VLOG(1) << "Successfully opened " << actually_opened << " workspace files";
 }
 
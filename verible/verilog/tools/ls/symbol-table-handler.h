@@ -16,23 +16,33 @@
 #ifndef VERILOG_TOOLS_LS_SYMBOL_TABLE_HANDLER_H
 #define VERILOG_TOOLS_LS_SYMBOL_TABLE_HANDLER_H
 
-#include <filesystem>
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <utility>
 #include <vector>
 
+#include "absl/flags/declare.h"
 #include "absl/status/status.h"
-#include "absl/types/optional.h"
 #include "verible/common/lsp/lsp-protocol.h"
 #include "verible/common/strings/line-column-map.h"
 #include "verible/common/text/symbol.h"
 #include "verible/common/text/token-info.h"
 #include "verible/verilog/analysis/symbol-table.h"
 #include "verible/verilog/analysis/verilog-analyzer.h"
+#include "verible/verilog/analysis/verilog-filelist-loader.h"
 #include "verible/verilog/analysis/verilog-project.h"
+#include "verible/verilog/tools/ls/completion-index.h"
 #include "verible/verilog/tools/ls/lsp-parse-buffer.h"
+#include "verible/verilog/tools/ls/performance-telemetry.h"
+#include "verible/verilog/tools/ls/symbol-occurrence-index.h"
+#include "verible/verilog/tools/ls/syntax-tree-working-set.h"
+
+ABSL_DECLARE_FLAG(int, lsp_syntax_tree_memory_budget_mb);
 
 namespace verilog {
 
@@ -82,6 +92,14 @@ class SymbolTableHandler {
       const verible::lsp::RenameParams &params,
       const verilog::BufferTrackerContainer &parsed_buffers);
 
+  // Returns the ranges in the document that refer to the same definition as
+  // the symbol at the cursor, for textDocument/documentHighlight.  Does not
+  // build the symbol table: returns nullopt if it is not up to date, or if
+  // the cursor is not at a symbol it knows.
+  std::optional<std::vector<verible::lsp::DocumentHighlight>>
+  FindHighlightRanges(const verible::lsp::DocumentHighlightParams &params,
+                      const verilog::BufferTrackerContainer &parsed_buffers);
+
   // Returns TokenInfo for token pointed by the LSP request based on
   // TextDocumentPositionParams. If text is not found, nullopt is returned.
   std::optional<verible::TokenInfo> GetTokenAtTextDocumentPosition(
@@ -112,6 +130,41 @@ class SymbolTableHandler {
   // These files will be used instead of verible.filelist when available.
   void SetWorkspaceFiles(const std::vector<std::string> &files);
 
+  // Returns the current project, with the files of the filelist loaded, or
+  // nullptr if none is set.
+  const VerilogProject *PreparedProject();
+
+  // Releases the syntax trees of the least recently used project files, if
+  // they take more memory than --lsp_syntax_tree_memory_budget_mb allows.
+  // Their symbols stay in the symbol table, and their syntax trees are
+  // parsed again when a request needs them.
+  // Invalidates syntax tree pointers obtained before, so only call it
+  // between requests.
+  void EnforceSyntaxTreeBudget();
+
+  // Sets a function that tells if the current request was cancelled. Finding
+  // references stops early then, and returns what it found so far.
+  void SetCancellationCheck(std::function<bool()> is_cancelled) {
+    is_cancelled_ = std::move(is_cancelled);
+  }
+
+  // Records the time each build of the symbol table takes in "telemetry",
+  // if it is enabled.  The telemetry has to outlive this.
+  void SetTelemetry(PerformanceTelemetry *telemetry) { telemetry_ = telemetry; }
+
+  // Returns the names to complete in the editor, after building the symbol
+  // table of the project the first time.  Later, the index is updated with
+  // each change of an open buffer, without re-building the symbol table.
+  const CompletionIndex &PreparedCompletionIndex();
+
+  // The project files whose syntax trees are in memory.
+  const SyntaxTreeWorkingSet &syntax_trees() const { return syntax_trees_; }
+
+  // Changes whenever the symbol table is built again, or a syntax tree of a
+  // project file is released or replaced.  What was found in the syntax
+  // trees of project files before a change may point to freed nodes.
+  uint64_t generation() const { return generation_; }
+
  private:
   // prepares structures for symbol-based requests
   void Prepare();
@@ -140,10 +193,9 @@ class SymbolTableHandler {
   std::optional<verible::lsp::Location> GetLocationFromSymbolName(
       std::string_view symbol_name, const VerilogSourceFile *file_origin);
 
-  // Scans the symbol table tree to find a given symbol.
-  // returns pointer to table node with the symbol on success, else nullptr.
-  const SymbolTableNode *ScanSymbolTreeForDefinition(
-      const SymbolTableNode *context, std::string_view symbol);
+  // Returns the definition of the symbol whose definition or reference is
+  // the text "symbol" of a file, or nullptr if there is none.
+  const SymbolTableNode *LookupDefinition(std::string_view symbol) const;
 
   // Internal function for CollectReferences that iterates over
   // ReferenceComponentNodes
@@ -162,15 +214,27 @@ class SymbolTableHandler {
   // data to project. It is meant to be executed once per VerilogProject setup
   bool LoadProjectFileList(std::string_view current_dir);
 
-  // Parse all the files in the project.
-  void ParseProjectFiles();
+  // Marks the syntax tree of "file" as used, after parsing it again if it
+  // was released.
+  void UseSyntaxTree(VerilogSourceFile *file);
+
+  // Parses the file again if its syntax tree was released.
+  void RestoreSyntaxTree(const VerilogSourceFile *file);
+
+  // Indexes the names that an open buffer declares, if it could be parsed.
+  void UpdateCompletionIndex(const VerilogSourceFile &file);
 
   // Path to the filelist file for the project
   std::string filelist_path_;
 
-  // Last timestamp of filelist file - used to check whether SymbolTable
-  // should be updated
-  absl::optional<std::filesystem::file_time_type> last_filelist_update_;
+  // Loads the filelist with its nested filelists, and caches it until any of
+  // them changes.
+  FileListLoader filelist_loader_{
+      static_cast<int>(std::thread::hardware_concurrency())};
+
+  // The last loaded filelist - used to check whether SymbolTable should be
+  // updated
+  std::shared_ptr<const LoadedFileList> loaded_filelist_;
 
   // tells that symbol table should be rebuilt due to changes in files
   bool files_dirty_ = true;
@@ -178,6 +242,24 @@ class SymbolTableHandler {
   // current VerilogProject for which the symbol table is created
   std::shared_ptr<VerilogProject> curr_project_;
   std::unique_ptr<SymbolTable> symbol_table_;
+
+  // Tells if the current request was cancelled.
+  std::function<bool()> is_cancelled_ = []() { return false; };
+
+  PerformanceTelemetry *telemetry_ = nullptr;
+
+  // Project files whose syntax trees are in memory; open buffers are not
+  // included, as their syntax trees belong to the buffer tracker.
+  SyntaxTreeWorkingSet syntax_trees_;
+
+  // Names for completion, and if they were indexed for the current project.
+  CompletionIndex completion_index_;
+  bool completion_index_ready_ = false;
+
+  // Occurrences of the symbols of symbol_table_, built with it.
+  SymbolOccurrenceIndex occurrences_;
+
+  uint64_t generation_ = 0;
 };
 
 };  // namespace verilog
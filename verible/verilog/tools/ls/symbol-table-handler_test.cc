@@ -483,6 +483,55 @@ TEST_F(SymbolTableHandlerTest, UpdateWithUnparseableEditorContentRegression) {
   parsed_buffers.GetSubscriptionCallback()(uri, &a_buffer);
 }
 
+TEST_F(SymbolTableHandlerTest, FindHighlightRangesOfSameDefinition) {
+  const verible::file::testing::ScopedTestFile filelist(
+      sources_dir, "a.sv\nb.sv\n", "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(sources_dir,
+                                                        kSampleModuleA, "a.sv");
+  const verible::file::testing::ScopedTestFile module_b(sources_dir,
+                                                        kSampleModuleB, "b.sv");
+  verible::lsp::DocumentHighlightParams parameters;
+  parameters.textDocument.uri =
+      verible::lsp::PathToLSPUri(sources_dir + "/b.sv");
+  parameters.position.line = 1;
+  parameters.position.character = 10;
+
+  std::shared_ptr<VerilogProject> project = std::make_shared<VerilogProject>(
+      sources_dir, std::vector<std::string>(), "");
+  SymbolTableHandler symbol_table_handler;
+  symbol_table_handler.SetProject(project);
+
+  verilog::BufferTrackerContainer parsed_buffers;
+  parsed_buffers.AddChangeListener(
+      symbol_table_handler.CreateBufferTrackerListener());
+  auto b_buffer = verible::lsp::EditTextBuffer(kSampleModuleB);
+  parsed_buffers.GetSubscriptionCallback()(parameters.textDocument.uri,
+                                           &b_buffer);
+
+  // Not before the symbol table is built.
+  EXPECT_FALSE(
+      symbol_table_handler.FindHighlightRanges(parameters, parsed_buffers)
+          .has_value());
+
+  symbol_table_handler.BuildProjectSymbolTable();
+  const std::optional<std::vector<verible::lsp::DocumentHighlight>>
+      highlights =
+          symbol_table_handler.FindHighlightRanges(parameters, parsed_buffers);
+  ASSERT_TRUE(highlights.has_value());
+  // "vara.var1" is the var1 of module a.
+  ASSERT_EQ(highlights->size(), 2);
+  EXPECT_EQ((*highlights)[0].range.start.line, 1);
+  EXPECT_EQ((*highlights)[0].range.start.character, 9);
+  EXPECT_EQ((*highlights)[1].range.start.line, 2);
+  EXPECT_EQ((*highlights)[1].range.start.character, 16);
+
+  // No symbol at "assign".
+  parameters.position.character = 3;
+  EXPECT_FALSE(
+      symbol_table_handler.FindHighlightRanges(parameters, parsed_buffers)
+          .has_value());
+}
+
 TEST_F(SymbolTableHandlerTest, MissingVerilogProject) {
   SymbolTableHandler symbol_table_handler;
   std::vector<absl::Status> diagnostics =
@@ -0,0 +1,95 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/syntax-tree-working-set.h"
+
+#include <cstddef>
+#include <stack>
+#include <vector>
+
+#include "verible/common/text/concrete-syntax-leaf.h"
+#include "verible/common/text/concrete-syntax-tree.h"
+#include "verible/common/text/symbol.h"
+#include "verible/common/text/text-structure.h"
+#include "verible/common/text/token-info.h"
+#include "verible/common/text/tree-utils.h"
+#include "verible/verilog/analysis/verilog-project.h"
+
+namespace verilog {
+
+size_t EstimateSyntaxTreeBytes(const VerilogSourceFile &file) {
+  const verible::TextStructureView *text_structure = file.GetTextStructure();
+  if (text_structure == nullptr) return 0;
+  size_t bytes =
+      text_structure->TokenStream().capacity() * sizeof(verible::TokenInfo) +
+      text_structure->GetTokenStreamView().capacity() *
+          sizeof(verible::TokenSequence::const_iterator);
+
+  if (text_structure->SyntaxTree() == nullptr) return bytes;
+  std::stack<const verible::Symbol *> pending;
+  pending.push(text_structure->SyntaxTree().get());
+  while (!pending.empty()) {
+    const verible::Symbol *symbol = pending.top();
+    pending.pop();
+    if (symbol->Kind() == verible::SymbolKind::kLeaf) {
+      bytes += sizeof(verible::SyntaxTreeLeaf);
+      continue;
+    }
+    bytes += sizeof(verible::SyntaxTreeNode);
+    for (const verible::SymbolPtr &child :
+         verible::SymbolCastToNode(*symbol).children()) {
+      bytes += sizeof(verible::SymbolPtr);
+      if (child) pending.push(child.get());
+    }
+  }
+  return bytes;
+}
+
+void SyntaxTreeWorkingSet::Use(VerilogSourceFile *file) {
+  if (!file->OwnsParsedStructure()) return;
+  released_.erase(file);
+  const auto found = index_.find(file);
+  if (found != index_.end()) {
+    lru_.splice(lru_.begin(), lru_, found->second);
+    return;
+  }
+  const size_t bytes = EstimateSyntaxTreeBytes(*file);
+  lru_.push_front({file, bytes});
+  index_[file] = lru_.begin();
+  resident_bytes_ += bytes;
+}
+
+std::vector<VerilogSourceFile *> SyntaxTreeWorkingSet::Enforce() {
+  std::vector<VerilogSourceFile *> evicted;
+  if (budget_bytes_ == 0 || resident_bytes_ <= budget_bytes_) return evicted;
+  while (lru_.size() > 1 && resident_bytes_ > budget_bytes_ / 2) {
+    const Entry &entry = lru_.back();
+    evicted.push_back(entry.file);
+    released_[entry.file] = entry.file;
+    resident_bytes_ -= entry.bytes;
+    index_.erase(entry.file);
+    lru_.pop_back();
+  }
+  return evicted;
+}
+
+void SyntaxTreeWorkingSet::Reset() {
+  lru_.clear();
+  index_.clear();
+  released_.clear();
+  resident_bytes_ = 0;
+}
+
+}  // namespace verilog
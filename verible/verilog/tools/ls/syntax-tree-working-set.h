@@ -0,0 +1,93 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef VERILOG_TOOLS_LS_SYNTAX_TREE_WORKING_SET_H
+#define VERILOG_TOOLS_LS_SYNTAX_TREE_WORKING_SET_H
+
+#include <cstddef>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "verible/verilog/analysis/verilog-project.h"
+
+namespace verilog {
+
+// Returns the approximate number of bytes taken by the tokens and the
+// syntax tree of a parsed file, not counting its content.
+size_t EstimateSyntaxTreeBytes(const VerilogSourceFile &file);
+
+// Keeps track of the project files whose syntax trees are in memory, in
+// least-recently-used order, and picks those to release when the trees take
+// more memory than the budget allows.
+//
+// Only files that own their parsed structure are tracked: the syntax trees
+// of open editor buffers belong to the buffer tracker and stay in memory.
+class SyntaxTreeWorkingSet {
+ public:
+  explicit SyntaxTreeWorkingSet(size_t budget_bytes = 0)
+      : budget_bytes_(budget_bytes) {}
+
+  // Marks the syntax tree of "file" as most recently used.  Call after
+  // parsing a file, and whenever a request needs its syntax tree.
+  void Use(VerilogSourceFile *file);
+
+  // If the resident syntax trees exceed the budget, removes the least
+  // recently used ones from the working set until they take half of the
+  // budget, so that the next few files do not release trees again right
+  // away.  The most recently used file always stays.
+  // Returns the removed files; the caller releases their syntax trees.
+  // A budget of zero means unlimited.
+  std::vector<VerilogSourceFile *> Enforce();
+
+  // Forgets all files, e.g. when the project is re-built.
+  void Reset();
+
+  size_t budget_bytes() const { return budget_bytes_; }
+  size_t resident_bytes() const { return resident_bytes_; }
+  size_t resident_files() const { return lru_.size(); }
+  size_t released_files() const { return released_.size(); }
+
+  bool IsResident(const VerilogSourceFile *file) const {
+    return index_.find(file) != index_.end();
+  }
+
+  // Returns "file" if it was removed from the working set by Enforce(), and
+  // not used since, else nullptr.
+  VerilogSourceFile *ReleasedFile(const VerilogSourceFile *file) const {
+    const auto found = released_.find(file);
+    return found == released_.end() ? nullptr : found->second;
+  }
+
+ private:
+  struct Entry {
+    VerilogSourceFile *file;
+    size_t bytes;
+  };
+
+  size_t budget_bytes_;
+  size_t resident_bytes_ = 0;
+
+  // Most recently used first.
+  std::list<Entry> lru_;
+  std::unordered_map<const VerilogSourceFile *, std::list<Entry>::iterator>
+      index_;
+
+  std::unordered_map<const VerilogSourceFile *, VerilogSourceFile *> released_;
+};
+
+}  // namespace verilog
+
+#endif  // VERILOG_TOOLS_LS_SYNTAX_TREE_WORKING_SET_H
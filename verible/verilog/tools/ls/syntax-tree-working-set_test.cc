@@ -0,0 +1,121 @@
+// Copyright 2021 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "verible/verilog/tools/ls/syntax-tree-working-set.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "verible/verilog/analysis/verilog-project.h"
+
+namespace verilog {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+std::unique_ptr<InMemoryVerilogSourceFile> ParsedFile(const std::string &name) {
+  auto file = std::make_unique<InMemoryVerilogSourceFile>(
+      name, "module " + name + ";\n  wire w;\nendmodule\n");
+  EXPECT_TRUE(file->Parse().ok());
+  return file;
+}
+
+TEST(SyntaxTreeWorkingSetTest, EstimateSyntaxTreeBytes) {
+  InMemoryVerilogSourceFile unparsed("a.sv", "module a;\nendmodule\n");
+  EXPECT_EQ(EstimateSyntaxTreeBytes(unparsed), 0);
+
+  const auto small = ParsedFile("a");
+  auto large = std::make_unique<InMemoryVerilogSourceFile>(
+      "b.sv", "module b;\n  wire w1;\n  wire w2;\n  wire w3;\nendmodule\n");
+  ASSERT_TRUE(large->Parse().ok());
+  EXPECT_GT(EstimateSyntaxTreeBytes(*small), 0);
+  EXPECT_GT(EstimateSyntaxTreeBytes(*large), EstimateSyntaxTreeBytes(*small));
+}
+
+TEST(SyntaxTreeWorkingSetTest, UnlimitedBudget) {
+  const auto a = ParsedFile("a");
+  const auto b = ParsedFile("b");
+  SyntaxTreeWorkingSet working_set;
+  working_set.Use(a.get());
+  working_set.Use(b.get());
+  EXPECT_EQ(working_set.resident_files(), 2);
+  EXPECT_EQ(working_set.resident_bytes(),
+            EstimateSyntaxTreeBytes(*a) + EstimateSyntaxTreeBytes(*b));
+  EXPECT_THAT(working_set.Enforce(), IsEmpty());
+}
+
+TEST(SyntaxTreeWorkingSetTest, EvictsLeastRecentlyUsed) {
+  const auto a = ParsedFile("a");
+  const auto b = ParsedFile("b");
+  const auto c = ParsedFile("c");
+  // Room for about two of these.
+  SyntaxTreeWorkingSet working_set(EstimateSyntaxTreeBytes(*a) * 5 / 2);
+  working_set.Use(a.get());
+  working_set.Use(b.get());
+  EXPECT_THAT(working_set.Enforce(), IsEmpty());
+
+  working_set.Use(a.get());  // now b is the least recently used.
+  working_set.Use(c.get());
+  // Evicts down to half the budget, which leaves only the last used one.
+  EXPECT_THAT(working_set.Enforce(), ElementsAre(b.get(), a.get()));
+  EXPECT_EQ(working_set.resident_files(), 1);
+  EXPECT_EQ(working_set.released_files(), 2);
+  EXPECT_EQ(working_set.ReleasedFile(a.get()), a.get());
+  EXPECT_EQ(working_set.ReleasedFile(b.get()), b.get());
+  EXPECT_EQ(working_set.ReleasedFile(c.get()), nullptr);
+  EXPECT_TRUE(working_set.IsResident(c.get()));
+
+  // Using a file again brings it back.
+  working_set.Use(b.get());
+  EXPECT_EQ(working_set.ReleasedFile(b.get()), nullptr);
+  EXPECT_TRUE(working_set.IsResident(b.get()));
+  EXPECT_EQ(working_set.resident_files(), 2);
+  EXPECT_EQ(working_set.released_files(), 1);
+}
+
+TEST(SyntaxTreeWorkingSetTest, KeepsMostRecentlyUsed) {
+  const auto a = ParsedFile("a");
+  SyntaxTreeWorkingSet working_set(1);
+  working_set.Use(a.get());
+  EXPECT_THAT(working_set.Enforce(), IsEmpty());
+  EXPECT_EQ(working_set.resident_files(), 1);
+}
+
+TEST(SyntaxTreeWorkingSetTest, IgnoresFilesWithoutOwnSyntaxTree) {
+  InMemoryVerilogSourceFile unparsed("a.sv", "module a;\nendmodule\n");
+  SyntaxTreeWorkingSet working_set(1);
+  working_set.Use(&unparsed);
+  EXPECT_EQ(working_set.resident_files(), 0);
+}
+
+TEST(SyntaxTreeWorkingSetTest, Reset) {
+  const auto a = ParsedFile("a");
+  const auto b = ParsedFile("b");
+  SyntaxTreeWorkingSet working_set(1);
+  working_set.Use(a.get());
+  working_set.Use(b.get());
+  EXPECT_THAT(working_set.Enforce(), ElementsAre(a.get()));
+  working_set.Reset();
+  EXPECT_EQ(working_set.resident_files(), 0);
+  EXPECT_EQ(working_set.resident_bytes(), 0);
+  EXPECT_EQ(working_set.released_files(), 0);
+}
+
+}  // namespace
+}  // namespace verilog
@@ -15,18 +15,22 @@
 
 #include "verible/verilog/tools/ls/verible-lsp-adapter.h"
 
+#include <cstdint>
 #include <iterator>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/hash/hash.h"
 #include "absl/strings/str_cat.h"
+#include "external_libs/editscript.h"
 #include "nlohmann/json.hpp"
 #include "verible/common/analysis/file-analyzer.h"
 #include "verible/common/analysis/lint-rule-status.h"
 #include "verible/common/lsp/lsp-protocol-enums.h"
 #include "verible/common/lsp/lsp-protocol-operators.h"
 #include "verible/common/lsp/lsp-protocol.h"
+#include "verible/common/strings/diff.h"
 #include "verible/common/strings/line-column-map.h"
 #include "verible/common/text/text-structure.h"
 #include "verible/common/text/token-info.h"
@@ -75,9 +79,14 @@ std::vector<verible::lsp::Diagnostic> CreateDiagnostics(
   // syntax errors.
   const auto current = tracker.current();
   if (!current) return {};
-  const auto &rejected_tokens = current->parser().GetRejectedTokens();
+  return CreateDiagnostics(*current, message_limit);
+}
+
+std::vector<verible::lsp::Diagnostic> CreateDiagnostics(
+    const ParsedBuffer &buffer, int message_limit) {
+  const auto &rejected_tokens = buffer.parser().GetRejectedTokens();
   auto const &lint_violations =
-      verilog::GetSortedViolations(current->lint_result());
+      verilog::GetSortedViolations(buffer.lint_result());
   std::vector<verible::lsp::Diagnostic> result;
   int remaining = rejected_tokens.size() + lint_violations.size();
 
@@ -99,7 +108,7 @@ std::vector<verible::lsp::Diagnostic> CreateDiagnostics(
   result.reserve(remaining);
   for (const auto &rejected_token : rejected_tokens) {
     if (remaining-- <= 0) break;
-    current->parser().ExtractLinterTokenErrorDetail(
+    buffer.parser().ExtractLinterTokenErrorDetail(
         rejected_token,
         [&result, &rejected_token](
             const std::string &filename, verible::LineColumnRange range,
@@ -132,17 +141,52 @@ std::vector<verible::lsp::Diagnostic> CreateDiagnostics(
 
   for (const auto &v : lint_violations) {
     if (remaining-- <= 0) break;
-    result.emplace_back(ViolationToDiagnostic(v, current->parser().Data()));
+    result.emplace_back(ViolationToDiagnostic(v, buffer.parser().Data()));
   }
   return result;
 }
 
-verible::lsp::FullDocumentDiagnosticReport GenerateDiagnosticReport(
+std::string DiagnosticResultId(const ParsedBuffer &buffer) {
+  return absl::StrCat(buffer.version(), "-",
+                      absl::Hex(buffer.lint_fingerprint()));
+}
+
+nlohmann::json GenerateDiagnosticReport(
     const BufferTracker *tracker,
     const verible::lsp::DocumentDiagnosticParams &p) {
   verible::lsp::FullDocumentDiagnosticReport result;
-  if (!tracker) return result;
-  result.items = CreateDiagnostics(*tracker, -1);  // no limit in diagnostic msg
+  const auto current = tracker ? tracker->current() : nullptr;
+  if (!current) return result;
+  const std::string result_id = DiagnosticResultId(*current);
+  if (p.has_previousResultId && p.previousResultId == result_id) {
+    return verible::lsp::UnchangedDocumentDiagnosticReport{.resultId =
+                                                               result_id};
+  }
+  result.resultId = result_id;
+  result.has_resultId = true;
+  result.items = CreateDiagnostics(*current, -1);  // no limit in diagnostic msg
+  return result;
+}
+
+nlohmann::json GenerateWorkspaceDocumentDiagnosticReport(
+    std::string_view uri, std::string_view content,
+    std::string_view previous_result_id) {
+  // Without an editor version, the content identifies the file state.
+  const std::string result_id = absl::StrCat(
+      "f", absl::Hex(absl::Hash<std::string_view>()(content)), "-",
+      absl::Hex(LintConfigurationFingerprint(uri)));
+  if (previous_result_id == result_id) {
+    verible::lsp::WorkspaceUnchangedDocumentDiagnosticReport unchanged;
+    unchanged.resultId = result_id;
+    unchanged.uri = uri;
+    return unchanged;
+  }
+  const ParsedBuffer buffer(0, uri, content);
+  verible::lsp::WorkspaceFullDocumentDiagnosticReport result;
+  result.resultId = result_id;
+  result.has_resultId = true;
+  result.items = CreateDiagnostics(buffer, -1);
+  result.uri = uri;
   return result;
 }
 
@@ -212,7 +256,8 @@ std::vector<verible::lsp::CodeAction> GenerateLinterCodeActions(
 
 std::vector<verible::lsp::CodeAction> GenerateCodeActions(
     SymbolTableHandler *symbol_table_handler, const BufferTracker *tracker,
-    const verible::lsp::CodeActionParams &p) {
+    const verible::lsp::CodeActionParams &p,
+    AutoExpandCache *auto_expand_cache) {
   std::vector<verible::lsp::CodeAction> result;
 
   if (!tracker) return result;
@@ -221,8 +266,8 @@ std::vector<verible::lsp::CodeAction> GenerateCodeActions(
 
   result = GenerateLinterCodeActions(tracker, p);
 
-  auto auto_expand =
-      GenerateAutoExpandCodeActions(symbol_table_handler, tracker, p);
+  auto auto_expand = GenerateAutoExpandCodeActions(
+      symbol_table_handler, tracker, p, auto_expand_cache);
   result.insert(result.end(), std::make_move_iterator(auto_expand.begin()),
                 make_move_iterator(auto_expand.end()));
 
@@ -279,6 +324,58 @@ std::vector<verible::lsp::DocumentHighlight> CreateHighlightRanges(
   return result;
 }
 
+// Returns the edits that change the lines of 'text' into 'new_text'.  Each
+// run of changed lines becomes one edit, so unchanged parts of the document
+// are not sent back to the client.  Empty if nothing changed.
+static std::vector<verible::lsp::TextEdit> LineEditsForChange(
+    const verible::TextStructureView &text, std::string_view new_text) {
+  std::vector<verible::lsp::TextEdit> result;
+  if (text.Contents() == new_text) return result;
+
+  const verible::LineDiffs diffs(text.Contents(), new_text);
+  const int before_line_count = diffs.before_lines.size();
+  // Replacing up to after the last line: that might not end in a newline.
+  const verible::LineColumn text_end =
+      text.GetRangeForText(text.Contents()).end;
+  auto line_start = [&](int line) -> verible::lsp::Position {
+    if (line >= before_line_count) {
+      return {.line = text_end.line, .character = text_end.column};
+    }
+    return {.line = line, .character = 0};
+  };
+
+  int before_line = 0;  // Current position in the old lines.
+  const auto &edits = diffs.edits;
+  for (auto edit = edits.begin(); edit != edits.end();) {
+    if (edit->operation == diff::Operation::EQUALS) {
+      before_line = edit->end;
+      ++edit;
+      continue;
+    }
+    // Collect the run of deletions and insertions into one edit.
+    const int start_line = before_line;
+    std::string replacement;
+    for (; edit != edits.end() && edit->operation != diff::Operation::EQUALS;
+         ++edit) {
+      if (edit->operation == diff::Operation::DELETE) {
+        before_line = edit->end;
+      } else {
+        for (int64_t i = edit->start; i < edit->end; ++i) {
+          absl::StrAppend(&replacement, diffs.after_lines[i]);
+        }
+      }
+    }
+    result.push_back(verible::lsp::TextEdit{
+        .range =
+            {
+                .start = line_start(start_line),
+                .end = line_start(before_line),
+            },
+        .newText = replacement});
+  }
+  return result;
+}
+
 std::vector<verible::lsp::TextEdit> FormatRange(
     const BufferTracker *tracker,
     const verible::lsp::DocumentFormattingParams &p) {
@@ -318,17 +415,7 @@ std::vector<verible::lsp::TextEdit> FormatRange(
     if (!FormatVerilog(text, current->uri(), format_style, &newText).ok()) {
       return result;
     }
-    // Emit a single edit that replaces the full range the file covers.
-    // TODO(hzeller): Could consider patches maybe.
-    // TODO(hzeller): Also be safe and don't emit anything if text is the same.
-    const auto range = text.GetRangeForText(text.Contents());
-    result.push_back(verible::lsp::TextEdit{
-        .range =
-            {
-                .start = {.line = 0, .character = 0},
-                .end = {.line = range.end.line, .character = range.end.column},
-            },
-        .newText = newText});
+    return LineEditsForChange(text, newText);
   }
   return result;
 }
@@ -16,10 +16,13 @@
 #ifndef VERILOG_TOOLS_LS_VERIBLE_LSP_ADAPTER_H
 #define VERILOG_TOOLS_LS_VERIBLE_LSP_ADAPTER_H
 
+#include <string>
+#include <string_view>
 #include <vector>
 
 #include "nlohmann/json.hpp"
 #include "verible/common/lsp/lsp-protocol.h"
+#include "verible/verilog/tools/ls/autoexpand.h"
 #include "verible/verilog/tools/ls/lsp-parse-buffer.h"
 #include "verible/verilog/tools/ls/symbol-table-handler.h"
 
@@ -31,20 +34,36 @@ namespace verilog {
 // output to be sent in textDocument/publishDiagnostics notification.
 std::vector<verible::lsp::Diagnostic> CreateDiagnostics(const BufferTracker &,
                                                         int message_limit);
+std::vector<verible::lsp::Diagnostic> CreateDiagnostics(const ParsedBuffer &,
+                                                        int message_limit);
 
 // Generate code actions from autofixes provided by the linter.
 std::vector<verible::lsp::CodeAction> GenerateLinterCodeActions(
     const BufferTracker *tracker, const verible::lsp::CodeActionParams &p);
 
-// Generate all available code actions.
+// Generate all available code actions. AUTO expansion keeps what it finds
+// in the buffer in "auto_expand_cache" for the next request.
 std::vector<verible::lsp::CodeAction> GenerateCodeActions(
     SymbolTableHandler *symbol_table_handler, const BufferTracker *tracker,
-    const verible::lsp::CodeActionParams &p);
+    const verible::lsp::CodeActionParams &p,
+    AutoExpandCache *auto_expand_cache);
+
+// Returns the resultId of the diagnostics of "buffer". It changes whenever
+// the diagnostics might, i.e. with the buffer version or lint configuration.
+std::string DiagnosticResultId(const ParsedBuffer &buffer);
 
-verible::lsp::FullDocumentDiagnosticReport GenerateDiagnosticReport(
+// Generate the textDocument/diagnostic response: an "unchanged" report if
+// the client already has the current result, a "full" report otherwise.
+nlohmann::json GenerateDiagnosticReport(
     const BufferTracker *tracker,
     const verible::lsp::DocumentDiagnosticParams &p);
 
+// Generate the workspace/diagnostic report of a file that is not open in
+// the editor, given its "content" and the resultId the client has for it.
+nlohmann::json GenerateWorkspaceDocumentDiagnosticReport(
+    std::string_view uri, std::string_view content,
+    std::string_view previous_result_id);
+
 // Given a parse tree, generate a document symbol outline
 // textDocument/documentSymbol request
 // There is a workaround for the kate editor currently. Goal is to actually
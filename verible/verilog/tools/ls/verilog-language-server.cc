@@ -14,17 +14,28 @@
 
 #include "verible/verilog/tools/ls/verilog-language-server.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
 #include <filesystem>
+#include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
 #include "nlohmann/json.hpp"
 #include "verible/common/lsp/lsp-file-utils.h"
 #include "verible/common/lsp/lsp-protocol.h"
@@ -32,9 +43,13 @@
 #include "verible/common/util/init-command-line.h"
 #include "verible/common/util/logging.h"
 #include "verible/verilog/analysis/verilog-project.h"
+#include "verible/verilog/tools/ls/completion.h"
+#include "verible/verilog/tools/ls/diagnostic-publisher.h"
 #include "verible/verilog/tools/ls/hover.h"
 #include "verible/verilog/tools/ls/lsp-parse-buffer.h"
+#include "verible/verilog/tools/ls/performance-telemetry.h"
 #include "verible/verilog/tools/ls/symbol-table-handler.h"
+#include "verible/verilog/tools/ls/syntax-tree-working-set.h"
 #include "verible/verilog/tools/ls/verible-lsp-adapter.h"
 
 ABSL_FLAG(bool, variables_in_outline, true,
@@ -43,27 +58,90 @@ ABSL_FLAG(bool, variables_in_outline, true,
 ABSL_FLAG(bool, lsp_enable_hover, false,
           "Enable hover mode, which is experimental right now");
 
+ABSL_FLAG(int, lsp_diagnostics_delay_ms, 100,
+          "Publish the diagnostics of a changed buffer only after it did not "
+          "change for this many milliseconds, so that a burst of edits "
+          "results in one notification.");
+
+ABSL_FLAG(int, lsp_telemetry_events, 0,
+          "If > 0, keep the timings of this many of the last buffer updates "
+          "and symbol table builds, for the verible/telemetry request.");
+
+ABSL_FLAG(std::string, lsp_telemetry_trace_file, "",
+          "If set, write the timings kept with --lsp_telemetry_events as "
+          "Chrome trace JSON to this file when the server exits.");
+
 namespace verilog {
 
 VerilogLanguageServer::VerilogLanguageServer(bool push_diagnostic_notification,
                                              const WriteFun &write_fun)
-    : dispatcher_(write_fun), text_buffers_(&dispatcher_) {
+    : dispatcher_(write_fun),
+      text_buffers_(&dispatcher_),
+      telemetry_(std::max(absl::GetFlag(FLAGS_lsp_telemetry_events), 0)),
+      diagnostic_publisher_(
+          absl::Milliseconds(absl::GetFlag(FLAGS_lsp_diagnostics_delay_ms)),
+          [this](const std::string &uri) {
+            return CreatePublishedDiagnostics(uri);
+          },
+          [this](const verible::lsp::PublishDiagnosticsParams &params) {
+            dispatcher_.SendNotification("textDocument/publishDiagnostics",
+                                         params);
+          }) {
   // All bodies the stream splitter extracts are pushed to the json dispatcher
   stream_splitter_.SetMessageProcessor(
       [this](std::string_view header, std::string_view body) {
-        dispatcher_.DispatchMessage(body);
+        QueueMessage(body);
       });
 
+  // Requests that take long, like finding references, stop when cancelled.
+  symbol_table_handler_.SetCancellationCheck(
+      [this]() { return dispatcher_.IsCurrentRequestCancelled(); });
+
+  symbol_table_handler_.SetTelemetry(&telemetry_);
+
   // Whenever the text changes in the editor, reparse affected code.
-  text_buffers_.SetChangeListener(parsed_buffers_.GetSubscriptionCallback());
+  text_buffers_.SetChangeListener(
+      [this, update = parsed_buffers_.GetSubscriptionCallback()](
+          const std::string &uri, const verible::lsp::EditTextBuffer *txt) {
+        if (!telemetry_.enabled() || txt == nullptr) {
+          update(uri, txt);
+          return;
+        }
+        const int64_t memory_before = ResidentMemoryBytes();
+        const absl::Time start = absl::Now();
+        update(uri, txt);
+        RecordBufferUpdate(uri, start, memory_before);
+      });
+
+  // What AUTO expansion found in a buffer is only valid for its version.
+  parsed_buffers_.AddChangeListener(
+      [this](const std::string &uri, const verilog::BufferTracker *) {
+        auto_expand_cache_.Remove(uri);
+      });
 
   // Whenever there is a new parse result ready, use that as an opportunity
-  // to send diagnostics to the client.
+  // to send diagnostics to the client, once the buffer settled.
   if (push_diagnostic_notification) {
     parsed_buffers_.AddChangeListener(
         [this](const std::string &uri,
                const verilog::BufferTracker *buffer_tracker) {
-          if (buffer_tracker) SendDiagnostics(uri, *buffer_tracker);
+          if (buffer_tracker) {
+            diagnostic_publisher_.Schedule(uri, absl::Now());
+          } else {
+            diagnostic_publisher_.Remove(uri);
+          }
+        });
+    // A client relates code actions and pulled diagnostics to the pushed
+    // diagnostics it shows, so these need to be current; other requests
+    // leave them to settle.
+    dispatcher_.SetBeforeRequestHandler(
+        [this](const std::string &method, const nlohmann::json &params) {
+          if (method == "textDocument/codeAction") {
+            diagnostic_publisher_.Publish(
+                params.at("textDocument").at("uri").get<std::string>());
+          } else if (method == "textDocument/diagnostic") {
+            diagnostic_publisher_.PublishAll();
+          }
         });
   }
   SetRequestHandlers();
@@ -96,10 +174,14 @@ verible::lsp::InitializeResult VerilogLanguageServer::GetCapabilities() {
       // Hover available, but not yet offered to client until tested.
       {"hoverProvider", enable_hover},  // Hover info over cursor
       {"renameProvider", true},         // Provide symbol renaming
+      {"completionProvider",            // Complete names as they are typed
+       {
+           {"triggerCharacters", {"`", ".", ":"}},
+       }},
       {"diagnosticProvider",            // Pull model of diagnostics.
        {
            {"interFileDependencies", false},
-           {"workspaceDiagnostics", false},
+           {"workspaceDiagnostics", true},
        }},
   };
 
@@ -119,13 +201,19 @@ void VerilogLanguageServer::SetRequestHandlers() {
         return verilog::GenerateDiagnosticReport(
             parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p);
       });
+  dispatcher_.AddRequestHandler(  // Diagnostics of files not opened
+      "workspace/diagnostic",
+      [this](const verible::lsp::WorkspaceDiagnosticParams &p) {
+        return WorkspaceDiagnostics(p);
+      });
 
   dispatcher_.AddRequestHandler(  // Provide autofixes
       "textDocument/codeAction",
       [this](const verible::lsp::CodeActionParams &p) {
         return verilog::GenerateCodeActions(
             &symbol_table_handler_,
-            parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p);
+            parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p,
+            &auto_expand_cache_);
       });
 
   dispatcher_.AddRequestHandler(  // Provide document outline/index
@@ -141,6 +229,11 @@ void VerilogLanguageServer::SetRequestHandlers() {
   dispatcher_.AddRequestHandler(  // Highlight related symbols under cursor
       "textDocument/documentHighlight",
       [this](const verible::lsp::DocumentHighlightParams &p) {
+        // By scope if the symbol table knows the symbol, else by name.
+        if (auto highlights =
+                symbol_table_handler_.FindHighlightRanges(p, parsed_buffers_)) {
+          return *std::move(highlights);
+        }
         return verilog::CreateHighlightRanges(
             parsed_buffers_.FindBufferTrackerOrNull(p.textDocument.uri), p);
       });
@@ -186,12 +279,30 @@ void VerilogLanguageServer::SetRequestHandlers() {
         return CreateHoverInformation(&symbol_table_handler_, parsed_buffers_,
                                       p);
       });
+  dispatcher_.AddRequestHandler(
+      "textDocument/completion",
+      [this](const verible::lsp::CompletionParams &p) {
+        return CreateCompletionList(&symbol_table_handler_, parsed_buffers_,
+                                    p);
+      });
   // The client sends a request to shut down. Use that to exit our loop.
   dispatcher_.AddRequestHandler("shutdown", [this](const nlohmann::json &) {
     shutdown_requested_ = true;
     return nullptr;
   });
 
+  dispatcher_.AddRequestHandler(  // Memory use, for diagnosing the server
+      "verible/status",
+      [this](const nlohmann::json &) { return StatusReport(); });
+
+  dispatcher_.AddRequestHandler(  // Timings, with --lsp_telemetry_events
+      "verible/telemetry", [this](const nlohmann::json &params) {
+        if (params.is_object() && params.value("format", "") == "chrome") {
+          return telemetry_.ToChromeTrace();
+        }
+        return telemetry_.ToJson();
+      });
+
   // Handle workspace files notification from client (DUDUlinter plugin)
   dispatcher_.AddNotificationHandler(
       "verible/updateWorkspaceFiles",
@@ -200,17 +311,250 @@ void VerilogLanguageServer::SetRequestHandlers() {
       });
 }
 
+// Requests that only look at the ParsedBuffer of their document, and can be
+// answered while the symbol table is in use. Others that do, like hover or
+// documentHighlight, also look up their symbol in the symbol table.
+static bool IsBufferRequest(std::string_view method) {
+  return method == "textDocument/documentSymbol" ||
+         method == "textDocument/formatting" ||
+         method == "textDocument/rangeFormatting" ||
+         method == "textDocument/diagnostic";
+}
+
+// Requests that read the symbol table, which builds itself on demand; these
+// run one at a time.
+static bool IsSymbolTableRequest(std::string_view method) {
+  return method == "textDocument/codeAction" ||
+         method == "textDocument/documentHighlight" ||
+         method == "textDocument/definition" ||
+         method == "textDocument/references" ||
+         method == "textDocument/prepareRename" ||
+         method == "textDocument/rename" || method == "textDocument/hover" ||
+         method == "textDocument/completion" ||
+         method == "workspace/diagnostic";
+}
+
+void VerilogLanguageServer::QueueMessage(std::string_view body) {
+  // Only look closer at requests, which may be cancelled, and the few
+  // messages that can affect those before them. Most of the large messages,
+  // didChange with the text of a file, are notifications without an id.
+  std::string request_method;
+  if (body.find("\"id\"") != std::string_view::npos ||
+      body.find("$/cancelRequest") != std::string_view::npos) {
+    const nlohmann::json message =
+        nlohmann::json::parse(body, nullptr, /*allow_exceptions=*/false);
+    if (message.is_object() && message.contains("method")) {
+      const nlohmann::json &method = message["method"];
+      if (message.contains("id")) {
+        dispatcher_.RequestQueued(message["id"]);
+        if (method.is_string()) request_method = method;
+      }
+      if (method == "$/cancelRequest" && message.contains("params") &&
+          message["params"].contains("id")) {
+        dispatcher_.CancelRequest(message["params"]["id"]);
+      } else if (method == "shutdown") {
+        shutdown_read_ = true;
+      }
+    }
+  }
+  {
+    const std::lock_guard<std::mutex> l(queue_mutex_);
+    queued_messages_.push_back(
+        {std::string(body), std::move(request_method)});
+  }
+  queue_changed_.notify_one();
+}
+
+void VerilogLanguageServer::DispatchQueuedMessages() {
+  for (;;) {
+    QueuedMessage message;
+    {
+      const std::lock_guard<std::mutex> l(queue_mutex_);
+      if (queued_messages_.empty()) return;
+      message = std::move(queued_messages_.front());
+      queued_messages_.pop_front();
+    }
+    ScheduleMessage(std::move(message));
+  }
+}
+
+void VerilogLanguageServer::ScheduleMessage(QueuedMessage message) {
+  const std::string &method = message.request_method;
+  if (IsBufferRequest(method)) {
+    // Buffers only change in between requests, so the request sees the
+    // ParsedBuffer snapshots as they were when it was read.
+    running_requests_.push_back(buffer_requests_.ExecAsync<void>(
+        [this, body = std::move(message.body)]() {
+          dispatcher_.DispatchMessage(body);
+        }));
+  } else if (IsSymbolTableRequest(method)) {
+    running_requests_.push_back(symbol_table_requests_.ExecAsync<void>(
+        [this, body = std::move(message.body)]() {
+          dispatcher_.DispatchMessage(body);
+          // No other request uses the symbol table, so syntax trees can be
+          // released.
+          symbol_table_handler_.EnforceSyntaxTreeBudget();
+        }));
+  } else {
+    // Changes of buffers, the project or settings.
+    WaitForRunningRequests();
+    dispatcher_.DispatchMessage(message.body);
+    symbol_table_handler_.EnforceSyntaxTreeBudget();
+    return;
+  }
+  // Forget the requests that were answered meanwhile.
+  running_requests_.erase(
+      std::remove_if(running_requests_.begin(), running_requests_.end(),
+                     [](const std::future<void> &request) {
+                       return request.wait_for(std::chrono::seconds(0)) ==
+                              std::future_status::ready;
+                     }),
+      running_requests_.end());
+}
+
+void VerilogLanguageServer::WaitForRunningRequests() {
+  for (std::future<void> &request : running_requests_) request.get();
+  running_requests_.clear();
+}
+
 absl::Status VerilogLanguageServer::Step(const ReadFun &read_fun) {
-  return stream_splitter_.PullFrom(read_fun);
+  const absl::Status status = stream_splitter_.PullFrom(read_fun);
+  DispatchQueuedMessages();
+  WaitForRunningRequests();
+  diagnostic_publisher_.PublishAll();
+  // No request is in flight, so syntax trees can be released.
+  symbol_table_handler_.EnforceSyntaxTreeBudget();
+  return status;
 }
 
 absl::Status VerilogLanguageServer::Run(const ReadFun &read_fun) {
   shutdown_requested_ = false;
-  absl::Status status = absl::OkStatus();
-  while (status.ok() && !shutdown_requested_) {
-    status = Step(read_fun);
+  shutdown_read_ = false;
+
+  bool reading = true;  // Guarded by queue_mutex_, as is read_status.
+  absl::Status read_status = absl::OkStatus();
+  std::thread reader([&]() {
+    absl::Status status;
+    do {
+      status = stream_splitter_.PullFrom(read_fun);
+    } while (status.ok() && !shutdown_read_);
+    {
+      const std::lock_guard<std::mutex> l(queue_mutex_);
+      read_status = status;
+      reading = false;
+    }
+    queue_changed_.notify_one();
+  });
+
+  while (!shutdown_requested_) {
+    QueuedMessage message;
+    {
+      std::unique_lock<std::mutex> l(queue_mutex_);
+      const auto has_message = [&]() {
+        return !queued_messages_.empty() || !reading;
+      };
+      // While idle, wake up when diagnostics are due.
+      const absl::Time next_due = diagnostic_publisher_.NextDue();
+      if (next_due == absl::InfiniteFuture()) {
+        queue_changed_.wait(l, has_message);
+      } else if (!queue_changed_.wait_until(l, absl::ToChronoTime(next_due),
+                                            has_message)) {
+        l.unlock();
+        diagnostic_publisher_.PublishDue(absl::Now());
+        continue;
+      }
+      if (queued_messages_.empty()) break;  // Nothing more to read.
+      message = std::move(queued_messages_.front());
+      queued_messages_.pop_front();
+    }
+    ScheduleMessage(std::move(message));
   }
-  return status;
+  WaitForRunningRequests();
+
+  // The reader stops after the shutdown request, or at the end of input.
+  reader.join();
+  WriteTelemetryTrace();
+  if (shutdown_requested_) return absl::OkStatus();
+  return read_status;
+}
+
+void VerilogLanguageServer::RecordBufferUpdate(const std::string &uri,
+                                               absl::Time start,
+                                               int64_t memory_before) {
+  const absl::Time end = absl::Now();
+  const int64_t memory_after = ResidentMemoryBytes();
+  const BufferTracker *tracker = parsed_buffers_.FindBufferTrackerOrNull(uri);
+  if (!tracker || !tracker->current()) return;
+  const ParsedBuffer &parsed = *tracker->current();
+  const ParsedBuffer::Timing &timing = parsed.timing();
+  const VerilogAnalyzer::PhaseTimes &analyze = timing.analyze_phases;
+  const LinterTimes &lint = timing.lint_phases;
+  // The analysis is tried again with other preprocessing if it fails; only
+  // the phases of the last attempt are known.
+  const absl::Duration retries =
+      timing.analyze - analyze.lex - analyze.preprocess - analyze.parse;
+  TelemetryEvent event{
+      .name = "buffer-update",
+      .subject = uri,
+      .start = start,
+      .duration = end - start,
+      .bytes = static_cast<int64_t>(parsed.parser().Data().Contents().size()),
+      .memory_delta = (memory_before >= 0 && memory_after >= 0)
+                          ? memory_after - memory_before
+                          : 0,
+  };
+  if (retries > absl::ZeroDuration()) {
+    event.phases.emplace_back("analysis-retries", retries);
+  }
+  event.phases.insert(event.phases.end(),
+                      {
+                          {"lex", analyze.lex},
+                          {"preprocess", analyze.preprocess},
+                          {"parse", analyze.parse},
+                          {"lint-waivers", lint.waivers},
+                          {"lint-text-structure-rules", lint.text_structure},
+                          {"lint-line-rules", lint.line},
+                          {"lint-token-stream-rules", lint.token_stream},
+                          {"lint-syntax-tree-rules", lint.syntax_tree},
+                      });
+  telemetry_.Record(std::move(event));
+}
+
+void VerilogLanguageServer::WriteTelemetryTrace() const {
+  const std::string path = absl::GetFlag(FLAGS_lsp_telemetry_trace_file);
+  if (path.empty() || !telemetry_.enabled()) return;
+  const absl::Status status =
+      verible::file::SetContents(path, telemetry_.ToChromeTrace().dump());
+  if (!status.ok()) {
+    LOG(WARNING) << "Can't write telemetry trace: " << status;
+  }
+}
+
+nlohmann::json VerilogLanguageServer::StatusReport() const {
+  const SyntaxTreeWorkingSet &syntax_trees =
+      symbol_table_handler_.syntax_trees();
+  nlohmann::json resident_memory;  // null if not known.
+  if (const int64_t bytes = ResidentMemoryBytes(); bytes >= 0) {
+    resident_memory = bytes;
+  }
+  return {
+      {"residentMemoryBytes", resident_memory},
+      {"openDocuments", text_buffers_.size()},
+      {"telemetryEvents", telemetry_.size()},
+      {"publishedDiagnostics",
+       {
+           {"scheduled", diagnostic_publisher_.scheduled()},
+           {"sent", diagnostic_publisher_.sent()},
+           {"unchanged", diagnostic_publisher_.unchanged()},
+       }},
+      {"syntaxTrees",
+       {
+           {"resident", syntax_trees.resident_files()},
+           {"residentBytes", syntax_trees.resident_bytes()},
+           {"released", syntax_trees.released_files()},
+           {"budgetBytes", syntax_trees.budget_bytes()},
+       }},
+  };
 }
 
 void VerilogLanguageServer::PrintStatistics() const {
@@ -276,11 +620,49 @@ void VerilogLanguageServer::ConfigureProject(std::string_view project_root) {
       symbol_table_handler_.CreateBufferTrackerListener());
 }
 
-void VerilogLanguageServer::SendDiagnostics(
-    const std::string &uri, const verilog::BufferTracker &buffer_tracker) {
-  // TODO(hzeller): Cache result and rate-limit.
-  // This should not send anything if the diagnostics we're about to
-  // send would be exactly the same as last time.
+verible::lsp::WorkspaceDiagnosticReport
+VerilogLanguageServer::WorkspaceDiagnostics(
+    const verible::lsp::WorkspaceDiagnosticParams &p) {
+  std::unordered_map<std::string, std::string> previous_result_ids;
+  for (const auto &previous : p.previousResultIds) {
+    previous_result_ids[previous.uri] = previous.value;
+  }
+
+  verible::lsp::WorkspaceDiagnosticReport report;
+  // With partial results, the client can show the first reports early. The
+  // final response then is empty.
+  static constexpr size_t kPartialResultBatch = 32;
+  auto flush_partial_result = [&]() {
+    if (!p.has_partialResultToken || report.items.empty()) return;
+    dispatcher_.SendNotification(
+        "$/progress", verible::lsp::ProgressParams{
+                          .token = p.partialResultToken, .value = report});
+    report.items.clear();
+  };
+
+  const VerilogProject *project = symbol_table_handler_.PreparedProject();
+  if (!project) return report;
+  for (const auto &[name, file] : *project) {
+    if (dispatcher_.IsCurrentRequestCancelled()) break;
+    const std::string_view content = file->GetContent();
+    if (content.empty()) continue;  // Not loaded.
+    const std::string uri = verible::lsp::PathToLSPUri(file->ResolvedPath());
+    // Open files are reported with textDocument/diagnostic.
+    if (parsed_buffers_.FindBufferTrackerOrNull(uri)) continue;
+    const auto previous = previous_result_ids.find(uri);
+    report.items.push_back(GenerateWorkspaceDocumentDiagnosticReport(
+        uri, content,
+        previous == previous_result_ids.end() ? "" : previous->second));
+    if (report.items.size() >= kPartialResultBatch) flush_partial_result();
+  }
+  flush_partial_result();
+  return report;
+}
+
+std::optional<verible::lsp::PublishDiagnosticsParams>
+VerilogLanguageServer::CreatePublishedDiagnostics(const std::string &uri) {
+  const BufferTracker *tracker = parsed_buffers_.FindBufferTrackerOrNull(uri);
+  if (!tracker) return std::nullopt;  // Closed meanwhile.
   verible::lsp::PublishDiagnosticsParams params;
 
   // For the diagnostic notification (that we send somewhat unsolicited), we
@@ -289,21 +671,19 @@ void VerilogLanguageServer::SendDiagnostics(
   // Arbitrary limit here. Maybe set with flag ?
   static constexpr int kDiagnosticLimit = 500;
   params.uri = uri;
-  params.diagnostics =
-      verilog::CreateDiagnostics(buffer_tracker, kDiagnosticLimit);
-  dispatcher_.SendNotification("textDocument/publishDiagnostics", params);
+  params.diagnostics = verilog::CreateDiagnostics(*tracker, kDiagnosticLimit);
+  return params;
 }
 
 void VerilogLanguageServer::RefreshAllDiagnostics() {
   // Re-lint all buffers with updated configuration (e.g., top modules).
   parsed_buffers_.ReLintAll();
 
-  // Send updated diagnostics for all tracked buffers.
+  // Send updated diagnostics for all tracked buffers; only those that
+  // changed are actually sent.
+  const absl::Time now = absl::Now();
   for (const std::string &uri : parsed_buffers_.GetAllUris()) {
-    const BufferTracker *tracker = parsed_buffers_.FindBufferTrackerOrNull(uri);
-    if (tracker) {
-      SendDiagnostics(uri, *tracker);
-    }
+    diagnostic_publisher_.Schedule(uri, now);
   }
 }
 
@@ -15,16 +15,28 @@
 #ifndef VERILOG_TOOLS_LS_LS_WRAPPER_H
 #define VERILOG_TOOLS_LS_LS_WRAPPER_H
 
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 #include "absl/status/status.h"
+#include "absl/time/time.h"
 #include "nlohmann/json.hpp"
 #include "verible/common/lsp/json-rpc-dispatcher.h"
 #include "verible/common/lsp/lsp-protocol.h"
 #include "verible/common/lsp/lsp-text-buffer.h"
 #include "verible/common/lsp/message-stream-splitter.h"
+#include "verible/common/util/thread-pool.h"
+#include "verible/verilog/tools/ls/autoexpand.h"
+#include "verible/verilog/tools/ls/diagnostic-publisher.h"
 #include "verible/verilog/tools/ls/lsp-parse-buffer.h"
+#include "verible/verilog/tools/ls/performance-telemetry.h"
 #include "verible/verilog/tools/ls/symbol-table-handler.h"
 
 namespace verilog {
@@ -43,9 +55,19 @@ class VerilogLanguageServer {
                                  const WriteFun &write_fun);
 
   // Reads single request and responds to it (public to mock in tests).
+  // Returns once all requests that were read are answered.
   absl::Status Step(const ReadFun &read_fun);
 
   // Runs the Language Server, calling "read_fun" until we receive shutdown.
+  // A separate thread calls "read_fun" and queues the messages, so that
+  // requests can be cancelled while they wait or run.
+  //
+  // The messages are taken from the queue in the order they arrived.
+  // Requests that only look at their buffer run on one worker thread, and
+  // requests that use the symbol table on another, so that a slow one of
+  // the latter does not hold up the former. Requests on the same worker are
+  // answered in order. All other messages, e.g. didOpen or didChange, wait
+  // for the running requests, and are handled before the next ones start.
   absl::Status Run(const ReadFun &read_fun);
 
   // Prints statistics of the current Language Server session.
@@ -72,9 +94,16 @@ class VerilogLanguageServer {
   // or directory containing verible.filelist
   void ConfigureProject(std::string_view project_root);
 
-  // Publish a diagnostic sent to the server.
-  void SendDiagnostics(const std::string &uri,
-                       const verilog::BufferTracker &buffer_tracker);
+  // Reports the diagnostics of the project files that are not open in the
+  // editor for workspace/diagnostic. Sends them as partial results if the
+  // client asks for it.
+  verible::lsp::WorkspaceDiagnosticReport WorkspaceDiagnostics(
+      const verible::lsp::WorkspaceDiagnosticParams &p);
+
+  // Creates the textDocument/publishDiagnostics notification of "uri", or
+  // returns nullopt if it is not open anymore.
+  std::optional<verible::lsp::PublishDiagnosticsParams>
+  CreatePublishedDiagnostics(const std::string &uri);
 
   // Re-lint all buffers and send updated diagnostics.
   // Called after top modules are detected to ensure R-2-10 rule works.
@@ -83,23 +112,80 @@ class VerilogLanguageServer {
   // Handle workspace files notification from client.
   void HandleUpdateWorkspaceFiles(const nlohmann::json &params);
 
+  // A message that was read, and the method if it is a request.
+  struct QueuedMessage {
+    std::string body;
+    std::string request_method;
+  };
+
+  // Queues a message that was read, to be dispatched in turn. Cancellations
+  // take effect right away.
+  void QueueMessage(std::string_view body);
+
+  // Dispatches the queued messages.
+  void DispatchQueuedMessages();
+
+  // Dispatches "message" on the worker of its kind of request; or, after
+  // the running requests are answered, right away.
+  void ScheduleMessage(QueuedMessage message);
+
+  // Waits until the requests passed to the workers are answered.
+  void WaitForRunningRequests();
+
+  // Reports the memory used by the language server for verible/status.
+  nlohmann::json StatusReport() const;
+
+  // Records the timings of the buffer "uri", which was updated since
+  // "start", when the process used "memory_before" bytes.
+  void RecordBufferUpdate(const std::string &uri, absl::Time start,
+                          int64_t memory_before);
+
+  // Writes the telemetry to --lsp_telemetry_trace_file, if set.
+  void WriteTelemetryTrace() const;
+
   // Stream splitter splits the input stream into messages (header/body).
   verible::lsp::MessageStreamSplitter stream_splitter_;
 
   // Parser for JSON messages from LS client
   verible::lsp::JsonRpcDispatcher dispatcher_;
 
+  // Messages read, but not dispatched yet.
+  std::mutex queue_mutex_;
+  std::condition_variable queue_changed_;
+  std::deque<QueuedMessage> queued_messages_;
+
+  // A shutdown request was read; nothing but "exit" may follow.
+  bool shutdown_read_ = false;
+
   // Object for keeping track of updates in opened buffers on client's side
   verible::lsp::BufferCollection text_buffers_;
 
+  // Timings of the last buffer updates and symbol table builds.
+  verilog::PerformanceTelemetry telemetry_;
+
   // Tracks changes in buffers from BufferCollection and parses their contents
   verilog::BufferTrackerContainer parsed_buffers_;
 
+  // Publishes the diagnostics of changed buffers to the client.
+  verilog::DiagnosticPublisher diagnostic_publisher_;
+
   // Handles requests relying on the symbol table
   verilog::SymbolTableHandler symbol_table_handler_;
 
+  // Module summaries for AUTO expansion code actions
+  verilog::AutoExpandCache auto_expand_cache_;
+
   // A flag for indicating "shutdown" request
   bool shutdown_requested_ = false;
+
+  // Workers for the requests that only look at their buffer, and for those
+  // that use the symbol table. Last, so that they stop before what their
+  // requests use goes away.
+  verible::ThreadPool buffer_requests_{1};
+  verible::ThreadPool symbol_table_requests_{1};
+
+  // Requests passed to the workers, and not known to be answered.
+  std::vector<std::future<void>> running_requests_;
 };
 
 }  // namespace verilog
@@ -15,13 +15,16 @@
 #include "verible/verilog/tools/ls/verilog-language-server.h"
 
 #include <algorithm>
+#include <cstddef>
 #include <filesystem>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <string_view>
 #include <vector>
 
+#include "absl/flags/declare.h"
 #include "absl/flags/flag.h"
 #include "absl/status/status.h"
 #include "absl/strings/match.h"
@@ -29,12 +32,16 @@
 #include "absl/strings/str_replace.h"
 #include "gtest/gtest.h"
 #include "nlohmann/json.hpp"
+#include "verible/common/lsp/json-rpc-dispatcher.h"
 #include "verible/common/lsp/lsp-file-utils.h"
 #include "verible/common/lsp/lsp-protocol-enums.h"
 #include "verible/common/lsp/lsp-protocol.h"
 #include "verible/common/strings/line-column-map.h"
 #include "verible/common/util/file-util.h"
 #include "verible/verilog/analysis/verilog-linter.h"
+#include "verible/verilog/tools/ls/symbol-table-handler.h"
+
+ABSL_DECLARE_FLAG(int, lsp_telemetry_events);
 
 #undef ASSERT_OK
 #define ASSERT_OK(value)                             \
@@ -90,6 +97,19 @@ class VerilogLanguageServerTest : public ::testing::Test {
     return ServerStep();
   }
 
+  // Sends several requests at once, as if they arrived while the server was
+  // busy.
+  absl::Status SendRequests(const std::vector<std::string> &requests) {
+    std::string stream;
+    for (const std::string &request : requests) {
+      absl::StrAppend(&stream, "Content-Length: ", request.size(), "\r\n\r\n",
+                      request);
+    }
+    request_stream_.clear();
+    request_stream_.str(stream);
+    return ServerStep();
+  }
+
   // Returns the latest responses from the Language Server
   std::string GetResponse() {
     std::string response = response_stream_.str();
@@ -238,6 +258,51 @@ TEST_F(VerilogLanguageServerTest, SyntaxError) {
       << "No syntax error found";
 }
 
+// Checks that textDocument/diagnostic only sends the items again if they
+// might have changed since the resultId the client has.
+TEST_F(VerilogLanguageServerTest, DiagnosticRequestWithPreviousResultId) {
+  ASSERT_OK(SendRequest(DidOpenRequest("file://mini.sv", "module mini();\n")));
+  GetResponse();  // Ignore diagnostics notification.
+
+  json request = {
+      {"jsonrpc", "2.0"},
+      {"id", 2},
+      {"method", "textDocument/diagnostic"},
+      {"params", {{"textDocument", {{"uri", "file://mini.sv"}}}}}};
+  ASSERT_OK(SendRequest(request.dump()));
+  const json full = json::parse(GetResponse());
+  EXPECT_EQ(full["result"]["kind"], "full");
+  ASSERT_TRUE(full["result"]["resultId"].is_string());
+  const std::string result_id = full["result"]["resultId"];
+
+  request["id"] = 3;
+  request["params"]["previousResultId"] = result_id;
+  ASSERT_OK(SendRequest(request.dump()));
+  const json unchanged = json::parse(GetResponse());
+  EXPECT_EQ(unchanged["result"]["kind"], "unchanged");
+  EXPECT_EQ(unchanged["result"]["resultId"], result_id);
+  EXPECT_FALSE(unchanged["result"].contains("items"));
+
+  // A new version of the document has a new result.
+  const std::string change_request = R"(
+    {
+      "jsonrpc": "2.0", "method": "textDocument/didChange",
+      "params":
+      {
+        "textDocument": {"uri": "file://mini.sv"},
+        "contentChanges": [{"text": "module mini();\nendmodule\n"}]
+      }
+    }
+  )";
+  ASSERT_OK(SendRequest(change_request));
+  GetResponse();
+  request["id"] = 4;
+  ASSERT_OK(SendRequest(request.dump()));
+  const json changed = json::parse(GetResponse());
+  EXPECT_EQ(changed["result"]["kind"], "full");
+  EXPECT_NE(changed["result"]["resultId"], result_id);
+}
+
 // Tests diagnostics for file with linting error before and after fix
 TEST_F(VerilogLanguageServerTest, LintErrorDetection) {
   const std::string lint_error =
@@ -699,6 +764,47 @@ TEST_F(VerilogLanguageServerTest, FormattingFileWithSyntaxErrors_issue1843) {
   const json response = json::parse(GetResponse());
 }
 
+TEST_F(VerilogLanguageServerTest, FormattingOnlyEditsChangedLines) {
+  const std::string fmt_module = DidOpenRequest(
+      "file://fmt.sv", "module fmt ();\n  assign a=1;\nendmodule\n");
+  ASSERT_OK(SendRequest(fmt_module));
+
+  GetResponse();  // Ignore diagnostics.
+
+  const std::string_view formatting_request = R"(
+{"jsonrpc":"2.0", "id":1,
+ "method": "textDocument/formatting",
+ "params": {"textDocument":{"uri":"file://fmt.sv"}}})";
+
+  ASSERT_OK(SendRequest(formatting_request));
+
+  const json response = json::parse(GetResponse());
+  ASSERT_EQ(response["result"].size(), 1);
+  EXPECT_EQ(std::string(response["result"][0]["newText"]),
+            "  assign a = 1;\n");
+  EXPECT_EQ(response["result"][0]["range"], json::parse(R"(
+{"start":{"line":1, "character": 0},
+ "end":  {"line":2, "character": 0}})"));
+}
+
+TEST_F(VerilogLanguageServerTest, FormattingFormattedFileHasNoEdits) {
+  const std::string fmt_module = DidOpenRequest(
+      "file://fmt.sv", "module fmt ();\n  assign a = 1;\nendmodule\n");
+  ASSERT_OK(SendRequest(fmt_module));
+
+  GetResponse();  // Ignore diagnostics.
+
+  const std::string_view formatting_request = R"(
+{"jsonrpc":"2.0", "id":1,
+ "method": "textDocument/formatting",
+ "params": {"textDocument":{"uri":"file://fmt.sv"}}})";
+
+  ASSERT_OK(SendRequest(formatting_request));
+
+  const json response = json::parse(GetResponse());
+  EXPECT_TRUE(response["result"].empty());
+}
+
 // Creates a request based on TextDocumentPosition parameters
 std::string TextDocumentPositionBasedRequest(std::string_view method,
                                              std::string_view file, int id,
@@ -872,6 +978,321 @@ TEST_F(VerilogLanguageServerSymbolTableTest, DefinitionRequestTest) {
                                           module_a_uri);
 }
 
+// Returns the messages the language server sent in one step.
+static std::vector<json> ParseMessages(const std::string &responses) {
+  std::vector<json> result;
+  std::istringstream stream(responses);
+  while ((stream >> std::ws).peek() != EOF) {
+    stream >> result.emplace_back();
+  }
+  return result;
+}
+
+// Checks that workspace/diagnostic reports files of the project that are not
+// opened, and only sends their items again if they changed.
+TEST_F(VerilogLanguageServerSymbolTableTest, WorkspaceDiagnostics) {
+  const verible::file::testing::ScopedTestFile filelist(
+      root_dir, "a.sv\nb.sv\n", "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(
+      root_dir, "module a;  \nendmodule\n", "a.sv");
+  const verible::file::testing::ScopedTestFile module_b(
+      root_dir, "module b;\nendmodule\n", "b.sv");
+  const std::string module_a_uri = PathToLSPUri(module_a.filename());
+  const std::string module_b_uri = PathToLSPUri(module_b.filename());
+
+  // Opened files are reported by textDocument/diagnostic instead.
+  ASSERT_OK(
+      SendRequest(DidOpenRequest(module_b_uri, "module b;\nendmodule\n")));
+  GetResponse();
+
+  json request = {{"jsonrpc", "2.0"},
+                  {"id", 2},
+                  {"method", "workspace/diagnostic"},
+                  {"params", {{"previousResultIds", json::array()}}}};
+  ASSERT_OK(SendRequest(request.dump()));
+  const json full = json::parse(GetResponse());
+  ASSERT_EQ(full["result"]["items"].size(), 1);
+  const json &report = full["result"]["items"][0];
+  EXPECT_EQ(report["kind"], "full");
+  EXPECT_EQ(report["uri"], module_a_uri);
+  EXPECT_TRUE(report["version"].is_null());
+  EXPECT_TRUE(std::any_of(
+      report["items"].begin(), report["items"].end(), [](const json &item) {
+        return absl::StrContains(item["message"].get<std::string>(),
+                                 "trailing spaces");
+      }));
+
+  request["id"] = 3;
+  request["params"]["previousResultIds"] = {
+      {{"uri", module_a_uri}, {"value", report["resultId"]}}};
+  ASSERT_OK(SendRequest(request.dump()));
+  const json unchanged = json::parse(GetResponse());
+  ASSERT_EQ(unchanged["result"]["items"].size(), 1);
+  EXPECT_EQ(unchanged["result"]["items"][0]["kind"], "unchanged");
+  EXPECT_EQ(unchanged["result"]["items"][0]["resultId"], report["resultId"]);
+  EXPECT_EQ(unchanged["result"]["items"][0]["uri"], module_a_uri);
+}
+
+// Checks that workspace/diagnostic sends partial results if asked to.
+TEST_F(VerilogLanguageServerSymbolTableTest,
+       WorkspaceDiagnosticsPartialResult) {
+  const verible::file::testing::ScopedTestFile filelist(root_dir, "a.sv\n",
+                                                        "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(
+      root_dir, "module a;\nendmodule\n", "a.sv");
+
+  const json request = {
+      {"jsonrpc", "2.0"},
+      {"id", 2},
+      {"method", "workspace/diagnostic"},
+      {"params",
+       {{"previousResultIds", json::array()}, {"partialResultToken", "tok"}}}};
+  ASSERT_OK(SendRequest(request.dump()));
+  const std::vector<json> messages = ParseMessages(GetResponse());
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_EQ(messages[0]["method"], "$/progress");
+  EXPECT_EQ(messages[0]["params"]["token"], "tok");
+  ASSERT_EQ(messages[0]["params"]["value"]["items"].size(), 1);
+  EXPECT_EQ(messages[0]["params"]["value"]["items"][0]["uri"],
+            PathToLSPUri(module_a.filename()));
+  // The response itself is empty.
+  EXPECT_EQ(messages[1]["id"], 2);
+  EXPECT_TRUE(messages[1]["result"]["items"].empty());
+}
+
+// Checks that syntax trees of project files beyond the memory budget are
+// released, and that definitions in these files are still found.
+TEST_F(VerilogLanguageServerSymbolTableTest, SyntaxTreesBeyondMemoryBudget) {
+  const int previous_budget =
+      absl::GetFlag(FLAGS_lsp_syntax_tree_memory_budget_mb);
+  absl::SetFlag(&FLAGS_lsp_syntax_tree_memory_budget_mb, 1);
+
+  // Each of these has well over a MiB of tokens and syntax tree.
+  std::string wires;
+  for (int i = 0; i < 5000; ++i) absl::StrAppend(&wires, "  wire w", i, ";\n");
+  const std::string module_a_content = absl::StrCat("module a;\n", wires,
+                                                    "endmodule\n");
+  const std::string module_b_content = absl::StrCat("module b;\n", wires,
+                                                    "endmodule\n");
+  constexpr std::string_view module_c_content =
+      "module c;\n  a a_inst();\nendmodule\n";
+  const verible::file::testing::ScopedTestFile filelist(
+      root_dir, "a.sv\nb.sv\nc.sv\n", "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(
+      root_dir, module_a_content, "a.sv");
+  const verible::file::testing::ScopedTestFile module_b(
+      root_dir, module_b_content, "b.sv");
+  const verible::file::testing::ScopedTestFile module_c(
+      root_dir, module_c_content, "c.sv");
+  const std::string module_c_uri = PathToLSPUri(module_c.filename());
+
+  ASSERT_OK(SendRequest(DidOpenRequest(module_c_uri, module_c_content)));
+  GetResponse();
+
+  ASSERT_OK(SendRequest(DefinitionRequest(module_c_uri, 2, 1, 2)));
+  const json definition = json::parse(GetResponse());
+  CheckDefinitionResponseSingleDefinition(
+      definition, 2, {.line = 0, .column = 7}, {.line = 0, .column = 8},
+      PathToLSPUri(module_a.filename()));
+
+  const json status_request = {
+      {"jsonrpc", "2.0"}, {"id", 3}, {"method", "verible/status"}};
+  ASSERT_OK(SendRequest(status_request.dump()));
+  const json status = json::parse(GetResponse());
+  EXPECT_EQ(status["result"]["openDocuments"], 1);
+  const json &syntax_trees = status["result"]["syntaxTrees"];
+  EXPECT_EQ(syntax_trees["budgetBytes"], 1 << 20);
+  EXPECT_GE(syntax_trees["released"], 1);
+  EXPECT_GE(syntax_trees["resident"], 1);
+
+  absl::SetFlag(&FLAGS_lsp_syntax_tree_memory_budget_mb, previous_budget);
+}
+
+// Checks that a request cancelled while it waits is answered with an error,
+// without affecting the requests before and after it.
+TEST_F(VerilogLanguageServerSymbolTableTest, CancelQueuedRequest) {
+  const verible::file::testing::ScopedTestFile filelist(root_dir, "a.sv\n",
+                                                        "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_a(root_dir,
+                                                        kSampleModuleA, "a.sv");
+  const std::string module_a_uri = PathToLSPUri(module_a.filename());
+
+  const json cancel = {{"jsonrpc", "2.0"},
+                       {"method", "$/cancelRequest"},
+                       {"params", {{"id", 3}}}};
+  ASSERT_OK(SendRequests({
+      DidOpenRequest(module_a_uri, kSampleModuleA),
+      ReferencesRequest(module_a_uri, 2, 1, 11),
+      ReferencesRequest(module_a_uri, 3, 1, 11),
+      cancel.dump(),
+      ReferencesRequest(module_a_uri, 4, 1, 11),
+  }));
+
+  std::map<int, json> responses;
+  for (const json &message : ParseMessages(GetResponse())) {
+    if (message.contains("id")) responses[message["id"]] = message;
+  }
+  ASSERT_EQ(responses.size(), 3);
+  EXPECT_EQ(responses[2]["result"].size(), 2);
+  EXPECT_TRUE(responses[3].find("result") == responses[3].end());
+  EXPECT_EQ(responses[3]["error"]["code"],
+            verible::lsp::JsonRpcDispatcher::kRequestCancelled);
+  EXPECT_EQ(responses[4]["result"], responses[2]["result"]);
+}
+
+// Returns a textDocument/didChange notification that replaces the text.
+static std::string DidChangeRequest(std::string_view uri,
+                                    std::string_view text) {
+  return json{{"jsonrpc", "2.0"},
+              {"method", "textDocument/didChange"},
+              {"params",
+               {{"textDocument", {{"uri", uri}}},
+                {"contentChanges", {{{"text", text}}}}}}}
+      .dump();
+}
+
+// Checks that a request between edits does not publish the diagnostics of
+// the intermediate version, unless the client relates it to them.
+TEST_F(VerilogLanguageServerTest, DocumentSymbolDoesNotPublishDiagnostics) {
+  ASSERT_OK(SendRequests({
+      DidOpenRequest("file://a.sv", "module a;\nendmodule\n"),
+      DidChangeRequest("file://a.sv", "module a;  \nendmodule\n"),
+      R"({"jsonrpc":"2.0", "id":2, "method":"textDocument/documentSymbol","params":{"textDocument":{"uri":"file://a.sv"}}})",
+      DidChangeRequest("file://a.sv", "module a;\nendmodule\n"),
+  }));
+  const std::vector<json> messages = ParseMessages(GetResponse());
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_EQ(messages[0]["id"], 2);
+  // Only the last version is published, once the messages are handled.
+  EXPECT_EQ(messages[1]["method"], "textDocument/publishDiagnostics");
+  EXPECT_EQ(messages[1]["params"]["diagnostics"].size(), 0);
+}
+
+// Checks that a code action publishes the diagnostics of its buffer first,
+// and only those.
+TEST_F(VerilogLanguageServerTest, CodeActionPublishesDiagnosticsOfItsBuffer) {
+  ASSERT_OK(SendRequests({
+      DidOpenRequest("file://a.sv", "module a;\nendmodule"),
+      DidOpenRequest("file://b.sv", "module b;\nendmodule"),
+      R"({"jsonrpc":"2.0", "id":2, "method":"textDocument/codeAction","params":{"textDocument":{"uri":"file://b.sv"},"range":{"start":{"line":1,"character":9},"end":{"line":1,"character":9}}}})",
+  }));
+  const std::vector<json> messages = ParseMessages(GetResponse());
+  ASSERT_EQ(messages.size(), 3);
+  EXPECT_EQ(messages[0]["method"], "textDocument/publishDiagnostics");
+  EXPECT_EQ(messages[0]["params"]["uri"], "file://b.sv");
+  EXPECT_EQ(messages[1]["id"], 2);
+  EXPECT_EQ(messages[2]["method"], "textDocument/publishDiagnostics");
+  EXPECT_EQ(messages[2]["params"]["uri"], "file://a.sv");
+}
+
+// Checks that requests answered on the workers see the buffer as it was
+// when they were read, before and after an edit.
+TEST_F(VerilogLanguageServerTest, RequestsSeeTheEditsBeforeThem) {
+  const auto document_symbol = [](int id) {
+    return json{{"jsonrpc", "2.0"},
+                {"id", id},
+                {"method", "textDocument/documentSymbol"},
+                {"params", {{"textDocument", {{"uri", "file://a.sv"}}}}}}
+        .dump();
+  };
+  const auto highlight = [](int id) {
+    return json{{"jsonrpc", "2.0"},
+                {"id", id},
+                {"method", "textDocument/documentHighlight"},
+                {"params",
+                 {{"textDocument", {{"uri", "file://a.sv"}}},
+                  {"position", {{"line", 1}, {"character", 7}}}}}}
+        .dump();
+  };
+  ASSERT_OK(SendRequests({
+      DidOpenRequest("file://a.sv",
+                     "module a;\n  wire x;\n  assign x = 1;\nendmodule\n"),
+      document_symbol(2),
+      highlight(3),
+      DidChangeRequest("file://a.sv", "module b;\n  wire x;\nendmodule\n"),
+      highlight(4),
+      document_symbol(5),
+  }));
+
+  std::map<int, json> responses;
+  for (const json &message : ParseMessages(GetResponse())) {
+    if (message.contains("id")) responses[message["id"]] = message;
+  }
+  ASSERT_EQ(responses.size(), 4);
+  ASSERT_EQ(responses[2]["result"].size(), 1);
+  EXPECT_EQ(responses[2]["result"][0]["name"], "a");
+  EXPECT_EQ(responses[3]["result"].size(), 2);
+  EXPECT_EQ(responses[4]["result"].size(), 1);
+  ASSERT_EQ(responses[5]["result"].size(), 1);
+  EXPECT_EQ(responses[5]["result"][0]["name"], "b");
+}
+
+// Returns the labels of the items of a textDocument/completion response.
+static std::vector<std::string> CompletionLabels(const json &response) {
+  std::vector<std::string> labels;
+  for (const json &item : response["result"]["items"]) {
+    labels.push_back(item["label"]);
+  }
+  return labels;
+}
+
+// Checks completion of ports, macros and names of the enclosing scopes, and
+// that names declared in an edited buffer are completed right away.
+TEST_F(VerilogLanguageServerSymbolTableTest, CompletionRequest) {
+  constexpr std::string_view module_sub_content =
+      "`define WIDTH 8\n"
+      "module sub(input clk, input [`WIDTH-1:0] data);\n"
+      "endmodule\n";
+  constexpr std::string_view module_top_content =
+      "module top;\n"
+      "  wire data_valid;\n"
+      "  sub u_sub(.clk());\n"
+      "  localparam int W = `WIDTH;\n"
+      "endmodule\n";
+  const verible::file::testing::ScopedTestFile filelist(
+      root_dir, "sub.sv\ntop.sv\n", "verible.filelist");
+  const verible::file::testing::ScopedTestFile module_sub(
+      root_dir, module_sub_content, "sub.sv");
+  const verible::file::testing::ScopedTestFile module_top(
+      root_dir, module_top_content, "top.sv");
+  const std::string module_top_uri = PathToLSPUri(module_top.filename());
+
+  ASSERT_OK(SendRequest(DidOpenRequest(module_top_uri, module_top_content)));
+  GetResponse();
+
+  // Ports of the instantiated module, after "u_sub(."
+  ASSERT_OK(SendRequest(TextDocumentPositionBasedRequest(
+      "textDocument/completion", module_top_uri, 2, 2, 13)));
+  const json ports = json::parse(GetResponse());
+  EXPECT_FALSE(ports["result"]["isIncomplete"]);
+  EXPECT_EQ(CompletionLabels(ports), std::vector<std::string>({"clk", "data"}));
+
+  // Macros, after the backtick.
+  ASSERT_OK(SendRequest(TextDocumentPositionBasedRequest(
+      "textDocument/completion", module_top_uri, 3, 3, 22)));
+  EXPECT_EQ(CompletionLabels(json::parse(GetResponse())),
+            std::vector<std::string>({"WIDTH"}));
+
+  // A new wire is found right after the change, at "e" of "extra".
+  const json change_request = {
+      {"jsonrpc", "2.0"},
+      {"method", "textDocument/didChange"},
+      {"params",
+       {{"textDocument", {{"uri", module_top_uri}}},
+        {"contentChanges",
+         {{{"text",
+            "module top;\n"
+            "  wire data_valid;\n"
+            "  wire extra;\n"
+            "endmodule\n"}}}}}}};
+  ASSERT_OK(SendRequest(change_request.dump()));
+  GetResponse();
+  ASSERT_OK(SendRequest(TextDocumentPositionBasedRequest(
+      "textDocument/completion", module_top_uri, 4, 2, 8)));
+  EXPECT_EQ(CompletionLabels(json::parse(GetResponse())),
+            std::vector<std::string>({"extra"}));
+}
+
 // Check textDocument/definition request when there are two symbols of the same
 // name (variable name), but in different modules
 TEST_F(VerilogLanguageServerSymbolTableTest,
@@ -2227,6 +2648,56 @@ TEST_F(VerilogLanguageServerSymbolTableTest, RenameTestPackageDistinction) {
       << "Invalid result size for id:  ";
 }
 
+class VerilogLanguageServerTelemetryTest : public VerilogLanguageServerTest {
+ protected:
+  // The server keeps the events from when it is created.
+  void SetUp() final {
+    absl::SetFlag(&FLAGS_lsp_telemetry_events, 4);
+    VerilogLanguageServerTest::SetUp();
+  }
+
+  void TearDown() final { absl::SetFlag(&FLAGS_lsp_telemetry_events, 0); }
+};
+
+// Checks that opening a buffer is recorded, and reported both as JSON and
+// as Chrome trace.
+TEST_F(VerilogLanguageServerTelemetryTest, RecordsBufferUpdate) {
+  constexpr std::string_view kContent = "module a;\nendmodule\n";
+  ASSERT_OK(SendRequest(DidOpenRequest("file://a.sv", kContent)));
+  GetResponse();
+
+  ASSERT_OK(SendRequest(
+      R"({"jsonrpc":"2.0", "id":2, "method":"verible/telemetry"})"));
+  const json telemetry = json::parse(GetResponse())["result"];
+  EXPECT_EQ(telemetry["capacity"], 4);
+  EXPECT_EQ(telemetry["dropped"], 0);
+  ASSERT_EQ(telemetry["events"].size(), 1);
+  const json &event = telemetry["events"][0];
+  EXPECT_EQ(event["name"], "buffer-update");
+  EXPECT_EQ(event["subject"], "file://a.sv");
+  EXPECT_EQ(event["bytes"], kContent.size());
+  for (const char *phase : {"lex", "preprocess", "parse", "lint-line-rules"}) {
+    EXPECT_TRUE(event["phasesUs"].contains(phase)) << phase;
+  }
+
+  ASSERT_OK(SendRequest(
+      R"({"jsonrpc":"2.0", "id":3, "method":"verible/telemetry","params":{"format":"chrome"}})"));
+  const json trace = json::parse(GetResponse())["result"];
+  const json &trace_events = trace["traceEvents"];
+  // The update, followed by its phases.
+  ASSERT_EQ(trace_events.size(), 1 + event["phasesUs"].size());
+  EXPECT_EQ(trace_events[0]["name"], "buffer-update");
+  EXPECT_EQ(trace_events[0]["ts"], event["startUs"]);
+  EXPECT_EQ(trace_events[0]["dur"], event["durationUs"]);
+  EXPECT_EQ(trace_events[0]["args"]["subject"], "file://a.sv");
+  EXPECT_EQ(trace_events[0]["ph"], "X");
+  for (size_t i = 1; i < trace_events.size(); ++i) {
+    const std::string name = trace_events[i]["name"];
+    EXPECT_TRUE(event["phasesUs"].contains(name)) << name;
+    EXPECT_EQ(trace_events[i]["ph"], "X");
+  }
+}
+
 // Tests correctness of Language Server shutdown request
 TEST_F(VerilogLanguageServerTest, ShutdownTest) {
   const std::string_view shutdown_request =
@@ -22,7 +22,6 @@
 
 #include <iostream>
 #include <set>
-#include <sstream>  // IWYU pragma: keep  // for ostringstream
 #include <string>   // for string, allocator, etc
 
 #ifdef _WIN32
@@ -39,6 +38,7 @@
 #include "verible/common/strings/obfuscator.h"
 #include "verible/common/util/file-util.h"
 #include "verible/common/util/init-command-line.h"
+#include "verible/common/util/output-sink.h"
 #include "verible/verilog/analysis/extractors.h"
 #include "verible/verilog/preprocessor/verilog-preprocess.h"
 #include "verible/verilog/transform/obfuscate.h"
@@ -149,9 +149,10 @@ Output is written to stdout.
   }
 
   // Encode/obfuscate.  Also verifies decode-ability.
-  std::ostringstream output;  // result buffer
+  std::string output;  // result buffer
+  verible::OutputSink buffer(&output);
   const auto status =
-      verilog::ObfuscateVerilogCode(*content_or, &output, &subst);
+      verilog::ObfuscateVerilogCode(*content_or, &buffer, &subst);
   if (!status.ok()) {
     std::cerr << status.message();
     return 1;
@@ -166,6 +167,11 @@ Output is written to stdout.
   }
 
   // Print obfuscated code.
-  std::cout << output.str();
+  verible::OutputSink stdout_sink(verible::OutputSink::kStdout);
+  stdout_sink.AppendReference(output);
+  if (const absl::Status written = stdout_sink.Flush(); !written.ok()) {
+    std::cerr << written.message() << std::endl;
+    return 1;
+  }
   return 0;
 }
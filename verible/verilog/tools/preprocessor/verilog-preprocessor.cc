@@ -12,9 +12,14 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstddef>
+#include <future>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -23,11 +28,14 @@
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "verible/common/strings/mem-block.h"
 #include "verible/common/text/token-stream-view.h"
 #include "verible/common/util/file-util.h"
 #include "verible/common/util/init-command-line.h"
+#include "verible/common/util/output-sink.h"
 #include "verible/common/util/status-macros.h"
 #include "verible/common/util/subcommand.h"
+#include "verible/common/util/thread-pool.h"
 #include "verible/verilog/analysis/flow-tree.h"
 #include "verible/verilog/analysis/verilog-filelist.h"
 #include "verible/verilog/analysis/verilog-project.h"
@@ -41,6 +49,19 @@ using FileOpener = verilog::VerilogPreprocess::FileOpener;
 
 // TODO(karimtera): Add a boolean flag to configure the macro expansion.
 ABSL_FLAG(int, limit_variants, 20, "Maximum number of variants printed");
+ABSL_FLAG(int, preprocess_threads, 0,
+          "Number of files that 'preprocess' works on concurrently. "
+          "If zero, uses one thread per core.");
+
+// Output to stdout bypasses std::cout, and is written with as few system
+// calls as possible.
+static std::unique_ptr<verible::OutputSink> OutputSinkFor(std::ostream &outs) {
+  if (&outs == &std::cout) {
+    outs.flush();
+    return std::make_unique<verible::OutputSink>(verible::OutputSink::kStdout);
+  }
+  return std::make_unique<verible::OutputSink>(&outs);
+}
 
 static absl::Status StripComments(const SubcommandArgsRange &args,
                                   std::istream &, std::ostream &outs,
@@ -57,8 +78,8 @@ static absl::Status StripComments(const SubcommandArgsRange &args,
         "Missing file argument.  Use '-' for stdin.");
   }
   const std::string_view source_file = files[0];
-  absl::StatusOr<std::string> source_contents_or =
-      verible::file::GetContentAsString(source_file);
+  absl::StatusOr<std::unique_ptr<verible::MemBlock>> source_contents_or =
+      verible::file::GetContentAsMemBlock(source_file);
   if (!source_contents_or.ok()) {
     return source_contents_or.status();
   }
@@ -79,38 +100,69 @@ static absl::Status StripComments(const SubcommandArgsRange &args,
     return absl::InvalidArgumentError("Too many arguments.");
   }
 
-  verilog::StripVerilogComments(*source_contents_or, &outs, replace_char);
-
-  return absl::OkStatus();
+  const auto sink = OutputSinkFor(outs);
+  verilog::StripVerilogComments((*source_contents_or)->AsStringView(),
+                                sink.get(), replace_char);
+  return sink->Flush();
 }
 
-static absl::Status PreprocessSingleFile(
+// Opens each included file once, and shares its contents with all
+// compilation units, which may be preprocessed concurrently.
+class IncludeFileCache {
+ public:
+  explicit IncludeFileCache(const std::vector<std::string> &include_dirs)
+      : project_(".", include_dirs) {}
+
+  absl::StatusOr<std::string_view> Open(std::string_view filename) {
+    const std::lock_guard<std::mutex> lock(mutex_);
+    auto result = project_.OpenIncludedFile(filename);
+    if (!result.status().ok()) return result.status();
+    // The contents stay at the same address as long as the project lives.
+    return (*result)->GetContent();
+  }
+
+ private:
+  std::mutex mutex_;
+  verilog::VerilogProject project_;
+};
+
+// Preprocessed text and messages of one compilation unit.
+struct PreprocessedFile {
+  absl::Status status;
+  std::string output;
+  std::string messages;
+};
+
+static PreprocessedFile PreprocessSingleFile(
     std::string_view source_file,
     const verilog::FileList::PreprocessingInfo &preprocessing_info,
-    std::ostream &outs, std::ostream &message_stream) {
+    IncludeFileCache *include_files,
+    verilog::VerilogIncludeCache *include_cache) {
+  PreprocessedFile result;
   absl::StatusOr<std::string> source_contents_or =
       verible::file::GetContentAsString(source_file);
   if (!source_contents_or.ok()) {
-    message_stream << source_file << source_contents_or.status();
-    return source_contents_or.status();
+    absl::StrAppend(&result.messages, source_file,
+                    source_contents_or.status().ToString());
+    result.status = source_contents_or.status();
+    return result;
   }
   verilog::VerilogPreprocess::Config config;
   config.filter_branches = true;
   config.include_files = true;
   config.expand_macros = true;
 
-  verilog::VerilogProject project(".", preprocessing_info.include_dirs);
-
   FileOpener file_opener =
-      [&project](
+      [include_files](
           std::string_view filename) -> absl::StatusOr<std::string_view> {
-    auto result = project.OpenIncludedFile(filename);
-    if (!result.status().ok()) return result.status();
-    return (*result)->GetContent();
+    return include_files->Open(filename);
   };
   verilog::VerilogPreprocess preprocessor(config, file_opener);
+  preprocessor.setIncludeCache(include_cache);
 
   // Setting the preprocessing info (defines, and incdirs) in the preprocessor.
+  // The preprocessor copies the defines, so every compilation unit starts from
+  // the same command-line defines.
   preprocessor.setPreprocessingInfo(preprocessing_info);
 
   verilog::VerilogLexer lexer(*source_contents_or);
@@ -127,13 +179,19 @@ static absl::Status PreprocessSingleFile(
   InitTokenStreamView(lexed_sequence, &lexed_streamview);
   verilog::VerilogPreprocessData preprocessed_data =
       preprocessor.ScanStream(lexed_streamview);
-  auto &preprocessed_stream = preprocessed_data.preprocessed_token_stream;
-  for (auto u : preprocessed_stream) outs << u->text();
-  for (auto &u : preprocessed_data.errors) outs << u.error_message << '\n';
+  const auto &preprocessed_stream = preprocessed_data.preprocessed_token_stream;
+  size_t output_size = 0;
+  for (auto u : preprocessed_stream) output_size += u->text().size();
+  result.output.reserve(output_size);
+  for (auto u : preprocessed_stream) result.output.append(u->text());
+  for (auto &u : preprocessed_data.errors) {
+    absl::StrAppend(&result.output, u.error_message, "\n");
+  }
   if (!preprocessed_data.errors.empty()) {
-    return absl::InvalidArgumentError("Error: The preprocessing has failed.");
+    result.status =
+        absl::InvalidArgumentError("Error: The preprocessing has failed.");
   }
-  return absl::OkStatus();
+  return result;
 }
 
 static absl::Status MultipleCU(const SubcommandArgsRange &args, std::istream &,
@@ -154,9 +212,37 @@ static absl::Status MultipleCU(const SubcommandArgsRange &args, std::istream &,
   if (files.empty()) {
     return absl::InvalidArgumentError("ERROR: Missing file argument.");
   }
+
+  IncludeFileCache include_files(preprocessing_info.include_dirs);
+  // Headers included by many compilation units under the same relevant
+  // defines are only preprocessed once.
+  verilog::VerilogIncludeCache include_cache;
+  int num_threads = absl::GetFlag(FLAGS_preprocess_threads);
+  if (num_threads <= 0) {
+    num_threads = static_cast<int>(std::thread::hardware_concurrency());
+  }
+  // Compilation units are independent, so they are preprocessed
+  // concurrently, and their outputs are written in the order of the files.
+  // A single file does not need a worker thread.
+  verible::ThreadPool pool(files.size() > 1 && num_threads > 1 ? num_threads
+                                                               : 0);
+  std::vector<std::future<PreprocessedFile>> results;
+  results.reserve(files.size());
   for (const std::string_view source_file : files) {
-    RETURN_IF_ERROR(PreprocessSingleFile(source_file, preprocessing_info, outs,
-                                         message_stream));
+    results.push_back(pool.ExecAsync<PreprocessedFile>(
+        [source_file, &preprocessing_info, &include_files, &include_cache]() {
+          return PreprocessSingleFile(source_file, preprocessing_info,
+                                      &include_files, &include_cache);
+        }));
+  }
+  const auto sink = OutputSinkFor(outs);
+  for (auto &result_future : results) {
+    const PreprocessedFile result = result_future.get();
+    message_stream << result.messages;
+    sink->AppendReference(result.output);
+    RETURN_IF_ERROR(sink->Flush());
+    // Stop at the first failing file; the remaining work is abandoned.
+    RETURN_IF_ERROR(result.status);
   }
   return absl::OkStatus();
 }
@@ -212,7 +298,9 @@ static absl::Status GenerateVariants(const SubcommandArgsRange &args,
         if (counter == limit_variants) return false;
         counter++;
         message_stream << "Variant number " << counter << ":\n";
-        for (auto token : variant.sequence) outs << token << '\n';
+        for (const auto &segment : variant.segments) {
+          for (const auto &token : segment) outs << token << '\n';
+        }
         // TODO(karimtera): Consider creating an output file per vairant,
         // Such that the files naming reflects which defines are
         // defined/undefined.
@@ -231,6 +319,7 @@ Inputs:
   other files (so multiple files will _not_ be treated as compilation unit).
   The +define+ and +include+ directives on the commandline are honored by
   the preprocessor.
+  Files are preprocessed concurrently, see --preprocess_threads.
 Output: (stdout)
   The preprocessed files content (same contents with directives interpreted)
   will be written to stdout, concatenated.
@@ -21,6 +21,7 @@ readonly MY_RELATIVE_INCLUDED_FILE_2="myinclude_2.txt"
 readonly MY_ABSOLUTE_INCLUDED_FILE_2="${TEST_TMPDIR}/${MY_RELATIVE_INCLUDED_FILE_2}"
 readonly MY_INCLUDED_FILE_PATH_2="${MY_ABSOLUTE_INCLUDED_FILE_2%$MY_RELATIVE_INCLUDED_FILE_2}"
 readonly MY_INPUT_FILE="${TEST_TMPDIR}/myinput.txt"
+readonly MY_INPUT_FILE_2="${TEST_TMPDIR}/myinput_2.txt"
 readonly MY_OUTPUT_FILE="${TEST_TMPDIR}/myoutput.txt"
 readonly MY_EXPECT_FILE="${TEST_TMPDIR}/myexpect.txt"
 
@@ -807,5 +808,53 @@ diff --strip-trailing-cr -u "$MY_EXPECT_FILE" "$MY_OUTPUT_FILE" || {
   exit 1
 }
 
+################################################################################
+echo "=== Line:${LINENO} Test preprocess: multiple files concurrently, sharing includes"
+
+cat > "$MY_INPUT_FILE" <<EOF
+\`include "${MY_ABSOLUTE_INCLUDED_FILE_1}"
+\`define B
+first_content
+EOF
+
+cat > "$MY_INPUT_FILE_2" <<EOF
+\`include "${MY_ABSOLUTE_INCLUDED_FILE_1}"
+\`ifdef B
+  B_LEAKED
+\`endif
+second_content
+EOF
+
+cat > "$MY_ABSOLUTE_INCLUDED_FILE_1" <<EOF
+\`ifdef A
+  included_with_A
+\`endif
+EOF
+
+cat > "$MY_EXPECT_FILE" <<EOF
+included_with_A
+first_content
+included_with_A
+second_content
+included_with_A
+first_content
+EOF
+
+"$preprocessor" preprocess --preprocess_threads=3 +define+A \
+  "$MY_INPUT_FILE" "$MY_INPUT_FILE_2" "$MY_INPUT_FILE" > "$MY_OUTPUT_FILE" 2>&1
+
+status="$?"
+
+[[ $status == 0 ]] || {
+  "Expected exit code 0, but got $status"
+  exit 1
+}
+
+# Outputs are in file order, and defines of one file don't leak into another.
+grep -o "[a-zA-Z_]*_\(A\|content\|LEAKED\)" "$MY_OUTPUT_FILE" > "${MY_OUTPUT_FILE}.words"
+diff -u "$MY_EXPECT_FILE" "${MY_OUTPUT_FILE}.words" || {
+  exit 1
+}
+
 ################################################################################
 echo "PASS"
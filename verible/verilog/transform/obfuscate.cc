@@ -25,6 +25,7 @@
 #include "verible/common/strings/random.h"
 #include "verible/common/text/token-info.h"
 #include "verible/common/util/logging.h"
+#include "verible/common/util/output-sink.h"
 #include "verible/common/util/status-macros.h"
 #include "verible/verilog/analysis/verilog-equivalence.h"
 #include "verible/verilog/parser/verilog-lexer.h"
@@ -51,7 +52,7 @@ std::string RandomEqualLengthSymbolIdentifier(std::string_view in) {
 // or use a shuffle/permutation to guarantee collision-free reversibility.
 
 static void ObfuscateVerilogCodeInternal(std::string_view content,
-                                         std::ostream *output,
+                                         verible::OutputSink *output,
                                          IdentifierObfuscator *subst) {
   VLOG(1) << __FUNCTION__;
   verilog::VerilogLexer lexer(content);
@@ -61,12 +62,12 @@ static void ObfuscateVerilogCodeInternal(std::string_view content,
     switch (token.token_enum()) {
       case verilog_tokentype::SymbolIdentifier:
       case verilog_tokentype::PP_Identifier:
-        *output << (*subst)(token.text());
+        output->Append((*subst)(token.text()));
         break;
         // Preserve all $ID calls, including system task/function calls, and VPI
         // calls
       case verilog_tokentype::SystemTFIdentifier:
-        *output << token.text();
+        output->AppendReference(token.text());
         break;
         // The following identifier types start with a special character that
         // needs to be preserved.
@@ -74,7 +75,8 @@ static void ObfuscateVerilogCodeInternal(std::string_view content,
       case verilog_tokentype::MacroCallId:
       case verilog_tokentype::MacroIdItem:
         // TODO(fangism): verilog_tokentype::EscapedIdentifier
-        *output << token.text()[0] << (*subst)(token.text().substr(1));
+        output->Append(token.text()[0]).Append(
+            (*subst)(token.text().substr(1)));
         break;
       // The following tokens are un-lexed, so they need to be lexed
       // recursively.
@@ -84,7 +86,7 @@ static void ObfuscateVerilogCodeInternal(std::string_view content,
         break;
       default:
         // This also covers lexical error tokens.
-        *output << token.text();
+        output->AppendReference(token.text());
     }
   }
   VLOG(1) << "end of " << __FUNCTION__;
@@ -124,10 +126,13 @@ static absl::Status VerifyDecoding(std::string_view original,
   RETURN_IF_ERROR(reverse_subst.load(saved_map));
 
   // Decode and compare.
-  std::ostringstream decoded_output;
-  ObfuscateVerilogCodeInternal(encoded, &decoded_output, &reverse_subst);
-  if (original != decoded_output.str()) {
-    return ReversibilityError(original, encoded, decoded_output.str());
+  std::string decoded_output;
+  {
+    verible::OutputSink sink(&decoded_output);
+    ObfuscateVerilogCodeInternal(encoded, &sink, &reverse_subst);
+  }
+  if (original != decoded_output) {
+    return ReversibilityError(original, encoded, decoded_output);
   }
   return absl::OkStatus();
 }
@@ -160,18 +165,29 @@ static absl::Status VerifyEquivalence(std::string_view original,
 absl::Status ObfuscateVerilogCode(std::string_view content,
                                   std::ostream *output,
                                   IdentifierObfuscator *subst) {
+  verible::OutputSink sink(output);
+  return ObfuscateVerilogCode(content, &sink, subst);
+}
+
+absl::Status ObfuscateVerilogCode(std::string_view content,
+                                  verible::OutputSink *output,
+                                  IdentifierObfuscator *subst) {
   VLOG(1) << __FUNCTION__;
-  std::ostringstream buffer;
-  ObfuscateVerilogCodeInternal(content, &buffer, subst);
+  std::string buffer;
+  buffer.reserve(content.size());  // Obfuscation preserves the length.
+  {
+    verible::OutputSink sink(&buffer);
+    ObfuscateVerilogCodeInternal(content, &sink, subst);
+  }
 
   // Always verify equivalence.
-  RETURN_IF_ERROR(VerifyEquivalence(content, buffer.str()));
+  RETURN_IF_ERROR(VerifyEquivalence(content, buffer));
 
   // Always verify decoding.
-  RETURN_IF_ERROR(VerifyDecoding(content, buffer.str(), *subst));
+  RETURN_IF_ERROR(VerifyDecoding(content, buffer, *subst));
 
-  *output << buffer.str();
-  return absl::OkStatus();
+  output->AppendReference(buffer);
+  return output->Flush();
 }
 
 }  // namespace verilog
@@ -21,6 +21,7 @@
 
 #include "absl/status/status.h"
 #include "verible/common/strings/obfuscator.h"
+#include "verible/common/util/output-sink.h"
 
 namespace verilog {
 
@@ -38,6 +39,12 @@ absl::Status ObfuscateVerilogCode(std::string_view content,
                                   std::ostream *output,
                                   verible::IdentifierObfuscator *subst);
 
+// Ditto, but writing to an OutputSink, which is flushed.  Returns the error
+// of the flush, if any.
+absl::Status ObfuscateVerilogCode(std::string_view content,
+                                  verible::OutputSink *output,
+                                  verible::IdentifierObfuscator *subst);
+
 }  // namespace verilog
 
 #endif  // VERIBLE_VERILOG_TRANSFORM_OBFUSCATE_H_
@@ -14,17 +14,21 @@
 
 #include "verible/verilog/transform/strip-comments.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string_view>
 #include <vector>
 
+#include "absl/strings/match.h"
 #include "absl/strings/str_split.h"
 #include "verible/common/strings/comment-utils.h"
 #include "verible/common/strings/range.h"
 #include "verible/common/text/token-info.h"
 #include "verible/common/util/iterator-range.h"
 #include "verible/common/util/logging.h"
-#include "verible/common/util/spacer.h"
+#include "verible/common/util/output-sink.h"
 #include "verible/verilog/parser/verilog-lexer.h"
 #include "verible/verilog/parser/verilog-parser.h"
 #include "verible/verilog/parser/verilog-token-enum.h"
@@ -32,26 +36,92 @@
 namespace verilog {
 
 using verible::make_string_view_range;
-using verible::Spacer;
+using verible::OutputSink;
 using verible::StripComment;
 using verible::TokenInfo;
 
 // Replace non-newline characters with a single char, like <space>.
 // Tabs are considered non-newline characters.
-static void ReplaceNonNewlines(std::string_view text, std::ostream *output,
+static void ReplaceNonNewlines(std::string_view text, OutputSink *output,
                                char replacement) {
   if (text.empty()) return;
   const std::vector<std::string_view> lines(
       absl::StrSplit(text, absl::ByChar('\n')));
   // no newline before first element
-  *output << Spacer(lines.front().size(), replacement);
+  output->Append(lines.front().size(), replacement);
   for (const auto &line : verible::make_range(lines.begin() + 1, lines.end())) {
-    *output << '\n' << Spacer(line.size(), replacement);
+    output->Append('\n').Append(line.size(), replacement);
+  }
+}
+
+// Writes the replacement of the end-of-line comment 'text', which does not
+// include the terminating newline.
+static void StripEndOfLineComment(std::string_view text, OutputSink *output,
+                                  char replacement) {
+  switch (replacement) {
+    case '\0':
+      // There is always a '\n' that follows, so there is no risk of
+      // accidentally fusing tokens by deleting these comments.
+      break;
+    case ' ':
+      // The comment does not contain '\n'.
+      output->Append(text.length(), ' ');
+      break;
+    default: {
+      // Retain the "//" but erase everything thereafter.
+      const std::string_view body(StripComment(text));
+      const std::string_view head(
+          make_string_view_range(text.begin(), body.begin()));
+      output->AppendReference(head).Append(body.length(), replacement);
+      break;
+    }
+  }
+}
+
+// Writes the replacement of the block comment 'text'.
+static void StripBlockComment(std::string_view text, OutputSink *output,
+                              char replacement) {
+  switch (replacement) {
+    case '\0':
+      // Print one space to prevent accidental token fusion in
+      // cases like: "a/**/b".
+      output->Append(' ');
+      break;
+    case ' ':
+      // Preserve newlines, but replace everything else with space.
+      ReplaceNonNewlines(text, output, replacement);
+      break;
+    default: {
+      // Retain the "/*" and "*/" but erase everything in between.
+      const std::string_view body(StripComment(text));
+      const std::string_view head(
+          make_string_view_range(text.begin(), body.begin()));
+      const std::string_view tail(
+          make_string_view_range(body.end(), text.end()));
+
+      output->AppendReference(head);
+      ReplaceNonNewlines(body, output, replacement);
+      output->AppendReference(tail);
+      break;
+    }
   }
 }
 
 void StripVerilogComments(std::string_view content, std::ostream *output,
                           char replacement) {
+  OutputSink sink(output);
+  StripVerilogComments(content, &sink, replacement);
+}
+
+void StripVerilogComments(std::string_view content, OutputSink *output,
+                          char replacement) {
+  if (StripVerilogCommentsWithScanner(content, output, replacement)) return;
+  VLOG(1) << "Falling back to lexing for comment stripping.";
+  StripVerilogCommentsWithLexer(content, output, replacement);
+}
+
+void StripVerilogCommentsWithLexer(std::string_view content,
+                                   OutputSink *output, char replacement) {
   VLOG(1) << __FUNCTION__;
   verilog::VerilogLexer lexer(content);
 
@@ -67,64 +137,434 @@ void StripVerilogComments(std::string_view content, std::ostream *output,
     const std::string_view text = token.text();
     switch (token.token_enum()) {
       case verilog_tokentype::TK_EOL_COMMENT:
-        switch (replacement) {
-          case '\0':
-            // There is always a '\n' that follows, so there is no risk of
-            // accidentally fusing tokens by deleting these comments.
-            break;
-          case ' ':
-            // The lexer guarantees the text does not contain '\n'.
-            *output << Spacer(text.length());
-            break;
-          default: {
-            // Retain the "//" but erase everything thereafter.
-            const std::string_view body(StripComment(text));
-            const std::string_view head(
-                make_string_view_range(text.begin(), body.begin()));
-            *output << head << Spacer(body.length(), replacement);
-            break;
-          }
-        }
+        StripEndOfLineComment(text, output, replacement);
         break;
-
       case verilog_tokentype::TK_COMMENT_BLOCK:
-        switch (replacement) {
-          case '\0':
-            // Print one space to prevent accidental token fusion in
-            // cases like: "a/**/b".
-            *output << ' ';
-            break;
-          case ' ':
-            // Preserve newlines, but replace everything else with space.
-            ReplaceNonNewlines(text, output, replacement);
-            break;
-          default: {
-            // Retain the "/*" and "*/" but erase everything in between.
-            const std::string_view body(StripComment(text));
-            const std::string_view head(
-                make_string_view_range(text.begin(), body.begin()));
-            const std::string_view tail(
-                make_string_view_range(body.end(), text.end()));
-
-            *output << head;
-            ReplaceNonNewlines(body, output, replacement);
-            *output << tail;
-            break;
-          }
-        }
+        StripBlockComment(text, output, replacement);
         break;
       // The following tokens are un-lexed, so they need to be lexed
       // recursively.
       case verilog_tokentype::MacroArg:
       case verilog_tokentype::PP_define_body:
-        StripVerilogComments(text, output, replacement);
+        StripVerilogCommentsWithLexer(text, output, replacement);
         break;
       default:
         // Preserve all other text, including lexical error tokens.
-        *output << text;
+        output->AppendReference(text);
     }  // switch
   }
   VLOG(1) << "end of " << __FUNCTION__;
 }
 
+namespace {
+
+constexpr size_t kNpos = std::string_view::npos;
+
+// Returns the position of the first character at or after 'pos' that may
+// start a comment, a string, an escaped identifier or a preprocessor
+// directive, or text.size() if there is none.
+// Most text is plain code, which is skipped eight bytes at a time.
+size_t SkipToInterestingChar(std::string_view text, size_t pos) {
+  constexpr uint64_t kOnes = 0x0101010101010101ULL;
+  constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+  const char *const data = text.data();
+  const size_t size = text.size();
+  for (; pos + sizeof(uint64_t) <= size; pos += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, data + pos, sizeof(word));
+    uint64_t found = 0;
+    for (const uint8_t c : {'/', '"', '\\', '`'}) {
+      // Has a zero byte where 'word' has 'c'.
+      const uint64_t diff = word ^ (kOnes * c);
+      found |= (diff - kOnes) & ~diff & kHighBits;
+    }
+    if (found) break;  // It is one of the next eight bytes.
+  }
+  for (; pos < size; ++pos) {
+    switch (data[pos]) {
+      case '/':
+      case '"':
+      case '\\':
+      case '`':
+        return pos;
+      default:
+        break;
+    }
+  }
+  return size;
+}
+
+bool IsIdentifierStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+bool IsIdentifierChar(char c) {
+  return IsIdentifierStart(c) || (c >= '0' && c <= '9') || c == '$';
+}
+
+// Spaces that don't end a line.
+bool IsSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\f' || c == '\b';
+}
+
+// Returns the end of the identifier that starts at 'pos'.
+size_t SkipIdentifier(std::string_view text, size_t pos) {
+  while (pos < text.size() && IsIdentifierChar(text[pos])) ++pos;
+  return pos;
+}
+
+size_t SkipSpaces(std::string_view text, size_t pos) {
+  while (pos < text.size() && IsSpace(text[pos])) ++pos;
+  return pos;
+}
+
+// Skips the string literal that starts with the '"' at *pos.  Returns false
+// if it is unterminated.
+bool SkipStringLiteral(std::string_view text, size_t *pos) {
+  size_t p = *pos + 1;
+  for (;;) {
+    p = text.find_first_of("\"\\\n", p);
+    if (p == kNpos || text[p] == '\n') return false;
+    if (text[p] == '"') break;
+    // An escaped character, or a line continuation.
+    p += 2;
+    if (p > text.size()) return false;
+  }
+  *pos = p + 1;
+  return true;
+}
+
+// Skips the `"..." string that starts at *pos, in which "`" escapes the next
+// character.  Returns false if it is unterminated.
+bool SkipEvalStringLiteral(std::string_view text, size_t *pos) {
+  size_t p = *pos + 2;
+  for (;;) {
+    p = text.find('`', p);
+    if (p == kNpos || p + 1 == text.size()) return false;
+    if (text[p + 1] == '"') break;
+    p += 2;
+  }
+  *pos = p + 2;
+  return true;
+}
+
+// Returns the end of the escaped identifier or the single backslash at 'pos'.
+size_t SkipEscapedIdentifier(std::string_view text, size_t pos) {
+  ++pos;
+  if (pos == text.size() || IsSpace(text[pos]) || text[pos] == '\n') {
+    return pos;
+  }
+  const size_t end = text.find_first_of(" \t\f\b\n", pos);
+  return end == kNpos ? text.size() : end;
+}
+
+// Directives after which the lexer does not look for macro call arguments.
+bool IsDirective(std::string_view name) {
+  static constexpr std::string_view kDirectives[] = {
+      "begin_keywords",
+      "celldefine",
+      "default_decay_time",
+      "default_nettype",
+      "default_trireg_strength",
+      "define",
+      "delay_mode_distributed",
+      "delay_mode_path",
+      "delay_mode_unit",
+      "delay_mode_zero",
+      "disable_portfaults",
+      "else",
+      "elsif",
+      "enable_portfaults",
+      "end_keywords",
+      "endcelldefine",
+      "endif",
+      "endprotect",
+      "ifdef",
+      "ifndef",
+      "include",
+      "nosuppress_faults",
+      "nounconnected_drive",
+      "protect",
+      "resetall",
+      "suppress_faults",
+      "timescale",
+      "unconnected_drive",
+      "undef",
+  };
+  for (const std::string_view directive : kDirectives) {
+    if (name == directive) return true;
+  }
+  return false;
+}
+
+// Returns true if the lexer might not be in its initial state at the comment
+// that starts at 'comment_start', which matters for comments that end with a
+// line continuation: only the initial state leaves that out of the comment.
+// This looks back at the preceding token to spot the states after "edge",
+// '.', `ifdef and friends, and gives up after another comment, which might
+// leave such a state unchanged.
+bool MayFollowSpecialState(std::string_view text, size_t comment_start,
+                           size_t last_comment_end) {
+  size_t p = comment_start;
+  while (p > 0 && (IsSpace(text[p - 1]) || text[p - 1] == '\n')) --p;
+  if (p == 0) return false;
+  if (p == last_comment_end || text[p - 1] == '.') return true;
+  if (!IsIdentifierChar(text[p - 1])) return false;
+  const size_t word_end = p;
+  while (p > 0 && IsIdentifierChar(text[p - 1])) --p;
+  if (p > 0 && text[p - 1] == '`') --p;
+  const std::string_view word = text.substr(p, word_end - p);
+  return word == "edge" || word == "`ifdef" || word == "`ifndef" ||
+         word == "`elsif" || word == "`undef";
+}
+
+// Finds the comments in Verilog text the same way as the VerilogLexer, but
+// without lexing: it only knows about the tokens that may contain something
+// that looks like a comment (strings, escaped identifiers) and about the
+// macro definition bodies and macro call arguments that the lexer lexes
+// again on their own.  It gives up on anything it doesn't handle exactly like
+// the lexer.
+class CommentScanner {
+ public:
+  // Appends the comments found to 'comments', in order.
+  explicit CommentScanner(std::vector<std::string_view> *comments)
+      : comments_(comments) {}
+
+  // Scans 'text' like the lexer does, starting in its initial state.  Returns
+  // false if 'text' contains anything that the lexer might treat differently.
+  bool Scan(std::string_view text);
+
+ private:
+  // Handles the "`" at *pos and what follows it, leaving *pos after it.
+  bool ScanBacktick(std::string_view text, size_t *pos);
+
+  // Handles the `define whose name starts at *pos.
+  bool ScanMacroDefinition(std::string_view text, size_t *pos);
+
+  // Handles the arguments of the macro call whose '(' is at *pos.
+  bool ScanMacroCallArguments(std::string_view text, size_t *pos);
+
+  std::vector<std::string_view> *const comments_;
+};
+
+bool CommentScanner::Scan(std::string_view text) {
+  // After `timescale, the lexer is in a state that doesn't accept comments at
+  // the end of the text, and includes line continuations in comments.
+  const bool has_timescale = absl::StrContains(text, "`timescale");
+  size_t last_comment_end = kNpos;
+  size_t pos = 0;
+  while ((pos = SkipToInterestingChar(text, pos)) < text.size()) {
+    switch (text[pos]) {
+      case '/': {
+        const size_t start = pos++;
+        if (pos == text.size()) break;
+        if (text[pos] == '/') {
+          size_t end = text.find('\n', pos);
+          if (end == kNpos) {
+            if (has_timescale) return false;
+            end = text.size();
+          } else if (end - 1 > pos && text[end - 1] == '\\') {
+            if (has_timescale ||
+                MayFollowSpecialState(text, start, last_comment_end)) {
+              return false;
+            }
+            --end;  // The line continuation is not part of the comment.
+          }
+          comments_->push_back(text.substr(start, end - start));
+          pos = last_comment_end = end;
+        } else if (text[pos] == '*') {
+          const size_t close = text.find("*/", pos + 1);
+          if (close == kNpos) return false;
+          comments_->push_back(text.substr(start, close + 2 - start));
+          pos = last_comment_end = close + 2;
+        }
+        break;
+      }
+      case '"':
+        if (!SkipStringLiteral(text, &pos)) return false;
+        break;
+      case '\\':
+        pos = SkipEscapedIdentifier(text, pos);
+        break;
+      case '`':
+        if (!ScanBacktick(text, &pos)) return false;
+        break;
+    }
+  }
+  return true;
+}
+
+bool CommentScanner::ScanBacktick(std::string_view text, size_t *pos) {
+  const size_t name_start = *pos + 1;
+  if (name_start == text.size()) {
+    ++*pos;
+    return true;
+  }
+  if (text[name_start] == '"') return SkipEvalStringLiteral(text, pos);
+  if (!IsIdentifierStart(text[name_start])) {
+    // "``", or a lone "`"
+    *pos = text[name_start] == '`' ? name_start + 1 : name_start;
+    return true;
+  }
+  const size_t name_end = SkipIdentifier(text, name_start);
+  const std::string_view name = text.substr(name_start, name_end - name_start);
+  *pos = name_end;
+  if (name == "define") return ScanMacroDefinition(text, pos);
+  if (name == "include") {
+    // <file> is a single token that might contain "//".
+    const size_t next = SkipSpaces(text, name_end);
+    return next == text.size() || text[next] != '<';
+  }
+  if (IsDirective(name)) return true;
+  // `pragma, `protected and the like have their own lexer states.
+  if (name == "pragma" || name == "uselib" || name == "protected" ||
+      name == "endprotected" || absl::StartsWith(name, "____verible")) {
+    return false;
+  }
+  // A macro call, if the '(' is on the same line.
+  const size_t next = SkipSpaces(text, name_end);
+  if (next == text.size() || text[next] != '(') return true;
+  *pos = next;
+  return ScanMacroCallArguments(text, pos);
+}
+
+bool CommentScanner::ScanMacroDefinition(std::string_view text, size_t *pos) {
+  size_t p = *pos;
+  while (p < text.size() && (IsSpace(text[p]) || text[p] == '\n')) ++p;
+  if (p == text.size() || !IsIdentifierStart(text[p])) return false;
+  p = SkipIdentifier(text, p);
+  if (p < text.size() && text[p] == '(') {
+    // Formal parameters, which are lexed token by token.  Accept only the
+    // simple ones, without comments, strings or default values in braces.
+    int depth = 0;
+    for (;; ++p) {
+      if (p == text.size()) return false;
+      const char c = text[p];
+      if (c == '(') {
+        ++depth;
+      } else if (c == ')') {
+        if (--depth == 0) break;
+      } else if (c == '"' || c == '/' || c == '{' || c == '}' || c == '`' ||
+                 c == '\\') {
+        return false;
+      }
+    }
+    ++p;
+  }
+  // The body consists of all lines that end with a line continuation, and
+  // the line after them.
+  const size_t body_start = SkipSpaces(text, p);
+  size_t body_end = body_start;
+  for (;;) {
+    const size_t newline = text.find('\n', body_end);
+    if (newline == kNpos) {
+      body_end = text.size();
+      break;
+    }
+    body_end = newline;
+    if (newline == body_start || text[newline - 1] != '\\' ||
+        newline + 1 == text.size()) {
+      break;
+    }
+    body_end = newline + 1;
+  }
+  *pos = body_end;
+  return Scan(text.substr(body_start, body_end - body_start));
+}
+
+bool CommentScanner::ScanMacroCallArguments(std::string_view text,
+                                            size_t *pos) {
+  size_t p = *pos + 1;
+  for (;;) {
+    while (p < text.size() && (IsSpace(text[p]) || text[p] == '\n')) ++p;
+    const size_t arg_start = p;
+    int depth = 0;
+    // Find the end of the argument, which is not lexed yet: only comments,
+    // strings and parentheses are recognized.
+    for (;;) {
+      if (p == text.size()) return false;
+      const char c = text[p];
+      if (depth == 0 && (c == ',' || c == ')')) break;
+      switch (c) {
+        case '(':
+        case '{':
+          ++depth;
+          ++p;
+          break;
+        case ')':
+        case '}':
+          --depth;
+          ++p;
+          break;
+        case '"':
+          if (!SkipStringLiteral(text, &p)) return false;
+          break;
+        case '`':
+          if (p + 1 < text.size() && text[p + 1] == '"') {
+            if (!SkipEvalStringLiteral(text, &p)) return false;
+          } else {
+            ++p;
+          }
+          break;
+        case '/':
+          ++p;
+          if (p == text.size()) return false;
+          if (text[p] == '/') {
+            p = text.find('\n', p);
+            if (p == kNpos) return false;
+          } else if (text[p] == '*') {
+            p = text.find("*/", p + 1);
+            if (p == kNpos) return false;
+            p += 2;
+          }
+          break;
+        default:
+          ++p;
+          break;
+      }
+    }
+    if (!Scan(text.substr(arg_start, p - arg_start))) return false;
+    if (text[p] == ')') break;
+    ++p;  // ','
+  }
+  *pos = p + 1;
+  return true;
+}
+
+}  // namespace
+
+bool StripVerilogCommentsWithScanner(std::string_view content,
+                                     OutputSink *output, char replacement) {
+  VLOG(1) << __FUNCTION__;
+  // Leave text that the scanner doesn't know about to the lexer: NUL bytes,
+  // carriage returns, attributes "(* ... *)" (but not "@(*)") and protected
+  // envelopes.
+  if (content.find_first_of(std::string_view("\0\r", 2)) != kNpos ||
+      absl::StrContains(content, "begin_protected")) {
+    return false;
+  }
+  for (size_t pos = content.find("(*"); pos != kNpos;
+       pos = content.find("(*", pos + 2)) {
+    if (pos + 2 == content.size() || content[pos + 2] != ')') return false;
+  }
+
+  std::vector<std::string_view> comments;
+  CommentScanner scanner(&comments);
+  if (!scanner.Scan(content)) return false;
+
+  const char *text_start = content.data();
+  for (const std::string_view comment : comments) {
+    output->AppendReference(make_string_view_range(text_start, comment.data()));
+    if (comment[1] == '/') {
+      StripEndOfLineComment(comment, output, replacement);
+    } else {
+      StripBlockComment(comment, output, replacement);
+    }
+    text_start = comment.data() + comment.size();
+  }
+  output->AppendReference(
+      make_string_view_range(text_start, content.data() + content.size()));
+  return true;
+}
+
 }  // namespace verilog
@@ -18,6 +18,8 @@
 #include <iosfwd>
 #include <string_view>
 
+#include "verible/common/util/output-sink.h"
+
 namespace verilog {
 
 // Removes or alters comments from Verilog code.
@@ -35,6 +37,29 @@ namespace verilog {
 void StripVerilogComments(std::string_view content, std::ostream *output,
                           char replacement = '\0');
 
+// Ditto, but writing to an OutputSink.  Unchanged text is referenced from
+// 'content', so it must outlive the flushing of 'output'.
+void StripVerilogComments(std::string_view content,
+                          verible::OutputSink *output, char replacement = '\0');
+
+// The two implementations of StripVerilogComments(), which uses the scanner
+// and falls back to the lexer.  Exposed for testing and benchmarking.
+
+// Finds comments with a scanner that only looks for strings, escaped
+// identifiers, comments, macro definitions and macro call arguments, skipping
+// all other text in bulk.  This is much faster than lexing.
+// Returns false, without writing anything, if 'content' contains constructs
+// for which the scanner can't tell that it finds the same comments as the
+// lexer, like attributes, protected envelopes or lexical errors.
+bool StripVerilogCommentsWithScanner(std::string_view content,
+                                     verible::OutputSink *output,
+                                     char replacement = '\0');
+
+// Finds comments by lexing 'content' with the VerilogLexer.
+void StripVerilogCommentsWithLexer(std::string_view content,
+                                   verible::OutputSink *output,
+                                   char replacement = '\0');
+
 }  // namespace verilog
 
 #endif  // VERIBLE_VERILOG_TRANSFORM_STRIP_COMMENTS_H_
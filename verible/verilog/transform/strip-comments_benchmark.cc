@@ -0,0 +1,117 @@
+// Copyright 2017-2020 The Verible Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the speed of the scanner and the lexer implementations of
+// StripVerilogComments() on the given files, and checks that they produce the
+// same output.
+//
+// Usage: strip-comments_benchmark [--iterations=N] files...
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "verible/common/strings/mem-block.h"
+#include "verible/common/util/file-util.h"
+#include "verible/common/util/init-command-line.h"
+#include "verible/common/util/output-sink.h"
+#include "verible/verilog/transform/strip-comments.h"
+
+ABSL_FLAG(int, iterations, 10, "Number of times each file is stripped.");
+
+using StripFunction = bool (*)(std::string_view, verible::OutputSink *, char);
+
+static bool StripWithLexer(std::string_view content,
+                           verible::OutputSink *output, char replacement) {
+  verilog::StripVerilogCommentsWithLexer(content, output, replacement);
+  return true;
+}
+
+// Strips 'content' repeatedly, and returns the time per iteration, or
+// absl::InfiniteDuration() if 'strip' gave up.  The last result is stored in
+// 'output'.
+static absl::Duration TimeStripping(StripFunction strip,
+                                    std::string_view content, int iterations,
+                                    std::string *output) {
+  const absl::Time start = absl::Now();
+  for (int i = 0; i < iterations; ++i) {
+    output->clear();
+    verible::OutputSink sink(output);
+    if (!strip(content, &sink, ' ')) return absl::InfiniteDuration();
+  }
+  return (absl::Now() - start) / iterations;
+}
+
+int main(int argc, char **argv) {
+  const auto usage = absl::StrCat("usage: ", argv[0], " [options] files...");
+  const auto files = verible::InitCommandLine(usage, &argc, &argv);
+  const int iterations = std::max(absl::GetFlag(FLAGS_iterations), 1);
+
+  int exit_code = 0;
+  size_t total_bytes = 0;
+  absl::Duration total_scanner;
+  absl::Duration total_lexer;
+  for (size_t i = 1; i < files.size(); ++i) {
+    const std::string_view filename = files[i];
+    const absl::StatusOr<std::unique_ptr<verible::MemBlock>> content_or =
+        verible::file::GetContentAsMemBlock(filename);
+    if (!content_or.ok()) {
+      std::cerr << content_or.status() << std::endl;
+      exit_code = 1;
+      continue;
+    }
+    const std::string_view content = (*content_or)->AsStringView();
+
+    std::string lexer_output;
+    const absl::Duration lexer_time =
+        TimeStripping(StripWithLexer, content, iterations, &lexer_output);
+    std::string scanner_output;
+    const absl::Duration scanner_time =
+        TimeStripping(verilog::StripVerilogCommentsWithScanner, content,
+                      iterations, &scanner_output);
+    if (scanner_time == absl::InfiniteDuration()) {
+      std::cout << filename << ": not handled by the scanner" << std::endl;
+      continue;
+    }
+    if (scanner_output != lexer_output) {
+      std::cerr << filename << ": scanner and lexer output differ" << std::endl;
+      exit_code = 1;
+      continue;
+    }
+    std::cout << absl::StrFormat("%s: scanner %s, lexer %s\n", filename,
+                                 absl::FormatDuration(scanner_time),
+                                 absl::FormatDuration(lexer_time));
+    total_bytes += content.size();
+    total_scanner += scanner_time;
+    total_lexer += lexer_time;
+  }
+  if (total_bytes > 0) {
+    const double megabytes = total_bytes / 1e6;
+    std::cout << absl::StrFormat(
+        "total %d bytes: scanner %.1f MB/s, lexer %.1f MB/s\n", total_bytes,
+        megabytes / absl::ToDoubleSeconds(total_scanner),
+        megabytes / absl::ToDoubleSeconds(total_lexer));
+  }
+  return exit_code;
+}
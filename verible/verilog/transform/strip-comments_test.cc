@@ -14,14 +14,36 @@
 
 #include "verible/verilog/transform/strip-comments.h"
 
+#include <optional>
 #include <sstream>
+#include <string>
 #include <string_view>
 
 #include "gtest/gtest.h"
+#include "verible/common/util/output-sink.h"
 
 namespace verilog {
 namespace {
 
+std::string StripWithLexer(std::string_view content, char replacement) {
+  std::string result;
+  verible::OutputSink sink(&result);
+  StripVerilogCommentsWithLexer(content, &sink, replacement);
+  return result;
+}
+
+// Returns std::nullopt if the scanner gives up on 'content'.
+std::optional<std::string> StripWithScanner(std::string_view content,
+                                            char replacement) {
+  std::string result;
+  verible::OutputSink sink(&result);
+  if (!StripVerilogCommentsWithScanner(content, &sink, replacement)) {
+    EXPECT_TRUE(result.empty());
+    return std::nullopt;
+  }
+  return result;
+}
+
 struct StripCommentsTestCase {
   std::string_view input;
   std::string_view expect_deleted;
@@ -322,6 +344,60 @@ TEST(StripVerilogCommentsTest, Various) {
       StripVerilogComments(test.input, &stream, '.');
       EXPECT_EQ(stream.str(), test.expect_otherchar);
     }
+    // Both implementations handle all of these.
+    EXPECT_EQ(StripWithScanner(test.input, '.'), test.expect_otherchar);
+    EXPECT_EQ(StripWithLexer(test.input, '.'), test.expect_otherchar);
+  }
+}
+
+// Inputs for which the scanner must find the same comments as the lexer, or
+// give up.
+TEST(StripVerilogCommentsTest, ScannerMatchesLexer) {
+  constexpr struct {
+    std::string_view input;
+    bool scanner_accepts;
+  } kTestCases[] = {
+      {"module m; endmodule // done", true},
+      {"a/b//c\n/d\n", true},
+      {"x = \"// not a comment /* nor this */\";\n", true},
+      {"x = \"\\\"// still a string\";\n", true},
+      {"x = \"line \\\n continued // in string\";\n", true},
+      {"\\esc//aped /* a comment */\n", true},
+      {"`define S `\"a // b`\"\n", true},
+      {"`define M(a, b) a /* x */ + \\\n  b // y\nz\n", true},
+      {"`define M \\\n", true},
+      {"`define M(a, b) a \\", true},
+      {"`M(/* a */ x, (y, /* b */ z), {1, 2} // c\n )\n", true},
+      {"`M (\"(\", `\"), // `\") /*x*/\n", true},
+      {"`ifdef A // c\n`endif // d\n", true},
+      {"`include \"a//b.svh\" // c\n", true},
+      {"always @(*) begin /* c */ end\n", true},
+      {"a = b; // continued \\\nc = d;\n", true},
+      {"x = a ``b; `c /* d */\n", true},
+      {"/* block\n * comment\n */ a /*/ b */\n", true},
+      // Constructs that the scanner leaves to the lexer.
+      {"(* attr = \"//\" *) wire w; // c\n", false},
+      {"x = \"unterminated // c\n", false},
+      {"/* unterminated\n", false},
+      {"`include <a//b.svh> // c\n", false},
+      {"`M(a, // c", false},
+      {"`define M(a /* x */) a\n", false},
+      {"`timescale 1ns/1ps // c", false},
+      {"`ifdef // c \\\nA\n", false},
+      {"always @(edge // c \\\n [01] x)\n", false},
+      {"a = b;\r\n// c\r\n", false},
+      {"`pragma protect begin_protected\n// c\n", false},
+  };
+  for (const auto &test : kTestCases) {
+    for (const char replacement : {'\0', ' ', '.'}) {
+      const std::optional<std::string> scanned =
+          StripWithScanner(test.input, replacement);
+      EXPECT_EQ(scanned.has_value(), test.scanner_accepts) << test.input;
+      if (scanned.has_value()) {
+        EXPECT_EQ(*scanned, StripWithLexer(test.input, replacement))
+            << test.input;
+      }
+    }
   }
 }
 